@@ -58,55 +58,58 @@ int main(int /*argc*/, char** /*argv*/) {
   const int32_t var_l2 = 2 * numbers + 4;
 
   /* Define the actual program. First, declare the algorithm's working variables. */
-  beast::Program prg;
+  beast::ProgramBuilder prg;
   prg.declareVariable(var_i, beast::Program::VariableType::Int32);
   prg.declareVariable(var_j, beast::Program::VariableType::Int32);
   prg.declareVariable(var_temp, beast::Program::VariableType::Int32);
   prg.declareVariable(var_l1, beast::Program::VariableType::Link);
   prg.declareVariable(var_l2, beast::Program::VariableType::Link);
 
-  /* Bubblesort uses two cascaded loops; store their starting addresses here to be able to
-     conditionally jump back. */
+  /* Bubblesort uses two cascaded loops; label their starting addresses to be able to conditionally
+     jump back. */
+  const beast::ProgramBuilder::Label outer_loop_start = prg.createLabel();
+  const beast::ProgramBuilder::Label inner_loop_start = prg.createLabel();
   prg.setVariable(var_i, 0x0, false);
-  const auto outer_loop_start = static_cast<int32_t>(prg.getPointer());
+  prg.bindLabel(outer_loop_start);
   prg.setVariable(var_j, 0x0, false);
-  const auto inner_loop_start = static_cast<int32_t>(prg.getPointer());
+  prg.bindLabel(inner_loop_start);
 
   /* Here we use the Link variable type for an indirection operation. `var_l1` and `var_l2` are
      links, so their value is used as a variable address when reading/writing to them. This way, we
      can access variables by knowing their index in another variable, allowing array iterations and
      alike. For bubblesort, we need this to iterate through all known numbers of the array to
-     sort. */
+     sort. The swap is skipped by jumping forward to a label that is bound only after it. */
   prg.copyVariable(var_j, true, var_l1, false);
   prg.copyVariable(var_j, true, var_l2, false);
   prg.addConstantToVariable(var_l2, 1, false);
   prg.compareIfVariableGtVariable(var_l1, true, var_l2, true, var_temp, true);
-  beast::Program swap;
-  swap.swapVariables(var_l1, true, var_l2, true);
-  prg.relativeJumpToAddressIfVariableEqualsZero(
-      var_temp, true, static_cast<int32_t>(swap.getSize()));
-  prg.insertProgram(swap);
+  const beast::ProgramBuilder::Label swap_end = prg.createLabel();
+  prg.jumpToLabelIfVariableEqualsZero(var_temp, true, swap_end);
+  prg.swapVariables(var_l1, true, var_l2, true);
+  prg.bindLabel(swap_end);
 
   /* The next two blocks are the cascaded loop tails; `var_j` controls the inner loop, `var_i`
      controls the outer loop. */
   prg.addConstantToVariable(var_j, 1, false);
   prg.compareIfVariableLtConstant(var_j, false, numbers - 1, var_temp, true);
-  prg.absoluteJumpToAddressIfVariableGreaterThanZero(var_temp, true, inner_loop_start);
+  prg.jumpToLabelIfVariableGreaterThanZero(var_temp, true, inner_loop_start);
 
   prg.addConstantToVariable(var_i, 1, false);
   prg.compareIfVariableLtConstant(var_i, false, numbers - 1, var_temp, true);
-  prg.absoluteJumpToAddressIfVariableGreaterThanZero(var_temp, true, outer_loop_start);
+  prg.jumpToLabelIfVariableGreaterThanZero(var_temp, true, outer_loop_start);
 
   /* Copy working variables to output after execution. */
   for (int32_t idx : output_variables) {
     prg.copyVariable(idx - numbers, true, idx, true);
   }
 
-  /* for informational purposes only, print the sort program's total length. */
-  std::cout << "Program length: " << prg.getSize() << " bytes" << std::endl;
+  /* Resolve the label jumps. For informational purposes only, print the sort program's total
+     length. */
+  beast::Program sort_program = prg.build();
+  std::cout << "Program length: " << sort_program.getSize() << " bytes" << std::endl;
 
   /* Define the session to use, and register input and output variables. */
-  beast::VmSession session(std::move(prg), 2 * numbers + 5, 0, 0);
+  beast::VmSession session(std::move(sort_program), 2 * numbers + 5, 0, 0);
   for (int32_t idx : input_variables) {
     session.setVariableBehavior(idx, beast::VmSession::VariableIoBehavior::Input);
     session.setVariableValue(idx, true, input[idx]);
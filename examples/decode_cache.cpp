@@ -0,0 +1,88 @@
+// Standard
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// BEAST
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Runs copies of a prepared session to their end and returns the mean time per run
+ */
+std::chrono::duration<double, std::micro> measure(const beast::VmSession& prototype, int32_t runs) {
+  beast::CpuVirtualMachine virtual_machine;
+  virtual_machine.setSilent(true);
+  const auto start = std::chrono::steady_clock::now();
+  for (int32_t run = 0; run < runs; ++run) {
+    beast::VmSession session = prototype;
+    while (virtual_machine.stepBlock(session, false)) {}
+  }
+  return (std::chrono::steady_clock::now() - start) / runs;
+}
+}  // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  /* Print BEAST library version. */
+  const auto version = beast::getVersion();
+  std::cout << "Using BEAST library version "
+            << static_cast<uint32_t>(version[0]) << "."
+            << static_cast<uint32_t>(version[1]) << "."
+            << static_cast<uint32_t>(version[2]) << "." << std::endl;
+
+  /* A loop that sums up a decreasing counter, with some arithmetic in its body. Every iteration
+     executes the same instructions again, which is where the decode cache replays them. */
+  const int32_t sum_variable = 0;
+  const int32_t counter_variable = 1;
+  const int32_t scratch_variable = 2;
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label loop = builder.createLabel();
+  builder.declareVariable(sum_variable, beast::Program::VariableType::Int32);
+  builder.declareVariable(counter_variable, beast::Program::VariableType::Int32);
+  builder.declareVariable(scratch_variable, beast::Program::VariableType::Int32);
+  builder.setVariable(counter_variable, 10000, true);
+  builder.bindLabel(loop);
+  builder.copyVariable(counter_variable, true, scratch_variable, true);
+  builder.bitShiftVariableLeft(scratch_variable, true, 2);
+  builder.addVariableToVariable(scratch_variable, true, sum_variable, true);
+  builder.addConstantToVariable(counter_variable, -1, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(counter_variable, true, loop);
+  builder.terminate(0);
+  const beast::Program program = builder.build();
+  const std::vector<unsigned char> compact = beast::CompactEncoding::compact(program.getData());
+
+  const int32_t rounds = 10;
+  const int32_t runs = 50;
+  for (const auto encoding : {beast::ProgramEncoding::Standard, beast::ProgramEncoding::Compact}) {
+    const beast::ProgramView code =
+        encoding == beast::ProgramEncoding::Standard ? program.getData() : compact;
+
+    /* Both sessions are verified, so the uncached one fetches operands without bounds checks.
+       The other one additionally replays its instructions from the decode cache, which all
+       copies of it share. */
+    beast::VmSession verified(code, 3, 0, 0, encoding);
+    if (!verified.verifyProgram().valid) {
+      std::cerr << "The program doesn't verify." << std::endl;
+      return EXIT_FAILURE;
+    }
+    beast::VmSession cached = verified;
+    cached.setDecodeCacheEnabled(true);
+
+    /* Alternate between both sessions and keep the fastest round of each, so that other load on
+       the machine affects both alike. */
+    auto verified_time = measure(verified, runs);
+    auto cached_time = measure(cached, runs);
+    for (int32_t round = 1; round < rounds; ++round) {
+      verified_time = std::min(verified_time, measure(verified, runs));
+      cached_time = std::min(cached_time, measure(cached, runs));
+    }
+    std::cout << (encoding == beast::ProgramEncoding::Standard ? "Standard" : "Compact")
+              << " encoding: " << verified_time.count() << " us per run verified, "
+              << cached_time.count() << " us per run with decode cache ("
+              << verified_time / cached_time << "x)" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+// Standard
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// BEAST
+#include <beast/beast.hpp>
+
+/* A pipe that scores its candidates on networked workers instead of locally. */
+class DistributedPipe : public beast::Pipe {
+ public:
+  DistributedPipe(uint32_t max_candidates, beast::EvaluationCoordinator& coordinator)
+    : Pipe(max_candidates), coordinator_{coordinator} {
+  }
+
+  ~DistributedPipe() override { stop(std::nothrow); }
+
+  [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+    return coordinator_.evaluate({program_data}).at(0);
+  }
+
+  [[nodiscard]] std::vector<double> evaluateBatch(
+      const std::vector<std::vector<unsigned char>>& programs) override {
+    return coordinator_.evaluate(programs);
+  }
+
+ private:
+  beast::EvaluationCoordinator& coordinator_;
+};
+
+/* Scores programs by how few NoOp instructions they execute. */
+double evaluateProgram(beast::ProgramView program_data) {
+  if (program_data.empty()) {
+    return 0.0;
+  }
+  // The byte code is executed in place, without copying it into a Program.
+  beast::VmSession session(program_data, 100, 10, 25);
+  beast::CpuVirtualMachine virtual_machine;
+  virtual_machine.setSilent(true);
+  try {
+    while (virtual_machine.step(session, true)) {
+      // No action to perform, just statically step through the program.
+    }
+  } catch(...) {
+    // If the program throws an exception, it gets a 0.0 score.
+    return 0.0;
+  }
+
+  beast::OperatorUsageEvaluator evaluator(beast::OpCode::NoOp);
+  return 1.0 - evaluator.evaluate(session);
+}
+
+int main(int /*argc*/, char** /*argv*/) {
+  /* Print BEAST library version. */
+  const auto version = beast::getVersion();
+  std::cout << "Using BEAST library version "
+            << static_cast<uint32_t>(version[0]) << "."
+            << static_cast<uint32_t>(version[1]) << "."
+            << static_cast<uint32_t>(version[2]) << "." << std::endl;
+
+  // Evolution parameters
+  const uint32_t pop_size = 10;
+  const uint32_t batch_size = 4;
+
+  // Program execution environment
+  const uint32_t prg_size = 50;
+  const uint32_t mem_size = 100;
+  const uint32_t string_table_size = 10;
+  const uint32_t string_table_item_length = 25;
+
+  /* Workers usually run on other machines (see the `evaluation_worker` example). For this example,
+     two of them are started locally and connect via the loopback interface. */
+  std::vector<std::thread> worker_threads;
+  {
+    beast::EvaluationCoordinator coordinator(0, batch_size, "127.0.0.1");
+    const uint16_t port = coordinator.getPort();
+    std::cout << "Coordinator listening on port " << port << "." << std::endl;
+
+    for (uint32_t idx = 0; idx < 2; ++idx) {
+      worker_threads.emplace_back([port]() {
+        beast::EvaluationWorker worker(evaluateProgram);
+        (void)worker.run("127.0.0.1", port);
+      });
+    }
+
+    DistributedPipe pipe(pop_size, coordinator);
+    beast::RandomProgramFactory factory;
+
+    while (pipe.hasSpace()) {
+      beast::Program prg =
+          factory.generate(prg_size, mem_size, string_table_size, string_table_item_length);
+      pipe.addInput(prg.getData());
+    }
+
+    pipe.evolve();
+
+    uint32_t finalists = 0;
+    while (pipe.hasOutput()) {
+      const beast::Pipe::OutputItem item = pipe.drawOutput();
+      std::cout << "Finalist: size = " << item.data.size() << " bytes, score = " << item.score
+                << std::endl;
+      finalists++;
+    }
+
+    std::cout << "Got " << finalists << " finalists." << std::endl;
+  }
+
+  /* Destroying the coordinator sent a shutdown signal to all workers. */
+  for (std::thread& worker_thread : worker_threads) {
+    worker_thread.join();
+  }
+
+  return 0;
+}
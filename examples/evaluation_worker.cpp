@@ -0,0 +1,56 @@
+// Standard
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// BEAST
+#include <beast/beast.hpp>
+
+/* Scores programs the same way as the `distributed_pipe` example's coordinator expects. */
+double evaluateProgram(beast::ProgramView program_data) {
+  if (program_data.empty()) {
+    return 0.0;
+  }
+  // The byte code is executed in place, without copying it into a Program.
+  beast::VmSession session(program_data, 100, 10, 25);
+  beast::CpuVirtualMachine virtual_machine;
+  virtual_machine.setSilent(true);
+  try {
+    while (virtual_machine.step(session, true)) {
+      // No action to perform, just statically step through the program.
+    }
+  } catch(...) {
+    // If the program throws an exception, it gets a 0.0 score.
+    return 0.0;
+  }
+
+  beast::OperatorUsageEvaluator evaluator(beast::OpCode::NoOp);
+  return 1.0 - evaluator.evaluate(session);
+}
+
+int main(int argc, char** argv) {
+  /* Print BEAST library version. */
+  const auto version = beast::getVersion();
+  std::cout << "Using BEAST library version "
+            << static_cast<uint32_t>(version[0]) << "."
+            << static_cast<uint32_t>(version[1]) << "."
+            << static_cast<uint32_t>(version[2]) << "." << std::endl;
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <coordinator host> <coordinator port>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /* Serve batches of programs until the coordinator shuts down. Any number of these workers can
+     be started (and stopped) on different machines while an evolution is running. */
+  const std::string host = argv[1];
+  const auto port = static_cast<uint16_t>(std::stoul(argv[2]));
+
+  beast::EvaluationWorker worker(evaluateProgram);
+  const uint64_t evaluated = worker.run(host, port);
+
+  std::cout << "Evaluated " << evaluated << " programs." << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -32,22 +32,23 @@ int main(int /*argc*/, char** /*argv*/) {
         outside the program.
      4. Once the counting variable reaches 0, terminate the program.
   */
-  beast::Program prg;
+  beast::ProgramBuilder prg;
   prg.declareVariable(count_variable, beast::Program::VariableType::Int32);
   prg.setVariable(count_variable, count_start_value, true);
   prg.declareVariable(input_changed_variable, beast::Program::VariableType::Int32);
   prg.setVariable(input_changed_variable, 0, true);
 
-  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  const beast::ProgramBuilder::Label loop_start = prg.createLabel();
+  prg.bindLabel(loop_start);
   prg.checkIfInputWasSet(input_variable, true, input_changed_variable, true);
-  prg.absoluteJumpToAddressIfVariableEqualsZero(input_changed_variable, true, loop_start_address);
+  prg.jumpToLabelIfVariableEqualsZero(input_changed_variable, true, loop_start);
   prg.subtractConstantFromVariable(count_variable, 1, true);
   prg.printVariable(count_variable, true, false);
   prg.copyVariable(count_variable, true, output_variable, true);
-  prg.absoluteJumpToAddressIfVariableGreaterThanZero(count_variable, true, loop_start_address);
+  prg.jumpToLabelIfVariableGreaterThanZero(count_variable, true, loop_start);
   prg.terminate(0);
 
-  beast::VmSession session(std::move(prg), 500, 100, 50);
+  beast::VmSession session(prg.build(), 500, 100, 50);
   session.setVariableBehavior(input_variable, beast::VmSession::VariableIoBehavior::Input);
   session.setVariableBehavior(output_variable, beast::VmSession::VariableIoBehavior::Output);
 
@@ -12,12 +12,14 @@ class SimplePipe : public beast::Pipe {
     : Pipe(max_candidates), mem_size_{mem_size}, st_size_{st_size}, sti_size_{sti_size} {
   }
 
+  ~SimplePipe() override { stop(std::nothrow); }
+
   [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
     if (program_data.empty()) {
       return 0.0;
     }
-    beast::Program prg(program_data);
-    beast::VmSession session(std::move(prg), mem_size_, st_size_, sti_size_);
+    // The byte code is executed in place, without copying it into a Program.
+    beast::VmSession session(program_data, mem_size_, st_size_, sti_size_);
     beast::CpuVirtualMachine virtual_machine;
     virtual_machine.setSilent(true);
     try {
@@ -0,0 +1,89 @@
+// Standard
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// BEAST
+#include <beast/beast.hpp>
+
+int main(int /*argc*/, char** /*argv*/) {
+  /* Print BEAST library version. */
+  const auto version = beast::getVersion();
+  std::cout << "Using BEAST library version "
+            << static_cast<uint32_t>(version[0]) << "."
+            << static_cast<uint32_t>(version[1]) << "."
+            << static_cast<uint32_t>(version[2]) << "." << std::endl;
+
+  /* Declare the variable indices and values to use in this program. */
+  const int32_t input_variable = 0;
+  const int32_t count_variable = 1;
+  const int32_t count_start_value = 5;
+  const int32_t input_changed_variable = 2;
+  const int32_t output_variable = 3;
+
+  /* This is the same program as in the `feedloop` example: it counts down once per input it
+     receives and copies the counter into an output variable. Instead of stepping a single session
+     in a polling loop, many such sessions (e.g., one per connected device) are handed to a
+     scheduler that runs them on a few threads and parks them while they wait for input. */
+  beast::Program prg;
+  prg.declareVariable(count_variable, beast::Program::VariableType::Int32);
+  prg.setVariable(count_variable, count_start_value, true);
+  prg.declareVariable(input_changed_variable, beast::Program::VariableType::Int32);
+  prg.setVariable(input_changed_variable, 0, true);
+
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.checkIfInputWasSet(input_variable, true, input_changed_variable, true);
+  prg.absoluteJumpToAddressIfVariableEqualsZero(input_changed_variable, true, loop_start_address);
+  prg.subtractConstantFromVariable(count_variable, 1, true);
+  prg.copyVariable(count_variable, true, output_variable, true);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(count_variable, true, loop_start_address);
+  prg.terminate(0);
+
+  const uint32_t device_count = 1000;
+  const uint32_t thread_count = 4;
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::SessionScheduler scheduler(virtual_machine, thread_count);
+
+  std::vector<beast::SessionScheduler::SessionId> devices;
+  for (uint32_t idx = 0; idx < device_count; ++idx) {
+    beast::VmSession session(prg, 500, 100, 50);
+    session.setVariableBehavior(input_variable, beast::VmSession::VariableIoBehavior::Input);
+    session.setVariableBehavior(output_variable, beast::VmSession::VariableIoBehavior::Output);
+    devices.push_back(scheduler.addSession(std::move(session)));
+  }
+
+  using namespace std::chrono_literals;
+  for (int32_t tick = 0; tick < count_start_value; ++tick) {
+    std::this_thread::sleep_for(100ms);
+
+    /* Feed every device with new input; parked sessions wake up and run again. */
+    for (const beast::SessionScheduler::SessionId device : devices) {
+      scheduler.setInput(device, input_variable, tick);
+    }
+    scheduler.waitUntilIdle();
+
+    /* Collect the outputs. */
+    int64_t output_sum = 0;
+    for (const beast::SessionScheduler::SessionId device : devices) {
+      scheduler.accessSession(device, [&output_sum](beast::VmSession& session) {
+        if (session.hasOutputDataAvailable(output_variable, true)) {
+          output_sum += session.getVariableValue(output_variable, true);
+        }
+      });
+    }
+    std::cout << "Tick " << tick << ": sum of device outputs = " << output_sum << std::endl;
+  }
+
+  uint32_t finished = 0;
+  for (const beast::SessionScheduler::SessionId device : devices) {
+    if (scheduler.getState(device) == beast::SessionScheduler::SessionState::Finished) {
+      finished++;
+    }
+  }
+  std::cout << finished << " of " << device_count << " device sessions finished." << std::endl;
+
+  return finished == device_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,16 +5,42 @@
 #include <array>
 
 // Internal
+#include <beast/behavior_archive.hpp>
+#include <beast/bounded_queue.hpp>
+#include <beast/cancellation_token.hpp>
+#include <beast/compact_encoding.hpp>
+#include <beast/control_flow_graph.hpp>
 #include <beast/cpu_virtual_machine.hpp>
 #include <beast/evaluator.hpp>
+#include <beast/evolution_checkpoint.hpp>
+#include <beast/fitness_cache.hpp>
+#include <beast/fitness_case_runner.hpp>
+#include <beast/genetic_operators.hpp>
+#include <beast/instruction_decoder.hpp>
+#include <beast/mapped_file.hpp>
+#include <beast/message_sink.hpp>
 #include <beast/opcodes.hpp>
 #include <beast/pipe.hpp>
+#include <beast/pipeline.hpp>
 #include <beast/program.hpp>
+#include <beast/program_builder.hpp>
+#include <beast/program_canonicalizer.hpp>
+#include <beast/program_corpus.hpp>
+#include <beast/program_optimizer.hpp>
+#include <beast/program_verifier.hpp>
+#include <beast/program_view.hpp>
 #include <beast/random_program_factory.hpp>
+#include <beast/session_scheduler.hpp>
+#include <beast/surrogate_model.hpp>
 #include <beast/time_functions.hpp>
 #include <beast/version.h>
 #include <beast/vm_session.hpp>
 
+#include <beast/distributed/evaluation_coordinator.hpp>
+#include <beast/distributed/evaluation_worker.hpp>
+#include <beast/distributed/tcp_connection.hpp>
+#include <beast/distributed/wire_protocol.hpp>
+
 #include <beast/evaluators/aggregation_evaluator.hpp>
 #include <beast/evaluators/operator_usage_evaluator.hpp>
 #include <beast/evaluators/runtime_statistics_evaluator.hpp>
@@ -0,0 +1,201 @@
+#ifndef BEAST_BEHAVIOR_ARCHIVE_HPP_
+#define BEAST_BEHAVIOR_ARCHIVE_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+// Internal
+#include <beast/vm_session.hpp>
+
+namespace beast {
+
+/**
+ * @class BehaviorArchive
+ * @brief A growing archive of fixed-size behavior descriptors with a nearest neighbour index
+ *
+ * Novelty search rewards programs for behaving differently from the ones seen before, measured as
+ * the mean distance of a program's behavior descriptor to its nearest neighbours in this archive.
+ * As the archive grows by up to one descriptor per evaluation, scanning it linearly would soon cost
+ * more than running the programs, so descriptors are indexed by a forest of vantage-point trees.
+ *
+ * New descriptors are appended to a small unindexed buffer. Once the buffer is full, it is built
+ * into a tree together with all trees of the same size (the logarithmic method), so there are at
+ * most logarithmically many trees, and every descriptor is only rebuilt into a tree logarithmically
+ * often. Queries search all trees, pruning subtrees with the triangle inequality, plus the buffer.
+ * Descriptors are stored contiguously as floats, and distances are computed by a kernel that the
+ * compiler vectorizes and that abandons a distance as soon as it exceeds the current k-th nearest
+ * neighbour.
+ *
+ * The archive is thread-safe: queries may run concurrently, insertions are exclusive.
+ */
+class BehaviorArchive {
+ public:
+  /**
+   * @fn BehaviorArchive::BehaviorArchive
+   * @brief Constructs an empty archive
+   *
+   * Throws if the dimension is zero.
+   *
+   * @param dimension The number of values in each descriptor
+   */
+  explicit BehaviorArchive(size_t dimension);
+
+  /**
+   * @fn BehaviorArchive::describeOperatorUsage
+   * @brief Returns a descriptor holding the share of executed steps per operator
+   *
+   * The descriptor has one value per OpCode (see getOperatorUsageDimension()), so programs that
+   * spend their execution on the same operators are close to each other.
+   *
+   * @param statistics The runtime statistics of a program's execution
+   */
+  [[nodiscard]] static std::vector<float> describeOperatorUsage(
+      const VmSession::RuntimeStatistics& statistics);
+
+  /**
+   * @fn BehaviorArchive::getOperatorUsageDimension
+   * @brief Returns the dimension of descriptors created by describeOperatorUsage()
+   */
+  [[nodiscard]] static size_t getOperatorUsageDimension() noexcept;
+
+  /**
+   * @fn BehaviorArchive::getDimension
+   * @brief Returns the number of values in each descriptor
+   */
+  [[nodiscard]] size_t getDimension() const noexcept;
+
+  /**
+   * @fn BehaviorArchive::getSize
+   * @brief Returns the number of descriptors in the archive
+   */
+  [[nodiscard]] size_t getSize() const;
+
+  /**
+   * @fn BehaviorArchive::insert
+   * @brief Adds a descriptor to the archive
+   *
+   * Throws if the descriptor's dimension differs from the archive's.
+   *
+   * @param descriptor The descriptor to add
+   */
+  void insert(const std::vector<float>& descriptor);
+
+  /**
+   * @fn BehaviorArchive::findNearestDistances
+   * @brief Returns the Euclidean distances to the `count` nearest descriptors, closest first
+   *
+   * Fewer distances are returned if the archive holds fewer descriptors. Throws if the descriptor's
+   * dimension differs from the archive's.
+   *
+   * @param descriptor The descriptor to find the neighbours of
+   * @param count The number of neighbours to find
+   */
+  [[nodiscard]] std::vector<double> findNearestDistances(
+      const std::vector<float>& descriptor, size_t count) const;
+
+  /**
+   * @fn BehaviorArchive::computeNovelty
+   * @brief Returns the mean distance to the `count` nearest descriptors, or 0.0 if the archive is
+   *        empty
+   *
+   * @param descriptor The descriptor to compute the novelty of
+   * @param count The number of neighbours to average over
+   */
+  [[nodiscard]] double computeNovelty(const std::vector<float>& descriptor, size_t count) const;
+
+ private:
+  /**
+   * @brief A vantage-point tree over a contiguous range of descriptors
+   *
+   * The tree is stored implicitly in `points`: a subtree spanning `[begin, end)` with more than
+   * kLeafSize points has its vantage point at `begin`, the points within `radii[begin]` of it in
+   * the first half of `(begin, end)`, and the points beyond in the second half. Smaller subtrees
+   * are leaves that are scanned linearly.
+   */
+  struct Tree {
+    uint32_t first;                ///< The first descriptor covered by the tree
+    std::vector<uint32_t> points;  ///< The covered descriptors, in tree order
+    std::vector<float> radii;      ///< The partitioning radius of each vantage point
+  };
+
+  /**
+   * @brief The nearest neighbours found so far, as a max-heap of squared distances
+   */
+  class NeighbourHeap;
+
+  /**
+   * @fn BehaviorArchive::buildTree
+   * @brief Builds the subtree spanning `[begin, end)` of a tree's points in place
+   *
+   * `order` is scratch space for sorting points by their distance to a vantage point.
+   */
+  void buildTree(Tree& tree, size_t begin, size_t end,
+                 std::vector<std::pair<float, uint32_t>>& order) const;
+
+  /**
+   * @fn BehaviorArchive::searchTree
+   * @brief Adds the nearest neighbours in the subtree spanning `[begin, end)` to the heap
+   */
+  void searchTree(
+      const Tree& tree, size_t begin, size_t end, const float* query, NeighbourHeap& heap) const;
+
+  /**
+   * @fn BehaviorArchive::considerPoint
+   * @brief Adds a descriptor to the heap if it is closer than the current k-th neighbour
+   */
+  void considerPoint(uint32_t point, const float* query, NeighbourHeap& heap) const;
+
+  /**
+   * @fn BehaviorArchive::getDescriptor
+   * @brief Returns the start of a stored descriptor
+   */
+  [[nodiscard]] const float* getDescriptor(uint32_t point) const noexcept;
+
+  /**
+   * @brief Number of unindexed descriptors that are built into a tree at once
+   */
+  static constexpr size_t kBufferSize = 256;
+
+  /**
+   * @brief Maximum number of points in a subtree that is scanned instead of split
+   */
+  static constexpr size_t kLeafSize = 16;
+
+  /**
+   * @var BehaviorArchive::dimension_
+   * @brief The number of values in each descriptor
+   */
+  size_t dimension_;
+
+  /**
+   * @var BehaviorArchive::descriptors_
+   * @brief All descriptors, stored contiguously in insertion order
+   */
+  std::vector<float> descriptors_;
+
+  /**
+   * @var BehaviorArchive::trees_
+   * @brief The index, covering consecutive ranges of descriptors from the oldest on, largest first
+   */
+  std::vector<Tree> trees_;
+
+  /**
+   * @var BehaviorArchive::indexed_count_
+   * @brief The number of descriptors covered by the trees; the rest are buffered
+   */
+  size_t indexed_count_ = 0;
+
+  /**
+   * @var BehaviorArchive::mutex_
+   * @brief Lets queries share the archive while insertions are exclusive
+   */
+  mutable std::shared_mutex mutex_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_BEHAVIOR_ARCHIVE_HPP_
@@ -0,0 +1,310 @@
+#ifndef BEAST_BOUNDED_QUEUE_HPP_
+#define BEAST_BOUNDED_QUEUE_HPP_
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace beast {
+
+/**
+ * @class BoundedQueue
+ * @brief A lock-free, fixed capacity queue for multiple producers and multiple consumers
+ *
+ * The queue is a ring buffer of cells that each carry a sequence number, as described by Dmitry
+ * Vyukov. Producers and consumers claim a position with a single compare-and-swap on the shared
+ * enqueue or dequeue counter and then only touch their own cell, so neither side ever blocks the
+ * other. The `try` variants of pushing into a full queue and popping from an empty one fail
+ * immediately. The blocking variants retry with an increasing back-off (spinning, then yielding,
+ * then sleeping briefly) instead of waiting on a condition variable, so the queue stays free of
+ * locks on both paths.
+ *
+ * The capacity is rounded up to the next power of two, and to at least 2, as a single cell can't
+ * distinguish a full queue from an empty one by its sequence number.
+ *
+ * @tparam T The type of the stored items; must be default constructible and movable
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @fn BoundedQueue::BoundedQueue
+   * @brief Constructs an empty queue holding at most `capacity` items (rounded up to a power of 2)
+   *
+   * @param capacity The minimum number of items the queue can hold; must be greater than 0
+   */
+  explicit BoundedQueue(size_t capacity)
+    : capacity_{roundUpToPowerOfTwo(capacity)}, mask_{capacity_ - 1},
+      cells_{std::make_unique<Cell[]>(capacity_)} {
+    for (size_t idx = 0; idx < capacity_; ++idx) {
+      cells_[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * @fn BoundedQueue::tryPush
+   * @brief Moves an item into the queue if there is space left
+   *
+   * @param item The item to push; left untouched if the queue is full
+   * @return `true` if the item was pushed, `false` if the queue was full
+   */
+  [[nodiscard]] bool tryPush(T&& item) {
+    Cell* cell = nullptr;
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // The cell still holds an item from the previous lap; the queue is full.
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->item = std::move(item);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @fn BoundedQueue::tryPop
+   * @brief Moves the oldest item out of the queue if there is one
+   *
+   * @return The oldest item, or no value if the queue was empty
+   */
+  [[nodiscard]] std::optional<T> tryPop() {
+    Cell* cell = nullptr;
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+      if (difference == 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // No producer has finished writing this cell yet; the queue is empty.
+        return std::nullopt;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    std::optional<T> item(std::move(cell->item));
+    cell->item = T();
+    cell->sequence.store(position + capacity_, std::memory_order_release);
+    return item;
+  }
+
+  /**
+   * @fn BoundedQueue::push
+   * @brief Moves an item into the queue, waiting until there is space left
+   *
+   * @param item The item to push
+   */
+  void push(T&& item) {
+    for (uint32_t attempt = 0; !tryPush(std::move(item)); ++attempt) {
+      backOff(attempt);
+    }
+  }
+
+  /**
+   * @fn BoundedQueue::tryPushFor
+   * @brief Moves an item into the queue, waiting at most `timeout` for space
+   *
+   * @param item The item to push; left untouched if the queue stayed full
+   * @param timeout The maximum time to wait
+   * @return `true` if the item was pushed, `false` if the queue stayed full
+   */
+  [[nodiscard]] bool tryPushFor(T&& item, std::chrono::steady_clock::duration timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (uint32_t attempt = 0; !tryPush(std::move(item)); ++attempt) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      backOff(attempt);
+    }
+    return true;
+  }
+
+  /**
+   * @fn BoundedQueue::pop
+   * @brief Moves the oldest item out of the queue, waiting until there is one
+   *
+   * @return The oldest item
+   */
+  [[nodiscard]] T pop() {
+    for (uint32_t attempt = 0;; ++attempt) {
+      if (std::optional<T> item = tryPop()) {
+        return std::move(*item);
+      }
+      backOff(attempt);
+    }
+  }
+
+  /**
+   * @fn BoundedQueue::tryPopFor
+   * @brief Moves the oldest item out of the queue, waiting at most `timeout` for one
+   *
+   * @param timeout The maximum time to wait
+   * @return The oldest item, or no value if the queue stayed empty
+   */
+  [[nodiscard]] std::optional<T> tryPopFor(std::chrono::steady_clock::duration timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (uint32_t attempt = 0;; ++attempt) {
+      if (std::optional<T> item = tryPop()) {
+        return item;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return std::nullopt;
+      }
+      backOff(attempt);
+    }
+  }
+
+  /**
+   * @fn BoundedQueue::forEach
+   * @brief Calls `visitor` with every item in the queue, oldest first, without removing them
+   *
+   * Producers may keep pushing meanwhile; items they push while the queue is being visited may or
+   * may not be visited. The queue must not be popped from at the same time, as a consumer would
+   * move an item out from under the visitor.
+   *
+   * @param visitor Called with a const reference to each item
+   */
+  template <typename Visitor>
+  void forEach(Visitor&& visitor) const {
+    const size_t enqueue_position = enqueue_position_.load(std::memory_order_acquire);
+    for (size_t position = dequeue_position_.load(std::memory_order_acquire);
+         position != enqueue_position; ++position) {
+      const Cell& cell = cells_[position & mask_];
+      if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        // A producer claimed this cell but hasn't finished writing it yet.
+        break;
+      }
+      visitor(static_cast<const T&>(cell.item));
+    }
+  }
+
+  /**
+   * @fn BoundedQueue::getCapacity
+   * @brief Returns the maximum number of items the queue can hold
+   */
+  [[nodiscard]] size_t getCapacity() const noexcept {
+    return capacity_;
+  }
+
+  /**
+   * @fn BoundedQueue::getApproximateSize
+   * @brief Returns the number of items in the queue
+   *
+   * The value is exact when no other thread is pushing or popping at the same time, and only an
+   * approximation otherwise.
+   */
+  [[nodiscard]] size_t getApproximateSize() const noexcept {
+    const size_t dequeue_position = dequeue_position_.load(std::memory_order_acquire);
+    const size_t enqueue_position = enqueue_position_.load(std::memory_order_acquire);
+    return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+  }
+
+ private:
+  /**
+   * @brief A slot of the ring buffer and the sequence number denoting whose turn it is
+   */
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    T item{};
+  };
+
+  /**
+   * @fn BoundedQueue::backOff
+   * @brief Waits before the next attempt of a blocking operation
+   *
+   * Short waits are served by spinning and yielding, which keeps the latency low when the other
+   * side is active. Long waits sleep, so that idle threads don't burn a core.
+   *
+   * @param attempt The number of failed attempts so far
+   */
+  static void backOff(uint32_t attempt) {
+    if (attempt < 64) {
+      return;
+    }
+    if (attempt < 128) {
+      std::this_thread::yield();
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  /**
+   * @fn BoundedQueue::roundUpToPowerOfTwo
+   * @brief Returns the smallest power of two that is not smaller than `value` and at least 2
+   */
+  static size_t roundUpToPowerOfTwo(size_t value) {
+    if (value == 0) {
+      throw std::invalid_argument("Queue capacity must be greater than 0.");
+    }
+    size_t result = 2;
+    while (result < value) {
+      result <<= 1U;
+    }
+    return result;
+  }
+
+  /**
+   * @var BoundedQueue::capacity_
+   * @brief The number of cells in the ring buffer
+   */
+  const size_t capacity_;
+
+  /**
+   * @var BoundedQueue::mask_
+   * @brief Maps ever increasing positions to cell indices
+   */
+  const size_t mask_;
+
+  /**
+   * @var BoundedQueue::cells_
+   * @brief The ring buffer
+   */
+  std::unique_ptr<Cell[]> cells_;
+
+  /**
+   * @var BoundedQueue::enqueue_position_
+   * @brief The position the next item is pushed to
+   *
+   * Kept on its own cache line so that producers and consumers don't invalidate each other's lines.
+   */
+  alignas(64) std::atomic<size_t> enqueue_position_{0};
+
+  /**
+   * @var BoundedQueue::dequeue_position_
+   * @brief The position the next item is popped from
+   */
+  alignas(64) std::atomic<size_t> dequeue_position_{0};
+};
+
+}  // namespace beast
+
+#endif  // BEAST_BOUNDED_QUEUE_HPP_
@@ -0,0 +1,50 @@
+#ifndef BEAST_CANCELLATION_TOKEN_HPP_
+#define BEAST_CANCELLATION_TOKEN_HPP_
+
+// Standard
+#include <atomic>
+
+namespace beast {
+
+/**
+ * @class CancellationToken
+ * @brief A flag that allows to asynchronously cancel program execution
+ *
+ * A token is attached to one or more VmSession instances (see VmSession::setCancellationToken).
+ * Any thread can call cancel() at any time; sessions holding the token stop before executing their
+ * next step and report the cancellation in their runtime statistics.
+ */
+class CancellationToken {
+ public:
+  /**
+   * @fn CancellationToken::cancel
+   * @brief Requests cancellation of all sessions holding this token
+   */
+  void cancel() noexcept;
+
+  /**
+   * @fn CancellationToken::reset
+   * @brief Withdraws a cancellation request so that the token can be reused
+   */
+  void reset() noexcept;
+
+  /**
+   * @fn CancellationToken::isCancelled
+   * @brief Denotes whether cancellation was requested
+   *
+   * @return `true` if cancel() was called since construction or the last reset(), `false`
+   *         otherwise
+   */
+  [[nodiscard]] bool isCancelled() const noexcept;
+
+ private:
+  /**
+   * @var CancellationToken::cancelled_
+   * @brief Whether cancellation was requested
+   */
+  std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace beast
+
+#endif  // BEAST_CANCELLATION_TOKEN_HPP_
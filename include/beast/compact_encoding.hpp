@@ -0,0 +1,172 @@
+#ifndef BEAST_COMPACT_ENCODING_HPP_
+#define BEAST_COMPACT_ENCODING_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Internal
+#include <beast/instruction_decoder.hpp>
+#include <beast/opcodes.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @brief The byte code encodings a VmSession can execute
+ */
+enum class ProgramEncoding {
+  Standard,  ///< Fixed size operands, as written by the Program class
+  Compact    ///< Variable length operands and packed flags (see CompactEncoding)
+};
+
+/**
+ * @class CompactEncoding
+ * @brief Converts byte code between the standard and a compact encoding
+ *
+ * In the standard encoding, every four byte operand takes four bytes and every flag takes a whole
+ * byte, even though most variable indices and constants are small. The compact encoding writes the
+ * same instructions with the same OpCodes, but:
+ *
+ * - Variable indices, four byte constants, string table indices, and jump addresses are written as
+ *   zigzag encoded LEB128 varints of one to five bytes.
+ * - String lengths are written as unsigned LEB128 varints, followed by the characters.
+ * - One byte constants are written as they are.
+ * - Flags are packed into bits. Operators with a single flag store it in the OpCode's most
+ *   significant bit, which is otherwise unused. For operators with more flags, that bit denotes
+ *   whether a byte follows the OpCode that holds the i-th flag in bit i; if no flag is set, the
+ *   byte is left out.
+ *
+ * `AddVariableToVariable(1, false, 2, false)`, for example, takes 3 bytes instead of 11.
+ *
+ * Constant jump targets address the compact instructions, so they are relocated when converting.
+ * Byte code whose behavior depends on its layout (see ProgramOptimizer::isRelocatable()) can't be
+ * converted. The conversion is lossless: expanding compacted byte code restores it, except that
+ * flag bytes other than `0x0` and `0x1` become `0x1`, and compacting expanded byte code restores
+ * the compact byte code it was expanded from, if that was produced by compact(). A VmSession
+ * executes compact byte code directly if it is constructed with ProgramEncoding::Compact.
+ */
+class CompactEncoding {
+ public:
+  /**
+   * @brief A decoded LEB128 varint
+   */
+  struct Varint {
+    uint32_t value = 0;  ///< The decoded value
+    size_t size = 0;     ///< The number of bytes the value was encoded in
+  };
+
+  /**
+   * @fn CompactEncoding::compact
+   * @brief Converts standard byte code into the compact encoding
+   *
+   * Throws if the byte code can't be relocated (see ProgramOptimizer::isRelocatable()).
+   *
+   * @param code The standard byte code to convert
+   * @return The compact byte code
+   */
+  [[nodiscard]] static std::vector<unsigned char> compact(ProgramView code);
+
+  /**
+   * @fn CompactEncoding::expand
+   * @brief Converts compact byte code into the standard encoding
+   *
+   * Throws if the byte code doesn't decode into complete compact instructions, or if a constant
+   * jump target lies off an instruction boundary.
+   *
+   * @param code The compact byte code to convert
+   * @return The standard byte code
+   */
+  [[nodiscard]] static std::vector<unsigned char> expand(ProgramView code);
+
+  /**
+   * @fn CompactEncoding::decode
+   * @brief Decodes the compact instruction starting at `offset`
+   *
+   * @param code The compact byte code to decode from
+   * @param offset The byte offset of the instruction's OpCode
+   * @return The instruction, or no value if the bytes don't form a complete known instruction
+   */
+  [[nodiscard]] static std::optional<InstructionDecoder::Instruction> decode(
+      ProgramView code, size_t offset) noexcept;
+
+  /**
+   * @fn CompactEncoding::decodeAll
+   * @brief Decodes compact byte code into consecutive instructions
+   *
+   * Decoding stops at the first offset that doesn't start a complete known instruction.
+   *
+   * @param code The compact byte code to decode
+   * @return The decoded instructions in ascending offset order
+   */
+  [[nodiscard]] static std::vector<InstructionDecoder::Instruction> decodeAll(ProgramView code);
+
+  /**
+   * @fn CompactEncoding::getJumpTarget
+   * @brief Returns the absolute target address of a compact jump with a constant target
+   *
+   * Relative targets are converted to absolute ones. Jumps to variable addresses have no constant
+   * target.
+   *
+   * @param code The compact byte code the instruction was decoded from
+   * @param instruction The decoded compact instruction
+   * @return The absolute jump target, or no value
+   */
+  [[nodiscard]] static std::optional<int64_t> getJumpTarget(
+      ProgramView code, const InstructionDecoder::Instruction& instruction);
+
+  /**
+   * @fn CompactEncoding::getFlagCount
+   * @brief Returns the number of flag operands of an operator
+   *
+   * Throws if the operator is unknown.
+   *
+   * @param opcode The operator to count the flags of
+   * @return The number of flag operands
+   */
+  [[nodiscard]] static size_t getFlagCount(OpCode opcode);
+
+  /**
+   * @fn CompactEncoding::readVarint
+   * @brief Reads an unsigned LEB128 varint
+   *
+   * @param code The byte code to read from
+   * @param offset The byte offset of the varint's first byte
+   * @return The varint, or no value if it is truncated or longer than five bytes
+   */
+  [[nodiscard]] static std::optional<Varint> readVarint(ProgramView code, size_t offset) noexcept;
+
+  /**
+   * @fn CompactEncoding::toSigned
+   * @brief Decodes a zigzag encoded value
+   *
+   * @param value The zigzag encoded value
+   * @return The signed value
+   */
+  [[nodiscard]] static int32_t toSigned(uint32_t value) noexcept {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+
+  /**
+   * @fn CompactEncoding::toUnsigned
+   * @brief Zigzag encodes a value, so that values close to zero encode into few bytes
+   *
+   * @param value The signed value
+   * @return The zigzag encoded value
+   */
+  [[nodiscard]] static uint32_t toUnsigned(int32_t value) noexcept {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value < 0 ? -1 : 0);
+  }
+
+  /**
+   * @var CompactEncoding::kFlagBit
+   * @brief The OpCode bit holding the flag, or denoting a following flag byte
+   */
+  static constexpr unsigned char kFlagBit = 0x80;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_COMPACT_ENCODING_HPP_
@@ -0,0 +1,218 @@
+#ifndef BEAST_CONTROL_FLOW_GRAPH_HPP_
+#define BEAST_CONTROL_FLOW_GRAPH_HPP_
+
+// Standard
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Internal
+#include <beast/compact_encoding.hpp>
+#include <beast/instruction_decoder.hpp>
+#include <beast/opcodes.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class ControlFlowGraph
+ * @brief Splits byte code into basic blocks and connects them by the ways execution can take
+ *
+ * A basic block is a sequence of instructions that is only entered at its first instruction and
+ * only left after its last one. Blocks start at the beginning of the code, at every constant jump
+ * target, and after every instruction that jumps or terminates. Every block knows the blocks
+ * execution may continue with (its successors), and the blocks execution may come from (its
+ * predecessors):
+ *
+ * - Blocks that end in a conditional jump have two successors, the jump target and the next block.
+ * - Blocks that end in an unconditional jump have the jump target as their only successor.
+ * - Blocks that end in a jump to a variable address have unknown successors, since the address is
+ *   only known at runtime. Conditional variable address jumps continue with the next block as well.
+ * - Blocks that end in a terminate operator, or jump to or run into the end of the code, are exit
+ *   blocks. So are blocks that jump to addresses outside the code or run into bytes that don't
+ *   decode, as execution ends (abnormally) there.
+ *
+ * Constant jumps into the middle of an instruction have unknown successors as well. The first
+ * block, if any, is the entry block. The graph only covers the part of the code that decodes into
+ * complete instructions.
+ */
+class ControlFlowGraph {
+ public:
+  /**
+   * @brief How an operator affects the flow of execution
+   */
+  enum class FlowType {
+    Continue,                ///< Execution continues with the next instruction
+    ConditionalJump,         ///< Jumps to a constant address or continues with the next instruction
+    Jump,                    ///< Jumps to a constant address
+    ConditionalVariableJump, ///< Jumps to a variable address or continues with the next instruction
+    VariableJump,            ///< Jumps to a variable address
+    Terminate                ///< Ends the program
+  };
+
+  /**
+   * @brief A basic block
+   */
+  struct BasicBlock {
+    size_t begin = 0;                                          ///< The first instruction's offset
+    size_t end = 0;                                            ///< The offset after the block
+    std::vector<InstructionDecoder::Instruction> instructions; ///< The block's instructions
+    std::vector<size_t> successors;    ///< The indices of the blocks execution may continue with
+    std::vector<size_t> predecessors;  ///< The indices of the blocks execution may come from
+    bool has_unknown_successors = false;  ///< Whether execution may continue anywhere else
+    bool is_exit = false;                 ///< Whether execution may end after this block
+  };
+
+  /**
+   * @brief A natural loop, formed by the back edges to a block that dominates their sources
+   */
+  struct Loop {
+    size_t header = 0;                ///< The index of the block every iteration starts at
+    std::vector<size_t> blocks;       ///< The indices of the loop's blocks, including the header
+    std::vector<size_t> back_edges;   ///< The indices of the blocks that jump back to the header
+  };
+
+  /**
+   * @fn ControlFlowGraph::ControlFlowGraph
+   * @brief Builds the control flow graph of byte code
+   *
+   * @param code The byte code to analyze
+   * @param encoding The encoding of the byte code
+   */
+  explicit ControlFlowGraph(
+      ProgramView code, ProgramEncoding encoding = ProgramEncoding::Standard);
+
+  /**
+   * @fn ControlFlowGraph::getFlowType
+   * @brief Returns how an operator affects the flow of execution
+   *
+   * @param opcode The operator
+   * @return The operator's flow type
+   */
+  [[nodiscard]] static FlowType getFlowType(OpCode opcode) noexcept;
+
+  /**
+   * @fn ControlFlowGraph::usesVariableIo
+   * @brief Determines whether an operator inspects the I/O behavior the host set for variables
+   *
+   * Code using these operators depends on which variable indices the host feeds or reads, so its
+   * variables can't be tracked or renumbered without the host's knowledge.
+   *
+   * @param opcode The operator
+   */
+  [[nodiscard]] static bool usesVariableIo(OpCode opcode) noexcept;
+
+  /**
+   * @fn ControlFlowGraph::getBlocks
+   * @brief Returns all basic blocks in ascending offset order
+   *
+   * @return The basic blocks; the first one is the entry block
+   */
+  [[nodiscard]] const std::vector<BasicBlock>& getBlocks() const noexcept;
+
+  /**
+   * @fn ControlFlowGraph::getExitBlocks
+   * @brief Returns the indices of all exit blocks
+   *
+   * @return The exit block indices in ascending order
+   */
+  [[nodiscard]] std::vector<size_t> getExitBlocks() const;
+
+  /**
+   * @fn ControlFlowGraph::getBlockAt
+   * @brief Returns the block that contains a byte offset
+   *
+   * @param offset The byte offset
+   * @return The index of the block, or no value if the offset isn't covered by the graph
+   */
+  [[nodiscard]] std::optional<size_t> getBlockAt(size_t offset) const noexcept;
+
+  /**
+   * @fn ControlFlowGraph::getInstructionCount
+   * @brief Returns the number of instructions in all blocks
+   */
+  [[nodiscard]] size_t getInstructionCount() const noexcept;
+
+  /**
+   * @fn ControlFlowGraph::getDecodedSize
+   * @brief Returns the number of bytes covered by the graph, from the beginning of the code
+   *
+   * This is smaller than the code's size if the code ends in bytes that don't decode.
+   */
+  [[nodiscard]] size_t getDecodedSize() const noexcept;
+
+  /**
+   * @fn ControlFlowGraph::hasUnknownSuccessors
+   * @brief Returns whether any reachable block has unknown successors
+   *
+   * If so, reachability, dominators, and loops only reflect the known edges.
+   */
+  [[nodiscard]] bool hasUnknownSuccessors() const;
+
+  /**
+   * @fn ControlFlowGraph::getReachableBlocks
+   * @brief Marks the blocks that known edges lead to from the entry block
+   *
+   * @return Whether each block is reachable, by block index
+   */
+  [[nodiscard]] std::vector<bool> getReachableBlocks() const;
+
+  /**
+   * @fn ControlFlowGraph::getImmediateDominators
+   * @brief Returns the immediate dominator of every reachable block
+   *
+   * A block dominates another one if every path from the entry block to the other one passes
+   * through it. The immediate dominator is the closest strict dominator; the entry block is its own
+   * immediate dominator.
+   *
+   * @return The index of each block's immediate dominator, or no value for unreachable blocks
+   */
+  [[nodiscard]] std::vector<std::optional<size_t>> getImmediateDominators() const;
+
+  /**
+   * @fn ControlFlowGraph::dominates
+   * @brief Returns whether a block dominates another one
+   *
+   * Every reachable block dominates itself. Unreachable blocks neither dominate nor are dominated.
+   *
+   * @param dominator The index of the dominating block
+   * @param block The index of the dominated block
+   * @return `true` if `dominator` dominates `block`, `false` otherwise
+   */
+  [[nodiscard]] bool dominates(size_t dominator, size_t block) const;
+
+  /**
+   * @fn ControlFlowGraph::getLoops
+   * @brief Detects the natural loops of the reachable blocks
+   *
+   * Back edges to the same header form a single loop. Cycles that can be entered at more than one
+   * block aren't natural loops and aren't reported.
+   *
+   * @return The loops, ordered by header index
+   */
+  [[nodiscard]] std::vector<Loop> getLoops() const;
+
+ private:
+  /**
+   * @fn ControlFlowGraph::getReversePostOrder
+   * @brief Orders the reachable blocks so that blocks come before their successors, back edges
+   *        aside
+   */
+  [[nodiscard]] std::vector<size_t> getReversePostOrder() const;
+
+  /**
+   * @var ControlFlowGraph::blocks_
+   * @brief The basic blocks in ascending offset order
+   */
+  std::vector<BasicBlock> blocks_;
+
+  /**
+   * @var ControlFlowGraph::decoded_size_
+   * @brief The number of bytes covered by the blocks
+   */
+  size_t decoded_size_ = 0;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_CONTROL_FLOW_GRAPH_HPP_
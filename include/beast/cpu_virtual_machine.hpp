@@ -27,8 +27,21 @@ class CpuVirtualMachine : public VirtualMachine {
 
   [[nodiscard]] bool step(VmSession& session, bool dry_run) override;
 
+  [[nodiscard]] bool stepBlock(VmSession& session, bool dry_run) override;
+
  protected:
   void message(MessageSeverity severity, const std::string& message) noexcept override;
+
+ private:
+  /**
+   * @fn CpuVirtualMachine::execute
+   * @brief Fetches the operands of an instruction whose operator was fetched, and executes it
+   *
+   * @param session The VmSession instance that holds the program and state to execute.
+   * @param instruction The instruction's operator.
+   * @param dry_run Determines whether the operator is executed or just read.
+   */
+  void execute(VmSession& session, OpCode instruction, bool dry_run);
 };
 
 }  // namespace beast
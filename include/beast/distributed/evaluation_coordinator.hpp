@@ -0,0 +1,263 @@
+#ifndef BEAST_EVALUATION_COORDINATOR_HPP_
+#define BEAST_EVALUATION_COORDINATOR_HPP_
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Internal
+#include <beast/distributed/tcp_connection.hpp>
+#include <beast/distributed/wire_protocol.hpp>
+
+namespace beast {
+
+/**
+ * @class EvaluationCoordinator
+ * @brief Distributes program evaluations over networked workers
+ *
+ * The coordinator owns the population side of a distributed evolution run. It listens on a TCP
+ * port for EvaluationWorker instances and, whenever evaluate() is called, splits the passed in
+ * programs into batches that are handed out to whichever worker is idle. Workers may connect and
+ * disconnect at any time, also while a generation is being evaluated: a batch that was in flight on
+ * a worker that left, or that didn't answer within the batch timeout, is put back into the queue
+ * and handed to the next idle worker.
+ *
+ * A Pipe can be distributed by overriding Pipe::evaluateBatch and forwarding to evaluate().
+ */
+class EvaluationCoordinator {
+ public:
+  /**
+   * @fn EvaluationCoordinator::EvaluationCoordinator
+   * @brief Starts listening for workers
+   *
+   * @param port The TCP port to listen on; `0` picks a free port (see getPort())
+   * @param batch_size The maximum number of programs sent to a worker per message
+   * @param bind_address The local address to listen on
+   */
+  explicit EvaluationCoordinator(
+      uint16_t port, uint32_t batch_size = 32, const std::string& bind_address = "0.0.0.0");
+
+  EvaluationCoordinator(const EvaluationCoordinator&) = delete;
+  EvaluationCoordinator& operator=(const EvaluationCoordinator&) = delete;
+
+  /**
+   * @fn EvaluationCoordinator::~EvaluationCoordinator
+   * @brief Sends a Shutdown message to all workers and disconnects them
+   */
+  ~EvaluationCoordinator();
+
+  /**
+   * @fn EvaluationCoordinator::getPort
+   * @brief Returns the TCP port workers can connect to
+   */
+  [[nodiscard]] uint16_t getPort() const noexcept;
+
+  /**
+   * @fn EvaluationCoordinator::setBatchTimeout
+   * @brief Sets how long a worker may take to score a batch
+   *
+   * A worker that doesn't send the batch's scores in time, e.g. because a program never terminates
+   * or the connection broke without being closed, is dropped, and its batch is handed to the next
+   * idle worker. Defaults to one minute.
+   *
+   * @param timeout The maximum time between sending a batch and receiving its scores
+   */
+  void setBatchTimeout(std::chrono::milliseconds timeout);
+
+  /**
+   * @fn EvaluationCoordinator::getBatchTimeout
+   * @brief Returns how long a worker may take to score a batch
+   */
+  [[nodiscard]] std::chrono::milliseconds getBatchTimeout() const;
+
+  /**
+   * @fn EvaluationCoordinator::setIdleTimeout
+   * @brief Sets how long evaluate() waits for a worker while none is connected
+   *
+   * Defaults to one minute.
+   *
+   * @param timeout The maximum time an evaluation goes on without any connected worker
+   */
+  void setIdleTimeout(std::chrono::milliseconds timeout);
+
+  /**
+   * @fn EvaluationCoordinator::getIdleTimeout
+   * @brief Returns how long evaluate() waits for a worker while none is connected
+   */
+  [[nodiscard]] std::chrono::milliseconds getIdleTimeout() const;
+
+  /**
+   * @fn EvaluationCoordinator::getWorkerCount
+   * @brief Returns the number of currently connected workers
+   *
+   * Connections that haven't completed the handshake yet are not counted.
+   */
+  [[nodiscard]] size_t getWorkerCount() const;
+
+  /**
+   * @fn EvaluationCoordinator::evaluate
+   * @brief Scores a set of programs on the connected workers
+   *
+   * Blocks until every program was scored. If no worker is connected, the call waits until one
+   * joins, and throws if none was connected for the idle timeout (see setIdleTimeout()). Only one
+   * evaluation can run at a time; concurrent calls are serialized.
+   *
+   * @param programs The program byte codes to score
+   * @return The scores, in the same order as `programs`
+   */
+  [[nodiscard]] std::vector<double> evaluate(
+      const std::vector<std::vector<unsigned char>>& programs);
+
+ private:
+  /**
+   * @brief A batch of programs waiting for, or being evaluated by, a worker
+   */
+  struct PendingBatch {
+    WireProtocol::EvaluationBatch batch;  ///< The batch as it is sent to a worker
+    size_t first_index;                   ///< Index of the batch's first program in the generation
+  };
+
+  /**
+   * @brief A connected worker and the thread serving it
+   */
+  struct WorkerSlot {
+    TcpConnection connection;             ///< The connection to the worker
+    std::thread thread;                   ///< The thread exchanging messages with the worker
+    std::atomic<bool> greeted{false};     ///< Whether the worker completed the handshake
+    std::atomic<bool> finished{false};    ///< Whether the worker has left
+  };
+
+  /**
+   * @fn EvaluationCoordinator::acceptWorkers
+   * @brief Accepts connecting workers until the coordinator is stopped
+   *
+   * Every connection is handed to its own serving thread right away, so a peer that never greets
+   * doesn't hold up the workers connecting after it.
+   */
+  void acceptWorkers();
+
+  /**
+   * @fn EvaluationCoordinator::serveWorker
+   * @brief Hands out batches to a single worker until it leaves or the coordinator stops
+   *
+   * Drops the connection if the peer doesn't send a compatible Hello within a few seconds.
+   */
+  void serveWorker(WorkerSlot& slot);
+
+  /**
+   * @fn EvaluationCoordinator::reapFinishedWorkers
+   * @brief Joins the threads of workers that have left
+   *
+   * Must be called with `workers_mutex_` held.
+   */
+  void reapFinishedWorkers();
+
+  /**
+   * @var EvaluationCoordinator::listener_
+   * @brief The socket workers connect to
+   */
+  TcpListener listener_;
+
+  /**
+   * @var EvaluationCoordinator::batch_size_
+   * @brief The maximum number of programs per batch
+   */
+  uint32_t batch_size_;
+
+  /**
+   * @var EvaluationCoordinator::stopping_
+   * @brief Set when the coordinator is being destroyed
+   */
+  std::atomic<bool> stopping_{false};
+
+  /**
+   * @var EvaluationCoordinator::mutex_
+   * @brief Guards the batch queue, the results of the current evaluation, and the timeouts
+   */
+  mutable std::mutex mutex_;
+
+  /**
+   * @var EvaluationCoordinator::batch_available_
+   * @brief Signalled when batches are queued or the coordinator stops
+   */
+  std::condition_variable batch_available_;
+
+  /**
+   * @var EvaluationCoordinator::batch_completed_
+   * @brief Signalled whenever a batch was scored
+   */
+  std::condition_variable batch_completed_;
+
+  /**
+   * @var EvaluationCoordinator::pending_
+   * @brief Batches waiting for an idle worker
+   */
+  std::deque<PendingBatch> pending_;
+
+  /**
+   * @var EvaluationCoordinator::outstanding_batches_
+   * @brief Number of batches of the current evaluation that were not scored yet
+   */
+  size_t outstanding_batches_ = 0;
+
+  /**
+   * @var EvaluationCoordinator::results_
+   * @brief The scores of the current evaluation
+   */
+  std::vector<double> results_;
+
+  /**
+   * @var EvaluationCoordinator::batch_timeout_
+   * @brief How long a worker may take to score a batch
+   */
+  std::chrono::milliseconds batch_timeout_{std::chrono::minutes(1)};
+
+  /**
+   * @var EvaluationCoordinator::idle_timeout_
+   * @brief How long an evaluation waits while no worker is connected
+   */
+  std::chrono::milliseconds idle_timeout_{std::chrono::minutes(1)};
+
+  /**
+   * @var EvaluationCoordinator::next_batch_id_
+   * @brief The identifier the next batch will receive
+   */
+  uint64_t next_batch_id_ = 0;
+
+  /**
+   * @var EvaluationCoordinator::evaluation_mutex_
+   * @brief Serializes calls to evaluate()
+   */
+  std::mutex evaluation_mutex_;
+
+  /**
+   * @var EvaluationCoordinator::workers_mutex_
+   * @brief Guards the worker list
+   */
+  mutable std::mutex workers_mutex_;
+
+  /**
+   * @var EvaluationCoordinator::workers_
+   * @brief The workers that are, or were recently, connected
+   */
+  std::list<std::unique_ptr<WorkerSlot>> workers_;
+
+  /**
+   * @var EvaluationCoordinator::accept_thread_
+   * @brief Accepts incoming worker connections
+   */
+  std::thread accept_thread_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_EVALUATION_COORDINATOR_HPP_
@@ -0,0 +1,99 @@
+#ifndef BEAST_EVALUATION_WORKER_HPP_
+#define BEAST_EVALUATION_WORKER_HPP_
+
+// Standard
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Internal
+#include <beast/distributed/tcp_connection.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class EvaluationWorker
+ * @brief Evaluates batches of programs on behalf of a remote EvaluationCoordinator
+ *
+ * A worker connects to a coordinator, announces itself, and then scores every batch of programs it
+ * receives using the evaluation function it was constructed with (typically forwarding to
+ * Pipe::evaluate of the same Pipe implementation the coordinator side uses). Workers can be started
+ * and stopped at any time; the coordinator redistributes work accordingly.
+ */
+class EvaluationWorker {
+ public:
+  /**
+   * @brief Scores a single program, see Pipe::evaluate
+   *
+   * The program is viewed in the received message, so that it can be executed in place (see
+   * VmSession). The view is only valid during the call.
+   */
+  using EvaluationFunction = std::function<double(ProgramView)>;
+
+  /**
+   * @fn EvaluationWorker::EvaluationWorker
+   * @brief Constructs a worker around an evaluation function
+   *
+   * Exceptions thrown by the evaluation function are caught and yield a score of `0.0`.
+   *
+   * @param evaluate The function used to score programs
+   */
+  explicit EvaluationWorker(EvaluationFunction evaluate);
+
+  /**
+   * @fn EvaluationWorker::run
+   * @brief Connects to a coordinator and serves batches until stopped
+   *
+   * Blocks until the coordinator shuts down, the connection fails, or stop() is called. Throws if
+   * the coordinator cannot be reached.
+   *
+   * @param host The host name or address of the coordinator
+   * @param port The TCP port of the coordinator
+   * @return The number of programs this worker evaluated
+   */
+  uint64_t run(const std::string& host, uint16_t port);
+
+  /**
+   * @fn EvaluationWorker::stop
+   * @brief Makes a running worker leave its coordinator
+   *
+   * Can be called from any thread. A batch that is being evaluated right now is still answered;
+   * the worker then says goodbye and run() returns. Batches the coordinator sends afterwards are
+   * redistributed to other workers. A stopped worker does not serve again; calling stop() before
+   * run() makes run() return right after connecting.
+   */
+  void stop() noexcept;
+
+ private:
+  /**
+   * @var EvaluationWorker::evaluate_
+   * @brief The function used to score programs
+   */
+  EvaluationFunction evaluate_;
+
+  /**
+   * @var EvaluationWorker::stopping_
+   * @brief Set by stop() to make run() return
+   */
+  std::atomic<bool> stopping_{false};
+
+  /**
+   * @var EvaluationWorker::connection_mutex_
+   * @brief Guards `connection_` against concurrent stop() calls
+   */
+  std::mutex connection_mutex_;
+
+  /**
+   * @var EvaluationWorker::connection_
+   * @brief The connection to the coordinator while run() is active
+   */
+  TcpConnection connection_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_EVALUATION_WORKER_HPP_
@@ -0,0 +1,195 @@
+#ifndef BEAST_TCP_CONNECTION_HPP_
+#define BEAST_TCP_CONNECTION_HPP_
+
+// Standard
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace beast {
+
+/**
+ * @class TcpConnection
+ * @brief A connected, blocking TCP stream that exchanges length-prefixed messages
+ *
+ * Each message is sent as a four byte little endian length followed by the payload bytes. The
+ * connection owns its socket and closes it on destruction; it can be moved but not copied.
+ *
+ * Sending and receiving may happen concurrently from two different threads, but two threads must
+ * not send (or receive) at the same time. A blocking receive can be interrupted from another thread
+ * by calling shutdown().
+ */
+class TcpConnection {
+ public:
+  /**
+   * @fn TcpConnection::TcpConnection
+   * @brief Constructs an unconnected instance
+   */
+  TcpConnection() = default;
+
+  /**
+   * @fn TcpConnection::TcpConnection(intptr_t)
+   * @brief Takes ownership of an already connected socket handle
+   *
+   * @param socket_handle The connected socket
+   */
+  explicit TcpConnection(intptr_t socket_handle) noexcept;
+
+  TcpConnection(const TcpConnection&) = delete;
+  TcpConnection& operator=(const TcpConnection&) = delete;
+  TcpConnection(TcpConnection&& other) noexcept;
+  TcpConnection& operator=(TcpConnection&& other) noexcept;
+
+  /**
+   * @fn TcpConnection::~TcpConnection
+   * @brief Closes the socket if it is still open
+   */
+  ~TcpConnection();
+
+  /**
+   * @fn TcpConnection::connect
+   * @brief Connects to a remote host
+   *
+   * Throws if the host name cannot be resolved or no connection can be established.
+   *
+   * @param host The host name or address to connect to
+   * @param port The TCP port to connect to
+   * @return The connected instance
+   */
+  [[nodiscard]] static TcpConnection connect(const std::string& host, uint16_t port);
+
+  /**
+   * @fn TcpConnection::isOpen
+   * @brief Denotes whether this instance holds an open socket
+   */
+  [[nodiscard]] bool isOpen() const noexcept;
+
+  /**
+   * @fn TcpConnection::sendMessage
+   * @brief Sends a length-prefixed message
+   *
+   * @param payload The message payload to send
+   * @return `true` if the entire message was sent, `false` if the connection failed
+   */
+  [[nodiscard]] bool sendMessage(const std::vector<unsigned char>& payload) noexcept;
+
+  /**
+   * @fn TcpConnection::receiveMessage
+   * @brief Blocks until a complete length-prefixed message was received
+   *
+   * Frames that announce a payload larger than WireProtocol::kMaximumPayloadSize are treated as a
+   * failed connection.
+   *
+   * @param payload Receives the message payload
+   * @return `true` if a message was received, `false` if the connection was closed or failed
+   */
+  [[nodiscard]] bool receiveMessage(std::vector<unsigned char>& payload);
+
+  /**
+   * @fn TcpConnection::receiveMessage(std::vector<unsigned char>&, std::chrono::milliseconds)
+   * @brief Waits at most `timeout` for a complete length-prefixed message
+   *
+   * The timeout covers the whole message, so a peer can't stretch it by trickling in bytes. A
+   * message that isn't complete in time fails the receive; as part of it may have been consumed,
+   * the connection should be dropped afterwards.
+   *
+   * @param payload Receives the message payload
+   * @param timeout The maximum time to wait for the message
+   * @return `true` if a message was received, `false` if the connection was closed or failed, or
+   *         the timeout passed
+   */
+  [[nodiscard]] bool receiveMessage(
+      std::vector<unsigned char>& payload, std::chrono::milliseconds timeout);
+
+  /**
+   * @fn TcpConnection::shutdown
+   * @brief Shuts down both directions of the connection without closing the socket
+   *
+   * Any send or receive currently blocking on this connection (also from other threads) returns
+   * with a failure. The peer observes the connection as closed.
+   */
+  void shutdown() noexcept;
+
+  /**
+   * @fn TcpConnection::shutdownReceive
+   * @brief Shuts down the receiving direction of the connection
+   *
+   * A receive currently blocking on this connection returns with a failure, while messages can
+   * still be sent to the peer.
+   */
+  void shutdownReceive() noexcept;
+
+  /**
+   * @fn TcpConnection::close
+   * @brief Closes the socket
+   */
+  void close() noexcept;
+
+ private:
+  /**
+   * @var TcpConnection::socket_
+   * @brief The native socket handle, or -1 if not connected
+   */
+  intptr_t socket_ = -1;
+};
+
+/**
+ * @class TcpListener
+ * @brief Listens for incoming TCP connections on a local port
+ */
+class TcpListener {
+ public:
+  /**
+   * @fn TcpListener::TcpListener
+   * @brief Binds a listening socket
+   *
+   * Passing port `0` lets the operating system pick a free port, which can be queried via
+   * getPort(). Throws if the socket cannot be bound.
+   *
+   * @param port The local port to listen on
+   * @param bind_address The local address to bind to
+   */
+  explicit TcpListener(uint16_t port, const std::string& bind_address = "0.0.0.0");
+
+  TcpListener(const TcpListener&) = delete;
+  TcpListener& operator=(const TcpListener&) = delete;
+
+  /**
+   * @fn TcpListener::~TcpListener
+   * @brief Closes the listening socket
+   */
+  ~TcpListener();
+
+  /**
+   * @fn TcpListener::getPort
+   * @brief Returns the local port this listener is bound to
+   */
+  [[nodiscard]] uint16_t getPort() const noexcept;
+
+  /**
+   * @fn TcpListener::accept
+   * @brief Waits for an incoming connection for at most `timeout`
+   *
+   * @param timeout The maximum time to wait for a connection
+   * @return The accepted connection; not open if the timeout passed without a connection
+   */
+  [[nodiscard]] TcpConnection accept(std::chrono::milliseconds timeout);
+
+ private:
+  /**
+   * @var TcpListener::socket_
+   * @brief The native listening socket handle
+   */
+  intptr_t socket_ = -1;
+
+  /**
+   * @var TcpListener::port_
+   * @brief The local port the socket is bound to
+   */
+  uint16_t port_ = 0;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_TCP_CONNECTION_HPP_
@@ -0,0 +1,147 @@
+#ifndef BEAST_WIRE_PROTOCOL_HPP_
+#define BEAST_WIRE_PROTOCOL_HPP_
+
+// Standard
+#include <cstdint>
+#include <vector>
+
+// Internal
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class WireProtocol
+ * @brief Encodes and decodes the messages exchanged between evaluation coordinators and workers
+ *
+ * Every message is a payload that starts with a one byte MessageType, followed by the type specific
+ * body. All integers are encoded in little endian byte order, and scores are transmitted as the bit
+ * pattern of an IEEE 754 double. On the wire, each payload is prefixed with its length as a four
+ * byte little endian value (see TcpConnection::sendMessage).
+ *
+ * Batches carry many programs per message so that the round trip latency of the network is
+ * amortized over a larger amount of evaluation work.
+ */
+class WireProtocol {
+ public:
+  /**
+   * @brief The protocol version sent along with the Hello message
+   *
+   * Coordinators reject workers that speak a different protocol version.
+   */
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * @brief The largest payload size in bytes that a peer is allowed to send
+   *
+   * Frames announcing a larger payload are considered corrupt and terminate the connection.
+   */
+  static constexpr uint32_t kMaximumPayloadSize = 256 * 1024 * 1024;
+
+  /**
+   * @brief The types of messages known to the protocol
+   */
+  enum class MessageType : uint8_t {
+    Hello = 1,          ///< Worker -> coordinator: announces a new worker and its protocol version
+    EvaluateBatch = 2,  ///< Coordinator -> worker: a batch of programs to evaluate
+    BatchResults = 3,   ///< Worker -> coordinator: the scores for a previously received batch
+    Goodbye = 4,        ///< Worker -> coordinator: the worker is leaving
+    Shutdown = 5        ///< Coordinator -> worker: the coordinator is shutting down
+  };
+
+  /**
+   * @brief A batch of programs to be evaluated by a worker
+   */
+  struct EvaluationBatch {
+    uint64_t batch_id;                               ///< Identifies the batch within a coordinator
+    std::vector<std::vector<unsigned char>> programs;  ///< The program byte codes to evaluate
+  };
+
+  /**
+   * @brief A batch of programs whose byte codes are viewed in the received payload
+   *
+   * The views are valid for as long as the payload is neither modified nor destroyed.
+   */
+  struct EvaluationBatchView {
+    uint64_t batch_id;                  ///< Identifies the batch within a coordinator
+    std::vector<ProgramView> programs;  ///< The program byte codes to evaluate
+  };
+
+  /**
+   * @brief The scores a worker determined for a batch
+   */
+  struct EvaluationResults {
+    uint64_t batch_id;           ///< The batch these results belong to
+    std::vector<double> scores;  ///< One score per program, in the order they were received
+  };
+
+  /**
+   * @fn WireProtocol::getMessageType
+   * @brief Returns the type of an encoded message
+   *
+   * Throws if the payload is empty or carries an unknown message type.
+   *
+   * @param payload The encoded message
+   * @return The type of the message
+   */
+  [[nodiscard]] static MessageType getMessageType(const std::vector<unsigned char>& payload);
+
+  /**
+   * @fn WireProtocol::encodeHello
+   * @brief Encodes a Hello message carrying the current protocol version
+   */
+  [[nodiscard]] static std::vector<unsigned char> encodeHello();
+
+  /**
+   * @fn WireProtocol::decodeHello
+   * @brief Decodes a Hello message and returns the protocol version the peer announced
+   */
+  [[nodiscard]] static uint32_t decodeHello(const std::vector<unsigned char>& payload);
+
+  /**
+   * @fn WireProtocol::encodeBatch
+   * @brief Encodes a batch of programs to evaluate
+   */
+  [[nodiscard]] static std::vector<unsigned char> encodeBatch(const EvaluationBatch& batch);
+
+  /**
+   * @fn WireProtocol::decodeBatch
+   * @brief Decodes a batch of programs to evaluate
+   *
+   * Throws if the payload is truncated or is not an EvaluateBatch message.
+   */
+  [[nodiscard]] static EvaluationBatch decodeBatch(const std::vector<unsigned char>& payload);
+
+  /**
+   * @fn WireProtocol::viewBatch
+   * @brief Decodes a batch of programs to evaluate without copying their byte codes
+   *
+   * Workers use this to execute received programs in place. Throws if the payload is truncated or
+   * is not an EvaluateBatch message.
+   */
+  [[nodiscard]] static EvaluationBatchView viewBatch(const std::vector<unsigned char>& payload);
+
+  /**
+   * @fn WireProtocol::encodeResults
+   * @brief Encodes the scores determined for a batch
+   */
+  [[nodiscard]] static std::vector<unsigned char> encodeResults(const EvaluationResults& results);
+
+  /**
+   * @fn WireProtocol::decodeResults
+   * @brief Decodes the scores determined for a batch
+   *
+   * Throws if the payload is truncated or is not a BatchResults message.
+   */
+  [[nodiscard]] static EvaluationResults decodeResults(const std::vector<unsigned char>& payload);
+
+  /**
+   * @fn WireProtocol::encodeSignal
+   * @brief Encodes a message that has no body (Goodbye and Shutdown)
+   */
+  [[nodiscard]] static std::vector<unsigned char> encodeSignal(MessageType type);
+};
+
+}  // namespace beast
+
+#endif  // BEAST_WIRE_PROTOCOL_HPP_
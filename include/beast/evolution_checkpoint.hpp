@@ -0,0 +1,216 @@
+#ifndef BEAST_EVOLUTION_CHECKPOINT_HPP_
+#define BEAST_EVOLUTION_CHECKPOINT_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Internal
+#include <beast/mapped_file.hpp>
+
+namespace beast {
+
+/**
+ * @class EvolutionCheckpoint
+ * @brief Holds the state of an evolution run and writes it to a checkpoint file
+ *
+ * A checkpoint consists of the generation counter, the seed the run's random number generators
+ * were reseeded with, and three sections of records: the population with its scores, the candidates
+ * pending in the input pool, and the finalists pending in the output buffer.
+ *
+ * The file starts with a fixed size header, followed by an index of all records (offset, size, and
+ * score each) and a blob holding the records' bytes. All values are stored in the host's byte order
+ * and at naturally aligned offsets, so that a MappedEvolutionCheckpoint can access the file in
+ * place without parsing it. Files are written to a temporary file next to the target first, flushed
+ * to disk, and then renamed over the target, so a crash while writing never leaves a torn
+ * checkpoint.
+ */
+class EvolutionCheckpoint {
+ public:
+  /**
+   * @brief The sections of records a checkpoint holds
+   */
+  enum class Section {
+    Population = 0,  ///< The individuals of the population and their scores
+    Inputs = 1,      ///< The candidates pending in the input pool
+    Outputs = 2      ///< The finalists pending in the output buffer and their scores
+  };
+
+  /**
+   * @brief The number of sections in a checkpoint
+   */
+  static constexpr size_t kSectionCount = 3;
+
+  /**
+   * @fn EvolutionCheckpoint::EvolutionCheckpoint
+   * @brief Constructs an empty checkpoint
+   *
+   * @param generation The number of generations the run completed
+   * @param random_seed The seed the run's random number generators were reseeded with
+   */
+  EvolutionCheckpoint(uint32_t generation, uint32_t random_seed);
+
+  /**
+   * @fn EvolutionCheckpoint::addRecord
+   * @brief Appends a record to a section
+   *
+   * @param section The section to append to
+   * @param data The record's bytes
+   * @param score The record's score; ignored for inputs
+   */
+  void addRecord(Section section, std::vector<unsigned char> data, double score = 0.0);
+
+  /**
+   * @fn EvolutionCheckpoint::getGeneration
+   * @brief Returns the number of generations the run completed
+   */
+  [[nodiscard]] uint32_t getGeneration() const noexcept;
+
+  /**
+   * @fn EvolutionCheckpoint::getRandomSeed
+   * @brief Returns the seed the run's random number generators were reseeded with
+   */
+  [[nodiscard]] uint32_t getRandomSeed() const noexcept;
+
+  /**
+   * @fn EvolutionCheckpoint::getRecordCount
+   * @brief Returns the number of records in a section
+   */
+  [[nodiscard]] size_t getRecordCount(Section section) const noexcept;
+
+  /**
+   * @fn EvolutionCheckpoint::serialize
+   * @brief Returns the checkpoint in its on-disk format
+   */
+  [[nodiscard]] std::vector<unsigned char> serialize() const;
+
+  /**
+   * @fn EvolutionCheckpoint::write
+   * @brief Atomically replaces a file with this checkpoint
+   *
+   * Throws if the file can't be written.
+   *
+   * @param path The file to write
+   */
+  void write(const std::string& path) const;
+
+ private:
+  /**
+   * @brief A record held until the checkpoint is serialized
+   */
+  struct Record {
+    std::vector<unsigned char> data;  ///< The record's bytes
+    double score;                     ///< The record's score
+  };
+
+  /**
+   * @var EvolutionCheckpoint::generation_
+   * @brief The number of generations the run completed
+   */
+  uint32_t generation_;
+
+  /**
+   * @var EvolutionCheckpoint::random_seed_
+   * @brief The seed the run's random number generators were reseeded with
+   */
+  uint32_t random_seed_;
+
+  /**
+   * @var EvolutionCheckpoint::sections_
+   * @brief The records of each section
+   */
+  std::vector<std::vector<Record>> sections_;
+};
+
+/**
+ * @class MappedEvolutionCheckpoint
+ * @brief Provides read-only access to a checkpoint file that is mapped into memory
+ *
+ * Opening a checkpoint only validates its header; records are located through the index and read
+ * straight from the mapped file when they are accessed, so resuming from a large checkpoint costs
+ * no more than touching the pages that are actually needed. On platforms without `mmap`, the file
+ * is read into memory instead.
+ */
+class MappedEvolutionCheckpoint {
+ public:
+  /**
+   * @brief A record in the mapped file
+   */
+  struct Record {
+    const unsigned char* data;  ///< The record's bytes, valid as long as the checkpoint is open
+    size_t size;                ///< The number of bytes
+    double score;               ///< The record's score
+  };
+
+  /**
+   * @fn MappedEvolutionCheckpoint::MappedEvolutionCheckpoint
+   * @brief Opens and maps a checkpoint file
+   *
+   * Throws if the file can't be opened or isn't a checkpoint written on a host with the same byte
+   * order.
+   *
+   * @param path The checkpoint file to open
+   */
+  explicit MappedEvolutionCheckpoint(const std::string& path);
+
+  /**
+   * @fn MappedEvolutionCheckpoint::getGeneration
+   * @brief Returns the number of generations the run completed
+   */
+  [[nodiscard]] uint32_t getGeneration() const noexcept;
+
+  /**
+   * @fn MappedEvolutionCheckpoint::getRandomSeed
+   * @brief Returns the seed the run's random number generators were reseeded with
+   */
+  [[nodiscard]] uint32_t getRandomSeed() const noexcept;
+
+  /**
+   * @fn MappedEvolutionCheckpoint::getRecordCount
+   * @brief Returns the number of records in a section
+   */
+  [[nodiscard]] size_t getRecordCount(EvolutionCheckpoint::Section section) const noexcept;
+
+  /**
+   * @fn MappedEvolutionCheckpoint::getRecord
+   * @brief Returns a record of a section
+   *
+   * Throws if the index is out of range or the record lies outside of the file.
+   *
+   * @param section The section to return the record from
+   * @param index The index of the record within its section
+   */
+  [[nodiscard]] Record getRecord(EvolutionCheckpoint::Section section, size_t index) const;
+
+  /**
+   * @fn MappedEvolutionCheckpoint::copyRecord
+   * @brief Returns a copy of a record's bytes
+   */
+  [[nodiscard]] std::vector<unsigned char> copyRecord(
+      EvolutionCheckpoint::Section section, size_t index) const;
+
+ private:
+  /**
+   * @var MappedEvolutionCheckpoint::file_
+   * @brief The mapped checkpoint file
+   */
+  MappedFile file_;
+
+  /**
+   * @var MappedEvolutionCheckpoint::data_
+   * @brief The start of the mapped file
+   */
+  const unsigned char* data_ = nullptr;
+
+  /**
+   * @var MappedEvolutionCheckpoint::size_
+   * @brief The size of the mapped file
+   */
+  size_t size_ = 0;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_EVOLUTION_CHECKPOINT_HPP_
@@ -0,0 +1,307 @@
+#ifndef BEAST_FITNESS_CACHE_HPP_
+#define BEAST_FITNESS_CACHE_HPP_
+
+// Standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Internal
+#include <beast/program_view.hpp>
+#include <beast/vm_session.hpp>
+
+namespace beast {
+
+/**
+ * @class FitnessCache
+ * @brief Bounded, thread-safe cache of evaluation results keyed by program content
+ *
+ * Evolved populations contain many byte-identical programs, and each of them would otherwise be
+ * evaluated from scratch in every generation. This cache maps a 128 bit hash of a program's byte
+ * code and an evaluation configuration value to the score (and optionally the runtime statistics)
+ * the program achieved. The configuration value distinguishes evaluations of the same program
+ * under different conditions (e.g. different fitness cases or execution limits); callers choose it
+ * freely.
+ *
+ * The cache is split into shards that each hold an equal share of the capacity and are guarded by
+ * their own mutex, so that concurrent evaluators rarely contend for the same lock. When a shard is
+ * full, its least recently used entry is evicted.
+ *
+ * Caching is only sound for programs whose evaluation is deterministic. Programs that contain
+ * operators with nondeterministic results (random values, system calls reading the clock) are
+ * neither served nor stored, unless nondeterministic programs are explicitly allowed, e.g. because
+ * the evaluation seeds its sessions (see VmSession::setRandomSeed()).
+ */
+class FitnessCache {
+ public:
+  /**
+   * @brief The content address of a cached evaluation result
+   */
+  struct Key {
+    uint64_t high = 0;  ///< The upper 64 bits of the hash
+    uint64_t low = 0;   ///< The lower 64 bits of the hash
+
+    bool operator==(const Key& other) const noexcept {
+      return high == other.high && low == other.low;
+    }
+  };
+
+  /**
+   * @brief A cached evaluation result
+   */
+  struct Entry {
+    double score = 0.0;                                      ///< The achieved score
+    std::optional<VmSession::RuntimeStatistics> statistics;  ///< Runtime statistics, if stored
+  };
+
+  /**
+   * @fn FitnessCache::FitnessCache
+   * @brief Constructs an empty cache
+   *
+   * Throws if the capacity or the shard count is zero. The capacity is distributed evenly over the
+   * shards, with each shard holding at least one entry.
+   *
+   * @param capacity The maximum number of entries to hold
+   * @param shard_count The number of independently locked shards
+   */
+  explicit FitnessCache(size_t capacity, size_t shard_count = 16);
+
+  /**
+   * @fn FitnessCache::makeKey
+   * @brief Computes the content address of a program under an evaluation configuration
+   *
+   * @param program The program's byte code
+   * @param configuration A value identifying the evaluation configuration
+   * @return The key of the program's evaluation result
+   */
+  [[nodiscard]] static Key makeKey(ProgramView program, uint64_t configuration) noexcept;
+
+  /**
+   * @fn FitnessCache::isDeterministic
+   * @brief Determines whether a program is free of operators with nondeterministic results
+   *
+   * The program is decoded with the InstructionDecoder. Byte code that can't be decoded completely
+   * is considered nondeterministic, as it can't be inspected. If the program jumps to variable
+   * addresses, or to constant addresses inside of instructions, the instructions starting at every
+   * other byte offset are inspected as well, as execution may read operand bytes as operators.
+   *
+   * @param program The program's byte code
+   * @return `true` if no nondeterministic operator was found, `false` otherwise
+   */
+  [[nodiscard]] static bool isDeterministic(ProgramView program);
+
+  /**
+   * @fn FitnessCache::setAllowNondeterministic
+   * @brief Sets whether programs with nondeterministic operators are served and stored
+   *
+   * Only allow this if the evaluation makes these operators deterministic, e.g. by seeding the
+   * sessions' random number generators.
+   */
+  void setAllowNondeterministic(bool allow) noexcept;
+
+  /**
+   * @fn FitnessCache::getAllowNondeterministic
+   * @brief Returns whether programs with nondeterministic operators are served and stored
+   */
+  [[nodiscard]] bool getAllowNondeterministic() const noexcept;
+
+  /**
+   * @fn FitnessCache::setCanonicalKeys
+   * @brief Sets whether programs are keyed by their canonical form instead of their byte code
+   *
+   * With canonical keys, programs that differ only in NoOps, unreachable code, or flag byte values
+   * share their evaluation result (see ProgramCanonicalizer, without renaming variables). Only
+   * enable this if the score depends on the programs' variable values, output, and return code
+   * alone, but not on their runtime statistics. Cached statistics belong to whichever equivalent
+   * program was stored.
+   */
+  void setCanonicalKeys(bool canonical) noexcept;
+
+  /**
+   * @fn FitnessCache::getCanonicalKeys
+   * @brief Returns whether programs are keyed by their canonical form
+   */
+  [[nodiscard]] bool getCanonicalKeys() const noexcept;
+
+  /**
+   * @fn FitnessCache::getKey
+   * @brief Computes the key this cache stores a program's evaluation result under
+   *
+   * This is makeKey() of either the program's byte code or its canonical form.
+   *
+   * @param program The program's byte code
+   * @param configuration A value identifying the evaluation configuration
+   * @return The key of the program's evaluation result
+   */
+  [[nodiscard]] Key getKey(ProgramView program, uint64_t configuration) const;
+
+  /**
+   * @fn FitnessCache::getCacheableKey
+   * @brief Computes the key of a program's evaluation result, if the program may be cached
+   *
+   * Evaluators that both look up and store a program's result compute its key once with this
+   * function and pass it to the key based lookup() and store(), which skip the determinism check
+   * and the key computation.
+   *
+   * @param program The program's byte code
+   * @param configuration A value identifying the evaluation configuration
+   * @return getKey() of the program, or no value if it was refused by the determinism check
+   */
+  [[nodiscard]] std::optional<Key> getCacheableKey(
+      ProgramView program, uint64_t configuration) const;
+
+  /**
+   * @fn FitnessCache::lookup
+   * @brief Returns the cached evaluation result of a program, if any
+   *
+   * Counts as a hit or a miss. Programs refused by the determinism check always miss.
+   *
+   * @param program The program's byte code
+   * @param configuration A value identifying the evaluation configuration
+   * @return The cached result, or no value
+   */
+  [[nodiscard]] std::optional<Entry> lookup(ProgramView program, uint64_t configuration);
+
+  /**
+   * @fn FitnessCache::lookup
+   * @brief Returns the cached evaluation result stored under a key, if any
+   *
+   * Counts as a hit or a miss.
+   *
+   * @param key The key returned by getCacheableKey()
+   * @return The cached result, or no value
+   */
+  [[nodiscard]] std::optional<Entry> lookup(const Key& key);
+
+  /**
+   * @fn FitnessCache::store
+   * @brief Stores the evaluation result of a program
+   *
+   * Replaces an existing result for the same program and configuration.
+   *
+   * @param program The program's byte code
+   * @param configuration A value identifying the evaluation configuration
+   * @param entry The evaluation result
+   * @return `true` if the result was stored, `false` if the program was refused by the determinism
+   *         check
+   */
+  bool store(ProgramView program, uint64_t configuration, Entry entry);
+
+  /**
+   * @fn FitnessCache::store
+   * @brief Stores an evaluation result under a key
+   *
+   * Replaces an existing result for the same key.
+   *
+   * @param key The key returned by getCacheableKey()
+   * @param entry The evaluation result
+   */
+  void store(const Key& key, Entry entry);
+
+  /**
+   * @fn FitnessCache::clear
+   * @brief Removes all entries and resets the hit and miss counters
+   */
+  void clear();
+
+  /**
+   * @fn FitnessCache::getSize
+   * @brief Returns the number of entries currently held
+   */
+  [[nodiscard]] size_t getSize() const;
+
+  /**
+   * @fn FitnessCache::getCapacity
+   * @brief Returns the maximum number of entries held across all shards
+   */
+  [[nodiscard]] size_t getCapacity() const noexcept;
+
+  /**
+   * @fn FitnessCache::getHitCount
+   * @brief Returns the number of lookups that were served from the cache
+   */
+  [[nodiscard]] uint64_t getHitCount() const noexcept;
+
+  /**
+   * @fn FitnessCache::getMissCount
+   * @brief Returns the number of lookups that were not served from the cache
+   */
+  [[nodiscard]] uint64_t getMissCount() const noexcept;
+
+ private:
+  /**
+   * @brief Hashes keys for the shards' maps; the key already is a well mixed hash
+   */
+  struct KeyHash {
+    size_t operator()(const Key& key) const noexcept {
+      return static_cast<size_t>(key.low);
+    }
+  };
+
+  /**
+   * @brief An independently locked part of the cache, holding entries in recency order
+   */
+  struct Shard {
+    std::mutex mutex;                                   ///< Guards this shard
+    std::list<std::pair<Key, Entry>> entries;           ///< Most recently used entry first
+    std::unordered_map<Key, std::list<std::pair<Key, Entry>>::iterator, KeyHash> index;  ///< Lookup
+  };
+
+  /**
+   * @fn FitnessCache::isCacheable
+   * @brief Determines whether results of a program may be served and stored
+   */
+  [[nodiscard]] bool isCacheable(ProgramView program) const;
+
+  /**
+   * @fn FitnessCache::getShard
+   * @brief Returns the shard responsible for a key
+   */
+  [[nodiscard]] Shard& getShard(const Key& key) const noexcept;
+
+  /**
+   * @var FitnessCache::shards_
+   * @brief The shards holding the entries
+   */
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  /**
+   * @var FitnessCache::shard_capacity_
+   * @brief The maximum number of entries per shard
+   */
+  size_t shard_capacity_;
+
+  /**
+   * @var FitnessCache::allow_nondeterministic_
+   * @brief Whether programs with nondeterministic operators are served and stored
+   */
+  std::atomic<bool> allow_nondeterministic_{false};
+
+  /**
+   * @var FitnessCache::canonical_keys_
+   * @brief Whether programs are keyed by their canonical form
+   */
+  std::atomic<bool> canonical_keys_{false};
+
+  /**
+   * @var FitnessCache::hits_
+   * @brief The number of lookups served from the cache
+   */
+  std::atomic<uint64_t> hits_{0};
+
+  /**
+   * @var FitnessCache::misses_
+   * @brief The number of lookups not served from the cache
+   */
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace beast
+
+#endif  // BEAST_FITNESS_CACHE_HPP_
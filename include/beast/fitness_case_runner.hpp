@@ -0,0 +1,318 @@
+#ifndef BEAST_FITNESS_CASE_RUNNER_HPP_
+#define BEAST_FITNESS_CASE_RUNNER_HPP_
+
+// Standard
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Internal
+#include <beast/virtual_machine.hpp>
+#include <beast/vm_session.hpp>
+
+namespace beast {
+
+/**
+ * @class FitnessCaseTable
+ * @brief Holds input variable assignments and expected outputs for a set of test cases
+ *
+ * The table has a fixed set of input and output variables. Each case (row) assigns a value to
+ * every input variable and expects a value in every output variable. Values are stored row-major
+ * in flat vectors.
+ */
+class FitnessCaseTable {
+ public:
+  /**
+   * @fn FitnessCaseTable::FitnessCaseTable
+   * @brief Constructs an empty table for the given input and output variables
+   *
+   * @param input_variables The variable indices the inputs of each case are written to
+   * @param output_variables The variable indices the outputs of each case are read from
+   */
+  FitnessCaseTable(std::vector<int32_t> input_variables, std::vector<int32_t> output_variables);
+
+  /**
+   * @fn FitnessCaseTable::addCase
+   * @brief Adds a test case
+   *
+   * Throws if the number of values doesn't match the number of input or output variables.
+   *
+   * @param inputs The values to write to the input variables, in order
+   * @param expected_outputs The values expected in the output variables, in order
+   */
+  void addCase(const std::vector<int32_t>& inputs, const std::vector<int32_t>& expected_outputs);
+
+  /**
+   * @fn FitnessCaseTable::getCaseCount
+   * @brief Returns the number of cases in this table
+   */
+  [[nodiscard]] size_t getCaseCount() const noexcept;
+
+  /**
+   * @fn FitnessCaseTable::getInputVariables
+   * @brief Returns the variable indices the inputs are written to
+   */
+  [[nodiscard]] const std::vector<int32_t>& getInputVariables() const noexcept;
+
+  /**
+   * @fn FitnessCaseTable::getOutputVariables
+   * @brief Returns the variable indices the outputs are read from
+   */
+  [[nodiscard]] const std::vector<int32_t>& getOutputVariables() const noexcept;
+
+  /**
+   * @fn FitnessCaseTable::getInput
+   * @brief Returns the value a case writes to one of the input variables
+   *
+   * @param case_index The case to return the input value of
+   * @param input_index The position of the input variable in getInputVariables()
+   */
+  [[nodiscard]] int32_t getInput(size_t case_index, size_t input_index) const;
+
+  /**
+   * @fn FitnessCaseTable::getExpectedOutput
+   * @brief Returns the value a case expects in one of the output variables
+   *
+   * @param case_index The case to return the expected output value of
+   * @param output_index The position of the output variable in getOutputVariables()
+   */
+  [[nodiscard]] int32_t getExpectedOutput(size_t case_index, size_t output_index) const;
+
+ private:
+  /**
+   * @var FitnessCaseTable::input_variables_
+   * @brief The variable indices the inputs are written to
+   */
+  std::vector<int32_t> input_variables_;
+
+  /**
+   * @var FitnessCaseTable::output_variables_
+   * @brief The variable indices the outputs are read from
+   */
+  std::vector<int32_t> output_variables_;
+
+  /**
+   * @var FitnessCaseTable::inputs_
+   * @brief The input values of all cases, row-major
+   */
+  std::vector<int32_t> inputs_;
+
+  /**
+   * @var FitnessCaseTable::expected_outputs_
+   * @brief The expected output values of all cases, row-major
+   */
+  std::vector<int32_t> expected_outputs_;
+};
+
+/**
+ * @class ScoreMatrix
+ * @brief Holds the per case and per output results of running a program against test cases
+ *
+ * For every case (row) and output variable (column), the actual output value and a score between
+ * 0.0 (far off) and 1.0 (exact match) are stored. Both are kept row-major in flat vectors.
+ */
+class ScoreMatrix {
+ public:
+  /**
+   * @fn ScoreMatrix::ScoreMatrix
+   * @brief Constructs a matrix with all scores and outputs set to zero
+   *
+   * @param case_count The number of cases (rows)
+   * @param output_count The number of output variables (columns)
+   */
+  ScoreMatrix(size_t case_count, size_t output_count);
+
+  /**
+   * @fn ScoreMatrix::getCaseCount
+   * @brief Returns the number of cases (rows)
+   */
+  [[nodiscard]] size_t getCaseCount() const noexcept;
+
+  /**
+   * @fn ScoreMatrix::getOutputCount
+   * @brief Returns the number of output variables (columns)
+   */
+  [[nodiscard]] size_t getOutputCount() const noexcept;
+
+  /**
+   * @fn ScoreMatrix::getScore
+   * @brief Returns the score of a single output of a single case
+   */
+  [[nodiscard]] double getScore(size_t case_index, size_t output_index) const;
+
+  /**
+   * @fn ScoreMatrix::getOutput
+   * @brief Returns the value a single output variable held after running a single case
+   */
+  [[nodiscard]] int32_t getOutput(size_t case_index, size_t output_index) const;
+
+  /**
+   * @fn ScoreMatrix::setResult
+   * @brief Stores the actual output value and score of a single output of a single case
+   */
+  void setResult(size_t case_index, size_t output_index, int32_t output, double score);
+
+  /**
+   * @fn ScoreMatrix::getCaseScore
+   * @brief Returns the mean score over all outputs of a single case
+   */
+  [[nodiscard]] double getCaseScore(size_t case_index) const;
+
+  /**
+   * @fn ScoreMatrix::getMeanScore
+   * @brief Returns the mean score over all cases and outputs
+   *
+   * @return The mean score, or 0.0 if the matrix is empty
+   */
+  [[nodiscard]] double getMeanScore() const noexcept;
+
+  /**
+   * @fn ScoreMatrix::getScores
+   * @brief Returns all scores, row-major
+   */
+  [[nodiscard]] const std::vector<double>& getScores() const noexcept;
+
+ private:
+  /**
+   * @fn ScoreMatrix::getIndex
+   * @brief Returns the flat index of a cell, throwing if it is out of range
+   */
+  [[nodiscard]] size_t getIndex(size_t case_index, size_t output_index) const;
+
+  /**
+   * @var ScoreMatrix::case_count_
+   * @brief The number of cases (rows)
+   */
+  size_t case_count_;
+
+  /**
+   * @var ScoreMatrix::output_count_
+   * @brief The number of output variables (columns)
+   */
+  size_t output_count_;
+
+  /**
+   * @var ScoreMatrix::scores_
+   * @brief The scores, row-major
+   */
+  std::vector<double> scores_;
+
+  /**
+   * @var ScoreMatrix::outputs_
+   * @brief The actual output values, row-major
+   */
+  std::vector<int32_t> outputs_;
+};
+
+/**
+ * @class FitnessCaseRunner
+ * @brief Runs a program against a table of test cases
+ *
+ * Programs usually start with a prologue that declares variables, initializes them, and sets up
+ * the string table. As the prologue doesn't depend on any inputs, it is executed only once. The
+ * resulting session is snapshotted, and for each case the snapshot is restored, the case's inputs
+ * are injected via VmSession::setVariableValue, and the program is run to its end. The outputs are
+ * then read and compared to the expected values.
+ *
+ * The prologue ends at the first instruction that is not a NoOp, DeclareVariable, or
+ * SetStringTableEntry instruction, or a SetVariable instruction writing to a variable other than an
+ * input variable. Running a case is therefore equivalent to running a fresh session with the
+ * case's inputs set up front. The snapshot's program is verified once (see
+ * VmSession::verifyProgram()), so that all cases run without per-fetch bounds checks if it passes.
+ *
+ * A case ends when the program terminates, reaches the end of its code, waits for further input
+ * (which never arrives in a batch run), or exceeds the execution limits set on the prototype
+ * session.
+ */
+class FitnessCaseRunner {
+ public:
+  /**
+   * @brief Called with each case's session after the case was run
+   *
+   * Allows to additionally score runtime behavior, e.g. with an Evaluator.
+   */
+  using CaseObserver = std::function<void(size_t case_index, const VmSession& session)>;
+
+  /**
+   * @brief The outcome of racing a program against a score threshold
+   *
+   * @sa race()
+   */
+  struct RaceResult {
+    ScoreMatrix scores;  ///< The outputs and scores of the cases run; cases not run score 0.0
+    size_t cases_run;    ///< How many cases were run before the race ended
+    bool abandoned;      ///< Whether the race was abandoned before all cases were run
+    double upper_bound;  ///< The best achievable mean score, or the mean score if all cases ran
+  };
+
+  /**
+   * @fn FitnessCaseRunner::FitnessCaseRunner
+   * @brief Constructs a runner that executes programs on the given virtual machine
+   *
+   * @param virtual_machine The virtual machine to execute programs with
+   */
+  explicit FitnessCaseRunner(VirtualMachine& virtual_machine);
+
+  /**
+   * @fn FitnessCaseRunner::run
+   * @brief Runs a program against all cases of a table
+   *
+   * The prototype session defines the program, the variable memory and string table sizes, the
+   * execution limits, and any variable behaviors. The table's input variables are marked as input
+   * variables automatically. The prototype itself is not modified.
+   *
+   * Each output is scored with `1 / (1 + |actual - expected|)`. All outputs of a case score 0.0 if
+   * the program exited abnormally or exceeded an execution limit in that case.
+   *
+   * @param prototype The session to run the cases on
+   * @param table The test cases
+   * @param observer Optionally called with each case's session after the case was run
+   * @return The actual outputs and scores of all cases
+   */
+  [[nodiscard]] ScoreMatrix run(
+      const VmSession& prototype, const FitnessCaseTable& table,
+      const CaseObserver& observer = nullptr);
+
+  /**
+   * @fn FitnessCaseRunner::race
+   * @brief Runs a program against the cases of a table until it can't reach a score threshold
+   *
+   * Works like run(), but keeps track of the best mean score the program can still achieve,
+   * assuming that all remaining cases score 1.0. As soon as this upper bound falls below the
+   * threshold, the remaining cases are skipped. Most weak candidates fail the first few cases, so
+   * comparing them against a cut-off score or the worst score of an elite this way saves most of
+   * their evaluation time. Order the table's cases so that discriminating cases come first.
+   *
+   * @param prototype The session to run the cases on
+   * @param table The test cases
+   * @param threshold The mean score the program needs to reach to be run to completion
+   * @param observer Optionally called with each case's session after the case was run
+   * @return The results of the cases run and the upper bound of the mean score
+   */
+  [[nodiscard]] RaceResult race(
+      const VmSession& prototype, const FitnessCaseTable& table, double threshold,
+      const CaseObserver& observer = nullptr);
+
+  /**
+   * @fn FitnessCaseRunner::getPrologueSteps
+   * @brief Returns the number of prologue steps that the last run() shared between all cases
+   */
+  [[nodiscard]] uint32_t getPrologueSteps() const noexcept;
+
+ private:
+  /**
+   * @var FitnessCaseRunner::virtual_machine_
+   * @brief The virtual machine to execute programs with
+   */
+  VirtualMachine& virtual_machine_;
+
+  /**
+   * @var FitnessCaseRunner::prologue_steps_
+   * @brief The number of prologue steps executed during the last run
+   */
+  uint32_t prologue_steps_ = 0;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_FITNESS_CASE_RUNNER_HPP_
@@ -0,0 +1,63 @@
+#ifndef BEAST_GENETIC_OPERATORS_HPP_
+#define BEAST_GENETIC_OPERATORS_HPP_
+
+// Standard
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace beast {
+
+/**
+ * @class GeneticOperators
+ * @brief Crossover and mutation operators for BEAST byte code that respect instruction boundaries
+ *
+ * Byte level operators routinely cut instructions in half, producing offspring that fail on an
+ * undefined or truncated instruction and waste an evaluation. These operators decode the byte code
+ * with the InstructionDecoder first and only cut, insert, remove, and modify whole instructions and
+ * individual operands. When code moves, constant jump targets are relocated so that they keep
+ * pointing at the same instruction; targets whose instruction was removed are moved to the closest
+ * remaining instruction boundary.
+ *
+ * Byte code that can't be decoded completely (e.g., hand-written data) is handled gracefully: the
+ * undecodable remainder is treated as one opaque block that is kept intact by crossover.
+ */
+class GeneticOperators {
+ public:
+  /**
+   * @fn GeneticOperators::crossOver
+   * @brief One-point crossover at instruction boundaries
+   *
+   * A cut point is chosen independently among the instruction boundaries of each parent. The first
+   * child is the mother's head followed by the father's tail, the second one the father's head
+   * followed by the mother's tail.
+   *
+   * @param mother The first parent's byte code
+   * @param father The second parent's byte code
+   * @param rng The random number generator to draw cut points from
+   * @return The two children's byte code
+   */
+  [[nodiscard]] static std::pair<std::vector<unsigned char>, std::vector<unsigned char>> crossOver(
+      const std::vector<unsigned char>& mother, const std::vector<unsigned char>& father,
+      std::mt19937& rng);
+
+  /**
+   * @fn GeneticOperators::mutate
+   * @brief Mutates whole instructions or their operands
+   *
+   * Each instruction is mutated with the given probability. A mutation either modifies one operand
+   * of the instruction in a type-aware way (flags are flipped, variable indices nudged, jump targets
+   * set to another instruction boundary, ...), removes the instruction, or duplicates it.
+   *
+   * @param code The byte code to mutate in place
+   * @param probability The probability of each instruction to be mutated
+   * @param rng The random number generator to draw mutations from
+   * @return The number of applied mutations
+   */
+  static uint32_t mutate(std::vector<unsigned char>& code, double probability, std::mt19937& rng);
+};
+
+}  // namespace beast
+
+#endif  // BEAST_GENETIC_OPERATORS_HPP_
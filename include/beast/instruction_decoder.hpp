@@ -0,0 +1,143 @@
+#ifndef BEAST_INSTRUCTION_DECODER_HPP_
+#define BEAST_INSTRUCTION_DECODER_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Internal
+#include <beast/opcodes.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class InstructionDecoder
+ * @brief Decodes instruction boundaries and operand layouts of BEAST byte code
+ *
+ * Every operator is encoded as its one byte OpCode followed by a fixed sequence of operands, as
+ * written by the Program class. The only variable length operand is a string, which is encoded as
+ * a two byte length followed by that many characters. This class holds the operand layout of every
+ * operator and allows to split byte code into instructions without executing it.
+ */
+class InstructionDecoder {
+ public:
+  /**
+   * @brief The types of operands an instruction can have
+   *
+   * Besides its encoded size, the type of an operand denotes its meaning. This allows to treat
+   * operands differently, e.g. to relocate jump addresses when code is moved.
+   */
+  enum class OperandType {
+    Variable,          ///< A four byte variable index
+    Flag,              ///< A one byte boolean flag (e.g., whether to follow links)
+    Constant4,         ///< A four byte constant
+    Constant1,         ///< A one byte constant (e.g., a return code or a number of places)
+    StringTableIndex,  ///< A four byte string table index
+    AbsoluteAddress,   ///< A four byte absolute jump target address
+    RelativeAddress,   ///< A four byte jump target address relative to the end of the instruction
+    String             ///< A two byte string length, followed by that many characters
+  };
+
+  /**
+   * @brief A single decoded instruction
+   */
+  struct Instruction {
+    size_t offset = 0;           ///< The byte offset of the instruction's OpCode
+    size_t size = 0;             ///< The encoded size of the instruction including its OpCode
+    OpCode opcode = OpCode::NoOp; ///< The instruction's operator
+  };
+
+  /**
+   * @fn InstructionDecoder::getOperandTypes
+   * @brief Returns the operand types of an operator, in encoding order
+   *
+   * Throws if the operator is unknown.
+   *
+   * @param opcode The operator to return the operand types of
+   * @return The operand types
+   */
+  [[nodiscard]] static const std::vector<OperandType>& getOperandTypes(OpCode opcode);
+
+  /**
+   * @fn InstructionDecoder::getOperandSize
+   * @brief Returns the encoded size of an operand type
+   *
+   * For strings, only the size of the length field is returned.
+   */
+  [[nodiscard]] static size_t getOperandSize(OperandType type) noexcept;
+
+  /**
+   * @fn InstructionDecoder::isKnownOpCode
+   * @brief Determines whether a byte denotes a known operator
+   */
+  [[nodiscard]] static bool isKnownOpCode(unsigned char byte) noexcept;
+
+  /**
+   * @fn InstructionDecoder::decode
+   * @brief Decodes the instruction starting at a given offset
+   *
+   * @param code The byte code to decode from
+   * @param offset The offset of the instruction's OpCode
+   * @return The decoded instruction, or no value if the byte at `offset` is not a known operator or
+   *         the instruction is truncated
+   */
+  [[nodiscard]] static std::optional<Instruction> decode(ProgramView code, size_t offset) noexcept;
+
+  /**
+   * @fn InstructionDecoder::decodeAll
+   * @brief Decodes byte code into consecutive instructions
+   *
+   * Decoding stops at the first byte that does not start a complete, known instruction.
+   *
+   * @param code The byte code to decode
+   * @return The decoded instructions, in order
+   */
+  [[nodiscard]] static std::vector<Instruction> decodeAll(ProgramView code);
+
+  /**
+   * @fn InstructionDecoder::getOperandOffset
+   * @brief Returns the byte offset of an instruction's operand of the given type
+   *
+   * @param code The byte code the instruction was decoded from
+   * @param instruction The instruction to look into
+   * @param type The operand type to look for
+   * @return The offset of the first operand of that type, or no value if there is none
+   */
+  [[nodiscard]] static std::optional<size_t> getOperandOffset(
+      ProgramView code, const Instruction& instruction, OperandType type);
+
+  /**
+   * @fn InstructionDecoder::getJumpTarget
+   * @brief Returns the absolute target address of a jump with a constant target
+   *
+   * Relative targets are converted to absolute ones. Jumps to variable addresses have no constant
+   * target and yield no value, as do all other instructions.
+   *
+   * @param code The byte code the instruction was decoded from
+   * @param instruction The instruction to inspect
+   * @return The absolute jump target, or no value
+   */
+  [[nodiscard]] static std::optional<int64_t> getJumpTarget(
+      ProgramView code, const Instruction& instruction);
+
+  /**
+   * @fn InstructionDecoder::setJumpTarget
+   * @brief Sets the absolute target address of a jump with a constant target
+   *
+   * Relative targets are converted to the instruction's relative encoding. Does nothing for
+   * instructions without a constant jump target.
+   *
+   * @param code The byte code the instruction was decoded from
+   * @param instruction The instruction to modify
+   * @param target The new absolute jump target
+   */
+  static void setJumpTarget(
+      std::vector<unsigned char>& code, const Instruction& instruction, int64_t target);
+};
+
+}  // namespace beast
+
+#endif  // BEAST_INSTRUCTION_DECODER_HPP_
@@ -0,0 +1,87 @@
+#ifndef BEAST_MAPPED_FILE_HPP_
+#define BEAST_MAPPED_FILE_HPP_
+
+// Standard
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace beast {
+
+/**
+ * @class MappedFile
+ * @brief Maps a file into memory for reading, and replaces files atomically
+ *
+ * Large files such as evolution checkpoints and program corpora are accessed in place rather than
+ * parsed into memory: the operating system only loads the pages that are actually touched. On
+ * platforms without `mmap`, the file is read into memory instead. Files meant to be mapped are
+ * written with writeAtomically(), so a reader never maps a partially written file.
+ */
+class MappedFile {
+ public:
+  /**
+   * @fn MappedFile::MappedFile
+   * @brief Opens and maps a file
+   *
+   * Throws if the file can't be opened or mapped.
+   *
+   * @param path The file to map
+   */
+  explicit MappedFile(const std::string& path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @fn MappedFile::~MappedFile
+   * @brief Unmaps the file
+   */
+  ~MappedFile();
+
+  /**
+   * @fn MappedFile::getData
+   * @brief Returns the start of the mapped file, or `nullptr` if the file is empty
+   */
+  [[nodiscard]] const unsigned char* getData() const noexcept;
+
+  /**
+   * @fn MappedFile::getSize
+   * @brief Returns the size of the mapped file
+   */
+  [[nodiscard]] size_t getSize() const noexcept;
+
+  /**
+   * @fn MappedFile::writeAtomically
+   * @brief Replaces a file with the given contents, never leaving a partially written file
+   *
+   * The contents are written to a temporary file next to the target first, flushed to disk, and
+   * then renamed over the target. Throws if the file can't be written.
+   *
+   * @param path The file to write
+   * @param data The file's new contents
+   */
+  static void writeAtomically(const std::string& path, const std::vector<unsigned char>& data);
+
+ private:
+  /**
+   * @var MappedFile::data_
+   * @brief The start of the mapped file
+   */
+  const unsigned char* data_ = nullptr;
+
+  /**
+   * @var MappedFile::size_
+   * @brief The size of the mapped file
+   */
+  size_t size_ = 0;
+
+  /**
+   * @var MappedFile::buffer_
+   * @brief Holds the file's contents on platforms without `mmap`
+   */
+  std::vector<unsigned char> buffer_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_MAPPED_FILE_HPP_
@@ -0,0 +1,202 @@
+#ifndef BEAST_MESSAGE_SINK_HPP_
+#define BEAST_MESSAGE_SINK_HPP_
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Internal
+#include <beast/bounded_queue.hpp>
+#include <beast/virtual_machine.hpp>
+
+namespace beast {
+
+/**
+ * @class MessageSink
+ * @brief Base class for destinations of VirtualMachine messages
+ *
+ * A sink receives every message a virtual machine decides to display, together with its severity
+ * and the time it was issued. As one virtual machine may step several sessions on different threads
+ * at once, implementations must be safe to call concurrently.
+ */
+class MessageSink {
+ public:
+  /**
+   * @fn MessageSink::~MessageSink
+   * @brief Virtual destructor performing no operation to ensure vtable consistency
+   */
+  virtual ~MessageSink() = default;
+
+  /**
+   * @fn MessageSink::write
+   * @brief Receives a single message
+   *
+   * @param severity The severity of the message
+   * @param time The point in time the message was issued at
+   * @param message The message text
+   */
+  virtual void write(
+      VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+      const std::string& message) noexcept = 0;
+};
+
+/**
+ * @class ConsoleMessageSink
+ * @brief Writes colored, timestamped messages to an output stream
+ *
+ * Each message is formatted into a single line up front and written in one go, so that lines of
+ * concurrent writers never interleave. Timestamps only have a resolution of one second, so they are
+ * formatted at most once per second and thread.
+ */
+class ConsoleMessageSink : public MessageSink {
+ public:
+  /**
+   * @fn ConsoleMessageSink::ConsoleMessageSink
+   * @brief Constructs a sink writing to the given stream
+   *
+   * @param out_stream The stream to write to; must outlive the sink
+   */
+  explicit ConsoleMessageSink(std::ostream& out_stream = std::cout);
+
+  void write(
+      VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+      const std::string& message) noexcept override;
+
+  /**
+   * @fn ConsoleMessageSink::formatMessage
+   * @brief Formats a message into the line that is written to the stream, including a line break
+   */
+  [[nodiscard]] static std::string formatMessage(
+      VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+      const std::string& message);
+
+ private:
+  /**
+   * @var ConsoleMessageSink::out_stream_
+   * @brief The stream to write to
+   */
+  std::ostream& out_stream_;
+
+  /**
+   * @var ConsoleMessageSink::mutex_
+   * @brief Serializes writes to the stream
+   */
+  std::mutex mutex_;
+};
+
+/**
+ * @class AsyncMessageSink
+ * @brief Hands messages to a background thread that forwards them to another sink
+ *
+ * Writers only move the message into a lock-free ring buffer (see BoundedQueue) and return, so
+ * threads stepping sessions in parallel never wait for each other or for the output stream. A
+ * background thread drains the buffer in order and forwards each message to the target sink. If
+ * writers outpace the target and the buffer runs full, further messages are dropped and counted
+ * rather than blocking the writers.
+ *
+ * Pending messages are forwarded before the sink is destroyed.
+ */
+class AsyncMessageSink : public MessageSink {
+ public:
+  /**
+   * @fn AsyncMessageSink::AsyncMessageSink
+   * @brief Constructs the sink and starts its background thread
+   *
+   * @param target The sink to forward messages to
+   * @param capacity The number of messages that can be pending at once
+   */
+  explicit AsyncMessageSink(std::shared_ptr<MessageSink> target, size_t capacity = 4096);
+
+  /**
+   * @fn AsyncMessageSink::~AsyncMessageSink
+   * @brief Forwards all pending messages and stops the background thread
+   */
+  ~AsyncMessageSink() override;
+
+  AsyncMessageSink(const AsyncMessageSink&) = delete;
+  AsyncMessageSink& operator=(const AsyncMessageSink&) = delete;
+
+  void write(
+      VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+      const std::string& message) noexcept override;
+
+  /**
+   * @fn AsyncMessageSink::flush
+   * @brief Blocks until all messages written so far were forwarded to the target sink
+   */
+  void flush() const;
+
+  /**
+   * @fn AsyncMessageSink::getDroppedCount
+   * @brief Returns the number of messages dropped because the buffer was full
+   */
+  [[nodiscard]] uint64_t getDroppedCount() const noexcept;
+
+ private:
+  /**
+   * @brief A message waiting to be forwarded
+   */
+  struct PendingMessage {
+    VirtualMachine::MessageSeverity severity = VirtualMachine::MessageSeverity::Debug;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+  };
+
+  /**
+   * @fn AsyncMessageSink::drainLoop
+   * @brief Forwards pending messages until the sink is destroyed
+   */
+  void drainLoop();
+
+  /**
+   * @var AsyncMessageSink::target_
+   * @brief The sink messages are forwarded to
+   */
+  std::shared_ptr<MessageSink> target_;
+
+  /**
+   * @var AsyncMessageSink::queue_
+   * @brief The messages waiting to be forwarded
+   */
+  BoundedQueue<PendingMessage> queue_;
+
+  /**
+   * @var AsyncMessageSink::accepted_count_
+   * @brief The number of messages pushed into the queue
+   */
+  std::atomic<uint64_t> accepted_count_{0};
+
+  /**
+   * @var AsyncMessageSink::forwarded_count_
+   * @brief The number of messages forwarded to the target sink
+   */
+  std::atomic<uint64_t> forwarded_count_{0};
+
+  /**
+   * @var AsyncMessageSink::dropped_count_
+   * @brief The number of messages dropped because the queue was full
+   */
+  std::atomic<uint64_t> dropped_count_{0};
+
+  /**
+   * @var AsyncMessageSink::stopping_
+   * @brief Denotes that the background thread should finish
+   */
+  std::atomic<bool> stopping_{false};
+
+  /**
+   * @var AsyncMessageSink::thread_
+   * @brief The background thread draining the queue
+   */
+  std::thread thread_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_MESSAGE_SINK_HPP_
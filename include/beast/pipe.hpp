@@ -2,11 +2,23 @@
 #define BEAST_PIPE_HPP_
 
 // Standard
-#include <deque>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
 #include <stdint.h>
+#include <string>
+#include <thread>
 #include <vector>
 
 // Internal
+#include <beast/behavior_archive.hpp>
+#include <beast/bounded_queue.hpp>
+#include <beast/evolution_checkpoint.hpp>
+#include <beast/fitness_cache.hpp>
+#include <beast/surrogate_model.hpp>
 #include <beast/vm_session.hpp>
 
 namespace beast {
@@ -19,11 +31,36 @@ namespace beast {
  * a given task. A pipe implements the entire logic to judge the fitness of a program for the task,
  * by implementing an `evaluate` function. This class is virtual and must be subclassed.
  *
+ * Evolution runs either as a blocking batch (see evolve()) or as a continuously running
+ * steady-state evolution on a background thread (see start()), which accepts new inputs while
+ * running and emits finalists as soon as they clear the cut-off score.
+ *
+ * Inputs and outputs are held in lock-free bounded queues (see BoundedQueue), so producers,
+ * evolution, and consumers can run on different threads without external locking. Candidates are
+ * moved through the queues without being copied. Both queues exert backpressure: adding inputs
+ * blocks while the input pool is full, and storing finalists blocks while the output buffer is
+ * full. Non-blocking variants are available for both.
+ *
  * @author Jan Winkler
  * @date 2023-02-04
  */
 class Pipe {
  public:
+  /**
+   * @brief Configures the genetic algorithm driving evolution
+   *
+   * @sa setEvolutionParameters()
+   */
+  struct EvolutionParameters {
+    uint32_t generations = 250;             ///< Generations run by evolve(); start() runs until
+                                            ///  stop() and ignores it
+    double mutation_probability = 0.01;     ///< Probability of each instruction to be mutated
+    double crossover_probability = 0.9;     ///< Probability of parents to be crossed over
+    bool elitism = true;                    ///< Whether evolve() keeps the best individual; start()
+                                            ///  only replaces the worst ones and ignores it
+    double replacement_probability = 0.25;  ///< Share of the population replaced per steady step
+  };
+
   /**
    * @brief Holds information about finalist programs
    *
@@ -35,35 +72,95 @@ class Pipe {
     double score;                     ///< The evaluation score this code achieved
   };
 
+  /**
+   * @brief The result of evaluating a program against a score threshold
+   *
+   * @sa evaluateRacing()
+   */
+  struct RacingScore {
+    double score;    ///< The achieved score, or an upper bound of it if evaluation was abandoned
+    bool abandoned;  ///< Whether evaluation was abandoned because the threshold was out of reach
+  };
+
+  /**
+   * @brief The result of evaluating a program while searching for novelty
+   *
+   * @sa evaluateWithBehavior()
+   */
+  struct BehaviorScore {
+    double score;                 ///< The achieved score
+    std::vector<float> behavior;  ///< The descriptor of the program's behavior during evaluation
+  };
+
+  /**
+   * @brief Configures novelty search
+   *
+   * @sa setNoveltySearch()
+   */
+  struct NoveltyParameters {
+    uint32_t neighbour_count = 15;   ///< How many nearest archived behaviors novelty averages over
+    double archive_threshold = 0.0;  ///< Novelty a behavior needs to be added to the archive
+    double novelty_weight = 1.0;     ///< Share of novelty in the score, from 0.0 to 1.0
+  };
+
+  /**
+   * @brief Configures when a surrogate model skips evaluating candidates
+   *
+   * @sa setSurrogateModel()
+   */
+  struct SurrogateParameters {
+    double skip_threshold = 0.0;     ///< Likely losers are predicted to score below this and
+                                     ///  below the cut-off score
+    double exploration_rate = 0.1;   ///< Probability of evaluating a likely loser anyway
+    uint64_t warm_up_samples = 100;  ///< Samples the model needs before it skips candidates
+  };
+
   /**
    * @class Pipe::Pipe
    * @brief Constructs the pipe for a maximum candidate buffer size
    *
    * Pipes have a specific initial population size that needs to be met with candidates before
-   * evolution can begin. This size is specified in this constructor.
+   * evolution can begin. This size is specified in this constructor. It also bounds the input pool.
    *
    * @param max_candidates The candidate population size for this pipe
+   * @param output_capacity The minimum number of finalists the output buffer can hold
    */
-  explicit Pipe(uint32_t max_candidates);
+  explicit Pipe(uint32_t max_candidates, size_t output_capacity = 1024);
 
   /**
    * @class Pipe::~Pipe
-   * @brief Deconstructs this instance
+   * @brief Deconstructs this instance, stopping a running steady-state evolution
    *
-   * Required for vtable consistency.
+   * As the evolution thread calls the virtual evaluation functions, subclasses must call
+   * `stop(std::nothrow)` in their own destructor. Debug builds assert that no evolution thread is
+   * left at this point.
    */
-  virtual ~Pipe() = default;
+  virtual ~Pipe();
 
   /**
    * @class Pipe::addInput
    * @brief Add a candidate program code to the input pool
    *
    * This function adds a given program code vector to the input candidate pool. These individuals
-   * will be used as initial population for evolution.
+   * will be used as initial population for evolution. Waits while the input pool is full (see
+   * hasSpace()), and throws std::overflow_error if it is still full after `timeout`, e.g. because
+   * no evolution draws from it.
    *
    * @param candidate The candidate program code to add to the input pool
+   * @param timeout How long to wait for space in the input pool
+   */
+  void addInput(
+      std::vector<unsigned char> candidate,
+      std::chrono::steady_clock::duration timeout = std::chrono::minutes(1));
+
+  /**
+   * @class Pipe::tryAddInput
+   * @brief Add a candidate program code to the input pool if there is space left
+   *
+   * @param candidate The candidate program code to add; left untouched if the pool is full
+   * @return `true` if the candidate was added, `false` if the input pool was full
    */
-  void addInput(const std::vector<unsigned char>& candidate);
+  [[nodiscard]] bool tryAddInput(std::vector<unsigned char>&& candidate);
 
   /**
    * @class Pipe::evolve
@@ -72,14 +169,124 @@ class Pipe {
    * Based on the `evaluate` function implemented in the concrete Pipe implementation, candidate
    * programs are scored according to their performance in these tasks. This function performs the
    * evolutionary steps required for recombination and formulation of new programs, and stores
-   * programs that pass the cut-off score into the output finalist buffer.
+   * programs that pass the cut-off score into the output finalist buffer, best first. Never waits
+   * for a consumer: finalists that don't fit into the output buffer are dropped and counted (see
+   * getDroppedFinalistCount()).
    */
   void evolve();
 
+  /**
+   * @class Pipe::resume
+   * @brief Continues a batch evolution from a checkpoint file written by evolve()
+   *
+   * The checkpoint is mapped into memory (see MappedEvolutionCheckpoint). Its pending inputs and
+   * finalists are put back into the pipe's buffers, and its population is evolved, with the scores
+   * it had, for the generations that remained when the checkpoint was taken. Throws if the
+   * checkpoint's population size differs from this pipe's, or the input pool can't take the
+   * checkpoint's inputs. Like evolve(), never waits for a consumer; the checkpoint's finalists and
+   * those of the resumed evolution are dropped and counted if the output buffer is full.
+   *
+   * The resumed evolution only continues exactly like the interrupted one if the pipe neither
+   * searches for novelty, nor uses a surrogate model, nor races candidates: the behavior archive,
+   * the model's weights, and the racing elite scores are not part of the checkpoint.
+   *
+   * @param checkpoint_path The checkpoint file to resume from
+   */
+  void resume(const std::string& checkpoint_path);
+
+  /**
+   * @class Pipe::setCheckpointing
+   * @brief Makes evolve() and resume() write a checkpoint every `interval` generations
+   *
+   * A checkpoint holds the population and its scores, the generation counter, and the candidates
+   * and finalists pending in the pipe's buffers (see EvolutionCheckpoint). The evolving thread only
+   * copies this state; the file is written in the background while evolution continues. At most
+   * one checkpoint is written at a time, and write errors are rethrown by evolve(). The random
+   * number generators are reseeded with a fresh seed at every checkpoint, which is stored along
+   * with it, so that a resumed evolution continues like the interrupted one would have (see
+   * resume() for the limits of this).
+   *
+   * The pending candidates and finalists are read from the buffers in place. Other threads may keep
+   * adding inputs while a checkpointing evolution runs, but must not draw inputs or outputs until it
+   * returns.
+   *
+   * @param path The file to write checkpoints to
+   * @param interval The number of generations between checkpoints, or 0 to disable them
+   */
+  void setCheckpointing(std::string path, uint32_t interval);
+
+  /**
+   * @class Pipe::getCheckpointPath
+   * @brief Returns the file checkpoints are written to
+   */
+  [[nodiscard]] const std::string& getCheckpointPath() const noexcept;
+
+  /**
+   * @class Pipe::getCheckpointInterval
+   * @brief Returns the number of generations between checkpoints, or 0 if they are disabled
+   */
+  [[nodiscard]] uint32_t getCheckpointInterval() const noexcept;
+
+  /**
+   * @class Pipe::start
+   * @brief Starts a continuously running steady-state evolution on a background thread
+   *
+   * The evolution waits until the input pool holds a full population, and then repeatedly breeds
+   * offspring that replace the worst individuals (see
+   * EvolutionParameters::replacement_probability). Before each step, inputs added in the meantime
+   * replace the worst individuals as well. After each step, individuals that clear the cut-off
+   * score and were not emitted before are stored as finalists. The evolution runs until stop() is
+   * called. Throws if the evolution already runs.
+   */
+  void start();
+
+  /**
+   * @class Pipe::stop
+   * @brief Stops a running steady-state evolution and waits for its thread to exit
+   *
+   * If the evolution ended because an evaluation threw, the exception is rethrown here.
+   */
+  void stop();
+
+  /**
+   * @class Pipe::stop
+   * @brief Stops a running steady-state evolution without rethrowing its error
+   *
+   * Meant for destructors, which must not throw. An error the evolution ended with stays stored,
+   * and a later call to stop() rethrows it.
+   */
+  void stop(std::nothrow_t /*nothrow*/) noexcept;
+
+  /**
+   * @class Pipe::isRunning
+   * @brief Denotes whether a steady-state evolution was started and not stopped yet
+   */
+  [[nodiscard]] bool isRunning() const noexcept;
+
+  /**
+   * @class Pipe::setEvolutionParameters
+   * @brief Sets the parameters of the genetic algorithm
+   *
+   * Takes effect with the next call to evolve() or start(). Like the fitness cache and racing
+   * settings, the parameters must not be changed while a steady-state evolution runs.
+   *
+   * @param parameters The parameters to apply
+   */
+  void setEvolutionParameters(const EvolutionParameters& parameters);
+
+  /**
+   * @class Pipe::getEvolutionParameters
+   * @brief Returns the parameters of the genetic algorithm
+   */
+  [[nodiscard]] const EvolutionParameters& getEvolutionParameters() const noexcept;
+
   /**
    * @class Pipe::hasSpace
    * @brief Denote whether space is left in the input pool
    *
+   * With several producers adding concurrently, the result is only a hint: another producer may
+   * have taken the remaining space in the meantime.
+   *
    * @return `true` if the number of candidates in the input pool is less than the population size,
    *         `false` otherwise.
    */
@@ -98,16 +305,89 @@ class Pipe {
    */
   [[nodiscard]] virtual double evaluate(const std::vector<unsigned char>& program_data) = 0;
 
+  /**
+   * @class Pipe::evaluateBatch
+   * @brief Scores a batch of candidate programs
+   *
+   * During evolution, all candidates of a generation that still need a score are passed to this
+   * function at once. The default implementation calls `evaluate` for each of them in order.
+   * Subclasses can override it to score candidates in parallel or on remote machines (see
+   * EvaluationCoordinator). The returned vector must hold exactly one score per program, in the
+   * order the programs were passed in.
+   *
+   * @param programs The program candidates to score
+   * @return The evaluation scores the program candidates achieved (0.0 - 1.0)
+   */
+  [[nodiscard]] virtual std::vector<double> evaluateBatch(
+      const std::vector<std::vector<unsigned char>>& programs);
+
+  /**
+   * @class Pipe::evaluateRacing
+   * @brief Scores a candidate program, abandoning evaluation once it can't reach a threshold
+   *
+   * Used instead of `evaluate` and `evaluateBatch` while racing is enabled (see setRacing()) and
+   * novelty search is not.
+   * Implementations score the program incrementally (e.g. fitness case by fitness case, see
+   * FitnessCaseRunner::race) and may stop as soon as the best score the program can still achieve
+   * falls below the threshold. An abandoned evaluation reports that upper bound as its score. The
+   * default implementation evaluates the program completely by calling `evaluate`.
+   *
+   * @param program_data The program candidate to score
+   * @param threshold The score the program needs to reach to be evaluated completely
+   * @return The achieved score, and whether the evaluation was abandoned
+   */
+  [[nodiscard]] virtual RacingScore evaluateRacing(
+      const std::vector<unsigned char>& program_data, double threshold);
+
+  /**
+   * @class Pipe::evaluateWithBehavior
+   * @brief Scores a candidate program and describes its behavior during that evaluation
+   *
+   * Used instead of `evaluate` and `evaluateRacing` while novelty search is enabled (see
+   * setNoveltySearch()). Implementations describe the execution they scored, e.g. its runtime
+   * statistics (see BehaviorArchive::describeOperatorUsage()), so that the program doesn't need to
+   * run again. The descriptor must have the archive's dimension. The default implementation throws
+   * std::logic_error.
+   *
+   * @param program_data The program candidate to score
+   * @return The evaluation score the program candidate achieved (0.0 - 1.0), and its behavior
+   */
+  [[nodiscard]] virtual BehaviorScore evaluateWithBehavior(
+      const std::vector<unsigned char>& program_data);
+
+  /**
+   * @class Pipe::evaluateBatchWithBehavior
+   * @brief Scores a batch of candidate programs and describes their behavior
+   *
+   * Used instead of `evaluateBatch` while novelty search is enabled. The default implementation
+   * calls `evaluateWithBehavior` for each program in order. The returned vector must hold exactly
+   * one result per program, in the order the programs were passed in.
+   *
+   * @param programs The program candidates to score
+   * @return The evaluation scores the program candidates achieved (0.0 - 1.0), and their behavior
+   */
+  [[nodiscard]] virtual std::vector<BehaviorScore> evaluateBatchWithBehavior(
+      const std::vector<std::vector<unsigned char>>& programs);
+
   /**
    * @class Pipe::drawInput
    * @brief Pull an input candidate from the input buffer
    *
-   * Returns the oldest input buffer candidate and removes it from the buffer.
+   * Returns the oldest input buffer candidate and removes it from the buffer. Throws if the buffer
+   * is empty.
    *
    * @return An input candidate program code
    */
   [[nodiscard]] std::vector<unsigned char> drawInput();
 
+  /**
+   * @class Pipe::tryDrawInput
+   * @brief Pull an input candidate from the input buffer if there is one
+   *
+   * @return The oldest input candidate program code, or no value if the buffer is empty
+   */
+  [[nodiscard]] std::optional<std::vector<unsigned char>> tryDrawInput();
+
   /**
    * @class Pipe::hasOutput
    * @brief Denotes whether output finalists are available
@@ -120,27 +400,190 @@ class Pipe {
    * @class Pipe::drawOutput
    * @brief Pull an output finalist from the output buffer
    *
-   * Returns the oldest output buffer candidate and removes it from the buffer.
+   * Returns the oldest output buffer candidate and removes it from the buffer. Throws if the
+   * buffer is empty.
    *
    * @return An output finalist item consisting of program code and score
    */
   [[nodiscard]] OutputItem drawOutput();
 
+  /**
+   * @class Pipe::tryDrawOutput
+   * @brief Pull an output finalist from the output buffer if there is one
+   *
+   * @return The oldest output finalist item, or no value if the buffer is empty
+   */
+  [[nodiscard]] std::optional<OutputItem> tryDrawOutput();
+
+  /**
+   * @class Pipe::drawOutputFor
+   * @brief Pull an output finalist from the output buffer, waiting at most `timeout` for one
+   *
+   * Allows consumers on other threads to wait for finalists of a steady-state evolution.
+   *
+   * @param timeout The maximum time to wait
+   * @return The oldest output finalist item, or no value if none arrived in time
+   */
+  [[nodiscard]] std::optional<OutputItem> drawOutputFor(std::chrono::milliseconds timeout);
+
+  /**
+   * @class Pipe::getDroppedFinalistCount
+   * @brief Returns the number of finalists evolve() and resume() dropped for a full output buffer
+   */
+  [[nodiscard]] uint64_t getDroppedFinalistCount() const noexcept;
+
   /**
    * @class Pipe::setCutOffScore
    * @brief Sets the cut-off score
    *
-   * Finalists that score below this score are discarded after evolution.
+   * Finalists that score below this score are discarded after evolution. Unlike the other settings,
+   * the cut-off score may be changed while a steady-state evolution runs.
    *
    * @param cut_off_score The cut-off score under which to discard finalists
    */
   void setCutOffScore(double cut_off_score);
 
+  /**
+   * @class Pipe::getCutOffScore
+   * @brief Returns the cut-off score under which finalists are discarded
+   */
+  [[nodiscard]] double getCutOffScore() const noexcept;
+
+  /**
+   * @class Pipe::setRacing
+   * @brief Enables or disables racing evaluation during evolution
+   *
+   * While racing, candidates are evaluated one by one with `evaluateRacing`, against a threshold
+   * that is the cut-off score or, once `elite_count` candidates have been scored completely in the
+   * current evolution, the worst score among the best `elite_count` of them if that is higher.
+   * Candidates that provably can't reach the threshold are abandoned early and keep the upper bound
+   * of their score. Abandoned scores are never stored in the fitness cache. Racing has no effect
+   * while novelty search is enabled, as novelty is measured on complete evaluations.
+   *
+   * @param enabled Whether to race candidates
+   * @param elite_count The number of best scores that form the elite, or 0 to only race against the
+   *        cut-off score
+   */
+  void setRacing(bool enabled, uint32_t elite_count = 0);
+
+  /**
+   * @class Pipe::isRacing
+   * @brief Denotes whether candidates are raced during evolution
+   */
+  [[nodiscard]] bool isRacing() const noexcept;
+
+  /**
+   * @class Pipe::getRacingEliteCount
+   * @brief Returns the number of best scores that form the elite candidates are raced against
+   */
+  [[nodiscard]] uint32_t getRacingEliteCount() const noexcept;
+
+  /**
+   * @class Pipe::setFitnessCache
+   * @brief Attaches a cache that stores the scores of evaluated programs
+   *
+   * With a cache attached, evolution only evaluates programs whose score is not cached yet, and
+   * byte-identical candidates of one generation are evaluated only once. This requires `evaluate`
+   * to be deterministic for the cached programs (see FitnessCache). The configuration value must
+   * change whenever the evaluation itself changes, so that stale scores aren't served. A cache can
+   * be shared between pipes that use distinct configuration values. Passing `nullptr` detaches the
+   * current cache.
+   *
+   * @param cache The cache to attach
+   * @param configuration A value identifying this pipe's evaluation configuration
+   */
+  void setFitnessCache(std::shared_ptr<FitnessCache> cache, uint64_t configuration = 0);
+
+  /**
+   * @class Pipe::getFitnessCache
+   * @brief Returns the attached fitness cache, if any
+   */
+  [[nodiscard]] const std::shared_ptr<FitnessCache>& getFitnessCache() const noexcept;
+
+  /**
+   * @class Pipe::getFitnessCacheConfiguration
+   * @brief Returns the value identifying this pipe's evaluation configuration in the fitness cache
+   */
+  [[nodiscard]] uint64_t getFitnessCacheConfiguration() const noexcept;
+
+  /**
+   * @class Pipe::setNoveltySearch
+   * @brief Rewards candidates for behaving differently from the behaviors in an archive
+   *
+   * With an archive attached, candidates are scored by `evaluateWithBehavior` or
+   * `evaluateBatchWithBehavior`, and a candidate's novelty is the mean distance of its descriptor to
+   * the `neighbour_count` nearest descriptors in the archive. Candidates that aren't evaluated, as
+   * the fitness cache holds their score, they repeat another candidate of their batch, or the
+   * surrogate model predicted their score, have no descriptor; they count as not novel and aren't
+   * archived. The novelty `n` is mapped to `n / (1 + n)` and blended into the candidate's score
+   * by `novelty_weight`, so that scores stay between 0.0 and 1.0 and a weight of 1.0 searches for
+   * novelty alone. Descriptors whose novelty reaches `archive_threshold`, and all descriptors while
+   * the archive holds fewer than `neighbour_count` ones, are added to the archive. The cut-off
+   * score applies to the blended score, while racing thresholds and the fitness cache keep
+   * referring to the scores returned by the evaluation functions. An archive can be shared between
+   * pipes. Passing `nullptr` disables novelty search. Takes effect with the next call to evolve()
+   * or start().
+   *
+   * @param archive The archive to compare behaviors against and to extend
+   * @param parameters The novelty search parameters
+   */
+  void setNoveltySearch(
+      std::shared_ptr<BehaviorArchive> archive, const NoveltyParameters& parameters);
+
+  /**
+   * @class Pipe::getBehaviorArchive
+   * @brief Returns the archive novelty search compares against, if any
+   */
+  [[nodiscard]] const std::shared_ptr<BehaviorArchive>& getBehaviorArchive() const noexcept;
+
+  /**
+   * @class Pipe::getNoveltyParameters
+   * @brief Returns the novelty search parameters
+   */
+  [[nodiscard]] const NoveltyParameters& getNoveltyParameters() const noexcept;
+
+  /**
+   * @class Pipe::setSurrogateModel
+   * @brief Attaches a surrogate model that predicts scores to skip evaluating likely losers
+   *
+   * Before a candidate without a cached score is evaluated, the model predicts its score from
+   * static features of its byte code (see SurrogateModel). If the prediction plus the model's mean
+   * absolute error stays below `skip_threshold`, the candidate is not evaluated and gets the
+   * predicted score instead, unless it is picked for exploration with probability
+   * `exploration_rate`. A candidate whose predicted score reaches the cut-off score is always
+   * evaluated, so predictions never turn into finalists; with the default cut-off score of 0.0,
+   * nothing is skipped. Exploration keeps the model learning about the candidates it would reject,
+   * and keeps unusual candidates from being starved by a biased model. The model only skips
+   * candidates once it was trained with `warm_up_samples` evaluations. Every complete evaluation
+   * trains the model, while predicted and abandoned racing scores neither train it nor enter the
+   * fitness cache. A model can be shared between pipes evaluating for the same task. Passing
+   * `nullptr` detaches the current model. Takes effect with the next call to evolve() or start().
+   *
+   * @param model The surrogate model to predict scores with and to train
+   * @param parameters The parameters deciding when to skip evaluation
+   */
+  void setSurrogateModel(
+      std::shared_ptr<SurrogateModel> model, const SurrogateParameters& parameters);
+
+  /**
+   * @class Pipe::getSurrogateModel
+   * @brief Returns the attached surrogate model, if any
+   */
+  [[nodiscard]] const std::shared_ptr<SurrogateModel>& getSurrogateModel() const noexcept;
+
+  /**
+   * @class Pipe::getSurrogateParameters
+   * @brief Returns the parameters deciding when the surrogate model skips evaluation
+   */
+  [[nodiscard]] const SurrogateParameters& getSurrogateParameters() const noexcept;
+
  protected:
   /**
    * @class Pipe::storeFinalist
    * @brief Stores a finalist in the output buffer
    *
+   * Waits while the output buffer is full.
+   *
    * @param finalist The finalist program code to add to the buffer
    * @param score The score the finalist program code has achieved in the evaluation
    * @sa hasOutput(), drawOutput()
@@ -148,6 +591,43 @@ class Pipe {
   void storeFinalist(const std::vector<unsigned char>& finalist, float score);
 
  private:
+  /**
+   * @class Pipe::evolveFrom
+   * @brief Runs a batch evolution, starting from a checkpoint's population if one is given
+   */
+  void evolveFrom(const MappedEvolutionCheckpoint* checkpoint);
+
+  /**
+   * @class Pipe::addBufferedItems
+   * @brief Adds the candidates and finalists pending in the buffers to a checkpoint
+   *
+   * The items are read in place, so the buffers keep their order and producers are never blocked.
+   * Nothing may draw from the buffers meanwhile (see setCheckpointing()).
+   */
+  void addBufferedItems(EvolutionCheckpoint& checkpoint) const;
+
+  /**
+   * @class Pipe::runSteadyState
+   * @brief Main loop of the steady-state evolution thread
+   */
+  void runSteadyState();
+
+  /**
+   * @class Pipe::emitFinalist
+   * @brief Stores a finalist of the steady-state evolution, giving up once it is stopping
+   *
+   * @return `true` if the finalist was stored, `false` if the evolution is stopping
+   */
+  bool emitFinalist(const std::vector<unsigned char>& finalist, float score);
+
+  /**
+   * @class Pipe::offerFinalist
+   * @brief Stores a finalist of a batch evolution if the output buffer has space, or drops it
+   *
+   * @return `true` if the finalist was stored, `false` if it was dropped
+   */
+  bool offerFinalist(OutputItem&& finalist);
+
   /**
    * @var Pipe::max_candidates_
    * @brief Denotes the population size of this pipe
@@ -158,13 +638,13 @@ class Pipe {
    * @var Pipe::input_
    * @brief Holds the input candidate programs
    */
-  std::deque<std::vector<unsigned char>> input_;
+  BoundedQueue<std::vector<unsigned char>> input_;
 
   /**
    * @var Pipe::output_
    * @brief Holds the finalist output buffer
    */
-  std::deque<OutputItem> output_;
+  BoundedQueue<OutputItem> output_;
 
   /**
    * @var Pipe::cut_off_score_
@@ -172,7 +652,97 @@ class Pipe {
    *
    * Finalists below this score are not added to the output buffer.
    */
-  double cut_off_score_ = 0.0;
+  std::atomic<double> cut_off_score_{0.0};
+
+  /**
+   * @var Pipe::dropped_finalist_count_
+   * @brief The number of batch evolution finalists that didn't fit into the output buffer
+   */
+  std::atomic<uint64_t> dropped_finalist_count_{0};
+
+  /**
+   * @var Pipe::fitness_cache_
+   * @brief Holds the scores of evaluated programs, if attached
+   */
+  std::shared_ptr<FitnessCache> fitness_cache_;
+
+  /**
+   * @var Pipe::fitness_cache_configuration_
+   * @brief Identifies this pipe's evaluation configuration in the fitness cache
+   */
+  uint64_t fitness_cache_configuration_ = 0;
+
+  /**
+   * @var Pipe::racing_
+   * @brief Whether candidates are raced against a threshold during evolution
+   */
+  bool racing_ = false;
+
+  /**
+   * @var Pipe::racing_elite_count_
+   * @brief The number of best scores that form the elite candidates are raced against
+   */
+  uint32_t racing_elite_count_ = 0;
+
+  /**
+   * @var Pipe::behavior_archive_
+   * @brief Holds the behaviors novelty search compares against, if attached
+   */
+  std::shared_ptr<BehaviorArchive> behavior_archive_;
+
+  /**
+   * @var Pipe::novelty_parameters_
+   * @brief The novelty search parameters
+   */
+  NoveltyParameters novelty_parameters_;
+
+  /**
+   * @var Pipe::surrogate_model_
+   * @brief Predicts scores to skip evaluating likely losers, if attached
+   */
+  std::shared_ptr<SurrogateModel> surrogate_model_;
+
+  /**
+   * @var Pipe::surrogate_parameters_
+   * @brief The parameters deciding when the surrogate model skips evaluation
+   */
+  SurrogateParameters surrogate_parameters_;
+
+  /**
+   * @var Pipe::evolution_parameters_
+   * @brief The parameters of the genetic algorithm
+   */
+  EvolutionParameters evolution_parameters_;
+
+  /**
+   * @var Pipe::checkpoint_path_
+   * @brief The file checkpoints are written to
+   */
+  std::string checkpoint_path_;
+
+  /**
+   * @var Pipe::checkpoint_interval_
+   * @brief The number of generations between checkpoints, or 0 if they are disabled
+   */
+  uint32_t checkpoint_interval_ = 0;
+
+  /**
+   * @var Pipe::stop_requested_
+   * @brief Set when the steady-state evolution is supposed to exit
+   */
+  std::atomic<bool> stop_requested_{false};
+
+  /**
+   * @var Pipe::evolution_thread_
+   * @brief Runs the steady-state evolution
+   */
+  std::thread evolution_thread_;
+
+  /**
+   * @var Pipe::evolution_error_
+   * @brief The exception that ended the steady-state evolution, if any
+   */
+  std::exception_ptr evolution_error_;
 };
 
 }  // namespace beast
@@ -0,0 +1,338 @@
+#ifndef BEAST_PIPELINE_HPP_
+#define BEAST_PIPELINE_HPP_
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Internal
+#include <beast/bounded_queue.hpp>
+#include <beast/pipe.hpp>
+#include <beast/program_factory_base.hpp>
+
+namespace beast {
+
+/**
+ * @class Pipeline
+ * @brief Connects program factories, pipes, and sinks into a directed acyclic graph
+ *
+ * Programs flow along the edges of the graph: factories generate candidates, pipes evolve the
+ * candidates they receive and pass on their finalists, and sinks consume whatever reaches them.
+ * This allows multi-stage evolution, e.g. a coarse search whose finalists are refined by a second
+ * pipe with a stricter cut-off score.
+ *
+ * Every node runs on its own executor thread while the pipeline runs, and pipes run their
+ * steady-state evolution (see Pipe::start()), so all stages work at the same time. Edges are
+ * bounded queues. A node only takes an item from its inputs once it can accept it, and only
+ * passes an item on once an output edge has space for it; otherwise it holds the item and retries.
+ * A slow stage therefore fills its input edges, which stalls the stages in front of it, down to the
+ * factories. Nodes with several output edges hand out their items round robin to the edges that
+ * have space, and nodes with several input edges take turns reading them.
+ *
+ * Items that are still in flight when the pipeline is stopped stay in the edges and the pipes'
+ * buffers, and continue to flow when the pipeline is started again.
+ */
+class Pipeline {
+ public:
+  /**
+   * @brief Identifies a node of the pipeline
+   */
+  using NodeId = size_t;
+
+  /**
+   * @brief Consumes the items that reach a sink node; called on the sink's executor thread
+   */
+  using Sink = std::function<void(Pipe::OutputItem item)>;
+
+  /**
+   * @brief The role of a node in the pipeline
+   */
+  enum class NodeKind {
+    Factory = 0,  ///< Generates programs and has no inputs
+    Pipe = 1,     ///< Evolves the programs it receives and emits its finalists
+    Sink = 2      ///< Consumes programs and has no outputs
+  };
+
+  /**
+   * @brief The runtime parameters programs of a factory node are generated for
+   *
+   * @sa ProgramFactoryBase::generate()
+   */
+  struct FactoryParameters {
+    uint32_t program_size = 100;            ///< The maximum size of each program, in bytes
+    uint32_t memory_size = 16;              ///< The variable memory size to generate for
+    uint32_t string_table_size = 8;         ///< The string table size to generate for
+    uint32_t string_table_item_length = 8;  ///< The string table item length to generate for
+    uint64_t program_count = 0;             ///< How many programs to generate; 0 means unlimited
+  };
+
+  /**
+   * @brief A snapshot of the activity of a node
+   *
+   * Rates refer to the time the pipeline was running, including earlier runs.
+   */
+  struct NodeStatistics {
+    NodeKind kind;               ///< The role of the node
+    uint64_t items_received;     ///< Items taken from the input edges
+    uint64_t items_emitted;      ///< Items passed on to the output edges
+    double received_per_second;  ///< Average rate of received items
+    double emitted_per_second;   ///< Average rate of emitted items
+    size_t queue_depth;          ///< Items currently waiting in the node's input edges
+    size_t queue_capacity;       ///< The combined capacity of the node's input edges
+  };
+
+  /**
+   * @fn Pipeline::Pipeline
+   * @brief Constructs an empty pipeline
+   */
+  Pipeline() = default;
+
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  /**
+   * @fn Pipeline::~Pipeline
+   * @brief Stops all executors and the pipes' evolutions, discarding any of their errors
+   */
+  ~Pipeline();
+
+  /**
+   * @fn Pipeline::addFactory
+   * @brief Adds a node that generates programs with a program factory
+   *
+   * Throws if the factory is null or the pipeline is running.
+   *
+   * @param factory The factory to generate programs with
+   * @param parameters The parameters to generate programs for
+   * @return The identifier of the new node
+   */
+  NodeId addFactory(
+      std::shared_ptr<ProgramFactoryBase> factory, const FactoryParameters& parameters);
+
+  /**
+   * @fn Pipeline::addPipe
+   * @brief Adds a node that evolves the programs it receives
+   *
+   * The pipe's steady-state evolution is started and stopped along with the pipeline, so it must
+   * not be run otherwise while the pipeline runs. Throws if the pipe is null or the pipeline is
+   * running.
+   *
+   * @param pipe The pipe to evolve programs with
+   * @return The identifier of the new node
+   */
+  NodeId addPipe(std::shared_ptr<Pipe> pipe);
+
+  /**
+   * @fn Pipeline::addSink
+   * @brief Adds a node that consumes the programs it receives
+   *
+   * Throws if the sink is empty or the pipeline is running.
+   *
+   * @param sink The function called with every received item
+   * @return The identifier of the new node
+   */
+  NodeId addSink(Sink sink);
+
+  /**
+   * @fn Pipeline::connect
+   * @brief Adds a bounded edge from one node to another
+   *
+   * Throws if a node is unknown, the edge leaves a sink or enters a factory, the nodes are already
+   * connected, the edge would close a cycle, the capacity is zero, or the pipeline is running.
+   *
+   * @param from The node emitting items into the edge
+   * @param to The node receiving items from the edge
+   * @param capacity The minimum number of items the edge holds before exerting backpressure
+   */
+  void connect(NodeId from, NodeId to, size_t capacity = 64);
+
+  /**
+   * @fn Pipeline::start
+   * @brief Starts the pipes' evolutions and one executor thread per node
+   *
+   * Throws if the pipeline is already running.
+   */
+  void start();
+
+  /**
+   * @fn Pipeline::stop
+   * @brief Stops all executors and the pipes' evolutions and waits for them to finish
+   *
+   * Rethrows the first error raised by a factory, sink, or pipe while the pipeline ran.
+   */
+  void stop();
+
+  /**
+   * @fn Pipeline::isRunning
+   * @brief Denotes whether the pipeline was started and has neither been stopped nor failed
+   */
+  [[nodiscard]] bool isRunning() const noexcept;
+
+  /**
+   * @fn Pipeline::getNodeCount
+   * @brief Returns the number of nodes in the pipeline
+   */
+  [[nodiscard]] size_t getNodeCount() const noexcept;
+
+  /**
+   * @fn Pipeline::getNodeStatistics
+   * @brief Returns a snapshot of a node's throughput and queue depth
+   *
+   * May be called while the pipeline runs. Throws if the node is unknown.
+   *
+   * @param node_id The node to return the statistics of
+   */
+  [[nodiscard]] NodeStatistics getNodeStatistics(NodeId node_id) const;
+
+ private:
+  /**
+   * @brief A bounded queue carrying items from one node to another
+   */
+  struct Edge {
+    Edge(NodeId from_node, NodeId to_node, size_t capacity)
+      : from{from_node}, to{to_node}, queue{capacity} {}
+
+    NodeId from;                           ///< The emitting node
+    NodeId to;                             ///< The receiving node
+    BoundedQueue<Pipe::OutputItem> queue;  ///< The items in flight
+  };
+
+  /**
+   * @brief A node of the graph and the state its executor keeps between iterations
+   */
+  struct Node {
+    NodeKind kind = NodeKind::Sink;                  ///< The role of the node
+    std::shared_ptr<ProgramFactoryBase> factory;     ///< Set for factory nodes
+    FactoryParameters factory_parameters;            ///< Set for factory nodes
+    std::shared_ptr<Pipe> pipe;                      ///< Set for pipe nodes
+    Sink sink;                                       ///< Set for sink nodes
+    std::vector<Edge*> inputs;                       ///< Edges entering the node
+    std::vector<Edge*> outputs;                      ///< Edges leaving the node
+    size_t next_input = 0;                           ///< Input edge to read next
+    size_t next_output = 0;                          ///< Output edge to try first
+    uint64_t programs_generated = 0;                 ///< Programs a factory node generated
+    std::optional<Pipe::OutputItem> pending_input;   ///< Received, but not accepted yet
+    std::optional<Pipe::OutputItem> pending_output;  ///< Produced, but not emitted yet
+    std::atomic<uint64_t> items_received{0};         ///< Items taken from the input edges
+    std::atomic<uint64_t> items_emitted{0};          ///< Items passed on to the output edges
+    std::thread executor;                            ///< Runs the node
+  };
+
+  /**
+   * @fn Pipeline::addNode
+   * @brief Appends a prepared node, throwing if the pipeline is running
+   */
+  NodeId addNode(std::unique_ptr<Node> node);
+
+  /**
+   * @fn Pipeline::runNode
+   * @brief The executor loop of a node
+   *
+   * Iterates the node until the pipeline stops, backing off while no item moves. Errors are stored
+   * for stop() and stop the whole pipeline.
+   */
+  void runNode(Node& node);
+
+  /**
+   * @fn Pipeline::stepNode
+   * @brief Moves as many items as currently possible through a node
+   *
+   * @return Whether any item moved
+   */
+  bool stepNode(Node& node);
+
+  /**
+   * @fn Pipeline::receive
+   * @brief Takes the next item from the node's input edges, taking turns between them
+   *
+   * @return Whether an item was received into Node::pending_input
+   */
+  static bool receive(Node& node);
+
+  /**
+   * @fn Pipeline::emit
+   * @brief Passes Node::pending_output on to the first output edge with space, round robin
+   *
+   * @return Whether the item was emitted
+   */
+  static bool emit(Node& node);
+
+  /**
+   * @fn Pipeline::joinExecutors
+   * @brief Waits for all executor threads and stops the pipes, collecting the first error
+   */
+  void joinExecutors();
+
+  /**
+   * @fn Pipeline::recordError
+   * @brief Stores an error for stop() unless an earlier one is stored already
+   */
+  void recordError(std::exception_ptr error);
+
+  /**
+   * @fn Pipeline::getRunningSeconds
+   * @brief Returns the total time the pipeline ran, including the current run
+   */
+  [[nodiscard]] double getRunningSeconds() const;
+
+  /**
+   * @var Pipeline::nodes_
+   * @brief The nodes, indexed by their identifiers
+   */
+  std::vector<std::unique_ptr<Node>> nodes_;
+
+  /**
+   * @var Pipeline::edges_
+   * @brief The edges connecting the nodes
+   */
+  std::vector<std::unique_ptr<Edge>> edges_;
+
+  /**
+   * @var Pipeline::started_
+   * @brief Whether executors were started and not joined yet
+   */
+  std::atomic<bool> started_{false};
+
+  /**
+   * @var Pipeline::stop_requested_
+   * @brief Tells the executors to finish
+   */
+  std::atomic<bool> stop_requested_{false};
+
+  /**
+   * @var Pipeline::state_mutex_
+   * @brief Guards the running time bookkeeping and the stored error
+   */
+  mutable std::mutex state_mutex_;
+
+  /**
+   * @var Pipeline::run_started_
+   * @brief When the current run started
+   */
+  std::chrono::steady_clock::time_point run_started_;
+
+  /**
+   * @var Pipeline::previous_runs_duration_
+   * @brief The accumulated duration of all finished runs
+   */
+  std::chrono::steady_clock::duration previous_runs_duration_{};
+
+  /**
+   * @var Pipeline::error_
+   * @brief The first error raised by a node during the current run
+   */
+  std::exception_ptr error_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PIPELINE_HPP_
@@ -99,7 +99,7 @@ class Program {
    * @return A 4 byte variable containing the next 4 program bytes, starting from an offset.
    * @sa getData2(), getData1()
    */
-  [[nodiscard]] int32_t getData4(int32_t offset);
+  [[nodiscard]] int32_t getData4(int32_t offset) const;
 
   /**
    * @fn Program::getData2
@@ -113,7 +113,7 @@ class Program {
    * @return A 2 byte variable containing the next 2 program bytes, starting from an offset.
    * @sa getData4(), getData1()
    */
-  [[nodiscard]] int16_t getData2(int32_t offset);
+  [[nodiscard]] int16_t getData2(int32_t offset) const;
 
   /**
    * @fn Program::getData1
@@ -127,7 +127,7 @@ class Program {
    * @return A 1 byte variable containing the next 1 program byte, starting from an offset.
    * @sa getData4(), getData2()
    */
-  [[nodiscard]] int8_t getData1(int32_t offset);
+  [[nodiscard]] int8_t getData1(int32_t offset) const;
 
   /**
    * @fn Program::getPointer
@@ -1596,6 +1596,8 @@ class Program {
       int32_t target_variable_index, bool target_follow_links);
 
  private:
+  friend class ProgramBuilder;
+
   /**
    * @fn Program::canFit
    * @brief Checks if a number of bytes fits into the available program space
@@ -1675,9 +1677,12 @@ class Program {
    * @fn Program::ensureSize
    * @brief If too small, resizes the internal byte storage to accomodate up to `size` bytes.
    *
+   * The storage capacity grows geometrically, so that adding a program's operators one by one takes
+   * amortized constant time per byte.
+   *
    * @param size The size that should be ensured to fit into the program space.
    */
-  void ensureSize(uint32_t size) noexcept ;
+  void ensureSize(uint32_t size) noexcept;
 
   /**
    * @var Program::data_
@@ -0,0 +1,198 @@
+#ifndef BEAST_PROGRAM_BUILDER_HPP_
+#define BEAST_PROGRAM_BUILDER_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Internal
+#include <beast/instruction_decoder.hpp>
+#include <beast/program.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramBuilder
+ * @brief Builds programs whose jumps target labels instead of hand-computed addresses
+ *
+ * A builder is a dynamically growing Program, so all operators can be added to it the same way.
+ * In addition, it hands out labels that can be bound to the current program position, and jumps
+ * that target a label. Jumps may refer to labels before they are bound (forward references); their
+ * targets are filled in when the program is built:
+ *
+ * @code
+ * beast::ProgramBuilder builder;
+ * const beast::ProgramBuilder::Label loop_start = builder.createLabel();
+ * builder.bindLabel(loop_start);
+ * builder.addConstantToVariable(0, 1, true);
+ * builder.compareIfVariableLtConstant(0, true, 10, 1, true);
+ * builder.jumpToLabelIfVariableGreaterThanZero(1, true, loop_start);
+ * beast::Program program = builder.build();
+ * @endcode
+ *
+ * Label jumps are encoded as relative jumps, so built programs keep working when they are inserted
+ * into other programs at any position.
+ */
+class ProgramBuilder : public Program {
+ public:
+  /**
+   * @class ProgramBuilder::Label
+   * @brief A handle to a program position, created by the builder it is used with
+   */
+  class Label {
+   private:
+    /**
+     * @fn ProgramBuilder::Label::Label
+     * @brief Constructs a handle to one of the builder's labels
+     *
+     * @param index The index of the label in its builder
+     */
+    explicit Label(size_t index) noexcept : index_{index} {}
+
+    /**
+     * @var ProgramBuilder::Label::index_
+     * @brief The index of the label in its builder
+     */
+    size_t index_;
+
+    friend class ProgramBuilder;
+  };
+
+  /**
+   * @fn ProgramBuilder::ProgramBuilder
+   * @brief Constructs an empty builder
+   */
+  ProgramBuilder() = default;
+
+  /**
+   * @fn ProgramBuilder::ProgramBuilder(size_t)
+   * @brief Constructs an empty builder that fits `capacity` bytes without reallocating
+   *
+   * @param capacity The number of bytes to reserve, e.g. the expected size of the program
+   */
+  explicit ProgramBuilder(size_t capacity);
+
+  /**
+   * @fn ProgramBuilder::createLabel
+   * @brief Creates a new, unbound label
+   *
+   * @return The new label
+   */
+  [[nodiscard]] Label createLabel();
+
+  /**
+   * @fn ProgramBuilder::bindLabel
+   * @brief Binds a label to the current program position
+   *
+   * Throws if the label is already bound or doesn't belong to this builder.
+   *
+   * @param label The label to bind
+   */
+  void bindLabel(Label label);
+
+  /**
+   * @fn ProgramBuilder::getLabelAddress
+   * @brief Returns the program position a label is bound to
+   *
+   * Throws if the label doesn't belong to this builder.
+   *
+   * @param label The label to look up
+   * @return The label's address, or `std::nullopt` if it isn't bound yet
+   */
+  [[nodiscard]] std::optional<uint32_t> getLabelAddress(Label label) const;
+
+  /**
+   * @fn ProgramBuilder::jumpToLabel
+   * @brief Adds an unconditional jump to a label
+   *
+   * @param label The label to jump to
+   */
+  void jumpToLabel(Label label);
+
+  /**
+   * @fn ProgramBuilder::jumpToLabelIfVariableGreaterThanZero
+   * @brief Adds a jump to a label that is taken if a variable is greater than zero
+   *
+   * @param variable_index The index of the variable to check
+   * @param follow_links Whether to follow variable links
+   * @param label The label to jump to
+   */
+  void jumpToLabelIfVariableGreaterThanZero(int32_t variable_index, bool follow_links, Label label);
+
+  /**
+   * @fn ProgramBuilder::jumpToLabelIfVariableLessThanZero
+   * @brief Adds a jump to a label that is taken if a variable is less than zero
+   *
+   * @param variable_index The index of the variable to check
+   * @param follow_links Whether to follow variable links
+   * @param label The label to jump to
+   */
+  void jumpToLabelIfVariableLessThanZero(int32_t variable_index, bool follow_links, Label label);
+
+  /**
+   * @fn ProgramBuilder::jumpToLabelIfVariableEqualsZero
+   * @brief Adds a jump to a label that is taken if a variable equals zero
+   *
+   * @param variable_index The index of the variable to check
+   * @param follow_links Whether to follow variable links
+   * @param label The label to jump to
+   */
+  void jumpToLabelIfVariableEqualsZero(int32_t variable_index, bool follow_links, Label label);
+
+  /**
+   * @fn ProgramBuilder::build
+   * @brief Resolves all label jumps and moves the byte code out into a program
+   *
+   * The byte code isn't copied. The returned program grows dynamically, and the builder is left
+   * empty, with all its labels discarded. Throws if a jump targets a label that was never bound;
+   * the builder is left unchanged in that case.
+   *
+   * @return The built program
+   */
+  [[nodiscard]] Program build();
+
+ private:
+  /**
+   * @brief A label jump whose target is filled in when the program is built
+   */
+  struct Fixup {
+    InstructionDecoder::Instruction instruction;  ///< The jump instruction
+    size_t label_index = 0;                       ///< The index of the label the jump targets
+  };
+
+  /**
+   * @fn ProgramBuilder::checkLabel
+   * @brief Throws if a label doesn't belong to this builder
+   *
+   * @param label The label to check
+   */
+  void checkLabel(Label label) const;
+
+  /**
+   * @fn ProgramBuilder::addFixup
+   * @brief Records a label jump that was just added, starting at `offset`
+   *
+   * @param offset The address of the jump instruction
+   * @param opcode The jump instruction's operator
+   * @param label The label the jump targets
+   */
+  void addFixup(uint32_t offset, OpCode opcode, Label label);
+
+  /**
+   * @var ProgramBuilder::label_addresses_
+   * @brief The address of every label created so far, by label index, if bound
+   */
+  std::vector<std::optional<uint32_t>> label_addresses_;
+
+  /**
+   * @var ProgramBuilder::fixups_
+   * @brief All label jumps added so far
+   */
+  std::vector<Fixup> fixups_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_BUILDER_HPP_
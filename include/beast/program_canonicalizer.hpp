@@ -0,0 +1,75 @@
+#ifndef BEAST_PROGRAM_CANONICALIZER_HPP_
+#define BEAST_PROGRAM_CANONICALIZER_HPP_
+
+// Standard
+#include <cstdint>
+#include <set>
+
+// Internal
+#include <beast/fitness_cache.hpp>
+#include <beast/program.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramCanonicalizer
+ * @brief Maps byte code that differs only in irrelevant details to the same canonical program
+ *
+ * Evolution produces many byte sequences that are the same program: they differ in NoOp padding,
+ * unreachable code, bytes that never decode because execution never gets there, or flag bytes that
+ * are read as booleans but hold different non-zero values. The canonical form removes these
+ * differences:
+ *
+ * - Undecodable trailing bytes are removed if no execution path can reach them.
+ * - Flag operands are set to `0x0` or `0x1`.
+ * - The code is optimized with the ProgramOptimizer until it doesn't change anymore.
+ * - Optionally, variables are renumbered in the order in which the code first mentions them.
+ *
+ * Without renaming, canonical programs produce the same variable values, output, and return code
+ * as the original, while their runtime statistics differ (see ProgramOptimizer). Renaming moves
+ * values to other variable indices, so a renamed program only behaves like the original for a
+ * host that feeds and reads variables by index if all of these indices are passed as fixed
+ * variables. Keys of programs renamed without them must not be used to share scores between
+ * programs whose evaluation sets or reads variables. Renaming is skipped for programs that declare
+ * link variables or use I/O operators. Byte code whose behavior depends on its own layout (see
+ * ProgramOptimizer::isRelocatable()) keeps its layout and is only stripped of unreachable trailing
+ * bytes.
+ *
+ * Canonicalizing canonical byte code returns it unchanged.
+ */
+class ProgramCanonicalizer {
+ public:
+  /**
+   * @fn ProgramCanonicalizer::canonicalize
+   * @brief Returns the canonical form of byte code
+   *
+   * @param code The byte code to canonicalize
+   * @param rename_variables Whether to renumber variables in order of their first mention
+   * @param fixed_variables The variable indices the host sets or reads, which renaming keeps
+   * @return The canonical program
+   */
+  [[nodiscard]] static Program canonicalize(
+      ProgramView code, bool rename_variables = false,
+      const std::set<int32_t>& fixed_variables = {});
+
+  /**
+   * @fn ProgramCanonicalizer::makeKey
+   * @brief Computes a structural hash that is equal for byte code with the same canonical form
+   *
+   * This is the FitnessCache::makeKey() key of the canonical program.
+   *
+   * @param code The byte code to hash
+   * @param configuration A value identifying the evaluation configuration
+   * @param rename_variables Whether to renumber variables in order of their first mention
+   * @param fixed_variables The variable indices the host sets or reads, which renaming keeps
+   * @return The key of the canonical program
+   */
+  [[nodiscard]] static FitnessCache::Key makeKey(
+      ProgramView code, uint64_t configuration, bool rename_variables = false,
+      const std::set<int32_t>& fixed_variables = {});
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_CANONICALIZER_HPP_
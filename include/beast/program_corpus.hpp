@@ -0,0 +1,228 @@
+#ifndef BEAST_PROGRAM_CORPUS_HPP_
+#define BEAST_PROGRAM_CORPUS_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Internal
+#include <beast/fitness_cache.hpp>
+#include <beast/mapped_file.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramCorpus
+ * @brief Collects programs with their metadata and writes them to a single corpus file
+ *
+ * A corpus archives evolved programs for later re-evaluation. Every record holds a program's byte
+ * code and its metadata: the score it achieved, the generation it was found in, and its content
+ * hash, which equals its FitnessCache::makeKey() key for configuration 0.
+ *
+ * The file starts with a fixed size header, followed by an index of all records (location and
+ * metadata each), a table of compression blocks, and the programs' bytes. Like evolution
+ * checkpoints, values are stored in the host's byte order and at naturally aligned offsets, and
+ * files are replaced atomically, so a MappedProgramCorpus can access the file in place.
+ *
+ * Uncompressed corpora store every program contiguously, so mapped records can be executed without
+ * copying a single byte. Compressed corpora group consecutive programs into blocks of at least the
+ * configured size and compress each block on its own with a fast LZ77 codec; reading a program
+ * then decompresses its block only. Evolved programs repeat operator sequences a lot, so this
+ * typically halves the file size. Blocks that don't shrink are stored as they are.
+ */
+class ProgramCorpus {
+ public:
+  /**
+   * @brief The metadata stored with each program
+   */
+  struct Metadata {
+    double score;            ///< The score the program achieved
+    FitnessCache::Key hash;  ///< The program's content hash
+    uint32_t generation;     ///< The generation the program was found in
+  };
+
+  /**
+   * @brief A block size that balances the compression ratio against the cost of reading a record
+   */
+  static constexpr size_t kDefaultBlockSize = 65536;
+
+  /**
+   * @fn ProgramCorpus::ProgramCorpus
+   * @brief Constructs an empty corpus
+   *
+   * @param block_size The minimum number of program bytes per compression block, or 0 to store
+   *        programs uncompressed
+   */
+  explicit ProgramCorpus(size_t block_size = 0);
+
+  /**
+   * @fn ProgramCorpus::addProgram
+   * @brief Appends a program to the corpus
+   *
+   * @param program The program's byte code
+   * @param score The score the program achieved
+   * @param generation The generation the program was found in
+   */
+  void addProgram(ProgramView program, double score, uint32_t generation);
+
+  /**
+   * @fn ProgramCorpus::getRecordCount
+   * @brief Returns the number of programs in the corpus
+   */
+  [[nodiscard]] size_t getRecordCount() const noexcept;
+
+  /**
+   * @fn ProgramCorpus::serialize
+   * @brief Returns the corpus in its on-disk format
+   */
+  [[nodiscard]] std::vector<unsigned char> serialize() const;
+
+  /**
+   * @fn ProgramCorpus::write
+   * @brief Atomically replaces a file with this corpus
+   *
+   * Throws if the file can't be written.
+   *
+   * @param path The file to write
+   */
+  void write(const std::string& path) const;
+
+ private:
+  /**
+   * @brief A program held until the corpus is serialized
+   */
+  struct Record {
+    size_t offset;      ///< The offset of the program's bytes in `data_`
+    size_t size;        ///< The number of bytes
+    Metadata metadata;  ///< The program's metadata
+  };
+
+  /**
+   * @var ProgramCorpus::block_size_
+   * @brief The minimum number of program bytes per compression block, or 0 if uncompressed
+   */
+  size_t block_size_;
+
+  /**
+   * @var ProgramCorpus::data_
+   * @brief The bytes of all programs, concatenated
+   */
+  std::vector<unsigned char> data_;
+
+  /**
+   * @var ProgramCorpus::records_
+   * @brief The location and metadata of each program
+   */
+  std::vector<Record> records_;
+};
+
+/**
+ * @class MappedProgramCorpus
+ * @brief Provides read-only access to a corpus file that is mapped into memory
+ *
+ * Opening a corpus only validates its header. Metadata is read from the index on demand, and the
+ * programs of uncompressed corpora are returned as ProgramView instances pointing into the mapped
+ * file, ready to be executed by a VmSession without copying. Programs of compressed corpora are
+ * decompressed into a BlockCache supplied by the caller, which keeps the most recently used block,
+ * so reading consecutive records decompresses each block only once. The corpus itself is never
+ * modified and can be read from many threads, each with its own BlockCache.
+ */
+class MappedProgramCorpus {
+ public:
+  /**
+   * @brief A record in the mapped file
+   */
+  struct Record {
+    ProgramView program;               ///< The program's byte code
+    ProgramCorpus::Metadata metadata;  ///< The program's metadata
+  };
+
+  /**
+   * @brief Holds the most recently decompressed block of a compressed corpus
+   *
+   * Views into a cache are invalidated when the cache is used to read a record of another block.
+   */
+  class BlockCache {
+   private:
+    friend class MappedProgramCorpus;
+
+    const MappedProgramCorpus* corpus_ = nullptr;        ///< The corpus the block belongs to
+    size_t block_ = std::numeric_limits<size_t>::max();  ///< The cached block, if any
+    std::vector<unsigned char> data_;                    ///< The decompressed block
+  };
+
+  /**
+   * @fn MappedProgramCorpus::MappedProgramCorpus
+   * @brief Opens and maps a corpus file
+   *
+   * Throws if the file can't be opened or isn't a corpus written on a host with the same byte
+   * order.
+   *
+   * @param path The corpus file to open
+   */
+  explicit MappedProgramCorpus(const std::string& path);
+
+  /**
+   * @fn MappedProgramCorpus::getRecordCount
+   * @brief Returns the number of programs in the corpus
+   */
+  [[nodiscard]] size_t getRecordCount() const noexcept;
+
+  /**
+   * @fn MappedProgramCorpus::isCompressed
+   * @brief Returns whether the programs are stored in compressed blocks
+   */
+  [[nodiscard]] bool isCompressed() const noexcept;
+
+  /**
+   * @fn MappedProgramCorpus::getMetadata
+   * @brief Returns the metadata of a program without accessing its byte code
+   *
+   * Throws if the index is out of range.
+   */
+  [[nodiscard]] ProgramCorpus::Metadata getMetadata(size_t index) const;
+
+  /**
+   * @fn MappedProgramCorpus::getRecord(size_t) const
+   * @brief Returns a record of an uncompressed corpus, viewing the program in the mapped file
+   *
+   * The view is valid as long as the corpus is open. Throws if the index is out of range, the
+   * record lies outside of the file, or the corpus is compressed.
+   *
+   * @param index The index of the record
+   */
+  [[nodiscard]] Record getRecord(size_t index) const;
+
+  /**
+   * @fn MappedProgramCorpus::getRecord(size_t, BlockCache&) const
+   * @brief Returns a record of any corpus, decompressing its block into the cache if necessary
+   *
+   * For uncompressed corpora, the cache is not used and the view points into the mapped file.
+   * Throws if the index is out of range, or the record or its block is corrupt.
+   *
+   * @param index The index of the record
+   * @param cache The cache to decompress the record's block into
+   */
+  [[nodiscard]] Record getRecord(size_t index, BlockCache& cache) const;
+
+  /**
+   * @fn MappedProgramCorpus::copyProgram
+   * @brief Returns a copy of a program's byte code
+   */
+  [[nodiscard]] std::vector<unsigned char> copyProgram(size_t index) const;
+
+ private:
+  /**
+   * @var MappedProgramCorpus::file_
+   * @brief The mapped corpus file
+   */
+  MappedFile file_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_CORPUS_HPP_
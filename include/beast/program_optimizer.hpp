@@ -0,0 +1,76 @@
+#ifndef BEAST_PROGRAM_OPTIMIZER_HPP_
+#define BEAST_PROGRAM_OPTIMIZER_HPP_
+
+// Standard
+#include <cstddef>
+#include <map>
+
+// Internal
+#include <beast/program.hpp>
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramOptimizer
+ * @brief Rewrites byte code into a smaller equivalent that executes fewer steps
+ *
+ * Evolved programs carry a lot of ballast: NoOps, regions no jump or fall-through ever reaches,
+ * chains of jumps that lead to other jumps, and stores that are overwritten right away. The
+ * optimizer removes that ballast in a few passes:
+ *
+ * - Jumps to unconditional jumps (and to NoOps in front of them) are threaded to their final
+ *   target.
+ * - Within straight-line code, the values written by SetVariable and by comparisons of known values
+ *   are tracked. Conditional jumps on known values become unconditional jumps or are removed, and
+ *   SetVariable instructions that store a value the variable already holds, or whose value is
+ *   overwritten by the next instruction, are removed.
+ * - Instructions that can't be reached from the first instruction are removed.
+ * - NoOps, and unconditional jumps to the instruction that follows anyway, are removed. Code that
+ *   optimizes away entirely keeps a single NoOp, as empty code fails on its first step.
+ *
+ * Constant jump targets, absolute and relative, are relocated to the new layout. The result
+ * produces the same variable values, output, and return code as the original, while its runtime
+ * statistics (e.g., executed steps and operator counts) differ.
+ *
+ * Byte code whose behavior depends on its own layout is returned unchanged: code that doesn't
+ * decode into complete instructions, has constant jump targets off instruction boundaries, jumps to
+ * variable addresses, or loads the current address into a variable. Value tracking assumes that
+ * variables are only accessed by the program while it runs; it is skipped for programs that
+ * declare link variables or use I/O operators.
+ */
+class ProgramOptimizer {
+ public:
+  /**
+   * @brief The outcome of optimizing byte code
+   */
+  struct Result {
+    Program program;                       ///< The optimized program
+    std::map<size_t, size_t> address_map;  ///< The new address of every instruction that was
+                                           ///  kept, by its address in the original byte code
+  };
+
+  /**
+   * @fn ProgramOptimizer::optimize
+   * @brief Optimizes byte code
+   *
+   * @param code The byte code to optimize
+   * @return The optimized program and where the kept instructions moved to
+   */
+  [[nodiscard]] static Result optimize(ProgramView code);
+
+  /**
+   * @fn ProgramOptimizer::isRelocatable
+   * @brief Determines whether byte code behaves the same when its instructions are moved
+   *
+   * Byte code that isn't relocatable is returned unchanged by optimize().
+   *
+   * @param code The byte code to inspect
+   * @return `true` if the byte code can be optimized, `false` otherwise
+   */
+  [[nodiscard]] static bool isRelocatable(ProgramView code);
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_OPTIMIZER_HPP_
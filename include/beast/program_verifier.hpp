@@ -0,0 +1,55 @@
+#ifndef BEAST_PROGRAM_VERIFIER_HPP_
+#define BEAST_PROGRAM_VERIFIER_HPP_
+
+// Standard
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Internal
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramVerifier
+ * @brief Statically checks byte code so that it can be executed without per-fetch bounds checks
+ *
+ * The verifier walks byte code once, from its first to its last byte, and confirms that it splits
+ * into complete instructions with known operators, that every constant jump target lies on an
+ * instruction boundary (or at the end of the code), and that every variable index operand lies
+ * within the session's variable memory. A VmSession that holds verified byte code (see
+ * VmSession::verifyProgram()) fetches the operands of every instruction starting on a verified
+ * boundary without bounds checks. Instructions reached through jumps to variable addresses, whose
+ * targets can't be known statically, are only executed unchecked if they land on a boundary as
+ * well.
+ */
+class ProgramVerifier {
+ public:
+  /**
+   * @brief The outcome of verifying byte code
+   */
+  struct Result {
+    bool valid = false;                    ///< Whether the byte code passed all checks
+    size_t offset = 0;                     ///< The offset of the first offending instruction
+    std::string error;                     ///< Why the byte code failed verification
+    std::vector<bool> instruction_starts;  ///< Marks every offset an instruction starts at; empty
+                                           ///  if the byte code is not valid
+  };
+
+  /**
+   * @fn ProgramVerifier::verify
+   * @brief Verifies byte code for execution in a session with the given variable memory size
+   *
+   * Empty byte code is valid.
+   *
+   * @param code The byte code to verify
+   * @param variable_count The number of variables the executing session allows
+   * @return The verification result
+   */
+  [[nodiscard]] static Result verify(ProgramView code, size_t variable_count);
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_VERIFIER_HPP_
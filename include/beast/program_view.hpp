@@ -0,0 +1,157 @@
+#ifndef BEAST_PROGRAM_VIEW_HPP_
+#define BEAST_PROGRAM_VIEW_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Internal
+#include <beast/program.hpp>
+
+namespace beast {
+
+/**
+ * @class ProgramView
+ * @brief A read-only, non-owning view of program byte code
+ *
+ * A view refers to byte code that lives elsewhere, e.g. in a Program instance, a genome, or a
+ * memory-mapped ProgramCorpus file, and allows to execute it without copying its bytes (see
+ * VmSession). The viewed bytes must stay valid and unchanged for as long as the view, and anything
+ * created from it, is in use. Views are cheap to copy.
+ */
+class ProgramView {
+ public:
+  /**
+   * @fn ProgramView::ProgramView
+   * @brief Constructs a view of empty byte code
+   */
+  ProgramView() noexcept = default;
+
+  /**
+   * @fn ProgramView::ProgramView(const unsigned char*, size_t)
+   * @brief Constructs a view of a contiguous range of bytes
+   *
+   * @param data The first byte of the byte code
+   * @param size The number of bytes
+   */
+  explicit ProgramView(const unsigned char* data, size_t size) noexcept;
+
+  /**
+   * @fn ProgramView::ProgramView(const std::vector<unsigned char>&)
+   * @brief Constructs a view of the bytes held in a vector
+   *
+   * Like `std::string_view` for strings, this conversion is implicit, so that functions taking a
+   * view accept byte code held in vectors as well. The view is invalidated when the vector is
+   * modified or destroyed.
+   */
+  // NOLINTNEXTLINE
+  ProgramView(const std::vector<unsigned char>& data) noexcept;
+
+  /**
+   * @fn ProgramView::ProgramView(const Program&)
+   * @brief Constructs a view of a program's byte code
+   *
+   * The view is invalidated when the program is modified or destroyed.
+   */
+  explicit ProgramView(const Program& program) noexcept;
+
+  /**
+   * @fn ProgramView::getData
+   * @brief Returns the first byte of the viewed byte code
+   */
+  [[nodiscard]] const unsigned char* getData() const noexcept;
+
+  /**
+   * @fn ProgramView::getSize
+   * @brief Returns the size of the viewed byte code in bytes
+   */
+  [[nodiscard]] size_t getSize() const noexcept;
+
+  /**
+   * @fn ProgramView::empty
+   * @brief Returns whether the viewed byte code is empty
+   */
+  [[nodiscard]] bool empty() const noexcept;
+
+  /**
+   * @fn ProgramView::begin
+   * @brief Returns a pointer to the first byte, for use in range-based loops and algorithms
+   */
+  [[nodiscard]] const unsigned char* begin() const noexcept;
+
+  /**
+   * @fn ProgramView::end
+   * @brief Returns a pointer past the last byte
+   */
+  [[nodiscard]] const unsigned char* end() const noexcept;
+
+  /**
+   * @fn ProgramView::operator[]
+   * @brief Returns the byte at an offset without checking the offset
+   *
+   * @param offset The offset of the byte, which must be less than getSize()
+   */
+  [[nodiscard]] unsigned char operator[](size_t offset) const noexcept;
+
+  /**
+   * @fn ProgramView::getData4
+   * @brief Returns the 4 bytes starting at an offset
+   *
+   * Throws if the region does not lie within the byte code, just like Program::getData4().
+   *
+   * @param offset The starting point from where to return the data
+   * @return The 4 bytes starting at the offset
+   * @sa getData2(), getData1()
+   */
+  [[nodiscard]] int32_t getData4(int32_t offset) const;
+
+  /**
+   * @fn ProgramView::getData2
+   * @brief Returns the 2 bytes starting at an offset
+   *
+   * @param offset The starting point from where to return the data
+   * @return The 2 bytes starting at the offset
+   * @sa getData4(), getData1()
+   */
+  [[nodiscard]] int16_t getData2(int32_t offset) const;
+
+  /**
+   * @fn ProgramView::getData1
+   * @brief Returns the byte at an offset
+   *
+   * @param offset The offset of the byte to return
+   * @return The byte at the offset
+   * @sa getData4(), getData2()
+   */
+  [[nodiscard]] int8_t getData1(int32_t offset) const;
+
+  /**
+   * @fn ProgramView::toProgram
+   * @brief Copies the viewed byte code into a constant size Program instance
+   */
+  [[nodiscard]] Program toProgram() const;
+
+ private:
+  /**
+   * @fn ProgramView::checkRange
+   * @brief Throws if `size` bytes starting at `offset` do not lie within the byte code
+   */
+  void checkRange(int32_t offset, size_t size) const;
+
+  /**
+   * @var ProgramView::data_
+   * @brief The first byte of the viewed byte code
+   */
+  const unsigned char* data_ = nullptr;
+
+  /**
+   * @var ProgramView::size_
+   * @brief The size of the viewed byte code in bytes
+   */
+  size_t size_ = 0;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_PROGRAM_VIEW_HPP_
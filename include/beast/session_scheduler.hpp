@@ -0,0 +1,318 @@
+#ifndef BEAST_SESSION_SCHEDULER_HPP_
+#define BEAST_SESSION_SCHEDULER_HPP_
+
+// Standard
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Internal
+#include <beast/virtual_machine.hpp>
+#include <beast/vm_session.hpp>
+
+namespace beast {
+
+/**
+ * @class SessionScheduler
+ * @brief Multiplexes many long-lived VmSession instances over a small number of threads
+ *
+ * Sessions are executed cooperatively in time slices of at most `step_quantum` steps. Which session
+ * runs next is decided by stride scheduling: every session advances a virtual time ("pass") by an
+ * amount inversely proportional to its priority for each step it executes, and the runnable session
+ * with the lowest pass is run next. Over time, each session receives CPU time proportional to its
+ * priority, and no runnable session starves.
+ *
+ * Sessions that wait for input (their program checked an input variable and found nothing new, see
+ * VmSession::isWaitingForInput) are parked and don't consume any time slices until the host writes
+ * an input variable through setInput() or accessSession(). This replaces per-session polling loops
+ * around VirtualMachine::step for interactive programs.
+ *
+ * Sessions are owned by the scheduler while they are scheduled. The host interacts with them only
+ * through the scheduler, which makes sure that a session is never accessed while it is running.
+ */
+class SessionScheduler {
+ public:
+  /**
+   * @brief Identifies a session added to the scheduler
+   */
+  using SessionId = uint64_t;
+
+  /**
+   * @brief The scheduling state of a session
+   */
+  enum class SessionState {
+    Runnable = 0,         ///< The session waits for its next time slice
+    Running = 1,          ///< The session is currently being executed
+    WaitingForInput = 2,  ///< The session is parked until input is set
+    Finished = 3          ///< The session's program has ended
+  };
+
+  /**
+   * @fn SessionScheduler::SessionScheduler
+   * @brief Constructs the scheduler and starts its worker threads
+   *
+   * With a `thread_count` of `0`, no threads are started and sessions only advance when the host
+   * calls runQuantum().
+   *
+   * @param virtual_machine The virtual machine used to step all sessions
+   * @param thread_count The number of worker threads executing sessions
+   * @param step_quantum The maximum number of steps a session may execute per time slice
+   */
+  explicit SessionScheduler(
+      VirtualMachine& virtual_machine, uint32_t thread_count = 1, uint32_t step_quantum = 100);
+
+  SessionScheduler(const SessionScheduler&) = delete;
+  SessionScheduler& operator=(const SessionScheduler&) = delete;
+
+  /**
+   * @fn SessionScheduler::~SessionScheduler
+   * @brief Stops all worker threads
+   *
+   * Sessions that are currently running finish their time slice first.
+   */
+  ~SessionScheduler();
+
+  /**
+   * @fn SessionScheduler::addSession
+   * @brief Hands a session over to the scheduler
+   *
+   * Throws if `priority` is `0`.
+   *
+   * @param session The session to schedule
+   * @param priority The relative share of execution time this session receives
+   * @return The identifier to refer to the session with
+   */
+  SessionId addSession(VmSession session, uint32_t priority = 1);
+
+  /**
+   * @fn SessionScheduler::removeSession
+   * @brief Takes a session out of the scheduler
+   *
+   * If the session is currently running or accessed, this call blocks until its time slice or the
+   * access ended. Throws if the session is unknown. Later accesses to the removed session throw as
+   * well.
+   *
+   * @param session_id The session to remove
+   * @return The removed session in its current state
+   */
+  VmSession removeSession(SessionId session_id);
+
+  /**
+   * @fn SessionScheduler::setPriority
+   * @brief Changes the relative share of execution time a session receives
+   *
+   * Throws if the session is unknown or `priority` is `0`.
+   *
+   * @param session_id The session to change the priority of
+   * @param priority The new priority
+   */
+  void setPriority(SessionId session_id, uint32_t priority);
+
+  /**
+   * @fn SessionScheduler::setInput
+   * @brief Writes a value to an input variable of a session and wakes it up if it was parked
+   *
+   * Blocks while the session is running. Throws if the session is unknown.
+   *
+   * @param session_id The session to write the input to
+   * @param variable_index The input variable to write, resolving its links
+   * @param value The value to write
+   */
+  void setInput(SessionId session_id, int32_t variable_index, int32_t value);
+
+  /**
+   * @fn SessionScheduler::accessSession
+   * @brief Grants exclusive access to a session
+   *
+   * The accessor is called while the session is guaranteed not to run; this is the way to read
+   * outputs and print buffers of scheduled sessions. A parked session that got input set by the
+   * accessor is woken up afterwards. Throws if the session is unknown.
+   *
+   * @param session_id The session to access
+   * @param accessor The function called with the session
+   */
+  void accessSession(SessionId session_id, const std::function<void(VmSession&)>& accessor);
+
+  /**
+   * @fn SessionScheduler::getState
+   * @brief Returns the scheduling state of a session
+   *
+   * Throws if the session is unknown.
+   *
+   * @param session_id The session to return the state of
+   */
+  [[nodiscard]] SessionState getState(SessionId session_id) const;
+
+  /**
+   * @fn SessionScheduler::getSessionCount
+   * @brief Returns the number of sessions owned by the scheduler, including finished ones
+   */
+  [[nodiscard]] size_t getSessionCount() const;
+
+  /**
+   * @fn SessionScheduler::runQuantum
+   * @brief Runs a single time slice of the next session in the calling thread
+   *
+   * Mostly useful with schedulers that were constructed without worker threads.
+   *
+   * @return `true` if a session was run, `false` if no session was runnable
+   */
+  bool runQuantum();
+
+  /**
+   * @fn SessionScheduler::waitUntilIdle
+   * @brief Blocks until no session is runnable or running anymore
+   *
+   * All sessions are then either parked or finished. Must not be used with schedulers without
+   * worker threads.
+   */
+  void waitUntilIdle();
+
+ private:
+  /**
+   * @brief Book keeping for a single scheduled session
+   */
+  struct Entry {
+    explicit Entry(VmSession&& vm_session) : session{std::move(vm_session)} {}
+
+    VmSession session;                            ///< The scheduled session
+    std::mutex mutex;                             ///< Held while the session runs or is accessed
+    uint64_t stride = 0;                          ///< Pass increment per full time slice
+    uint64_t pass = 0;                            ///< The session's virtual time
+    SessionState state = SessionState::Runnable;  ///< The current scheduling state
+    std::atomic<bool> removed{false};             ///< Set once removeSession() took the entry
+  };
+
+  /**
+   * @fn SessionScheduler::getEntry
+   * @brief Returns the book keeping entry for a session, throwing if it is unknown
+   *
+   * Requires `mutex_` to be held. Callers that use the entry after releasing `mutex_` keep a copy
+   * of the pointer, so that a concurrent removeSession() can't free it.
+   */
+  [[nodiscard]] const std::shared_ptr<Entry>& getEntry(SessionId session_id) const;
+
+  /**
+   * @fn SessionScheduler::dispatchNext
+   * @brief Takes the session with the lowest pass from the run queue and marks it as running
+   *
+   * Requires `mutex_` to be held and the run queue to be non-empty.
+   */
+  [[nodiscard]] std::pair<SessionId, std::shared_ptr<Entry>> dispatchNext();
+
+  /**
+   * @fn SessionScheduler::makeRunnable
+   * @brief Puts a session into the run queue
+   *
+   * Sessions rejoining the queue start at the current global pass so that time spent parked does
+   * not turn into a burst of execution later. Requires `mutex_` to be held.
+   */
+  void makeRunnable(SessionId session_id, Entry& entry);
+
+  /**
+   * @fn SessionScheduler::wakeIfInputArrived
+   * @brief Moves a parked session back to the run queue if it is not waiting anymore
+   *
+   * Requires the session's mutex to be held. Sessions that were removed in the meantime stay out
+   * of the run queue.
+   */
+  void wakeIfInputArrived(SessionId session_id, Entry& entry);
+
+  /**
+   * @fn SessionScheduler::executeQuantum
+   * @brief Executes one time slice of a session that was taken from the run queue
+   */
+  void executeQuantum(SessionId session_id, Entry& entry);
+
+  /**
+   * @fn SessionScheduler::workerLoop
+   * @brief Main loop of the worker threads
+   */
+  void workerLoop();
+
+  /**
+   * @var SessionScheduler::virtual_machine_
+   * @brief The virtual machine used to step all sessions
+   */
+  VirtualMachine& virtual_machine_;
+
+  /**
+   * @var SessionScheduler::step_quantum_
+   * @brief The maximum number of steps per time slice
+   */
+  uint32_t step_quantum_;
+
+  /**
+   * @var SessionScheduler::mutex_
+   * @brief Guards all scheduling state below
+   *
+   * When a session's mutex is held as well, it must be acquired before this one.
+   */
+  mutable std::mutex mutex_;
+
+  /**
+   * @var SessionScheduler::queue_changed_
+   * @brief Signalled when a session became runnable or the scheduler is stopping
+   */
+  std::condition_variable queue_changed_;
+
+  /**
+   * @var SessionScheduler::session_released_
+   * @brief Signalled when a session ended its time slice
+   */
+  std::condition_variable session_released_;
+
+  /**
+   * @var SessionScheduler::sessions_
+   * @brief All sessions owned by the scheduler
+   */
+  std::map<SessionId, std::shared_ptr<Entry>> sessions_;
+
+  /**
+   * @var SessionScheduler::run_queue_
+   * @brief The runnable sessions, ordered by their pass value
+   */
+  std::set<std::pair<uint64_t, SessionId>> run_queue_;
+
+  /**
+   * @var SessionScheduler::global_pass_
+   * @brief The pass value of the most recently dispatched session
+   */
+  uint64_t global_pass_ = 0;
+
+  /**
+   * @var SessionScheduler::next_session_id_
+   * @brief The identifier assigned to the next added session
+   */
+  SessionId next_session_id_ = 0;
+
+  /**
+   * @var SessionScheduler::running_count_
+   * @brief The number of sessions currently being executed
+   */
+  uint32_t running_count_ = 0;
+
+  /**
+   * @var SessionScheduler::stopping_
+   * @brief Set when the worker threads are supposed to exit
+   */
+  bool stopping_ = false;
+
+  /**
+   * @var SessionScheduler::threads_
+   * @brief The worker threads
+   */
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_SESSION_SCHEDULER_HPP_
@@ -0,0 +1,141 @@
+#ifndef BEAST_SURROGATE_MODEL_HPP_
+#define BEAST_SURROGATE_MODEL_HPP_
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Internal
+#include <beast/program_view.hpp>
+
+namespace beast {
+
+/**
+ * @class SurrogateModel
+ * @brief A cheap linear model predicting a program's score from static features of its byte code
+ *
+ * Evaluating a candidate usually means running it in a virtual machine, often against many fitness
+ * cases. Most candidates of an evolution turn out to be losers, and a surrogate that predicts their
+ * scores from the byte code alone allows to skip evaluating the likely ones (see
+ * Pipe::setSurrogateModel()).
+ *
+ * The features of a program (see extractFeatures()) are its size, the fraction of its code that is
+ * reachable from the entry point, and the share of each operator among its decoded instructions.
+ * The model is trained online from the scores of actually evaluated programs, using the normalized
+ * least mean squares rule: every sample moves the weights towards reducing that sample's prediction
+ * error by a fixed fraction, regardless of the feature vector's magnitude. This keeps training
+ * stable without tuning, and lets the model follow a population whose programs drift over time.
+ *
+ * The model is thread-safe, so it can be shared between pipes evaluating for the same task.
+ */
+class SurrogateModel {
+ public:
+  /**
+   * @fn SurrogateModel::SurrogateModel
+   * @brief Constructs an untrained model predicting 0.0 for all programs
+   *
+   * Throws if the learning rate is not within (0.0, 2.0), where the training rule converges.
+   *
+   * @param learning_rate The fraction of a sample's prediction error each training step corrects
+   */
+  explicit SurrogateModel(double learning_rate = 0.1);
+
+  /**
+   * @fn SurrogateModel::extractFeatures
+   * @brief Returns the static features of a program's byte code
+   *
+   * The features are a constant bias of 1.0, the logarithm of the code size, the fraction of bytes
+   * that belong to instructions reachable from the first one, and the share of each operator among
+   * the decoded instructions. Decoding stops at the first byte that is not a complete, known
+   * instruction. Code reachable through jumps to variable addresses can't be determined statically,
+   * so all code counts as reachable once such a jump is reachable.
+   *
+   * @param program The program's byte code
+   * @return The feature vector, with getFeatureCount() values
+   */
+  [[nodiscard]] static std::vector<double> extractFeatures(ProgramView program);
+
+  /**
+   * @fn SurrogateModel::getFeatureCount
+   * @brief Returns the number of features extracted from each program
+   */
+  [[nodiscard]] static size_t getFeatureCount() noexcept;
+
+  /**
+   * @fn SurrogateModel::predict
+   * @brief Returns the predicted score of a program with the given features
+   *
+   * Throws if the number of features is wrong.
+   */
+  [[nodiscard]] double predict(const std::vector<double>& features) const;
+
+  /**
+   * @fn SurrogateModel::train
+   * @brief Adjusts the model towards a program's actual score
+   *
+   * Throws if the number of features is wrong.
+   *
+   * @param features The features of the evaluated program
+   * @param score The score the program actually achieved
+   */
+  void train(const std::vector<double>& features, double score);
+
+  /**
+   * @fn SurrogateModel::getSampleCount
+   * @brief Returns the number of samples the model was trained with
+   */
+  [[nodiscard]] uint64_t getSampleCount() const;
+
+  /**
+   * @fn SurrogateModel::getMeanAbsoluteError
+   * @brief Returns the exponentially weighted mean of the absolute prediction errors in training
+   *
+   * Each error is measured before the model is adjusted to the sample, so this estimates how far
+   * off predictions for unseen programs are. The weight of each new error is 1/64, or 1/n for the
+   * first n < 64 samples.
+   */
+  [[nodiscard]] double getMeanAbsoluteError() const;
+
+ private:
+  /**
+   * @fn SurrogateModel::predictUnlocked
+   * @brief Returns the weighted sum of the features; the caller must hold the mutex
+   */
+  [[nodiscard]] double predictUnlocked(const std::vector<double>& features) const;
+
+  /**
+   * @var SurrogateModel::learning_rate_
+   * @brief The fraction of a sample's prediction error each training step corrects
+   */
+  double learning_rate_;
+
+  /**
+   * @var SurrogateModel::weights_
+   * @brief The weight of each feature
+   */
+  std::vector<double> weights_;
+
+  /**
+   * @var SurrogateModel::sample_count_
+   * @brief The number of samples the model was trained with
+   */
+  uint64_t sample_count_ = 0;
+
+  /**
+   * @var SurrogateModel::mean_absolute_error_
+   * @brief The running mean of the absolute prediction errors
+   */
+  double mean_absolute_error_ = 0.0;
+
+  /**
+   * @var SurrogateModel::mutex_
+   * @brief Guards the weights and statistics
+   */
+  mutable std::mutex mutex_;
+};
+
+}  // namespace beast
+
+#endif  // BEAST_SURROGATE_MODEL_HPP_
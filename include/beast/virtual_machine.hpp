@@ -1,11 +1,18 @@
 #ifndef BEAST_VIRTUAL_MACHINE_HPP_
 #define BEAST_VIRTUAL_MACHINE_HPP_
 
+// Standard
+#include <atomic>
+#include <memory>
+#include <string>
+
 // Internal
 #include <beast/vm_session.hpp>
 
 namespace beast {
 
+class MessageSink;
+
 /**
  * @class VirtualMachine
  * @brief A base class for virtual machine types to execute BEAST code.
@@ -13,6 +20,10 @@ namespace beast {
  * This base class provides messaging functionalities and a base function signature to allow
  * integrating different types of virtual machines that are executing BEAST instructions.
  *
+ * All state of a running program lives in its VmSession. Virtual machines therefore are reentrant:
+ * one instance may step different sessions on different threads at the same time, as long as each
+ * session is only stepped by one thread at a time. Implementations must uphold this guarantee.
+ *
  * @author Jan Winkler
  * @date 2022-12-19
  */
@@ -58,6 +69,25 @@ class VirtualMachine {
    */
   void setMinimumMessageSeverity(MessageSeverity minimum_severity) noexcept;
 
+  /**
+   * @fn VirtualMachine::setMessageSink
+   * @brief Routes all displayed messages to the given sink instead of the built-in output
+   *
+   * Sinks allow to redirect messages (e.g., into a log file) and, using an AsyncMessageSink, to keep
+   * threads stepping sessions in parallel from serializing on the output stream. Passing `nullptr`
+   * restores the built-in output of the virtual machine implementation. The sink must not be changed
+   * while sessions are being stepped.
+   *
+   * @param sink The sink to write messages to
+   */
+  void setMessageSink(std::shared_ptr<MessageSink> sink) noexcept;
+
+  /**
+   * @fn VirtualMachine::getMessageSink
+   * @brief Returns the sink messages are written to, or `nullptr` for the built-in output
+   */
+  [[nodiscard]] const std::shared_ptr<MessageSink>& getMessageSink() const noexcept;
+
   /**
    * @fn VirtualMachine::step
    * @brief Executes the next step a program in its current state as denoted by a VM session.
@@ -70,13 +100,39 @@ class VirtualMachine {
    * in a program and not actually execute them. This can be used to count the effective amount and
    * individual types of operators in a program, as well as analyze its structure.
    *
+   * Before executing an operator, implementations are supposed to call
+   * VmSession::checkExecutionLimits and stop if it returns `false`.
+   *
    * @param session The VmSession instance that holds the program and state to step through.
    * @param dry_run Determines whether operators are executed or just read.
    * @return A boolean flag denoting whether the session can further execute instructions.
    */
   [[nodiscard]] virtual bool step(VmSession& session, bool dry_run) = 0;
 
-  void setSilent(bool silent);
+  /**
+   * @fn VirtualMachine::stepBlock
+   * @brief Executes the next basic block of a program, or at least its next step
+   *
+   * Implementations may execute all instructions of the basic block that starts at the current
+   * instruction at once (see VmSession::beginBasicBlock), which saves the per-step bookkeeping. The
+   * resulting program state and runtime statistics must be the same as if the block's instructions
+   * were executed by individual step() calls. Blocks end after every instruction that may end
+   * execution or make the session wait for input, so callers can check for these conditions after
+   * each call just like after each step. The default implementation executes a single step.
+   *
+   * @param session The VmSession instance that holds the program and state to step through.
+   * @param dry_run Determines whether operators are executed or just read.
+   * @return A boolean flag denoting whether the session can further execute instructions.
+   */
+  [[nodiscard]] virtual bool stepBlock(VmSession& session, bool dry_run);
+
+  /**
+   * @fn VirtualMachine::setSilent
+   * @brief Suppresses all messages regardless of their severity
+   *
+   * @param silent Whether to suppress messages
+   */
+  void setSilent(bool silent) noexcept;
 
  protected:
   /**
@@ -127,6 +183,12 @@ class VirtualMachine {
    */
   [[nodiscard]] bool shouldDisplayMessageWithSeverity(MessageSeverity severity) const noexcept;
 
+  /**
+   * @fn VirtualMachine::emitMessage
+   * @brief Passes a message on to the message sink or, if there is none, to message()
+   */
+  void emitMessage(MessageSeverity severity, const std::string& message) noexcept;
+
   /**
    * @var VirtualMachine::minimum_severity_
    * @brief The minimum message severity to print
@@ -134,9 +196,19 @@ class VirtualMachine {
    * Only messages that are equal or above this severity are actually printed. All other messages
    * are silently dropped.
    */
-  MessageSeverity minimum_severity_ = MessageSeverity::Info;
+  std::atomic<MessageSeverity> minimum_severity_{MessageSeverity::Info};
 
-  bool silent_ = false;
+  /**
+   * @var VirtualMachine::silent_
+   * @brief Whether all messages are suppressed
+   */
+  std::atomic<bool> silent_{false};
+
+  /**
+   * @var VirtualMachine::message_sink_
+   * @brief The sink messages are written to, or `nullptr` for the built-in output
+   */
+  std::shared_ptr<MessageSink> message_sink_;
 };
 
 }  // namespace beast
@@ -2,12 +2,24 @@
 #define BEAST_VM_SESSION_HPP_
 
 // Standard
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <optional>
+#include <random>
 #include <set>
+#include <utility>
+#include <vector>
 
 // Internal
+#include <beast/cancellation_token.hpp>
+#include <beast/compact_encoding.hpp>
+#include <beast/instruction_decoder.hpp>
 #include <beast/program.hpp>
+#include <beast/program_verifier.hpp>
+#include <beast/program_view.hpp>
 
 namespace beast {
 
@@ -68,7 +80,8 @@ class VmSession {
    * session of any operators that were executed. The usage count for each operator is recorded in
    * the session, alongside the overall number of steps executed, whether the program has
    * terminated, whether the termination was abnormal (an exception throw), and what the program's
-   * return code was.
+   * return code was. If execution was stopped because an execution limit was exceeded or the
+   * session was cancelled, the respective flag is set.
    *
    * @sa getRuntimeStatistics(), informAboutStep(), resetRuntimeStatistics()
    */
@@ -79,6 +92,44 @@ class VmSession {
     int8_t return_code;                              ///< The program's return code
     std::map<OpCode, uint32_t> operator_executions;  ///< How often which operator was executed
     std::set<uint32_t> executed_indices;             ///< Which operator indices were executed
+    bool step_limit_exceeded;                        ///< Whether the step limit stopped execution
+    bool time_limit_exceeded;                        ///< Whether the time limit stopped execution
+    bool print_limit_exceeded;                       ///< Whether the print limit stopped execution
+    bool cancelled;                                  ///< Whether execution was cancelled
+  };
+
+  /**
+   * @brief Bounds the execution of a program
+   *
+   * Execution stops before the next step once any of these limits is exceeded. A value of zero
+   * disables the respective limit. The wall time is measured from the first executed step after the
+   * runtime statistics were last reset.
+   *
+   * @sa setExecutionLimits(), RuntimeStatistics
+   */
+  struct ExecutionLimits {
+    uint32_t max_steps = 0;                      ///< The maximum number of steps to execute
+    std::chrono::milliseconds max_wall_time{0};  ///< The maximum wall clock time to execute for
+    size_t max_print_output = 0;                 ///< The maximum number of characters to print
+  };
+
+  /**
+   * @brief The precomputed runtime statistics contribution of a basic block
+   *
+   * Execution blocks are the basic blocks of the program's control flow graph (see
+   * ControlFlowGraph), additionally split after every operator that may stop execution or make the
+   * session wait for input. Only the last instruction of a block may jump, terminate, exceed the
+   * print limit, or wait for input.
+   *
+   * @sa beginBasicBlock(), endBasicBlock()
+   */
+  struct BasicBlockSummary {
+    size_t index = 0;                ///< The block's index in the session's block table
+    size_t begin = 0;                ///< The offset of the block's first instruction
+    uint32_t instruction_count = 0;  ///< The number of instructions in the block
+    std::vector<std::pair<OpCode, uint32_t>> operator_counts;  ///< How often each operator occurs
+    std::vector<OpCode> operators;           ///< The operator of each instruction, in order
+    std::vector<uint32_t> executed_indices;  ///< The executed index of each instruction, in order
   };
 
   /**
@@ -94,10 +145,39 @@ class VmSession {
    * @param variable_count The maximum number of variables
    * @param string_table_count The maximum number of string table items
    * @param max_string_size The maximum length per string table item
+   * @param encoding The encoding of the program's byte code
    */
   VmSession(
       Program program, size_t variable_count, size_t string_table_count,
-      size_t max_string_size);
+      size_t max_string_size, ProgramEncoding encoding = ProgramEncoding::Standard);
+
+  /**
+   * @fn VmSession::VmSession(ProgramView, size_t, size_t, size_t)
+   * @brief Constructs a session executing byte code in place
+   *
+   * Unlike the Program based constructor, the session doesn't hold a copy of the byte code, so
+   * constructing it allocates nothing for the program. Byte code held in a vector (e.g. the genome
+   * passed to Pipe::evaluate()) converts to a view implicitly. The viewed bytes (e.g. a record of a
+   * MappedProgramCorpus) must stay valid and unchanged for as long as the session and its copies
+   * exist.
+   *
+   * @param program The byte code to execute
+   * @param variable_count The maximum number of variables
+   * @param string_table_count The maximum number of string table items
+   * @param max_string_size The maximum length per string table item
+   * @param encoding The encoding of the byte code
+   */
+  VmSession(
+      ProgramView program, size_t variable_count, size_t string_table_count,
+      size_t max_string_size, ProgramEncoding encoding = ProgramEncoding::Standard);
+
+  /**
+   * @fn VmSession::VmSession(std::vector<unsigned char>&&, size_t, size_t, size_t, ProgramEncoding)
+   * @brief Rejects temporary byte code, which a view based session would outlive
+   */
+  VmSession(
+      std::vector<unsigned char>&& program, size_t variable_count, size_t string_table_count,
+      size_t max_string_size, ProgramEncoding encoding = ProgramEncoding::Standard) = delete;
 
   /**
    * @fn VmSession::informAboutStep
@@ -132,6 +212,39 @@ class VmSession {
    */
   [[nodiscard]] const RuntimeStatistics& getRuntimeStatistics() const noexcept;
 
+  /**
+   * @fn VmSession::getProgram
+   * @brief Returns the program associated with this session
+   *
+   * Throws if the session was constructed from a ProgramView, as it then holds no Program.
+   *
+   * @return A constant reference to the program
+   * @sa getProgramView()
+   */
+  [[nodiscard]] const Program& getProgram() const;
+
+  /**
+   * @fn VmSession::getProgramView
+   * @brief Returns a view of the byte code this session executes
+   *
+   * Works for sessions constructed from a Program as well as from a ProgramView.
+   */
+  [[nodiscard]] ProgramView getProgramView() const noexcept;
+
+  /**
+   * @fn VmSession::getProgramEncoding
+   * @brief Returns the encoding of the byte code this session executes
+   */
+  [[nodiscard]] ProgramEncoding getProgramEncoding() const noexcept;
+
+  /**
+   * @fn VmSession::getPointer
+   * @brief Returns the current instruction pointer
+   *
+   * @return The byte offset of the next instruction to execute
+   */
+  [[nodiscard]] int32_t getPointer() const noexcept;
+
   /**
    * @fn VmSession::setVariableBehavior
    * @brief Sets the I/O behavior for a variable
@@ -193,10 +306,108 @@ class VmSession {
    */
   void setMaximumPrintBufferLength(size_t maximum_print_buffer_length);
 
+  /**
+   * @fn VmSession::setExecutionLimits
+   * @brief Sets the limits that bound the execution of the program
+   *
+   * The limits are enforced by the virtual machine before each step (see
+   * checkExecutionLimits()). Exceeding a limit stops execution as if the program ended, and is
+   * reported in the runtime statistics.
+   *
+   * @param limits The execution limits to apply
+   */
+  void setExecutionLimits(const ExecutionLimits& limits) noexcept;
+
+  /**
+   * @fn VmSession::getExecutionLimits
+   * @brief Returns the limits that bound the execution of the program
+   */
+  [[nodiscard]] const ExecutionLimits& getExecutionLimits() const noexcept;
+
+  /**
+   * @fn VmSession::setCancellationToken
+   * @brief Attaches a token that allows to cancel execution from another thread
+   *
+   * Copies of this session share the token. Passing `nullptr` detaches the current token.
+   *
+   * @param token The token to attach
+   */
+  void setCancellationToken(std::shared_ptr<const CancellationToken> token) noexcept;
+
+  /**
+   * @fn VmSession::setRandomSeed
+   * @brief Makes random values drawn by the program reproducible
+   *
+   * By default, every random value loaded by the program comes from a fresh `std::random_device`.
+   * Once a seed is set, random values are drawn from a pseudo random number generator seeded with
+   * it instead, so that running the same program twice yields the same values. The generator is
+   * reseeded on reset(), and copies of this session continue the sequence independently.
+   *
+   * @param seed The seed of the session's random number generator
+   */
+  void setRandomSeed(uint32_t seed) noexcept;
+
+  /**
+   * @fn VmSession::getRandomSeed
+   * @brief Returns the seed set for the session's random values, if any
+   */
+  [[nodiscard]] std::optional<uint32_t> getRandomSeed() const noexcept;
+
+  /**
+   * @fn VmSession::checkExecutionLimits
+   * @brief Checks whether the program may execute another step
+   *
+   * Virtual machines call this before each step. If a limit was exceeded or the session was
+   * cancelled, the respective runtime statistics flag is set and `false` is returned. To keep the
+   * per-step cost low, the wall clock is only consulted every few steps.
+   *
+   * @return `true` if another step may be executed, `false` otherwise
+   */
+  [[nodiscard]] bool checkExecutionLimits() noexcept;
+
+  /**
+   * @fn VmSession::prepareBasicBlocks
+   * @brief Splits the program into execution blocks, unless already done
+   *
+   * Copies of the session share the blocks, so preparing them before copying a session saves each
+   * copy from splitting the program again.
+   *
+   * @sa BasicBlockSummary
+   */
+  void prepareBasicBlocks();
+
+  /**
+   * @fn VmSession::beginBasicBlock
+   * @brief Returns the block starting at the instruction pointer, if it may be executed at once
+   *
+   * Virtual machines call this instead of checkExecutionLimits() before executing the instructions
+   * of a whole block without informing the session about every step. A block may be executed at
+   * once if the execution limits permit all of its steps. If no block is returned, the next
+   * instruction is to be executed as a regular step. Prepares the blocks if necessary.
+   *
+   * @return The block to execute, or `nullptr`
+   */
+  [[nodiscard]] const BasicBlockSummary* beginBasicBlock();
+
+  /**
+   * @fn VmSession::endBasicBlock
+   * @brief Records the steps of a block executed after beginBasicBlock() in the runtime statistics
+   *
+   * The runtime statistics end up as if informAboutStep() was called for each executed
+   * instruction. If the block's instructions were all executed, its summary is added in one go.
+   *
+   * @param block The executed block
+   * @param executed_count The number of instructions executed from the start of the block
+   */
+  void endBasicBlock(const BasicBlockSummary& block, size_t executed_count) noexcept;
+
   /**
    * @fn VmSession::getData4
    * @brief Return the next 4 bytes of program byte code
    *
+   * For compact byte code, this decodes the current instruction's next four byte operand instead.
+   * getData2() and getData1() likewise decode string lengths, flags, and one byte operands.
+   *
    * @return The next 4 bytes of program byte code
    */
   [[nodiscard]] int32_t getData4();
@@ -217,6 +428,67 @@ class VmSession {
    */
   [[nodiscard]] int8_t getData1();
 
+  /**
+   * @fn VmSession::verifyProgram
+   * @brief Verifies the session's program, enabling unchecked operand fetches if it is valid
+   *
+   * Once the program passed verification (see ProgramVerifier), every instruction that starts on a
+   * verified instruction boundary fetches its operator and operands without bounds checks. Since
+   * the program can't change, the verification holds for the lifetime of the session and of its
+   * copies. Programs that fail verification keep executing with all checks in place. Compact byte
+   * code is verified in its standard encoding; the result refers to the compact offsets.
+   *
+   * @return The verification result
+   */
+  ProgramVerifier::Result verifyProgram();
+
+  /**
+   * @fn VmSession::isProgramVerified
+   * @brief Returns whether the session's program passed verification
+   *
+   * @sa verifyProgram()
+   */
+  [[nodiscard]] bool isProgramVerified() const noexcept;
+
+  /**
+   * @fn VmSession::beginInstruction
+   * @brief Returns the operator of the next instruction and prepares fetching its operands
+   *
+   * Virtual machines call this instead of getData1() to fetch the operator at the start of each
+   * step. If the program was verified and the instruction pointer is on a verified instruction
+   * boundary, the operator and the subsequent getData4(), getData2(), and getData1() calls of this
+   * step skip their bounds checks. Otherwise, all fetches remain checked.
+   *
+   * If the decode cache is enabled and the instruction pointer is on the start of a cached
+   * instruction, the operator and operands are replayed from the cache instead of parsing the byte
+   * code again. Instructions with string operands are never cached, and neither are offsets in the
+   * middle of other instructions, e.g. reached through jumps to variable addresses.
+   *
+   * @return The operator byte of the next instruction
+   */
+  [[nodiscard]] int8_t beginInstruction();
+
+  /**
+   * @fn VmSession::setDecodeCacheEnabled
+   * @brief Sets whether instructions are replayed from the decode cache (default: disabled)
+   *
+   * Enabling the cache decodes every instruction of the program once. Copies of the session made
+   * afterwards share the cache, as the program never changes.
+   *
+   * @param enabled Whether beginInstruction() consults the decode cache
+   *
+   * @sa beginInstruction()
+   */
+  void setDecodeCacheEnabled(bool enabled);
+
+  /**
+   * @fn VmSession::getDecodedInstructionCount
+   * @brief Returns the number of instructions held by the decode cache
+   *
+   * @return The number of instructions replayed from the cache, or 0 if it is disabled
+   */
+  [[nodiscard]] size_t getDecodedInstructionCount() const noexcept;
+
   /**
    * @fn VmSession::getVariableValue
    * @brief Returns the stored value of a variable
@@ -248,7 +520,8 @@ class VmSession {
    * @brief Checks whether the associated program is at the end of its executable code
    *
    * Effectively, this function returns whether the instruction pointer points beyond the end of the
-   * code.
+   * code. A program that was stopped due to an exceeded execution limit or a cancellation is at its
+   * end as well.
    *
    * @return Boolean flag denoting whether the program execution is at its end
    */
@@ -260,6 +533,18 @@ class VmSession {
    */
   void setExitedAbnormally();
 
+  /**
+   * @fn VmSession::isWaitingForInput
+   * @brief Denotes whether the program is waiting for input from outside
+   *
+   * A program is considered waiting when its most recent checkIfInputWasSet call found no new
+   * input. The state is cleared as soon as an input variable is set from outside of the program
+   * via setVariableValue. Schedulers use this to park sessions that would otherwise busy-poll.
+   *
+   * @return Boolean flag denoting whether the program is waiting for input
+   */
+  [[nodiscard]] bool isWaitingForInput() const noexcept;
+
   /**
    * @fn VmSession::registerVariable
    * @brief Registers a variable at index and type in the variable memory
@@ -737,7 +1022,8 @@ class VmSession {
    * See Program::checkIfInputWasSet for the intended operator use.
    *
    * If the target variable is not declared as an input variable this call will
-   * throw an exception.
+   * throw an exception. If no new input was set, the session is marked as waiting for input (see
+   * isWaitingForInput()).
    *
    * @param variable_index The index of the input variable to check
    * @param follow_links Whether to resolve the variable's links
@@ -1486,11 +1772,107 @@ class VmSession {
    */
   void setVariableValueInternal(int32_t variable_index, bool follow_links, int32_t value);
 
+  /**
+   * @fn VmSession::verifyCompactProgram
+   * @brief Verifies the session's compact byte code in its standard encoding
+   *
+   * @return The verification result, referring to compact offsets
+   */
+  ProgramVerifier::Result verifyCompactProgram();
+
+  /**
+   * @fn VmSession::fetchByte
+   * @brief Returns the next byte of program byte code
+   *
+   * @return The next byte
+   */
+  unsigned char fetchByte();
+
+  /**
+   * @fn VmSession::fetchVarint
+   * @brief Returns the next LEB128 varint of compact byte code
+   *
+   * @return The decoded value
+   */
+  uint32_t fetchVarint();
+
+  /**
+   * @fn VmSession::beginCompactInstruction
+   * @brief Fetches the operator and flags of the next compact instruction
+   *
+   * @return The operator byte, or the raw byte if it doesn't start a known compact instruction
+   */
+  int8_t beginCompactInstruction();
+
+  /**
+   * @fn VmSession::nextCompactOperand
+   * @brief Returns the type of the current compact instruction's next operand
+   *
+   * Throws if the instruction has no operands left.
+   *
+   * @return The operand's type
+   */
+  InstructionDecoder::OperandType nextCompactOperand();
+
+  /**
+   * @fn VmSession::replayOperand
+   * @brief Returns the next operand of the cached instruction being replayed
+   *
+   * Moves the instruction pointer past the instruction after its last operand.
+   *
+   * @return The operand's value
+   */
+  int32_t replayOperand() noexcept;
+
   /**
    * @var VmSession::program_
-   * @brief The program to execute
+   * @brief The program to execute, unless the session executes a ProgramView
+   *
+   * Shared between copies of the session, as the program never changes.
+   */
+  std::shared_ptr<const Program> program_;
+
+  /**
+   * @var VmSession::code_
+   * @brief The byte code to execute, either held by `program_` or viewed in place
    */
-  Program program_;
+  ProgramView code_;
+
+  /**
+   * @var VmSession::encoding_
+   * @brief The encoding of the byte code to execute
+   */
+  ProgramEncoding encoding_;
+
+  /**
+   * @var VmSession::compact_operands_
+   * @brief The operand types of the current compact instruction, if its operator is known
+   */
+  const std::vector<InstructionDecoder::OperandType>* compact_operands_ = nullptr;
+
+  /**
+   * @var VmSession::compact_operand_
+   * @brief The index of the current compact instruction's next operand
+   */
+  size_t compact_operand_ = 0;
+
+  /**
+   * @var VmSession::compact_flags_
+   * @brief The packed flags of the current compact instruction
+   */
+  unsigned char compact_flags_ = 0;
+
+  /**
+   * @var VmSession::compact_flag_
+   * @brief The index of the current compact instruction's next flag
+   */
+  size_t compact_flag_ = 0;
+
+  /**
+   * @var VmSession::compact_string_bytes_
+   * @brief The number of characters of the current compact string operand left to fetch
+   */
+  size_t compact_string_bytes_ = 0;
 
   /**
    * @var VmSession::pointer_
@@ -1500,6 +1882,100 @@ class VmSession {
    */
   int32_t pointer_ = 0;
 
+  /**
+   * @var VmSession::instruction_starts_
+   * @brief Marks the offsets instructions of the verified program start at, if it was verified
+   *
+   * Shared between copies of the session, as the program never changes.
+   */
+  std::shared_ptr<const std::vector<bool>> instruction_starts_;
+
+  /**
+   * @brief The execution blocks of a program, and where they start
+   */
+  struct BasicBlockTable {
+    std::vector<BasicBlockSummary> blocks;  ///< The blocks in ascending offset order
+    std::vector<size_t> block_at;           ///< One more than the index of the block starting at
+                                            ///  each offset, or 0 if no block starts there
+  };
+
+  /**
+   * @var VmSession::basic_blocks_
+   * @brief The program's execution blocks, once prepared
+   *
+   * Shared between copies of the session, as the program never changes.
+   */
+  std::shared_ptr<const BasicBlockTable> basic_blocks_;
+
+  /**
+   * @var VmSession::covered_blocks_
+   * @brief Whether the executed indices of each block were added to the runtime statistics
+   */
+  std::vector<bool> covered_blocks_;
+
+  /**
+   * @var VmSession::unchecked_instruction_
+   * @brief Whether the current instruction fetches its operands without bounds checks
+   */
+  bool unchecked_instruction_ = false;
+
+  /**
+   * @brief The maximum number of operands of a cacheable instruction
+   */
+  static constexpr size_t kMaxDecodedOperands = 6;
+
+  /**
+   * @brief An instruction as decoded from the byte code, ready to be replayed
+   */
+  struct DecodedInstruction {
+    int8_t opcode = 0;          ///< The operator byte returned by beginInstruction()
+    uint8_t prefix_size = 0;    ///< The number of bytes in front of the first operand
+    uint8_t size = 0;           ///< The size of the whole instruction in bytes
+    uint8_t operand_count = 0;  ///< The number of operands held by `operands`
+    std::array<int32_t, kMaxDecodedOperands> operands{};  ///< The fetched operand values
+  };
+
+  /**
+   * @brief The cacheable instructions of a program, and where they start
+   */
+  struct DecodeTable {
+    std::vector<DecodedInstruction> instructions;  ///< The instructions in ascending offset order
+    std::vector<uint32_t> instruction_at;  ///< One more than the index of the instruction starting
+                                           ///  at each offset, or 0 if none is cached there
+  };
+
+  /**
+   * @var VmSession::decode_cache_
+   * @brief The program's decoded instructions, if the decode cache is enabled
+   *
+   * Shared between copies of the session, as the program never changes.
+   */
+  std::shared_ptr<const DecodeTable> decode_cache_;
+
+  /**
+   * @var VmSession::pending_instruction_
+   * @brief The instruction being replayed
+   */
+  DecodedInstruction pending_instruction_;
+
+  /**
+   * @var VmSession::pending_offset_
+   * @brief The offset the instruction being replayed starts at
+   */
+  int32_t pending_offset_ = 0;
+
+  /**
+   * @var VmSession::pending_operand_
+   * @brief The number of operands of the pending instruction replayed so far
+   */
+  size_t pending_operand_ = 0;
+
+  /**
+   * @var VmSession::replaying_
+   * @brief Whether operands are returned from the pending instruction instead of the byte code
+   */
+  bool replaying_ = false;
+
   /**
    * @var VmSession::variable_count_
    * @brief The maximum number of variables to store in the variable memory
@@ -1528,6 +2004,44 @@ class VmSession {
    */
   size_t maximum_print_buffer_length_ = 256;
 
+  /**
+   * @var VmSession::execution_limits_
+   * @brief The limits bounding the execution of the program
+   */
+  ExecutionLimits execution_limits_;
+
+  /**
+   * @var VmSession::cancellation_token_
+   * @brief The token that allows to cancel execution, if any
+   */
+  std::shared_ptr<const CancellationToken> cancellation_token_;
+
+  /**
+   * @var VmSession::execution_start_
+   * @brief When the first step since the last runtime statistics reset was executed
+   */
+  std::chrono::steady_clock::time_point execution_start_;
+
+  /**
+   * @var VmSession::print_output_size_
+   * @brief The number of characters printed since the last runtime statistics reset
+   *
+   * Unlike the print buffer size, this count is not affected by clearPrintBuffer().
+   */
+  size_t print_output_size_ = 0;
+
+  /**
+   * @var VmSession::random_seed_
+   * @brief The seed of the random number generator, if random values are reproducible
+   */
+  std::optional<uint32_t> random_seed_;
+
+  /**
+   * @var VmSession::random_engine_
+   * @brief Draws the program's random values if a random seed was set
+   */
+  std::mt19937 random_engine_;
+
   /**
    * @var VmSession::variables_
    * @brief Holds the program's variable memory
@@ -1559,6 +2073,12 @@ class VmSession {
    * @brief Holds this session's runtime statistics
    */
   RuntimeStatistics runtime_statistics_;
+
+  /**
+   * @var VmSession::waiting_for_input_
+   * @brief Whether the last input check of the program found no new input
+   */
+  bool waiting_for_input_ = false;
 };
 
 }  // namespace beast
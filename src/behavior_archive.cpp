@@ -0,0 +1,297 @@
+#include <beast/behavior_archive.hpp>
+
+// Standard
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+// Internal
+#include <beast/opcodes.hpp>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief The number of independent accumulators of the distance kernel
+ */
+constexpr size_t kLaneCount = 8;
+
+/**
+ * @brief Returns the squared Euclidean distance between two descriptors
+ *
+ * Every lane accumulates its own share of the dimensions, which lets the compiler turn the inner
+ * loop into SIMD instructions without reordering floating point additions. Every 32 dimensions the
+ * partial sum is compared against `bound`, and the computation is abandoned once it is exceeded;
+ * the returned value is then only known to be greater than `bound`.
+ */
+float squaredDistance(
+    const float* first, const float* second, size_t dimension, float bound) noexcept {
+  std::array<float, kLaneCount> lanes{};
+  size_t idx = 0;
+  for (; idx + kLaneCount <= dimension; idx += kLaneCount) {
+    for (size_t lane = 0; lane < kLaneCount; ++lane) {
+      const float difference = first[idx + lane] - second[idx + lane];
+      lanes[lane] += difference * difference;
+    }
+    if ((idx / kLaneCount) % 4 == 3) {
+      const float partial = std::accumulate(lanes.begin(), lanes.end(), 0.0F);
+      if (partial > bound) {
+        return partial;
+      }
+    }
+  }
+
+  float sum = std::accumulate(lanes.begin(), lanes.end(), 0.0F);
+  for (; idx < dimension; ++idx) {
+    const float difference = first[idx] - second[idx];
+    sum += difference * difference;
+  }
+  return sum;
+}
+
+/**
+ * @brief Returns the end of the inner half of a subtree, which is the start of its outer half
+ */
+size_t getPartitionEnd(size_t begin, size_t end) noexcept {
+  return begin + 1 + (end - begin - 1) / 2;
+}
+}  // namespace
+
+class BehaviorArchive::NeighbourHeap {
+ public:
+  explicit NeighbourHeap(size_t count) : count_{count} {
+    squared_distances_.reserve(count);
+  }
+
+  /**
+   * @brief Returns the squared distance a descriptor must undercut to become a neighbour
+   */
+  [[nodiscard]] float getSquaredBound() const noexcept {
+    if (squared_distances_.size() < count_) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return squared_distances_.front();
+  }
+
+  /**
+   * @brief Returns the distance a descriptor must undercut to become a neighbour
+   */
+  [[nodiscard]] float getBound() const noexcept {
+    return std::sqrt(getSquaredBound());
+  }
+
+  /**
+   * @brief Keeps a squared distance if it is among the `count` smallest offered so far
+   */
+  void offer(float squared_distance) {
+    if (squared_distances_.size() < count_) {
+      squared_distances_.push_back(squared_distance);
+      std::push_heap(squared_distances_.begin(), squared_distances_.end());
+    } else if (squared_distance < squared_distances_.front()) {
+      std::pop_heap(squared_distances_.begin(), squared_distances_.end());
+      squared_distances_.back() = squared_distance;
+      std::push_heap(squared_distances_.begin(), squared_distances_.end());
+    }
+  }
+
+  /**
+   * @brief Returns the kept distances in ascending order
+   */
+  [[nodiscard]] std::vector<double> getSortedDistances() const {
+    std::vector<double> distances;
+    distances.reserve(squared_distances_.size());
+    for (const float squared_distance : squared_distances_) {
+      distances.push_back(std::sqrt(static_cast<double>(squared_distance)));
+    }
+    std::sort(distances.begin(), distances.end());
+    return distances;
+  }
+
+ private:
+  size_t count_;
+  std::vector<float> squared_distances_;
+};
+
+BehaviorArchive::BehaviorArchive(size_t dimension) : dimension_{dimension} {
+  if (dimension == 0) {
+    throw std::invalid_argument("Behavior descriptors need at least one dimension.");
+  }
+}
+
+std::vector<float> BehaviorArchive::describeOperatorUsage(
+    const VmSession::RuntimeStatistics& statistics) {
+  std::vector<float> descriptor(getOperatorUsageDimension(), 0.0F);
+  uint64_t total_executions = 0;
+  for (const auto& [opcode, executions] : statistics.operator_executions) {
+    total_executions += executions;
+  }
+  if (total_executions == 0) {
+    return descriptor;
+  }
+
+  for (const auto& [opcode, executions] : statistics.operator_executions) {
+    const auto index = static_cast<size_t>(opcode);
+    if (index < descriptor.size()) {
+      descriptor[index] = static_cast<float>(executions) / static_cast<float>(total_executions);
+    }
+  }
+  return descriptor;
+}
+
+size_t BehaviorArchive::getOperatorUsageDimension() noexcept {
+  return static_cast<size_t>(OpCode::Size);
+}
+
+size_t BehaviorArchive::getDimension() const noexcept {
+  return dimension_;
+}
+
+size_t BehaviorArchive::getSize() const {
+  std::shared_lock lock(mutex_);
+  return descriptors_.size() / dimension_;
+}
+
+void BehaviorArchive::insert(const std::vector<float>& descriptor) {
+  if (descriptor.size() != dimension_) {
+    throw std::invalid_argument("Behavior descriptor has the wrong dimension.");
+  }
+
+  std::unique_lock lock(mutex_);
+  const size_t size = descriptors_.size() / dimension_;
+  if (size >= std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("Behavior archive is full.");
+  }
+  descriptors_.insert(descriptors_.end(), descriptor.begin(), descriptor.end());
+  if (size + 1 - indexed_count_ < kBufferSize) {
+    return;
+  }
+
+  // Like incrementing a binary counter, the full buffer absorbs all trees of its own size.
+  Tree tree{static_cast<uint32_t>(indexed_count_), {}, {}};
+  size_t count = kBufferSize;
+  while (!trees_.empty() && trees_.back().points.size() == count) {
+    tree.first = trees_.back().first;
+    count += trees_.back().points.size();
+    trees_.pop_back();
+  }
+  tree.points.resize(count);
+  std::iota(tree.points.begin(), tree.points.end(), tree.first);
+  tree.radii.resize(count, 0.0F);
+  std::vector<std::pair<float, uint32_t>> order;
+  order.reserve(count);
+  buildTree(tree, 0, count, order);
+  trees_.push_back(std::move(tree));
+  indexed_count_ = size + 1;
+}
+
+std::vector<double> BehaviorArchive::findNearestDistances(
+    const std::vector<float>& descriptor, size_t count) const {
+  if (descriptor.size() != dimension_) {
+    throw std::invalid_argument("Behavior descriptor has the wrong dimension.");
+  }
+  if (count == 0) {
+    return {};
+  }
+
+  NeighbourHeap heap(count);
+  std::shared_lock lock(mutex_);
+  for (const Tree& tree : trees_) {
+    searchTree(tree, 0, tree.points.size(), descriptor.data(), heap);
+  }
+  const size_t size = descriptors_.size() / dimension_;
+  for (size_t point = indexed_count_; point < size; ++point) {
+    considerPoint(static_cast<uint32_t>(point), descriptor.data(), heap);
+  }
+  return heap.getSortedDistances();
+}
+
+double BehaviorArchive::computeNovelty(const std::vector<float>& descriptor, size_t count) const {
+  const std::vector<double> distances = findNearestDistances(descriptor, count);
+  if (distances.empty()) {
+    return 0.0;
+  }
+  return std::accumulate(distances.begin(), distances.end(), 0.0) /
+         static_cast<double>(distances.size());
+}
+
+void BehaviorArchive::buildTree(
+    Tree& tree, size_t begin, size_t end, std::vector<std::pair<float, uint32_t>>& order) const {
+  if (end - begin <= kLeafSize) {
+    return;
+  }
+
+  // A pseudo-random vantage point avoids degenerate trees on sorted input, while keeping the index
+  // independent of any random number generator the caller may be seeding.
+  const size_t pick = begin + (begin * 2654435761U + end) % (end - begin);
+  std::swap(tree.points[begin], tree.points[pick]);
+
+  // Partition the points by their distance to the vantage point, keeping distances alongside.
+  const float* vantage_point = getDescriptor(tree.points[begin]);
+  order.clear();
+  for (size_t idx = begin + 1; idx < end; ++idx) {
+    const float squared_distance =
+        squaredDistance(vantage_point, getDescriptor(tree.points[idx]), dimension_,
+                        std::numeric_limits<float>::infinity());
+    order.emplace_back(std::sqrt(squared_distance), tree.points[idx]);
+  }
+  const size_t partition_end = getPartitionEnd(begin, end);
+  std::nth_element(order.begin(), order.begin() + (partition_end - begin - 1), order.end());
+  for (size_t idx = begin + 1; idx < end; ++idx) {
+    tree.points[idx] = order[idx - begin - 1].second;
+  }
+  tree.radii[begin] = order[partition_end - begin - 1].first;
+
+  buildTree(tree, begin + 1, partition_end, order);
+  buildTree(tree, partition_end, end, order);
+}
+
+void BehaviorArchive::searchTree(
+    const Tree& tree, size_t begin, size_t end, const float* query, NeighbourHeap& heap) const {
+  if (end - begin <= kLeafSize) {
+    for (size_t idx = begin; idx < end; ++idx) {
+      considerPoint(tree.points[idx], query, heap);
+    }
+    return;
+  }
+
+  const float squared_distance = squaredDistance(
+      query, getDescriptor(tree.points[begin]), dimension_, std::numeric_limits<float>::infinity());
+  heap.offer(squared_distance);
+  const float distance = std::sqrt(squared_distance);
+  const float radius = tree.radii[begin];
+  const size_t partition_end = getPartitionEnd(begin, end);
+
+  // Descend into the half the query lies in first; the other half can only hold neighbours if the
+  // ball around the query with the current k-th distance crosses the partitioning radius.
+  if (distance < radius) {
+    searchTree(tree, begin + 1, partition_end, query, heap);
+    if (distance + heap.getBound() >= radius) {
+      searchTree(tree, partition_end, end, query, heap);
+    }
+  } else {
+    searchTree(tree, partition_end, end, query, heap);
+    if (distance - heap.getBound() <= radius) {
+      searchTree(tree, begin + 1, partition_end, query, heap);
+    }
+  }
+}
+
+void BehaviorArchive::considerPoint(
+    uint32_t point, const float* query, NeighbourHeap& heap) const {
+  const float bound = heap.getSquaredBound();
+  const float squared_distance = squaredDistance(query, getDescriptor(point), dimension_, bound);
+  if (squared_distance < bound) {
+    heap.offer(squared_distance);
+  }
+}
+
+const float* BehaviorArchive::getDescriptor(uint32_t point) const noexcept {
+  return descriptors_.data() + static_cast<size_t>(point) * dimension_;
+}
+
+}  // namespace beast
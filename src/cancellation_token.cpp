@@ -0,0 +1,17 @@
+#include <beast/cancellation_token.hpp>
+
+namespace beast {
+
+void CancellationToken::cancel() noexcept {
+  cancelled_.store(true, std::memory_order_release);
+}
+
+void CancellationToken::reset() noexcept {
+  cancelled_.store(false, std::memory_order_release);
+}
+
+bool CancellationToken::isCancelled() const noexcept {
+  return cancelled_.load(std::memory_order_acquire);
+}
+
+}  // namespace beast
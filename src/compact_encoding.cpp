@@ -0,0 +1,431 @@
+#include <beast/compact_encoding.hpp>
+
+// Standard
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Internal
+#include <beast/program_optimizer.hpp>
+
+namespace beast {
+
+namespace {
+using Instruction = InstructionDecoder::Instruction;
+using OperandType = InstructionDecoder::OperandType;
+
+const auto kOperatorCount = static_cast<size_t>(OpCode::Size);
+const size_t kNoIndex = std::numeric_limits<size_t>::max();
+const uint32_t kMaxStringLength = static_cast<uint32_t>(std::numeric_limits<int16_t>::max());
+
+/**
+ * @brief Returns the number of flag operands of all operators, counting them on first use
+ */
+const std::array<size_t, kOperatorCount>& getFlagCounts() {
+  static const std::array<size_t, kOperatorCount> counts = []() {
+    std::array<size_t, kOperatorCount> result{};
+    for (size_t opcode = 0; opcode < kOperatorCount; ++opcode) {
+      const auto& types = InstructionDecoder::getOperandTypes(static_cast<OpCode>(opcode));
+      for (const OperandType type : types) {
+        result[opcode] += type == OperandType::Flag ? 1 : 0;
+      }
+    }
+    return result;
+  }();
+  return counts;
+}
+
+bool isAddress(OperandType type) noexcept {
+  return type == OperandType::AbsoluteAddress || type == OperandType::RelativeAddress;
+}
+
+/**
+ * @brief Returns the number of bytes an unsigned LEB128 varint of `value` takes at least
+ */
+size_t getVarintSize(uint32_t value) noexcept {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+/**
+ * @brief Appends `value` as an unsigned LEB128 varint of exactly `size` bytes
+ *
+ * `size` must be at least getVarintSize(value). Larger sizes are padded with continuation bytes, so
+ * that jump addresses can keep their size while the layout settles.
+ */
+void appendVarint(std::vector<unsigned char>& code, uint32_t value, size_t size) {
+  for (size_t idx = 1; idx < size; ++idx) {
+    code.push_back(static_cast<unsigned char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  code.push_back(static_cast<unsigned char>(value));
+}
+
+void appendData4(std::vector<unsigned char>& code, int32_t data) {
+  const size_t offset = code.size();
+  code.resize(offset + 4);
+  std::memcpy(&code[offset], &data, 4);
+}
+
+int32_t readData4(ProgramView code, size_t offset) {
+  int32_t data = 0;
+  std::memcpy(&data, code.getData() + offset, 4);
+  return data;
+}
+
+int16_t readData2(ProgramView code, size_t offset) {
+  int16_t data = 0;
+  std::memcpy(&data, code.getData() + offset, 2);
+  return data;
+}
+
+/**
+ * @brief Appends the compact encoding of a standard instruction
+ *
+ * @param compact_code The compact byte code to append to
+ * @param code The standard byte code the instruction was decoded from
+ * @param instruction The instruction to append
+ * @param address The new value of the instruction's jump address operand, if it has one
+ * @param address_size The number of bytes to encode the jump address in
+ */
+void appendCompactInstruction(
+    std::vector<unsigned char>& compact_code, ProgramView code, const Instruction& instruction,
+    int32_t address, size_t address_size) {
+  const std::vector<OperandType>& types = InstructionDecoder::getOperandTypes(instruction.opcode);
+  std::vector<size_t> offsets;
+  offsets.reserve(types.size());
+  size_t offset = instruction.offset + 1;
+  unsigned char flags = 0;
+  size_t flag_count = 0;
+  for (const OperandType type : types) {
+    offsets.push_back(offset);
+    if (type == OperandType::Flag) {
+      flags |= static_cast<unsigned char>((code[offset] != 0x0 ? 1 : 0) << flag_count);
+      ++flag_count;
+    } else if (type == OperandType::String) {
+      offset += static_cast<size_t>(readData2(code, offset));
+    }
+    offset += InstructionDecoder::getOperandSize(type);
+  }
+
+  const auto opcode = static_cast<unsigned char>(instruction.opcode);
+  compact_code.push_back(
+      flags != 0 ? static_cast<unsigned char>(opcode | CompactEncoding::kFlagBit) : opcode);
+  if (flag_count > 1 && flags != 0) {
+    compact_code.push_back(flags);
+  }
+
+  for (size_t idx = 0; idx < types.size(); ++idx) {
+    switch (types[idx]) {
+    case OperandType::Flag:
+      break;
+
+    case OperandType::Constant1:
+      compact_code.push_back(code[offsets[idx]]);
+      break;
+
+    case OperandType::String: {
+      const auto length = static_cast<uint32_t>(readData2(code, offsets[idx]));
+      appendVarint(compact_code, length, getVarintSize(length));
+      compact_code.insert(
+          compact_code.end(), code.begin() + offsets[idx] + 2,
+          code.begin() + offsets[idx] + 2 + length);
+    } break;
+
+    case OperandType::AbsoluteAddress:
+    case OperandType::RelativeAddress:
+      appendVarint(compact_code, CompactEncoding::toUnsigned(address), address_size);
+      break;
+
+    default: {
+      const uint32_t value = CompactEncoding::toUnsigned(readData4(code, offsets[idx]));
+      appendVarint(compact_code, value, getVarintSize(value));
+    } break;
+    }
+  }
+}
+
+/**
+ * @brief Returns the index of the instruction starting at every offset, and the instruction count
+ *        for the end of the code
+ *
+ * Offsets that don't start an instruction are mapped to `kNoIndex`.
+ */
+std::vector<size_t> getInstructionIndices(
+    const std::vector<Instruction>& instructions, size_t code_size) {
+  std::vector<size_t> indices(code_size + 1, kNoIndex);
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    indices[instructions[idx].offset] = idx;
+  }
+  indices[code_size] = instructions.size();
+  return indices;
+}
+}  // namespace
+
+std::vector<unsigned char> CompactEncoding::compact(ProgramView code) {
+  if (!ProgramOptimizer::isRelocatable(code)) {
+    throw std::invalid_argument(
+        "Unable to compact byte code whose behavior depends on its layout.");
+  }
+  const std::vector<Instruction> instructions = InstructionDecoder::decodeAll(code);
+  const std::vector<size_t> indices = getInstructionIndices(instructions, code.getSize());
+
+  // Everything but the jump addresses has a fixed compact size. The address sizes depend on the
+  // layout and vice versa, so they only ever grow until the layout settles.
+  std::vector<size_t> fixed_sizes(instructions.size());
+  std::vector<size_t> targets(instructions.size(), kNoIndex);
+  std::vector<bool> relative(instructions.size(), false);
+  std::vector<size_t> address_sizes(instructions.size(), 0);
+  std::vector<unsigned char> scratch;
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const Instruction& instruction = instructions[idx];
+    const std::optional<int64_t> target = InstructionDecoder::getJumpTarget(code, instruction);
+    if (target.has_value()) {
+      targets[idx] = indices[static_cast<size_t>(*target)];
+      relative[idx] = InstructionDecoder::getOperandOffset(
+          code, instruction, OperandType::RelativeAddress).has_value();
+      address_sizes[idx] = 1;
+    }
+    scratch.clear();
+    appendCompactInstruction(scratch, code, instruction, 0, 1);
+    fixed_sizes[idx] = scratch.size() - address_sizes[idx];
+  }
+
+  std::vector<size_t> offsets(instructions.size() + 1, 0);
+  const auto getAddress = [&](size_t idx) {
+    const auto target = static_cast<int64_t>(offsets[targets[idx]]);
+    return static_cast<int32_t>(
+        relative[idx] ? target - static_cast<int64_t>(offsets[idx + 1]) : target);
+  };
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+      offsets[idx + 1] = offsets[idx] + fixed_sizes[idx] + address_sizes[idx];
+    }
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+      if (targets[idx] == kNoIndex) {
+        continue;
+      }
+      const size_t size = getVarintSize(toUnsigned(getAddress(idx)));
+      if (size > address_sizes[idx]) {
+        address_sizes[idx] = size;
+        changed = true;
+      }
+    }
+  }
+
+  std::vector<unsigned char> compact_code;
+  compact_code.reserve(offsets.back());
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const int32_t address = targets[idx] == kNoIndex ? 0 : getAddress(idx);
+    appendCompactInstruction(compact_code, code, instructions[idx], address, address_sizes[idx]);
+  }
+  return compact_code;
+}
+
+std::vector<unsigned char> CompactEncoding::expand(ProgramView code) {
+  const std::vector<Instruction> instructions = decodeAll(code);
+  const size_t decoded_size =
+      instructions.empty() ? 0 : instructions.back().offset + instructions.back().size;
+  if (decoded_size != code.getSize()) {
+    throw std::invalid_argument("Unable to expand byte code that isn't compact byte code.");
+  }
+  const std::vector<size_t> indices = getInstructionIndices(instructions, code.getSize());
+
+  // Standard instructions have a fixed size apart from their strings.
+  std::vector<size_t> offsets(instructions.size() + 1, 0);
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const Instruction& instruction = instructions[idx];
+    size_t size = 1;
+    const bool has_flag_byte =
+        (code[instruction.offset] & kFlagBit) != 0 && getFlagCount(instruction.opcode) > 1;
+    size_t offset = instruction.offset + (has_flag_byte ? 2 : 1);
+    for (const OperandType type : InstructionDecoder::getOperandTypes(instruction.opcode)) {
+      size += InstructionDecoder::getOperandSize(type);
+      if (type == OperandType::Flag) {
+        continue;
+      }
+      if (type == OperandType::Constant1) {
+        offset += 1;
+        continue;
+      }
+      const Varint varint = *readVarint(code, offset);
+      offset += varint.size;
+      if (type == OperandType::String) {
+        size += varint.value;
+        offset += varint.value;
+      }
+    }
+    offsets[idx + 1] = offsets[idx] + size;
+  }
+
+  std::vector<unsigned char> standard_code;
+  standard_code.reserve(offsets.back());
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const Instruction& instruction = instructions[idx];
+    const unsigned char opcode = code[instruction.offset];
+    size_t offset = instruction.offset + 1;
+    unsigned char flags = 0;
+    if ((opcode & kFlagBit) != 0) {
+      flags = getFlagCount(instruction.opcode) == 1 ? 1 : code[offset++];
+    }
+    size_t flag_index = 0;
+
+    standard_code.push_back(static_cast<unsigned char>(instruction.opcode));
+    for (const OperandType type : InstructionDecoder::getOperandTypes(instruction.opcode)) {
+      if (type == OperandType::Flag) {
+        standard_code.push_back((flags >> flag_index++) & 0x1);
+        continue;
+      }
+      if (type == OperandType::Constant1) {
+        standard_code.push_back(code[offset++]);
+        continue;
+      }
+      const Varint varint = *readVarint(code, offset);
+      offset += varint.size;
+      if (type == OperandType::String) {
+        const auto length = static_cast<int16_t>(varint.value);
+        standard_code.resize(standard_code.size() + 2);
+        std::memcpy(&standard_code[standard_code.size() - 2], &length, 2);
+        standard_code.insert(
+            standard_code.end(), code.begin() + offset, code.begin() + offset + varint.value);
+        offset += varint.value;
+      } else if (isAddress(type)) {
+        const bool is_relative = type == OperandType::RelativeAddress;
+        const int64_t target = toSigned(varint.value) +
+            (is_relative ? static_cast<int64_t>(instruction.offset + instruction.size) : 0);
+        if (target < 0 || target > static_cast<int64_t>(code.getSize()) ||
+            indices[static_cast<size_t>(target)] == kNoIndex) {
+          throw std::invalid_argument(
+              "Unable to expand compact byte code with a jump off instruction boundaries.");
+        }
+        const auto new_target = static_cast<int64_t>(offsets[indices[static_cast<size_t>(target)]]);
+        appendData4(standard_code, static_cast<int32_t>(
+            is_relative ? new_target - static_cast<int64_t>(offsets[idx + 1]) : new_target));
+      } else {
+        appendData4(standard_code, toSigned(varint.value));
+      }
+    }
+  }
+  return standard_code;
+}
+
+std::optional<InstructionDecoder::Instruction> CompactEncoding::decode(
+    ProgramView code, size_t offset) noexcept {
+  if (offset >= code.getSize()) {
+    return std::nullopt;
+  }
+  const unsigned char opcode = code[offset] & static_cast<unsigned char>(~kFlagBit);
+  if (!InstructionDecoder::isKnownOpCode(opcode)) {
+    return std::nullopt;
+  }
+  const size_t flag_count = getFlagCounts()[opcode];
+  size_t size = 1;
+  if ((code[offset] & kFlagBit) != 0) {
+    if (flag_count == 0) {
+      return std::nullopt;
+    }
+    size += flag_count > 1 ? 1 : 0;
+  }
+
+  for (const OperandType type : InstructionDecoder::getOperandTypes(static_cast<OpCode>(opcode))) {
+    if (type == OperandType::Flag) {
+      continue;
+    }
+    if (type == OperandType::Constant1) {
+      size += 1;
+      continue;
+    }
+    const std::optional<Varint> varint = readVarint(code, offset + size);
+    if (!varint.has_value()) {
+      return std::nullopt;
+    }
+    size += varint->size;
+    if (type == OperandType::String) {
+      if (varint->value > kMaxStringLength) {
+        return std::nullopt;
+      }
+      size += varint->value;
+    }
+  }
+  if (size > code.getSize() - offset) {
+    return std::nullopt;
+  }
+
+  Instruction instruction;
+  instruction.offset = offset;
+  instruction.size = size;
+  instruction.opcode = static_cast<OpCode>(opcode);
+  return instruction;
+}
+
+std::vector<InstructionDecoder::Instruction> CompactEncoding::decodeAll(ProgramView code) {
+  std::vector<Instruction> instructions;
+  size_t offset = 0;
+  while (const std::optional<Instruction> instruction = decode(code, offset)) {
+    instructions.push_back(*instruction);
+    offset += instruction->size;
+  }
+  return instructions;
+}
+
+std::optional<int64_t> CompactEncoding::getJumpTarget(
+    ProgramView code, const InstructionDecoder::Instruction& instruction) {
+  const bool has_flag_byte =
+      (code[instruction.offset] & kFlagBit) != 0 && getFlagCount(instruction.opcode) > 1;
+  size_t offset = instruction.offset + (has_flag_byte ? 2 : 1);
+  for (const OperandType type : InstructionDecoder::getOperandTypes(instruction.opcode)) {
+    if (type == OperandType::Flag) {
+      continue;
+    }
+    if (type == OperandType::Constant1) {
+      offset += 1;
+      continue;
+    }
+    const Varint varint = *readVarint(code, offset);
+    if (type == OperandType::AbsoluteAddress) {
+      return toSigned(varint.value);
+    }
+    if (type == OperandType::RelativeAddress) {
+      return static_cast<int64_t>(instruction.offset + instruction.size) + toSigned(varint.value);
+    }
+    offset += varint.size + (type == OperandType::String ? varint.value : 0);
+  }
+  return std::nullopt;
+}
+
+size_t CompactEncoding::getFlagCount(OpCode opcode) {
+  const auto index = static_cast<size_t>(static_cast<uint8_t>(opcode));
+  if (index >= kOperatorCount) {
+    throw std::invalid_argument("Unknown operator.");
+  }
+  return getFlagCounts()[index];
+}
+
+std::optional<CompactEncoding::Varint> CompactEncoding::readVarint(
+    ProgramView code, size_t offset) noexcept {
+  uint32_t value = 0;
+  for (size_t idx = 0; idx < 5; ++idx) {
+    if (offset + idx >= code.getSize()) {
+      return std::nullopt;
+    }
+    const unsigned char byte = code[offset + idx];
+    if (idx == 4 && byte > 0x0f) {
+      // Only four bits of a 32 bit value are left for the fifth byte.
+      return std::nullopt;
+    }
+    value |= static_cast<uint32_t>(byte & 0x7f) << (7 * idx);
+    if ((byte & 0x80) == 0) {
+      return Varint{value, idx + 1};
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace beast
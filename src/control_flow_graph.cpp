@@ -0,0 +1,349 @@
+#include <beast/control_flow_graph.hpp>
+
+// Standard
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace beast {
+
+namespace {
+using Instruction = InstructionDecoder::Instruction;
+
+/**
+ * @brief Adds `block` to `blocks` unless it is already contained
+ */
+void addUnique(std::vector<size_t>& blocks, size_t block) {
+  if (std::find(blocks.begin(), blocks.end(), block) == blocks.end()) {
+    blocks.push_back(block);
+  }
+}
+}  // namespace
+
+ControlFlowGraph::ControlFlowGraph(ProgramView code, ProgramEncoding encoding) {
+  const bool is_compact = encoding == ProgramEncoding::Compact;
+  const std::vector<Instruction> instructions =
+      is_compact ? CompactEncoding::decodeAll(code) : InstructionDecoder::decodeAll(code);
+  if (instructions.empty()) {
+    return;
+  }
+  decoded_size_ = instructions.back().offset + instructions.back().size;
+
+  // Constant jump targets that lie within the graph and on an instruction boundary start blocks.
+  std::vector<bool> instruction_starts(decoded_size_, false);
+  for (const Instruction& instruction : instructions) {
+    instruction_starts[instruction.offset] = true;
+  }
+  std::vector<std::optional<int64_t>> targets(instructions.size());
+  std::vector<bool> leaders(decoded_size_, false);
+  leaders[0] = true;
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const FlowType flow = getFlowType(instructions[idx].opcode);
+    if (flow == FlowType::ConditionalJump || flow == FlowType::Jump) {
+      targets[idx] = is_compact ? CompactEncoding::getJumpTarget(code, instructions[idx])
+                                : InstructionDecoder::getJumpTarget(code, instructions[idx]);
+      const int64_t target = *targets[idx];
+      if (target >= 0 && target < static_cast<int64_t>(decoded_size_) &&
+          instruction_starts[static_cast<size_t>(target)]) {
+        leaders[static_cast<size_t>(target)] = true;
+      }
+    }
+    if (flow != FlowType::Continue && idx + 1 < instructions.size()) {
+      leaders[instructions[idx + 1].offset] = true;
+    }
+  }
+
+  std::vector<size_t> last_instructions;
+  for (size_t idx = 0; idx < instructions.size(); ++idx) {
+    const Instruction& instruction = instructions[idx];
+    if (leaders[instruction.offset]) {
+      BasicBlock block;
+      block.begin = instruction.offset;
+      blocks_.push_back(std::move(block));
+      last_instructions.emplace_back();
+    }
+    blocks_.back().instructions.push_back(instruction);
+    blocks_.back().end = instruction.offset + instruction.size;
+    last_instructions.back() = idx;
+  }
+
+  for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+    BasicBlock& block = blocks_[idx];
+    const size_t last = last_instructions[idx];
+    const FlowType flow = getFlowType(instructions[last].opcode);
+
+    if (flow == FlowType::ConditionalJump || flow == FlowType::Jump) {
+      const int64_t target = *targets[last];
+      if (target < 0 || target >= static_cast<int64_t>(decoded_size_)) {
+        block.is_exit = true;
+      } else if (!instruction_starts[static_cast<size_t>(target)]) {
+        block.has_unknown_successors = true;
+      } else {
+        addUnique(block.successors, *getBlockAt(static_cast<size_t>(target)));
+      }
+    } else if (flow == FlowType::ConditionalVariableJump || flow == FlowType::VariableJump) {
+      block.has_unknown_successors = true;
+    } else if (flow == FlowType::Terminate) {
+      block.is_exit = true;
+    }
+
+    if (flow == FlowType::Continue || flow == FlowType::ConditionalJump ||
+        flow == FlowType::ConditionalVariableJump) {
+      if (idx + 1 < blocks_.size()) {
+        addUnique(block.successors, idx + 1);
+      } else {
+        block.is_exit = true;
+      }
+    }
+  }
+
+  for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+    for (const size_t successor : blocks_[idx].successors) {
+      blocks_[successor].predecessors.push_back(idx);
+    }
+  }
+}
+
+ControlFlowGraph::FlowType ControlFlowGraph::getFlowType(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::RelativeJumpIfVariableGt0:
+  case OpCode::RelativeJumpIfVariableLt0:
+  case OpCode::RelativeJumpIfVariableEq0:
+  case OpCode::AbsoluteJumpIfVariableGt0:
+  case OpCode::AbsoluteJumpIfVariableLt0:
+  case OpCode::AbsoluteJumpIfVariableEq0:
+    return FlowType::ConditionalJump;
+
+  case OpCode::UnconditionalJumpToAbsoluteAddress:
+  case OpCode::UnconditionalJumpToRelativeAddress:
+    return FlowType::Jump;
+
+  case OpCode::RelativeJumpToVariableAddressIfVariableGt0:
+  case OpCode::RelativeJumpToVariableAddressIfVariableLt0:
+  case OpCode::RelativeJumpToVariableAddressIfVariableEq0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableGt0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableLt0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableEq0:
+    return FlowType::ConditionalVariableJump;
+
+  case OpCode::UnconditionalJumpToAbsoluteVariableAddress:
+  case OpCode::UnconditionalJumpToRelativeVariableAddress:
+    return FlowType::VariableJump;
+
+  case OpCode::Terminate:
+  case OpCode::TerminateWithVariableReturnCode:
+    return FlowType::Terminate;
+
+  default:
+    return FlowType::Continue;
+  }
+}
+
+bool ControlFlowGraph::usesVariableIo(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::CheckIfVariableIsInput:
+  case OpCode::CheckIfVariableIsOutput:
+  case OpCode::LoadInputCountIntoVariable:
+  case OpCode::LoadOutputCountIntoVariable:
+  case OpCode::CheckIfInputWasSet:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+const std::vector<ControlFlowGraph::BasicBlock>& ControlFlowGraph::getBlocks() const noexcept {
+  return blocks_;
+}
+
+std::vector<size_t> ControlFlowGraph::getExitBlocks() const {
+  std::vector<size_t> exits;
+  for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+    if (blocks_[idx].is_exit) {
+      exits.push_back(idx);
+    }
+  }
+  return exits;
+}
+
+std::optional<size_t> ControlFlowGraph::getBlockAt(size_t offset) const noexcept {
+  if (offset >= decoded_size_) {
+    return std::nullopt;
+  }
+  const auto iterator = std::upper_bound(
+      blocks_.begin(), blocks_.end(), offset,
+      [](size_t value, const BasicBlock& block) { return value < block.begin; });
+  return static_cast<size_t>(iterator - blocks_.begin()) - 1;
+}
+
+size_t ControlFlowGraph::getInstructionCount() const noexcept {
+  size_t count = 0;
+  for (const BasicBlock& block : blocks_) {
+    count += block.instructions.size();
+  }
+  return count;
+}
+
+size_t ControlFlowGraph::getDecodedSize() const noexcept {
+  return decoded_size_;
+}
+
+bool ControlFlowGraph::hasUnknownSuccessors() const {
+  const std::vector<bool> reachable = getReachableBlocks();
+  for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+    if (reachable[idx] && blocks_[idx].has_unknown_successors) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<bool> ControlFlowGraph::getReachableBlocks() const {
+  std::vector<bool> reachable(blocks_.size(), false);
+  for (const size_t block : getReversePostOrder()) {
+    reachable[block] = true;
+  }
+  return reachable;
+}
+
+std::vector<std::optional<size_t>> ControlFlowGraph::getImmediateDominators() const {
+  // Cooper, Harvey, and Kennedy: "A Simple, Fast Dominance Algorithm"
+  const std::vector<size_t> order = getReversePostOrder();
+  std::vector<size_t> positions(blocks_.size(), 0);
+  for (size_t idx = 0; idx < order.size(); ++idx) {
+    positions[order[idx]] = idx;
+  }
+
+  std::vector<std::optional<size_t>> dominators(blocks_.size());
+  if (order.empty()) {
+    return dominators;
+  }
+  dominators[order.front()] = order.front();
+  const auto intersect = [&dominators, &positions](size_t block_a, size_t block_b) {
+    while (block_a != block_b) {
+      while (positions[block_a] > positions[block_b]) {
+        block_a = *dominators[block_a];
+      }
+      while (positions[block_b] > positions[block_a]) {
+        block_b = *dominators[block_b];
+      }
+    }
+    return block_a;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t idx = 1; idx < order.size(); ++idx) {
+      const size_t block = order[idx];
+      std::optional<size_t> dominator;
+      for (const size_t predecessor : blocks_[block].predecessors) {
+        if (dominators[predecessor].has_value()) {
+          dominator = dominator.has_value() ? intersect(predecessor, *dominator) : predecessor;
+        }
+      }
+      if (dominators[block] != dominator) {
+        dominators[block] = dominator;
+        changed = true;
+      }
+    }
+  }
+  return dominators;
+}
+
+bool ControlFlowGraph::dominates(size_t dominator, size_t block) const {
+  const std::vector<std::optional<size_t>> dominators = getImmediateDominators();
+  if (dominator >= blocks_.size() || block >= blocks_.size() ||
+      !dominators[dominator].has_value() || !dominators[block].has_value()) {
+    return false;
+  }
+  while (block != dominator && *dominators[block] != block) {
+    block = *dominators[block];
+  }
+  return block == dominator;
+}
+
+std::vector<ControlFlowGraph::Loop> ControlFlowGraph::getLoops() const {
+  const std::vector<std::optional<size_t>> dominators = getImmediateDominators();
+  const auto isDominatedBy = [&dominators](size_t block, size_t dominator) {
+    while (block != dominator && *dominators[block] != block) {
+      block = *dominators[block];
+    }
+    return block == dominator;
+  };
+
+  std::map<size_t, Loop> loops;
+  for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+    if (!dominators[idx].has_value()) {
+      continue;
+    }
+    for (const size_t successor : blocks_[idx].successors) {
+      if (isDominatedBy(idx, successor)) {
+        Loop& loop = loops[successor];
+        loop.header = successor;
+        loop.back_edges.push_back(idx);
+      }
+    }
+  }
+
+  std::vector<Loop> result;
+  for (auto& [header, loop] : loops) {
+    // The loop consists of all blocks that reach a back edge without passing the header.
+    std::vector<bool> contained(blocks_.size(), false);
+    contained[header] = true;
+    std::vector<size_t> pending;
+    for (const size_t source : loop.back_edges) {
+      if (!contained[source]) {
+        contained[source] = true;
+        pending.push_back(source);
+      }
+    }
+    while (!pending.empty()) {
+      const size_t block = pending.back();
+      pending.pop_back();
+      for (const size_t predecessor : blocks_[block].predecessors) {
+        if (!contained[predecessor] && dominators[predecessor].has_value()) {
+          contained[predecessor] = true;
+          pending.push_back(predecessor);
+        }
+      }
+    }
+    for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+      if (contained[idx]) {
+        loop.blocks.push_back(idx);
+      }
+    }
+    result.push_back(std::move(loop));
+  }
+  return result;
+}
+
+std::vector<size_t> ControlFlowGraph::getReversePostOrder() const {
+  std::vector<size_t> order;
+  if (blocks_.empty()) {
+    return order;
+  }
+
+  // Iterative depth-first search; each entry holds a block and the index of its next successor.
+  std::vector<bool> visited(blocks_.size(), false);
+  std::vector<std::pair<size_t, size_t>> stack{{0, 0}};
+  visited[0] = true;
+  while (!stack.empty()) {
+    auto& [block, next] = stack.back();
+    if (next < blocks_[block].successors.size()) {
+      const size_t successor = blocks_[block].successors[next++];
+      if (!visited[successor]) {
+        visited[successor] = true;
+        stack.emplace_back(successor, 0);
+      }
+    } else {
+      order.push_back(block);
+      stack.pop_back();
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+}  // namespace beast
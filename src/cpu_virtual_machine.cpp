@@ -5,8 +5,8 @@
 #include <iostream>
 
 // Internal
+#include <beast/message_sink.hpp>
 #include <beast/opcodes.hpp>
-#include <beast/time_functions.hpp>
 
 namespace {
 /**
@@ -25,10 +25,15 @@ std::string to_string(bool flag) noexcept {
 namespace beast {
 
 bool CpuVirtualMachine::step(VmSession& session, bool dry_run) {
+  if (!session.checkExecutionLimits()) {
+    // A step, time, or print output limit was exceeded, or execution was cancelled.
+    return false;
+  }
+
   OpCode instruction = OpCode::NoOp;
   try {
     // Try to get next major instruction symbol.
-    instruction = static_cast<OpCode>(session.getData1());
+    instruction = static_cast<OpCode>(session.beginInstruction());
   } catch(...) {
     // Unable to get more data; the program came to an unexpected end.
     panic("Program ended unexpectedly.");
@@ -38,7 +43,33 @@ bool CpuVirtualMachine::step(VmSession& session, bool dry_run) {
   }
 
   session.informAboutStep(instruction);
+  execute(session, instruction, dry_run);
+  return !session.isAtEnd();
+}
+
+bool CpuVirtualMachine::stepBlock(VmSession& session, bool dry_run) {
+  const VmSession::BasicBlockSummary* block = session.beginBasicBlock();
+  if (block == nullptr) {
+    return step(session, dry_run);
+  }
 
+  // The block's instructions decode, and only its last one may jump or stop execution.
+  size_t executed = 0;
+  try {
+    while (executed < block->instruction_count) {
+      const auto instruction = static_cast<OpCode>(session.beginInstruction());
+      executed++;
+      execute(session, instruction, dry_run);
+    }
+  } catch (...) {
+    session.endBasicBlock(*block, executed);
+    throw;
+  }
+  session.endBasicBlock(*block, executed);
+  return !session.isAtEnd();
+}
+
+void CpuVirtualMachine::execute(VmSession& session, OpCode instruction, bool dry_run) {
   switch (instruction) {
   case OpCode::NoOp:
     break;
@@ -948,55 +979,11 @@ bool CpuVirtualMachine::step(VmSession& session, bool dry_run) {
     throw std::invalid_argument("Undefined instruction reached.");
   }
   }
-
-  return !session.isAtEnd();
 }
 
 void CpuVirtualMachine::message(MessageSeverity severity, const std::string& message) noexcept {
-  std::ostream& out_stream = std::cout;
-  uint32_t color_fg = 0;
-  uint32_t color_bg = 0;
-  std::string prefix;
-
-  switch (severity) {
-  case MessageSeverity::Debug: {
-    color_fg = 90;
-    prefix = "DBG";
-  } break;
-
-  case MessageSeverity::Info: {
-    color_fg = 97;
-    prefix = "INF";
-  } break;
-
-  case MessageSeverity::Warning: {
-    color_fg = 33;
-    prefix = "WRN";
-  } break;
-
-  case MessageSeverity::Error: {
-    color_fg = 31;
-    prefix = "ERR";
-  } break;
-
-  case MessageSeverity::Panic: {
-    color_fg = 31;
-    color_bg = 107;
-    prefix = "PNC";
-  } break;
-  }
-
-  const std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-  std::vector<char> timestamp_buffer(100);
-
-  struct tm result{};
-  const size_t timestamp_length =
-      std::strftime(timestamp_buffer.data(), 100, "%F %T", localtime_r(&time, &result));
-  const std::string timestamp(timestamp_buffer.data(), timestamp_length);
-  out_stream << "\033[1;" << color_fg << (color_bg != 0 ? ";" + std::to_string(color_bg) : "")
-             << "m" << "[" << timestamp << " " << prefix << "] "
-             << message
-             << "\033[0m" << std::endl;
+  static ConsoleMessageSink console_sink(std::cout);
+  console_sink.write(severity, std::chrono::system_clock::now(), message);
 }
 
 }  // namespace beast
@@ -0,0 +1,202 @@
+#include <beast/distributed/evaluation_coordinator.hpp>
+
+// Standard
+#include <algorithm>
+#include <stdexcept>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief How long the accept loop waits for a connection before checking for shutdown
+ */
+const std::chrono::milliseconds kAcceptPollInterval(100);
+
+/**
+ * @brief How long a connecting peer may take to send its Hello before it is dropped
+ */
+const std::chrono::milliseconds kHelloTimeout(5000);
+}  // namespace
+
+EvaluationCoordinator::EvaluationCoordinator(
+    uint16_t port, uint32_t batch_size, const std::string& bind_address)
+  : listener_{port, bind_address}, batch_size_{std::max(batch_size, 1U)} {
+  accept_thread_ = std::thread([this]() { acceptWorkers(); });
+}
+
+EvaluationCoordinator::~EvaluationCoordinator() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+  }
+  batch_available_.notify_all();
+  batch_completed_.notify_all();
+  accept_thread_.join();
+
+  std::scoped_lock lock(workers_mutex_);
+  for (const std::unique_ptr<WorkerSlot>& slot : workers_) {
+    // Unblocks serving threads that wait for results from a worker.
+    slot->connection.shutdown();
+  }
+  for (const std::unique_ptr<WorkerSlot>& slot : workers_) {
+    slot->thread.join();
+  }
+}
+
+uint16_t EvaluationCoordinator::getPort() const noexcept {
+  return listener_.getPort();
+}
+
+void EvaluationCoordinator::setBatchTimeout(std::chrono::milliseconds timeout) {
+  std::scoped_lock lock(mutex_);
+  batch_timeout_ = timeout;
+}
+
+std::chrono::milliseconds EvaluationCoordinator::getBatchTimeout() const {
+  std::scoped_lock lock(mutex_);
+  return batch_timeout_;
+}
+
+void EvaluationCoordinator::setIdleTimeout(std::chrono::milliseconds timeout) {
+  std::scoped_lock lock(mutex_);
+  idle_timeout_ = timeout;
+}
+
+std::chrono::milliseconds EvaluationCoordinator::getIdleTimeout() const {
+  std::scoped_lock lock(mutex_);
+  return idle_timeout_;
+}
+
+size_t EvaluationCoordinator::getWorkerCount() const {
+  std::scoped_lock lock(workers_mutex_);
+  return static_cast<size_t>(std::count_if(
+      workers_.begin(), workers_.end(),
+      [](const std::unique_ptr<WorkerSlot>& slot) { return slot->greeted && !slot->finished; }));
+}
+
+std::vector<double> EvaluationCoordinator::evaluate(
+    const std::vector<std::vector<unsigned char>>& programs) {
+  std::scoped_lock evaluation_lock(evaluation_mutex_);
+  std::unique_lock lock(mutex_);
+
+  results_.assign(programs.size(), 0.0);
+  for (size_t first = 0; first < programs.size(); first += batch_size_) {
+    const size_t last = std::min(first + batch_size_, programs.size());
+    PendingBatch pending{{next_batch_id_++, {}}, first};
+    pending.batch.programs.assign(
+        programs.begin() + static_cast<std::ptrdiff_t>(first),
+        programs.begin() + static_cast<std::ptrdiff_t>(last));
+    pending_.push_back(std::move(pending));
+    outstanding_batches_++;
+  }
+  batch_available_.notify_all();
+
+  auto last_worker_time = std::chrono::steady_clock::now();
+  while (!batch_completed_.wait_for(lock, kAcceptPollInterval, [this]() {
+    return outstanding_batches_ == 0 || stopping_;
+  })) {
+    const auto now = std::chrono::steady_clock::now();
+    if (getWorkerCount() != 0) {
+      last_worker_time = now;
+    } else if (now - last_worker_time >= idle_timeout_) {
+      // Without workers, no batch is in flight that could still come back.
+      pending_.clear();
+      outstanding_batches_ = 0;
+      throw std::runtime_error("No worker was connected to finish the evaluation.");
+    }
+  }
+  if (outstanding_batches_ != 0) {
+    pending_.clear();
+    outstanding_batches_ = 0;
+    throw std::runtime_error("Coordinator stopped during evaluation.");
+  }
+
+  return std::move(results_);
+}
+
+void EvaluationCoordinator::acceptWorkers() {
+  while (!stopping_) {
+    TcpConnection connection = listener_.accept(kAcceptPollInterval);
+    if (!connection.isOpen()) {
+      continue;
+    }
+
+    std::scoped_lock lock(workers_mutex_);
+    reapFinishedWorkers();
+    auto slot = std::make_unique<WorkerSlot>();
+    slot->connection = std::move(connection);
+    WorkerSlot& slot_reference = *slot;
+    slot->thread = std::thread([this, &slot_reference]() { serveWorker(slot_reference); });
+    workers_.push_back(std::move(slot));
+  }
+}
+
+void EvaluationCoordinator::serveWorker(WorkerSlot& slot) {
+  std::vector<unsigned char> payload;
+  try {
+    slot.greeted = slot.connection.receiveMessage(payload, kHelloTimeout) &&
+                   WireProtocol::decodeHello(payload) == WireProtocol::kVersion;
+  } catch (const std::exception& /*exception*/) {
+    // Malformed greeting; the peer is not a compatible worker.
+  }
+
+  while (slot.greeted) {
+    std::unique_lock lock(mutex_);
+    batch_available_.wait(lock, [this]() { return !pending_.empty() || stopping_; });
+    if (stopping_) {
+      (void)slot.connection.sendMessage(
+          WireProtocol::encodeSignal(WireProtocol::MessageType::Shutdown));
+      break;
+    }
+    PendingBatch in_flight = std::move(pending_.front());
+    pending_.pop_front();
+    const std::chrono::milliseconds batch_timeout = batch_timeout_;
+    lock.unlock();
+
+    // A worker that doesn't answer in time is dropped like one that disconnected.
+    bool scored = false;
+    if (slot.connection.sendMessage(WireProtocol::encodeBatch(in_flight.batch)) &&
+        slot.connection.receiveMessage(payload, batch_timeout)) {
+      try {
+        WireProtocol::EvaluationResults results = WireProtocol::decodeResults(payload);
+        scored = results.batch_id == in_flight.batch.batch_id &&
+                 results.scores.size() == in_flight.batch.programs.size();
+        if (scored) {
+          lock.lock();
+          std::copy(results.scores.begin(), results.scores.end(),
+                    results_.begin() + static_cast<std::ptrdiff_t>(in_flight.first_index));
+          outstanding_batches_--;
+          lock.unlock();
+          batch_completed_.notify_all();
+        }
+      } catch (const std::exception& /*exception*/) {
+        // Anything but matching results (e.g. a Goodbye) means the worker is gone.
+      }
+    }
+
+    if (!scored) {
+      // The worker left mid-batch; hand its batch to the next idle worker.
+      lock.lock();
+      pending_.push_front(std::move(in_flight));
+      lock.unlock();
+      batch_available_.notify_one();
+      break;
+    }
+  }
+
+  slot.connection.shutdown();
+  slot.finished = true;
+}
+
+void EvaluationCoordinator::reapFinishedWorkers() {
+  for (auto iterator = workers_.begin(); iterator != workers_.end();) {
+    if ((*iterator)->finished) {
+      (*iterator)->thread.join();
+      iterator = workers_.erase(iterator);
+    } else {
+      ++iterator;
+    }
+  }
+}
+
+}  // namespace beast
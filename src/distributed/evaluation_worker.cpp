@@ -0,0 +1,70 @@
+#include <beast/distributed/evaluation_worker.hpp>
+
+// Standard
+#include <exception>
+
+// Internal
+#include <beast/distributed/wire_protocol.hpp>
+
+namespace beast {
+
+EvaluationWorker::EvaluationWorker(EvaluationFunction evaluate)
+  : evaluate_{std::move(evaluate)} {
+}
+
+uint64_t EvaluationWorker::run(const std::string& host, uint16_t port) {
+  {
+    std::scoped_lock lock(connection_mutex_);
+    connection_ = TcpConnection::connect(host, port);
+  }
+
+  uint64_t evaluated = 0;
+  std::vector<unsigned char> payload;
+  if (connection_.sendMessage(WireProtocol::encodeHello())) {
+    while (!stopping_ && connection_.receiveMessage(payload)) {
+      // The programs are evaluated right where they were received; `payload` isn't touched until
+      // the results are sent.
+      WireProtocol::EvaluationBatchView batch{0, {}};
+      try {
+        batch = WireProtocol::viewBatch(payload);
+      } catch (const std::exception& /*exception*/) {
+        // Shutdown, or anything this worker doesn't understand (including unknown message types
+        // and malformed batches).
+        break;
+      }
+      WireProtocol::EvaluationResults results{batch.batch_id, {}};
+      results.scores.reserve(batch.programs.size());
+      for (const ProgramView program : batch.programs) {
+        double score = 0.0;
+        try {
+          score = evaluate_(program);
+        } catch (...) {
+          // Programs that make the evaluation throw are scored with 0.0.
+        }
+        results.scores.push_back(score);
+      }
+      evaluated += batch.programs.size();
+
+      if (!connection_.sendMessage(WireProtocol::encodeResults(results))) {
+        break;
+      }
+    }
+
+    (void)connection_.sendMessage(WireProtocol::encodeSignal(WireProtocol::MessageType::Goodbye));
+  }
+
+  std::scoped_lock lock(connection_mutex_);
+  connection_.close();
+
+  return evaluated;
+}
+
+void EvaluationWorker::stop() noexcept {
+  std::scoped_lock lock(connection_mutex_);
+  stopping_ = true;
+  // Only interrupt an idle worker that waits for the next batch; a batch in evaluation is
+  // answered first, then the loop observes `stopping_`.
+  connection_.shutdownReceive();
+}
+
+}  // namespace beast
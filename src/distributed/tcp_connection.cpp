@@ -0,0 +1,385 @@
+#include <beast/distributed/tcp_connection.hpp>
+
+// Standard
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Internal
+#include <beast/distributed/wire_protocol.hpp>
+
+namespace beast {
+
+namespace {
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+
+/**
+ * @brief Initializes Winsock once per process
+ *
+ * Winsock needs to be started before any socket function can be used. The function local static
+ * makes sure this happens exactly once and in a thread safe manner.
+ */
+void ensureSocketsInitialized() {
+  struct WinsockInitializer {
+    WinsockInitializer() {
+      WSADATA data{};
+      if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        throw std::runtime_error("Failed to initialize Winsock.");
+      }
+    }
+    ~WinsockInitializer() { WSACleanup(); }
+  };
+  static const WinsockInitializer initializer;
+}
+
+void closeNativeSocket(NativeSocket socket_handle) noexcept {
+  closesocket(socket_handle);
+}
+
+const int kShutdownBoth = SD_BOTH;
+const int kShutdownReceive = SD_RECEIVE;
+#else
+using NativeSocket = int;
+
+void ensureSocketsInitialized() {
+  // Nothing to do on POSIX systems.
+}
+
+void closeNativeSocket(NativeSocket socket_handle) noexcept {
+  ::close(socket_handle);
+}
+
+const int kShutdownBoth = SHUT_RDWR;
+const int kShutdownReceive = SHUT_RD;
+#endif
+
+#ifdef MSG_NOSIGNAL
+// Writing to a socket whose peer has gone away must not raise SIGPIPE and kill the process.
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+NativeSocket toNative(intptr_t socket_handle) noexcept {
+  return static_cast<NativeSocket>(socket_handle);
+}
+
+/**
+ * @brief Denotes whether the last failed socket call was interrupted by a signal and can be retried
+ */
+bool wasInterrupted() noexcept {
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEINTR;
+#else
+  return errno == EINTR;
+#endif
+}
+
+/**
+ * @brief Waits until a socket has data to read, or the deadline passed
+ *
+ * @return `true` if data can be read, `false` if the deadline passed or waiting failed
+ */
+bool waitUntilReadable(
+    NativeSocket socket_handle, std::chrono::steady_clock::time_point deadline) noexcept {
+  while (true) {
+    const auto remaining =
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return false;
+    }
+#ifdef _WIN32
+    WSAPOLLFD descriptor{};
+    descriptor.fd = socket_handle;
+    descriptor.events = POLLRDNORM;
+    const int ready = WSAPoll(&descriptor, 1, static_cast<INT>(remaining.count()));
+#else
+    pollfd descriptor{};
+    descriptor.fd = socket_handle;
+    descriptor.events = POLLIN;
+    const int ready = ::poll(&descriptor, 1, static_cast<int>(remaining.count()));
+#endif
+    if (ready > 0) {
+      return true;
+    }
+    if (ready == 0 || !wasInterrupted()) {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief Sends an entire buffer, retrying on partial writes and interruptions
+ *
+ * @return `true` if all bytes were sent, `false` otherwise
+ */
+bool sendAll(NativeSocket socket_handle, const unsigned char* data, size_t size) noexcept {
+  while (size > 0) {
+    const auto sent = ::send(
+        socket_handle, reinterpret_cast<const char*>(data), static_cast<int>(size), kSendFlags);
+    if (sent < 0 && wasInterrupted()) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+/**
+ * @brief Receives exactly `size` bytes, retrying on partial reads and interruptions
+ *
+ * @param deadline The time by which all bytes must have arrived, if any
+ * @return `true` if all bytes were received, `false` if the connection was closed or failed, or
+ *         the deadline passed
+ */
+bool receiveAll(
+    NativeSocket socket_handle, unsigned char* data, size_t size,
+    const std::optional<std::chrono::steady_clock::time_point>& deadline) noexcept {
+  while (size > 0) {
+    if (deadline && !waitUntilReadable(socket_handle, *deadline)) {
+      return false;
+    }
+    const auto received =
+        ::recv(socket_handle, reinterpret_cast<char*>(data), static_cast<int>(size), 0);
+    if (received < 0 && wasInterrupted()) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    size -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+/**
+ * @brief Receives a length-prefixed message
+ *
+ * @param deadline The time by which the whole message must have arrived, if any
+ * @return `true` if a message was received, `false` if the connection was closed or failed, the
+ *         frame was too large, or the deadline passed
+ */
+bool receiveFrame(
+    NativeSocket socket_handle, std::vector<unsigned char>& payload,
+    const std::optional<std::chrono::steady_clock::time_point>& deadline) {
+  std::array<unsigned char, 4> header{};
+  if (!receiveAll(socket_handle, header.data(), header.size(), deadline)) {
+    return false;
+  }
+
+  uint32_t size = 0;
+  for (uint32_t idx = 0; idx < 4; ++idx) {
+    size |= static_cast<uint32_t>(header[idx]) << (8 * idx);
+  }
+  if (size > WireProtocol::kMaximumPayloadSize) {
+    return false;
+  }
+
+  payload.resize(size);
+  return receiveAll(socket_handle, payload.data(), payload.size(), deadline);
+}
+}  // namespace
+
+TcpConnection::TcpConnection(intptr_t socket_handle) noexcept
+  : socket_{socket_handle} {
+}
+
+TcpConnection::TcpConnection(TcpConnection&& other) noexcept
+  : socket_{other.socket_} {
+  other.socket_ = -1;
+}
+
+TcpConnection& TcpConnection::operator=(TcpConnection&& other) noexcept {
+  if (this != &other) {
+    close();
+    socket_ = other.socket_;
+    other.socket_ = -1;
+  }
+  return *this;
+}
+
+TcpConnection::~TcpConnection() {
+  close();
+}
+
+TcpConnection TcpConnection::connect(const std::string& host, uint16_t port) {
+  ensureSocketsInitialized();
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+
+  addrinfo* addresses = nullptr;
+  const std::string service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+    throw std::runtime_error("Unable to resolve host: " + host);
+  }
+
+  intptr_t connected = -1;
+  for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+    const NativeSocket socket_handle =
+        ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (static_cast<intptr_t>(socket_handle) < 0) {
+      continue;
+    }
+    if (::connect(socket_handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+      connected = static_cast<intptr_t>(socket_handle);
+      break;
+    }
+    closeNativeSocket(socket_handle);
+  }
+  freeaddrinfo(addresses);
+
+  if (connected < 0) {
+    throw std::runtime_error(
+        "Unable to connect to " + host + ":" + std::to_string(port) + ".");
+  }
+
+  // Messages are written as a header and a payload; don't let Nagle's algorithm hold back the
+  // second half of a frame.
+  const int no_delay = 1;
+  setsockopt(toNative(connected), IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+
+  return TcpConnection(connected);
+}
+
+bool TcpConnection::isOpen() const noexcept {
+  return socket_ >= 0;
+}
+
+bool TcpConnection::sendMessage(const std::vector<unsigned char>& payload) noexcept {
+  if (!isOpen() || payload.size() > WireProtocol::kMaximumPayloadSize) {
+    return false;
+  }
+
+  std::array<unsigned char, 4> header{};
+  const auto size = static_cast<uint32_t>(payload.size());
+  for (uint32_t idx = 0; idx < 4; ++idx) {
+    header[idx] = static_cast<unsigned char>((size >> (8 * idx)) & 0xffU);
+  }
+
+  return sendAll(toNative(socket_), header.data(), header.size()) &&
+         sendAll(toNative(socket_), payload.data(), payload.size());
+}
+
+bool TcpConnection::receiveMessage(std::vector<unsigned char>& payload) {
+  return isOpen() && receiveFrame(toNative(socket_), payload, std::nullopt);
+}
+
+bool TcpConnection::receiveMessage(
+    std::vector<unsigned char>& payload, std::chrono::milliseconds timeout) {
+  return isOpen() &&
+         receiveFrame(toNative(socket_), payload, std::chrono::steady_clock::now() + timeout);
+}
+
+void TcpConnection::shutdown() noexcept {
+  if (isOpen()) {
+    ::shutdown(toNative(socket_), kShutdownBoth);
+  }
+}
+
+void TcpConnection::shutdownReceive() noexcept {
+  if (isOpen()) {
+    ::shutdown(toNative(socket_), kShutdownReceive);
+  }
+}
+
+void TcpConnection::close() noexcept {
+  if (isOpen()) {
+    closeNativeSocket(toNative(socket_));
+    socket_ = -1;
+  }
+}
+
+TcpListener::TcpListener(uint16_t port, const std::string& bind_address) {
+  ensureSocketsInitialized();
+
+  const NativeSocket socket_handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (static_cast<intptr_t>(socket_handle) < 0) {
+    throw std::runtime_error("Unable to create listening socket.");
+  }
+
+  const int reuse = 1;
+  setsockopt(socket_handle, SOL_SOCKET, SO_REUSEADDR,
+             reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) {
+    closeNativeSocket(socket_handle);
+    throw std::invalid_argument("Invalid bind address: " + bind_address);
+  }
+
+  if (::bind(socket_handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      ::listen(socket_handle, SOMAXCONN) != 0) {
+    closeNativeSocket(socket_handle);
+    throw std::runtime_error("Unable to listen on port " + std::to_string(port) + ".");
+  }
+
+  socklen_t address_length = sizeof(address);
+  getsockname(socket_handle, reinterpret_cast<sockaddr*>(&address), &address_length);
+  port_ = ntohs(address.sin_port);
+  socket_ = static_cast<intptr_t>(socket_handle);
+}
+
+TcpListener::~TcpListener() {
+  closeNativeSocket(toNative(socket_));
+}
+
+uint16_t TcpListener::getPort() const noexcept {
+  return port_;
+}
+
+TcpConnection TcpListener::accept(std::chrono::milliseconds timeout) {
+#ifdef _WIN32
+  WSAPOLLFD descriptor{};
+  descriptor.fd = toNative(socket_);
+  descriptor.events = POLLRDNORM;
+  const int ready = WSAPoll(&descriptor, 1, static_cast<INT>(timeout.count()));
+#else
+  pollfd descriptor{};
+  descriptor.fd = toNative(socket_);
+  descriptor.events = POLLIN;
+  const int ready = ::poll(&descriptor, 1, static_cast<int>(timeout.count()));
+#endif
+  if (ready <= 0) {
+    return TcpConnection();
+  }
+
+  const NativeSocket accepted = ::accept(toNative(socket_), nullptr, nullptr);
+  if (static_cast<intptr_t>(accepted) < 0) {
+    return TcpConnection();
+  }
+
+  const int no_delay = 1;
+  setsockopt(accepted, IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+
+  return TcpConnection(static_cast<intptr_t>(accepted));
+}
+
+}  // namespace beast
@@ -0,0 +1,198 @@
+#include <beast/distributed/wire_protocol.hpp>
+
+// Standard
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Appends an unsigned integer in little endian byte order to a buffer
+ *
+ * @param buffer The buffer to append to
+ * @param value The value to append
+ * @param bytes The number of least significant bytes of `value` to append
+ */
+void appendLittleEndian(std::vector<unsigned char>& buffer, uint64_t value, uint32_t bytes) {
+  for (uint32_t idx = 0; idx < bytes; ++idx) {
+    buffer.push_back(static_cast<unsigned char>((value >> (8 * idx)) & 0xffU));
+  }
+}
+
+/**
+ * @brief Sequentially reads little endian values from a payload
+ *
+ * Every read is bounds checked; reading beyond the end of the payload throws.
+ */
+class PayloadReader {
+ public:
+  explicit PayloadReader(const std::vector<unsigned char>& payload)
+    : payload_{payload} {
+  }
+
+  uint64_t read(uint32_t bytes) {
+    if (bytes > payload_.size() - offset_) {
+      throw std::underflow_error("Message payload is truncated.");
+    }
+    uint64_t value = 0;
+    for (uint32_t idx = 0; idx < bytes; ++idx) {
+      value |= static_cast<uint64_t>(payload_[offset_ + idx]) << (8 * idx);
+    }
+    offset_ += bytes;
+    return value;
+  }
+
+  ProgramView viewBytes(size_t count) {
+    if (count > payload_.size() - offset_) {
+      throw std::underflow_error("Message payload is truncated.");
+    }
+    const ProgramView view(payload_.data() + offset_, count);
+    offset_ += count;
+    return view;
+  }
+
+ private:
+  const std::vector<unsigned char>& payload_;
+
+  size_t offset_ = 0;
+};
+
+/**
+ * @brief Throws if a payload is not of the expected message type
+ */
+void expectType(const std::vector<unsigned char>& payload, WireProtocol::MessageType type) {
+  if (WireProtocol::getMessageType(payload) != type) {
+    throw std::invalid_argument("Unexpected message type.");
+  }
+}
+}  // namespace
+
+WireProtocol::MessageType WireProtocol::getMessageType(const std::vector<unsigned char>& payload) {
+  if (payload.empty()) {
+    throw std::invalid_argument("Empty message payload.");
+  }
+
+  const auto type = static_cast<MessageType>(payload[0]);
+  switch (type) {
+  case MessageType::Hello:
+  case MessageType::EvaluateBatch:
+  case MessageType::BatchResults:
+  case MessageType::Goodbye:
+  case MessageType::Shutdown:
+    return type;
+  }
+
+  throw std::invalid_argument("Unknown message type: " + std::to_string(payload[0]));
+}
+
+std::vector<unsigned char> WireProtocol::encodeHello() {
+  std::vector<unsigned char> payload = encodeSignal(MessageType::Hello);
+  appendLittleEndian(payload, kVersion, 4);
+  return payload;
+}
+
+uint32_t WireProtocol::decodeHello(const std::vector<unsigned char>& payload) {
+  expectType(payload, MessageType::Hello);
+  PayloadReader reader(payload);
+  (void)reader.read(1);
+  return static_cast<uint32_t>(reader.read(4));
+}
+
+std::vector<unsigned char> WireProtocol::encodeBatch(const EvaluationBatch& batch) {
+  size_t total_size = 1 + 8 + 4;
+  for (const std::vector<unsigned char>& program : batch.programs) {
+    total_size += 4 + program.size();
+  }
+
+  std::vector<unsigned char> payload;
+  payload.reserve(total_size);
+  payload.push_back(static_cast<unsigned char>(MessageType::EvaluateBatch));
+  appendLittleEndian(payload, batch.batch_id, 8);
+  appendLittleEndian(payload, batch.programs.size(), 4);
+  for (const std::vector<unsigned char>& program : batch.programs) {
+    appendLittleEndian(payload, program.size(), 4);
+    payload.insert(payload.end(), program.begin(), program.end());
+  }
+
+  return payload;
+}
+
+WireProtocol::EvaluationBatch WireProtocol::decodeBatch(const std::vector<unsigned char>& payload) {
+  const EvaluationBatchView view = viewBatch(payload);
+  EvaluationBatch batch{view.batch_id, {}};
+  batch.programs.reserve(view.programs.size());
+  for (const ProgramView program : view.programs) {
+    batch.programs.emplace_back(program.begin(), program.end());
+  }
+
+  return batch;
+}
+
+WireProtocol::EvaluationBatchView WireProtocol::viewBatch(
+    const std::vector<unsigned char>& payload) {
+  expectType(payload, MessageType::EvaluateBatch);
+  PayloadReader reader(payload);
+  (void)reader.read(1);
+
+  EvaluationBatchView batch;
+  batch.batch_id = reader.read(8);
+  const auto count = static_cast<uint32_t>(reader.read(4));
+  // Every program needs at least its length prefix; this guards the reservation below against
+  // corrupt counts.
+  if (count > payload.size() / 4) {
+    throw std::underflow_error("Message payload is truncated.");
+  }
+  batch.programs.reserve(count);
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    const auto size = static_cast<size_t>(reader.read(4));
+    batch.programs.push_back(reader.viewBytes(size));
+  }
+
+  return batch;
+}
+
+std::vector<unsigned char> WireProtocol::encodeResults(const EvaluationResults& results) {
+  std::vector<unsigned char> payload;
+  payload.reserve(1 + 8 + 4 + 8 * results.scores.size());
+  payload.push_back(static_cast<unsigned char>(MessageType::BatchResults));
+  appendLittleEndian(payload, results.batch_id, 8);
+  appendLittleEndian(payload, results.scores.size(), 4);
+  for (const double score : results.scores) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &score, sizeof(bits));
+    appendLittleEndian(payload, bits, 8);
+  }
+
+  return payload;
+}
+
+WireProtocol::EvaluationResults WireProtocol::decodeResults(
+    const std::vector<unsigned char>& payload) {
+  expectType(payload, MessageType::BatchResults);
+  PayloadReader reader(payload);
+  (void)reader.read(1);
+
+  EvaluationResults results;
+  results.batch_id = reader.read(8);
+  const auto count = static_cast<uint32_t>(reader.read(4));
+  if (count > payload.size() / 8) {
+    throw std::underflow_error("Message payload is truncated.");
+  }
+  results.scores.reserve(count);
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    const uint64_t bits = reader.read(8);
+    double score = 0.0;
+    std::memcpy(&score, &bits, sizeof(score));
+    results.scores.push_back(score);
+  }
+
+  return results;
+}
+
+std::vector<unsigned char> WireProtocol::encodeSignal(MessageType type) {
+  return {static_cast<unsigned char>(type)};
+}
+
+}  // namespace beast
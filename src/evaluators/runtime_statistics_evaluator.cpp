@@ -4,7 +4,7 @@
 #include <stdexcept>
 
 // Internal
-#include <beast/cpu_virtual_machine.hpp>
+#include <beast/control_flow_graph.hpp>
 
 namespace beast {
 
@@ -36,23 +36,24 @@ double RuntimeStatisticsEvaluator::evaluate(const VmSession& session) {
   const double steps_executed_noop_fraction =
       static_cast<double>(steps_executed_noop) / static_cast<double>(steps_executed);
 
-  VmSession static_session = session;
-  static_session.reset();
-  CpuVirtualMachine virtual_machine;
-  virtual_machine.setSilent(true);
-  while (virtual_machine.step(static_session, true)) {
-    /* Do nothing, just execute the entirely program in a static manner. */
-  }
-  VmSession::RuntimeStatistics static_statistics = static_session.getRuntimeStatistics();
+  // The static analysis covers the whole program, regardless of how its execution was bounded.
+  const ControlFlowGraph graph(session.getProgramView(), session.getProgramEncoding());
 
   /* The number of operators present in the program. */
-  const uint32_t total_steps = static_statistics.steps_executed;
+  const size_t total_steps = graph.getInstructionCount();
   if (total_steps == 0) {
     // Not executing steps results in a zero score.
     return 0.0;
   }
   /* The number of noop operators present in the program. */
-  const uint32_t total_steps_noop = static_statistics.operator_executions[OpCode::NoOp];
+  size_t total_steps_noop = 0;
+  for (const ControlFlowGraph::BasicBlock& block : graph.getBlocks()) {
+    for (const InstructionDecoder::Instruction& instruction : block.instructions) {
+      if (instruction.opcode == OpCode::NoOp) {
+        ++total_steps_noop;
+      }
+    }
+  }
   /* The fraction of noop vs. all steps present in the program. We want this to be high. */
   const double total_steps_noop_fraction =
       static_cast<double>(total_steps_noop) / static_cast<double>(total_steps);
@@ -61,7 +62,7 @@ double RuntimeStatisticsEvaluator::evaluate(const VmSession& session) {
      statically present operator is only counted once. We want this to be high. */
   const double program_executed_fraction =
       static_cast<double>(dynamic_statistics.executed_indices.size()) /
-      static_cast<double>(static_statistics.executed_indices.size());
+      static_cast<double>(total_steps);
 
   /*
     In order to get to a good measure of efficiency in both, static program structure AND dynamic
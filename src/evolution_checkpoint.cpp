@@ -0,0 +1,180 @@
+#include <beast/evolution_checkpoint.hpp>
+
+// Standard
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Identifies checkpoint files
+ */
+const std::array<char, 8> kMagic = {'B', 'E', 'A', 'S', 'T', 'C', 'K', 'P'};
+
+/**
+ * @brief The version of the file format
+ */
+const uint32_t kFormatVersion = 1;
+
+/**
+ * @brief Reads differently if the file was written on a host with a different byte order
+ */
+const uint32_t kByteOrderMark = 0x01020304;
+
+/**
+ * @brief The fixed size header at the start of every checkpoint file
+ */
+struct FileHeader {
+  std::array<char, 8> magic;  ///< Always kMagic
+  uint32_t version;           ///< Always kFormatVersion
+  uint32_t byte_order_mark;   ///< Always kByteOrderMark
+  uint32_t generation;        ///< The number of completed generations
+  uint32_t random_seed;       ///< The seed of the run's random number generators
+  std::array<uint64_t, EvolutionCheckpoint::kSectionCount> counts;  ///< Records per section
+  uint64_t file_size;         ///< The size of the whole file, to detect truncation
+};
+
+/**
+ * @brief Locates a record in the blob; the index holds one per record, section by section
+ */
+struct IndexEntry {
+  uint64_t offset;  ///< The offset of the record's bytes from the start of the file
+  uint64_t size;    ///< The number of bytes
+  double score;     ///< The record's score
+};
+
+static_assert(sizeof(FileHeader) % alignof(IndexEntry) == 0, "Index must be aligned.");
+}  // namespace
+
+EvolutionCheckpoint::EvolutionCheckpoint(uint32_t generation, uint32_t random_seed)
+  : generation_{generation}, random_seed_{random_seed}, sections_(kSectionCount) {
+}
+
+void EvolutionCheckpoint::addRecord(
+    Section section, std::vector<unsigned char> data, double score) {
+  sections_[static_cast<size_t>(section)].push_back({std::move(data), score});
+}
+
+uint32_t EvolutionCheckpoint::getGeneration() const noexcept {
+  return generation_;
+}
+
+uint32_t EvolutionCheckpoint::getRandomSeed() const noexcept {
+  return random_seed_;
+}
+
+size_t EvolutionCheckpoint::getRecordCount(Section section) const noexcept {
+  return sections_[static_cast<size_t>(section)].size();
+}
+
+std::vector<unsigned char> EvolutionCheckpoint::serialize() const {
+  FileHeader header{};
+  header.magic = kMagic;
+  header.version = kFormatVersion;
+  header.byte_order_mark = kByteOrderMark;
+  header.generation = generation_;
+  header.random_seed = random_seed_;
+
+  size_t record_count = 0;
+  size_t blob_size = 0;
+  for (size_t section_idx = 0; section_idx < kSectionCount; ++section_idx) {
+    header.counts[section_idx] = sections_[section_idx].size();
+    record_count += sections_[section_idx].size();
+    for (const Record& record : sections_[section_idx]) {
+      blob_size += record.data.size();
+    }
+  }
+  const size_t blob_offset = sizeof(FileHeader) + record_count * sizeof(IndexEntry);
+  header.file_size = blob_offset + blob_size;
+
+  std::vector<unsigned char> buffer(header.file_size);
+  std::memcpy(buffer.data(), &header, sizeof(FileHeader));
+  size_t index_offset = sizeof(FileHeader);
+  size_t data_offset = blob_offset;
+  for (const std::vector<Record>& section : sections_) {
+    for (const Record& record : section) {
+      const IndexEntry entry{data_offset, record.data.size(), record.score};
+      std::memcpy(&buffer[index_offset], &entry, sizeof(IndexEntry));
+      if (!record.data.empty()) {
+        std::memcpy(&buffer[data_offset], record.data.data(), record.data.size());
+      }
+      index_offset += sizeof(IndexEntry);
+      data_offset += record.data.size();
+    }
+  }
+  return buffer;
+}
+
+void EvolutionCheckpoint::write(const std::string& path) const {
+  MappedFile::writeAtomically(path, serialize());
+}
+
+MappedEvolutionCheckpoint::MappedEvolutionCheckpoint(const std::string& path)
+  : file_{path}, data_{file_.getData()}, size_{file_.getSize()} {
+  FileHeader header{};
+  if (data_ != nullptr && size_ >= sizeof(FileHeader)) {
+    std::memcpy(&header, data_, sizeof(FileHeader));
+  }
+  uint64_t record_count = 0;
+  for (const uint64_t count : header.counts) {
+    record_count += count;
+  }
+  const bool valid = header.magic == kMagic && header.version == kFormatVersion &&
+                     header.byte_order_mark == kByteOrderMark && header.file_size == size_ &&
+                     record_count <= (size_ - sizeof(FileHeader)) / sizeof(IndexEntry);
+  if (!valid) {
+    throw std::runtime_error("Not a valid checkpoint: " + path);
+  }
+}
+
+uint32_t MappedEvolutionCheckpoint::getGeneration() const noexcept {
+  uint32_t generation = 0;
+  std::memcpy(&generation, data_ + offsetof(FileHeader, generation), sizeof(generation));
+  return generation;
+}
+
+uint32_t MappedEvolutionCheckpoint::getRandomSeed() const noexcept {
+  uint32_t random_seed = 0;
+  std::memcpy(&random_seed, data_ + offsetof(FileHeader, random_seed), sizeof(random_seed));
+  return random_seed;
+}
+
+size_t MappedEvolutionCheckpoint::getRecordCount(
+    EvolutionCheckpoint::Section section) const noexcept {
+  uint64_t count = 0;
+  std::memcpy(&count,
+              data_ + offsetof(FileHeader, counts) + static_cast<size_t>(section) * sizeof(count),
+              sizeof(count));
+  return static_cast<size_t>(count);
+}
+
+MappedEvolutionCheckpoint::Record MappedEvolutionCheckpoint::getRecord(
+    EvolutionCheckpoint::Section section, size_t index) const {
+  if (index >= getRecordCount(section)) {
+    throw std::out_of_range("Checkpoint record index out of range.");
+  }
+
+  size_t position = index;
+  for (size_t section_idx = 0; section_idx < static_cast<size_t>(section); ++section_idx) {
+    position += getRecordCount(static_cast<EvolutionCheckpoint::Section>(section_idx));
+  }
+  IndexEntry entry{};
+  std::memcpy(&entry, data_ + sizeof(FileHeader) + position * sizeof(IndexEntry),
+              sizeof(IndexEntry));
+  if (entry.offset > size_ || entry.size > size_ - entry.offset) {
+    throw std::runtime_error("Checkpoint record lies outside of the file.");
+  }
+  return {data_ + entry.offset, static_cast<size_t>(entry.size), entry.score};
+}
+
+std::vector<unsigned char> MappedEvolutionCheckpoint::copyRecord(
+    EvolutionCheckpoint::Section section, size_t index) const {
+  const Record record = getRecord(section, index);
+  return {record.data, record.data + record.size};
+}
+
+}  // namespace beast
@@ -0,0 +1,264 @@
+#include <beast/fitness_cache.hpp>
+
+// Standard
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Internal
+#include <beast/control_flow_graph.hpp>
+#include <beast/instruction_decoder.hpp>
+#include <beast/program_canonicalizer.hpp>
+
+namespace beast {
+
+namespace {
+const uint64_t kPrime1 = 0x9E3779B97F4A7C15ULL;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+uint64_t rotateLeft(uint64_t value, uint32_t places) noexcept {
+  return (value << places) | (value >> (64U - places));
+}
+
+/**
+ * @brief Finalizes a hash lane so that every input bit affects every output bit
+ */
+uint64_t mix(uint64_t value) noexcept {
+  value ^= value >> 30U;
+  value *= 0xBF58476D1CE4E5B9ULL;
+  value ^= value >> 27U;
+  value *= 0x94D049BB133111EBULL;
+  value ^= value >> 31U;
+  return value;
+}
+
+/**
+ * @brief Determines whether an instruction's result depends on anything but the program's state
+ */
+bool isNondeterministic(ProgramView program,
+                        const InstructionDecoder::Instruction& instruction) {
+  switch (instruction.opcode) {
+  case OpCode::LoadRandomValueIntoVariable:
+    return true;
+
+  case OpCode::PerformSystemCall:
+    // Major code 0 reads the clock; all other major codes are invalid and fail deterministically.
+    return static_cast<int8_t>(program[instruction.offset + 1]) == 0;
+
+  default:
+    return false;
+  }
+}
+}  // namespace
+
+FitnessCache::FitnessCache(size_t capacity, size_t shard_count) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Fitness cache capacity must be greater than zero.");
+  }
+  if (shard_count == 0) {
+    throw std::invalid_argument("Fitness cache shard count must be greater than zero.");
+  }
+
+  shard_capacity_ = std::max<size_t>(1, capacity / shard_count);
+  shards_.reserve(shard_count);
+  for (size_t idx = 0; idx < shard_count; ++idx) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+FitnessCache::Key FitnessCache::makeKey(ProgramView program, uint64_t configuration) noexcept {
+  // Two lanes with different multipliers yield 128 bits; both are seeded with the configuration.
+  uint64_t high = configuration ^ kPrime1;
+  uint64_t low = rotateLeft(configuration, 32U) ^ kPrime2;
+
+  const size_t size = program.getSize();
+  size_t offset = 0;
+  for (; offset + 8 <= size; offset += 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, program.getData() + offset, 8);
+    high = rotateLeft(high ^ (word * kPrime2), 31U) * kPrime1;
+    low = rotateLeft(low ^ (word * kPrime1), 27U) * kPrime2 + high;
+  }
+  if (offset < size) {
+    uint64_t word = 0;
+    std::memcpy(&word, program.getData() + offset, size - offset);
+    high = rotateLeft(high ^ (word * kPrime2), 31U) * kPrime1;
+    low = rotateLeft(low ^ (word * kPrime1), 27U) * kPrime2 + high;
+  }
+
+  high ^= static_cast<uint64_t>(size);
+  Key key;
+  key.high = mix(high ^ rotateLeft(low, 17U));
+  key.low = mix(low + key.high);
+  return key;
+}
+
+bool FitnessCache::isDeterministic(ProgramView program) {
+  std::vector<bool> instruction_starts(program.getSize(), false);
+  std::vector<int64_t> jump_targets;
+  bool jumps_to_variable_addresses = false;
+  size_t offset = 0;
+  while (offset < program.getSize()) {
+    const std::optional<InstructionDecoder::Instruction> instruction =
+        InstructionDecoder::decode(program, offset);
+    if (!instruction || isNondeterministic(program, *instruction)) {
+      return false;
+    }
+    instruction_starts[offset] = true;
+    const ControlFlowGraph::FlowType flow = ControlFlowGraph::getFlowType(instruction->opcode);
+    if (flow == ControlFlowGraph::FlowType::ConditionalVariableJump ||
+        flow == ControlFlowGraph::FlowType::VariableJump) {
+      jumps_to_variable_addresses = true;
+    } else if (const std::optional<int64_t> target =
+                   InstructionDecoder::getJumpTarget(program, *instruction)) {
+      jump_targets.push_back(*target);
+    }
+    offset += instruction->size;
+  }
+
+  const auto is_inside_instruction = [&program, &instruction_starts](int64_t target) {
+    return target > 0 && target < static_cast<int64_t>(program.getSize()) &&
+           !instruction_starts[static_cast<size_t>(target)];
+  };
+  if (!jumps_to_variable_addresses &&
+      std::none_of(jump_targets.begin(), jump_targets.end(), is_inside_instruction)) {
+    return true;
+  }
+
+  // Execution may continue in the middle of an instruction, where operand bytes are read as
+  // operators. Any offset may start an instruction then.
+  for (offset = 0; offset < program.getSize(); ++offset) {
+    if (instruction_starts[offset]) {
+      continue;
+    }
+    const std::optional<InstructionDecoder::Instruction> instruction =
+        InstructionDecoder::decode(program, offset);
+    if (instruction && isNondeterministic(program, *instruction)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FitnessCache::setAllowNondeterministic(bool allow) noexcept {
+  allow_nondeterministic_ = allow;
+}
+
+bool FitnessCache::getAllowNondeterministic() const noexcept {
+  return allow_nondeterministic_;
+}
+
+void FitnessCache::setCanonicalKeys(bool canonical) noexcept {
+  canonical_keys_ = canonical;
+}
+
+bool FitnessCache::getCanonicalKeys() const noexcept {
+  return canonical_keys_;
+}
+
+FitnessCache::Key FitnessCache::getKey(ProgramView program, uint64_t configuration) const {
+  return canonical_keys_ ? ProgramCanonicalizer::makeKey(program, configuration)
+                         : makeKey(program, configuration);
+}
+
+std::optional<FitnessCache::Key> FitnessCache::getCacheableKey(
+    ProgramView program, uint64_t configuration) const {
+  if (!isCacheable(program)) {
+    return std::nullopt;
+  }
+  return getKey(program, configuration);
+}
+
+std::optional<FitnessCache::Entry> FitnessCache::lookup(
+    ProgramView program, uint64_t configuration) {
+  if (const std::optional<Key> key = getCacheableKey(program, configuration)) {
+    return lookup(*key);
+  }
+  misses_++;
+  return std::nullopt;
+}
+
+std::optional<FitnessCache::Entry> FitnessCache::lookup(const Key& key) {
+  Shard& shard = getShard(key);
+  std::scoped_lock lock(shard.mutex);
+  const auto iterator = shard.index.find(key);
+  if (iterator == shard.index.end()) {
+    misses_++;
+    return std::nullopt;
+  }
+
+  // Move the entry to the front to mark it as most recently used.
+  shard.entries.splice(shard.entries.begin(), shard.entries, iterator->second);
+  hits_++;
+  return iterator->second->second;
+}
+
+bool FitnessCache::store(ProgramView program, uint64_t configuration, Entry entry) {
+  if (const std::optional<Key> key = getCacheableKey(program, configuration)) {
+    store(*key, std::move(entry));
+    return true;
+  }
+  return false;
+}
+
+void FitnessCache::store(const Key& key, Entry entry) {
+  Shard& shard = getShard(key);
+  std::scoped_lock lock(shard.mutex);
+  const auto iterator = shard.index.find(key);
+  if (iterator != shard.index.end()) {
+    iterator->second->second = std::move(entry);
+    shard.entries.splice(shard.entries.begin(), shard.entries, iterator->second);
+    return;
+  }
+
+  if (shard.entries.size() >= shard_capacity_) {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+  }
+  shard.entries.emplace_front(key, std::move(entry));
+  shard.index.emplace(key, shard.entries.begin());
+}
+
+void FitnessCache::clear() {
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    std::scoped_lock lock(shard->mutex);
+    shard->index.clear();
+    shard->entries.clear();
+  }
+  hits_ = 0;
+  misses_ = 0;
+}
+
+size_t FitnessCache::getSize() const {
+  size_t size = 0;
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    std::scoped_lock lock(shard->mutex);
+    size += shard->entries.size();
+  }
+  return size;
+}
+
+size_t FitnessCache::getCapacity() const noexcept {
+  return shard_capacity_ * shards_.size();
+}
+
+uint64_t FitnessCache::getHitCount() const noexcept {
+  return hits_;
+}
+
+uint64_t FitnessCache::getMissCount() const noexcept {
+  return misses_;
+}
+
+bool FitnessCache::isCacheable(ProgramView program) const {
+  return allow_nondeterministic_ || isDeterministic(program);
+}
+
+FitnessCache::Shard& FitnessCache::getShard(const Key& key) const noexcept {
+  // The high half selects the shard, so that the low half used by the maps stays well distributed.
+  return *shards_[key.high % shards_.size()];
+}
+
+}  // namespace beast
@@ -0,0 +1,279 @@
+#include <beast/fitness_case_runner.hpp>
+
+// Standard
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Internal
+#include <beast/opcodes.hpp>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Scores how close an actual output value is to the expected one
+ */
+double scoreOutput(int32_t actual, int32_t expected) {
+  const double distance =
+      std::fabs(static_cast<double>(actual) - static_cast<double>(expected));
+  return 1.0 / (1.0 + distance);
+}
+
+/**
+ * @brief Determines whether the next instruction of a session still belongs to the prologue
+ *
+ * The prologue consists of instructions that don't depend on inputs: NoOps, variable declarations,
+ * string table entries, and assignments to variables that are not input variables.
+ */
+bool isPrologueInstruction(VmSession& session, const std::vector<int32_t>& input_variables) {
+  const ProgramView program = session.getProgramView();
+  const int32_t pointer = session.getPointer();
+  if (static_cast<size_t>(pointer) >= program.getSize()) {
+    return false;
+  }
+
+  try {
+    switch (static_cast<OpCode>(program.getData1(pointer))) {
+    case OpCode::NoOp:
+    case OpCode::DeclareVariable:
+    case OpCode::SetStringTableEntry:
+      return true;
+
+    case OpCode::SetVariable: {
+      const int32_t variable_index = program.getData4(pointer + 1);
+      const bool follow_links = program.getData1(pointer + 5) != 0;
+      const int32_t target = session.getRealVariableIndex(variable_index, follow_links);
+      return std::find(input_variables.begin(), input_variables.end(), target) ==
+             input_variables.end();
+    }
+
+    default:
+      return false;
+    }
+  } catch (...) {
+    // Truncated instructions and unresolvable variables are left to the per case runs.
+    return false;
+  }
+}
+}  // namespace
+
+FitnessCaseTable::FitnessCaseTable(
+    std::vector<int32_t> input_variables, std::vector<int32_t> output_variables)
+  : input_variables_{std::move(input_variables)}, output_variables_{std::move(output_variables)} {
+}
+
+void FitnessCaseTable::addCase(
+    const std::vector<int32_t>& inputs, const std::vector<int32_t>& expected_outputs) {
+  if (inputs.size() != input_variables_.size()) {
+    throw std::invalid_argument("Number of inputs does not match number of input variables.");
+  }
+  if (expected_outputs.size() != output_variables_.size()) {
+    throw std::invalid_argument("Number of outputs does not match number of output variables.");
+  }
+  inputs_.insert(inputs_.end(), inputs.begin(), inputs.end());
+  expected_outputs_.insert(
+      expected_outputs_.end(), expected_outputs.begin(), expected_outputs.end());
+}
+
+size_t FitnessCaseTable::getCaseCount() const noexcept {
+  if (!output_variables_.empty()) {
+    return expected_outputs_.size() / output_variables_.size();
+  }
+  if (!input_variables_.empty()) {
+    return inputs_.size() / input_variables_.size();
+  }
+  return 0;
+}
+
+const std::vector<int32_t>& FitnessCaseTable::getInputVariables() const noexcept {
+  return input_variables_;
+}
+
+const std::vector<int32_t>& FitnessCaseTable::getOutputVariables() const noexcept {
+  return output_variables_;
+}
+
+int32_t FitnessCaseTable::getInput(size_t case_index, size_t input_index) const {
+  if (input_index >= input_variables_.size()) {
+    throw std::out_of_range("Input index out of range.");
+  }
+  return inputs_.at(case_index * input_variables_.size() + input_index);
+}
+
+int32_t FitnessCaseTable::getExpectedOutput(size_t case_index, size_t output_index) const {
+  if (output_index >= output_variables_.size()) {
+    throw std::out_of_range("Output index out of range.");
+  }
+  return expected_outputs_.at(case_index * output_variables_.size() + output_index);
+}
+
+ScoreMatrix::ScoreMatrix(size_t case_count, size_t output_count)
+  : case_count_{case_count}, output_count_{output_count},
+    scores_(case_count * output_count, 0.0), outputs_(case_count * output_count, 0) {
+}
+
+size_t ScoreMatrix::getCaseCount() const noexcept {
+  return case_count_;
+}
+
+size_t ScoreMatrix::getOutputCount() const noexcept {
+  return output_count_;
+}
+
+double ScoreMatrix::getScore(size_t case_index, size_t output_index) const {
+  return scores_[getIndex(case_index, output_index)];
+}
+
+int32_t ScoreMatrix::getOutput(size_t case_index, size_t output_index) const {
+  return outputs_[getIndex(case_index, output_index)];
+}
+
+void ScoreMatrix::setResult(size_t case_index, size_t output_index, int32_t output, double score) {
+  const size_t index = getIndex(case_index, output_index);
+  outputs_[index] = output;
+  scores_[index] = score;
+}
+
+double ScoreMatrix::getCaseScore(size_t case_index) const {
+  if (case_index >= case_count_) {
+    throw std::out_of_range("Case index out of range.");
+  }
+  if (output_count_ == 0) {
+    return 0.0;
+  }
+  const auto row_begin = scores_.begin() + static_cast<std::ptrdiff_t>(case_index * output_count_);
+  const auto row_end = row_begin + static_cast<std::ptrdiff_t>(output_count_);
+  return std::accumulate(row_begin, row_end, 0.0) / static_cast<double>(output_count_);
+}
+
+double ScoreMatrix::getMeanScore() const noexcept {
+  if (scores_.empty()) {
+    return 0.0;
+  }
+  return std::accumulate(scores_.begin(), scores_.end(), 0.0) / static_cast<double>(scores_.size());
+}
+
+const std::vector<double>& ScoreMatrix::getScores() const noexcept {
+  return scores_;
+}
+
+size_t ScoreMatrix::getIndex(size_t case_index, size_t output_index) const {
+  if (case_index >= case_count_ || output_index >= output_count_) {
+    throw std::out_of_range("Score matrix index out of range.");
+  }
+  return case_index * output_count_ + output_index;
+}
+
+FitnessCaseRunner::FitnessCaseRunner(VirtualMachine& virtual_machine)
+  : virtual_machine_{virtual_machine} {
+}
+
+ScoreMatrix FitnessCaseRunner::run(
+    const VmSession& prototype, const FitnessCaseTable& table, const CaseObserver& observer) {
+  return race(prototype, table, -std::numeric_limits<double>::infinity(), observer).scores;
+}
+
+FitnessCaseRunner::RaceResult FitnessCaseRunner::race(
+    const VmSession& prototype, const FitnessCaseTable& table, double threshold,
+    const CaseObserver& observer) {
+  const std::vector<int32_t>& input_variables = table.getInputVariables();
+  const std::vector<int32_t>& output_variables = table.getOutputVariables();
+
+  VmSession snapshot = prototype;
+  // Verifying once lets all cases execute the program without per-fetch bounds checks.
+  if (!snapshot.isProgramVerified()) {
+    snapshot.verifyProgram();
+  }
+  // All cases share the execution blocks of the snapshot.
+  snapshot.prepareBasicBlocks();
+  for (const int32_t variable_index : input_variables) {
+    snapshot.setVariableBehavior(variable_index, VmSession::VariableIoBehavior::Input);
+  }
+
+  // Execute the input independent prologue once; all cases continue from the resulting state.
+  prologue_steps_ = 0;
+  while (!snapshot.isAtEnd() && isPrologueInstruction(snapshot, input_variables)) {
+    try {
+      if (!virtual_machine_.step(snapshot, false)) {
+        break;
+      }
+    } catch (...) {
+      // Programs that throw are treated like programs that crashed.
+      snapshot.setExitedAbnormally();
+      break;
+    }
+    prologue_steps_++;
+  }
+
+  const size_t case_count = table.getCaseCount();
+  RaceResult result{ScoreMatrix(case_count, output_variables.size()), 0, false, 0.0};
+  double score_sum = 0.0;
+  for (size_t case_index = 0; case_index < case_count; ++case_index) {
+    // Assume that all remaining cases score perfectly.
+    const double remaining_cases = static_cast<double>(case_count - case_index);
+    const double upper_bound = (score_sum + remaining_cases) / static_cast<double>(case_count);
+    if (upper_bound < threshold) {
+      result.abandoned = true;
+      result.upper_bound = upper_bound;
+      return result;
+    }
+
+    VmSession session = snapshot;
+    // Restart the wall clock so that every case gets the full time budget.
+    session.setExecutionLimits(session.getExecutionLimits());
+    for (size_t input_index = 0; input_index < input_variables.size(); ++input_index) {
+      session.setVariableValue(
+          input_variables[input_index], true, table.getInput(case_index, input_index));
+    }
+
+    // A case ends when the program ends or waits for input that a batch run never provides.
+    while (!session.getRuntimeStatistics().abnormal_exit && !session.isAtEnd() &&
+           !session.isWaitingForInput()) {
+      try {
+        if (!virtual_machine_.stepBlock(session, false)) {
+          break;
+        }
+      } catch (...) {
+        session.setExitedAbnormally();
+      }
+    }
+
+    const VmSession::RuntimeStatistics& statistics = session.getRuntimeStatistics();
+    const bool failed = statistics.abnormal_exit || statistics.step_limit_exceeded ||
+                        statistics.time_limit_exceeded || statistics.print_limit_exceeded ||
+                        statistics.cancelled;
+    for (size_t output_index = 0; output_index < output_variables.size(); ++output_index) {
+      int32_t output = 0;
+      double score = 0.0;
+      try {
+        output = session.getVariableValue(output_variables[output_index], true);
+        if (!failed) {
+          score = scoreOutput(output, table.getExpectedOutput(case_index, output_index));
+        }
+      } catch (...) {
+        // Output variables the program never declared score 0.
+      }
+      result.scores.setResult(case_index, output_index, output, score);
+    }
+    if (!output_variables.empty()) {
+      score_sum += result.scores.getCaseScore(case_index);
+    }
+    result.cases_run++;
+
+    if (observer) {
+      observer(case_index, session);
+    }
+  }
+
+  result.upper_bound = result.scores.getMeanScore();
+  return result;
+}
+
+uint32_t FitnessCaseRunner::getPrologueSteps() const noexcept {
+  return prologue_steps_;
+}
+
+}  // namespace beast
@@ -0,0 +1,331 @@
+#include <beast/genetic_operators.hpp>
+
+// Standard
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+// Internal
+#include <beast/instruction_decoder.hpp>
+
+namespace beast {
+
+namespace {
+using Instruction = InstructionDecoder::Instruction;
+using OperandType = InstructionDecoder::OperandType;
+
+/**
+ * @brief Returns the offsets at which code can be cut without splitting an instruction
+ *
+ * These are the offsets of all decoded instructions, the end of the decodable part, and the end of
+ * the code (if there is an undecodable remainder).
+ */
+std::vector<size_t> getBoundaries(const std::vector<Instruction>& instructions, size_t code_size) {
+  std::vector<size_t> boundaries;
+  boundaries.reserve(instructions.size() + 2);
+  for (const Instruction& instruction : instructions) {
+    boundaries.push_back(instruction.offset);
+  }
+  const size_t decoded_end =
+      instructions.empty() ? 0 : instructions.back().offset + instructions.back().size;
+  boundaries.push_back(decoded_end);
+  if (decoded_end < code_size) {
+    boundaries.push_back(code_size);
+  }
+  return boundaries;
+}
+
+/**
+ * @brief Returns the boundary closest to the given address
+ */
+size_t snapToBoundary(int64_t address, const std::vector<size_t>& boundaries) {
+  const auto clamped = static_cast<size_t>(std::max<int64_t>(address, 0));
+  const auto iterator = std::lower_bound(boundaries.begin(), boundaries.end(), clamped);
+  if (iterator == boundaries.end()) {
+    return boundaries.back();
+  }
+  if (iterator == boundaries.begin() || *iterator == clamped) {
+    return *iterator;
+  }
+  const size_t previous = *(iterator - 1);
+  return clamped - previous <= *iterator - clamped ? previous : *iterator;
+}
+
+/**
+ * @brief Draws a uniformly distributed index in the range [0, count)
+ */
+size_t drawIndex(size_t count, std::mt19937& rng) {
+  return std::uniform_int_distribution<size_t>(0, count - 1)(rng);
+}
+
+/**
+ * @brief Relocates the constant jump targets of a code segment that was copied into another program
+ *
+ * Targets within the segment (including its end) move along with it; all others are moved by the
+ * same displacement and then snapped to the closest boundary of the destination.
+ */
+void relocateSegment(
+    std::vector<unsigned char>& destination, const std::vector<size_t>& destination_boundaries,
+    const std::vector<unsigned char>& source, const std::vector<Instruction>& source_instructions,
+    size_t source_begin, size_t source_end, size_t destination_begin) {
+  const int64_t displacement =
+      static_cast<int64_t>(destination_begin) - static_cast<int64_t>(source_begin);
+  for (const Instruction& instruction : source_instructions) {
+    if (instruction.offset < source_begin || instruction.offset + instruction.size > source_end) {
+      continue;
+    }
+    const std::optional<int64_t> target = InstructionDecoder::getJumpTarget(source, instruction);
+    if (!target) {
+      continue;
+    }
+
+    int64_t new_target = *target + displacement;
+    if (*target < static_cast<int64_t>(source_begin) || *target > static_cast<int64_t>(source_end)) {
+      new_target = static_cast<int64_t>(snapToBoundary(new_target, destination_boundaries));
+    }
+    Instruction moved = instruction;
+    moved.offset = static_cast<size_t>(static_cast<int64_t>(instruction.offset) + displacement);
+    InstructionDecoder::setJumpTarget(destination, moved, new_target);
+  }
+}
+
+/**
+ * @brief Joins the head of one program and the tail of another, relocating jumps of both parts
+ */
+std::vector<unsigned char> joinAtBoundaries(
+    const std::vector<unsigned char>& head, const std::vector<Instruction>& head_instructions,
+    size_t head_end, const std::vector<unsigned char>& tail,
+    const std::vector<Instruction>& tail_instructions, size_t tail_begin) {
+  std::vector<unsigned char> child;
+  child.reserve(head_end + tail.size() - tail_begin);
+  child.insert(child.end(), head.begin(), head.begin() + static_cast<std::ptrdiff_t>(head_end));
+  child.insert(child.end(), tail.begin() + static_cast<std::ptrdiff_t>(tail_begin), tail.end());
+
+  const std::vector<size_t> boundaries =
+      getBoundaries(InstructionDecoder::decodeAll(child), child.size());
+  relocateSegment(child, boundaries, head, head_instructions, 0, head_end, 0);
+  relocateSegment(child, boundaries, tail, tail_instructions, tail_begin, tail.size(), head_end);
+  return child;
+}
+
+/**
+ * @brief Clamps a widened operand value back into `[minimum, INT32_MAX]`
+ *
+ * Operand arithmetic is done in 64 bits so that values near the limits saturate instead of
+ * overflowing.
+ */
+int32_t clampToInt32(int64_t value, int32_t minimum) noexcept {
+  return static_cast<int32_t>(std::clamp<int64_t>(
+      value, minimum, std::numeric_limits<int32_t>::max()));
+}
+
+/**
+ * @brief Modifies a random operand of an instruction according to the operand's type
+ *
+ * @return Whether an operand was modified (instructions without operands are left untouched)
+ */
+bool mutateOperand(
+    std::vector<unsigned char>& code, const Instruction& instruction,
+    const std::vector<size_t>& boundaries, std::mt19937& rng) {
+  const std::vector<OperandType>& types = InstructionDecoder::getOperandTypes(instruction.opcode);
+  if (types.empty()) {
+    return false;
+  }
+
+  const size_t operand_index = drawIndex(types.size(), rng);
+  size_t offset = instruction.offset + 1;
+  for (size_t idx = 0; idx < operand_index; ++idx) {
+    if (types[idx] == OperandType::String) {
+      int16_t length = 0;
+      std::memcpy(&length, &code[offset], 2);
+      offset += static_cast<size_t>(length);
+    }
+    offset += InstructionDecoder::getOperandSize(types[idx]);
+  }
+
+  int32_t value = 0;
+  switch (types[operand_index]) {
+  case OperandType::Flag: {
+    code[offset] = code[offset] != 0 ? 0x0 : 0x1;
+  } break;
+
+  case OperandType::Variable:
+  case OperandType::StringTableIndex: {
+    // Nudge indices, as far-off indices are most likely outside of the available memory.
+    static const std::array<int32_t, 4> kDeltas = {-2, -1, 1, 2};
+    std::memcpy(&value, &code[offset], 4);
+    value = clampToInt32(
+        static_cast<int64_t>(value) + kDeltas[drawIndex(kDeltas.size(), rng)], 0);
+    std::memcpy(&code[offset], &value, 4);
+  } break;
+
+  case OperandType::Constant4: {
+    std::memcpy(&value, &code[offset], 4);
+    if (std::bernoulli_distribution(0.5)(rng)) {
+      value = clampToInt32(
+          static_cast<int64_t>(value) + std::uniform_int_distribution<int32_t>(-8, 8)(rng),
+          std::numeric_limits<int32_t>::min());
+    } else {
+      value = std::uniform_int_distribution<int32_t>(
+          std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())(rng);
+    }
+    std::memcpy(&code[offset], &value, 4);
+  } break;
+
+  case OperandType::Constant1: {
+    if (instruction.opcode == OpCode::DeclareVariable) {
+      // Only Int32 (0) and Link (1) are valid variable types.
+      code[offset] ^= 0x1U;
+    } else {
+      code[offset] = static_cast<unsigned char>(std::uniform_int_distribution<int>(0, 255)(rng));
+    }
+  } break;
+
+  case OperandType::AbsoluteAddress:
+  case OperandType::RelativeAddress: {
+    InstructionDecoder::setJumpTarget(
+        code, instruction, static_cast<int64_t>(boundaries[drawIndex(boundaries.size(), rng)]));
+  } break;
+
+  case OperandType::String: {
+    int16_t length = 0;
+    std::memcpy(&length, &code[offset], 2);
+    if (length <= 0) {
+      return false;
+    }
+    code[offset + 2 + drawIndex(static_cast<size_t>(length), rng)] =
+        static_cast<unsigned char>(std::uniform_int_distribution<int>(33, 126)(rng));
+  } break;
+  }
+
+  return true;
+}
+}  // namespace
+
+std::pair<std::vector<unsigned char>, std::vector<unsigned char>> GeneticOperators::crossOver(
+    const std::vector<unsigned char>& mother, const std::vector<unsigned char>& father,
+    std::mt19937& rng) {
+  const std::vector<Instruction> mother_instructions = InstructionDecoder::decodeAll(mother);
+  const std::vector<Instruction> father_instructions = InstructionDecoder::decodeAll(father);
+  const std::vector<size_t> mother_boundaries = getBoundaries(mother_instructions, mother.size());
+  const std::vector<size_t> father_boundaries = getBoundaries(father_instructions, father.size());
+  const size_t mother_cut = mother_boundaries[drawIndex(mother_boundaries.size(), rng)];
+  const size_t father_cut = father_boundaries[drawIndex(father_boundaries.size(), rng)];
+
+  return {joinAtBoundaries(mother, mother_instructions, mother_cut,
+                           father, father_instructions, father_cut),
+          joinAtBoundaries(father, father_instructions, father_cut,
+                           mother, mother_instructions, mother_cut)};
+}
+
+uint32_t GeneticOperators::mutate(
+    std::vector<unsigned char>& code, double probability, std::mt19937& rng) {
+  if (probability <= 0.0 || code.empty()) {
+    return 0;
+  }
+
+  enum class Mutation { None, Operand, Removal, Duplication };
+  std::bernoulli_distribution mutation_chance(std::min(probability, 1.0));
+  // Operand mutations are drawn twice as often as structural ones.
+  std::discrete_distribution<int> mutation_kind({2.0, 1.0, 1.0});
+  const auto draw_mutation = [&]() {
+    if (!mutation_chance(rng)) {
+      return Mutation::None;
+    }
+    return static_cast<Mutation>(mutation_kind(rng) + 1);
+  };
+
+  const std::vector<Instruction> instructions = InstructionDecoder::decodeAll(code);
+  const size_t decoded_end =
+      instructions.empty() ? 0 : instructions.back().offset + instructions.back().size;
+
+  // Rebuild the code with removed and duplicated instructions, and record where every old
+  // instruction boundary ended up. Boundaries of removed instructions map to their successor.
+  std::vector<unsigned char> result;
+  result.reserve(code.size() + code.size() / 4);
+  std::vector<int64_t> new_boundaries(code.size() + 1, -1);
+  std::vector<size_t> unmapped_boundaries;
+  std::vector<std::pair<size_t, Instruction>> copies;
+  std::vector<size_t> operand_mutations;
+  uint32_t mutations = 0;
+
+  const auto map_boundary = [&](size_t old_offset) {
+    new_boundaries[old_offset] = static_cast<int64_t>(result.size());
+    for (const size_t unmapped : unmapped_boundaries) {
+      new_boundaries[unmapped] = static_cast<int64_t>(result.size());
+    }
+    unmapped_boundaries.clear();
+  };
+  const auto copy_instruction = [&](const Instruction& instruction) {
+    copies.emplace_back(result.size(), instruction);
+    const auto begin = code.begin() + static_cast<std::ptrdiff_t>(instruction.offset);
+    result.insert(result.end(), begin, begin + static_cast<std::ptrdiff_t>(instruction.size));
+  };
+
+  for (const Instruction& instruction : instructions) {
+    const Mutation mutation = draw_mutation();
+    if (mutation == Mutation::Removal) {
+      unmapped_boundaries.push_back(instruction.offset);
+      mutations++;
+      continue;
+    }
+
+    map_boundary(instruction.offset);
+    copy_instruction(instruction);
+    if (mutation == Mutation::Operand) {
+      operand_mutations.push_back(copies.size() - 1);
+    } else if (mutation == Mutation::Duplication) {
+      copy_instruction(instruction);
+      mutations++;
+    }
+  }
+
+  // The undecodable remainder is kept as it is, apart from an occasional random byte.
+  map_boundary(decoded_end);
+  const size_t tail_begin = result.size();
+  result.insert(result.end(), code.begin() + static_cast<std::ptrdiff_t>(decoded_end), code.end());
+  new_boundaries[code.size()] = static_cast<int64_t>(result.size());
+  if (decoded_end < code.size() && mutation_chance(rng)) {
+    result[tail_begin + drawIndex(code.size() - decoded_end, rng)] =
+        static_cast<unsigned char>(std::uniform_int_distribution<int>(0, 255)(rng));
+    mutations++;
+  }
+
+  // Relocate jumps. Targets that didn't point at a boundary before keep their absolute address.
+  for (const auto& [new_offset, instruction] : copies) {
+    const std::optional<int64_t> target = InstructionDecoder::getJumpTarget(code, instruction);
+    if (!target) {
+      continue;
+    }
+    int64_t new_target = *target;
+    if (*target >= 0 && *target <= static_cast<int64_t>(code.size()) &&
+        new_boundaries[static_cast<size_t>(*target)] >= 0) {
+      new_target = new_boundaries[static_cast<size_t>(*target)];
+    }
+    Instruction moved = instruction;
+    moved.offset = new_offset;
+    InstructionDecoder::setJumpTarget(result, moved, new_target);
+  }
+
+  if (!operand_mutations.empty()) {
+    std::vector<Instruction> result_instructions;
+    result_instructions.reserve(copies.size());
+    for (const auto& [new_offset, instruction] : copies) {
+      Instruction moved = instruction;
+      moved.offset = new_offset;
+      result_instructions.push_back(moved);
+    }
+    const std::vector<size_t> boundaries = getBoundaries(result_instructions, result.size());
+    for (const size_t index : operand_mutations) {
+      if (mutateOperand(result, result_instructions[index], boundaries, rng)) {
+        mutations++;
+      }
+    }
+  }
+
+  code = std::move(result);
+  return mutations;
+}
+
+}  // namespace beast
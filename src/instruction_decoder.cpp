@@ -0,0 +1,263 @@
+#include <beast/instruction_decoder.hpp>
+
+// Standard
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace beast {
+
+namespace {
+using OperandType = InstructionDecoder::OperandType;
+
+const auto kOperatorCount = static_cast<size_t>(OpCode::Size);
+
+/**
+ * @brief Builds the operand layouts of all operators, indexed by OpCode
+ *
+ * The layouts mirror the encoding of the respective Program member functions.
+ */
+std::array<std::vector<OperandType>, kOperatorCount> makeOperandTable() {
+  const OperandType V = OperandType::Variable;
+  const OperandType F = OperandType::Flag;
+  const OperandType C4 = OperandType::Constant4;
+  const OperandType C1 = OperandType::Constant1;
+  const OperandType S = OperandType::StringTableIndex;
+  const OperandType A = OperandType::AbsoluteAddress;
+  const OperandType R = OperandType::RelativeAddress;
+  const OperandType T = OperandType::String;
+
+  std::array<std::vector<OperandType>, kOperatorCount> table;
+  const auto set = [&table](OpCode opcode, std::vector<OperandType> operands) {
+    table[static_cast<size_t>(opcode)] = std::move(operands);
+  };
+
+  // Misc
+  set(OpCode::NoOp, {});
+  set(OpCode::LoadMemorySizeIntoVariable, {V, F});
+  set(OpCode::LoadCurrentAddressIntoVariable, {V, F});
+  set(OpCode::Terminate, {C1});
+  set(OpCode::TerminateWithVariableReturnCode, {V, F});
+  set(OpCode::PerformSystemCall, {C1, C1, V, F});
+  set(OpCode::LoadRandomValueIntoVariable, {V, F});
+
+  // Variable management
+  set(OpCode::DeclareVariable, {V, C1});
+  set(OpCode::SetVariable, {V, F, C4});
+  set(OpCode::UndeclareVariable, {V});
+  set(OpCode::CopyVariable, {V, F, V, F});
+  set(OpCode::SwapVariables, {V, F, V, F});
+
+  // Math
+  set(OpCode::AddConstantToVariable, {V, F, C4});
+  set(OpCode::AddVariableToVariable, {V, F, V, F});
+  set(OpCode::SubtractConstantFromVariable, {V, F, C4});
+  set(OpCode::SubtractVariableFromVariable, {V, F, V, F});
+  set(OpCode::CompareIfVariableGtConstant, {V, F, C4, V, F});
+  set(OpCode::CompareIfVariableLtConstant, {V, F, C4, V, F});
+  set(OpCode::CompareIfVariableEqConstant, {V, F, C4, V, F});
+  set(OpCode::CompareIfVariableGtVariable, {V, F, V, F, V, F});
+  set(OpCode::CompareIfVariableLtVariable, {V, F, V, F, V, F});
+  set(OpCode::CompareIfVariableEqVariable, {V, F, V, F, V, F});
+  set(OpCode::GetMaxOfVariableAndConstant, {V, F, C4, V, F});
+  set(OpCode::GetMinOfVariableAndConstant, {V, F, C4, V, F});
+  set(OpCode::GetMaxOfVariableAndVariable, {V, F, V, F, V, F});
+  set(OpCode::GetMinOfVariableAndVariable, {V, F, V, F, V, F});
+  set(OpCode::ModuloVariableByConstant, {V, F, C4});
+  set(OpCode::ModuloVariableByVariable, {V, F, V, F});
+
+  // Bit manipulation
+  set(OpCode::BitShiftVariableLeft, {V, F, C1});
+  set(OpCode::BitShiftVariableRight, {V, F, C1});
+  set(OpCode::BitWiseInvertVariable, {V, F});
+  set(OpCode::BitWiseAndTwoVariables, {V, F, V, F});
+  set(OpCode::BitWiseOrTwoVariables, {V, F, V, F});
+  set(OpCode::BitWiseXorTwoVariables, {V, F, V, F});
+  set(OpCode::RotateVariableLeft, {V, F, C1});
+  set(OpCode::RotateVariableRight, {V, F, C1});
+  set(OpCode::VariableBitShiftVariableLeft, {V, F, V, F});
+  set(OpCode::VariableBitShiftVariableRight, {V, F, V, F});
+  set(OpCode::VariableRotateVariableLeft, {V, F, V, F});
+  set(OpCode::VariableRotateVariableRight, {V, F, V, F});
+
+  // Jumps
+  set(OpCode::RelativeJumpToVariableAddressIfVariableGt0, {V, F, V, F});
+  set(OpCode::RelativeJumpToVariableAddressIfVariableLt0, {V, F, V, F});
+  set(OpCode::RelativeJumpToVariableAddressIfVariableEq0, {V, F, V, F});
+  set(OpCode::AbsoluteJumpToVariableAddressIfVariableGt0, {V, F, V, F});
+  set(OpCode::AbsoluteJumpToVariableAddressIfVariableLt0, {V, F, V, F});
+  set(OpCode::AbsoluteJumpToVariableAddressIfVariableEq0, {V, F, V, F});
+  set(OpCode::RelativeJumpIfVariableGt0, {V, F, R});
+  set(OpCode::RelativeJumpIfVariableLt0, {V, F, R});
+  set(OpCode::RelativeJumpIfVariableEq0, {V, F, R});
+  set(OpCode::AbsoluteJumpIfVariableGt0, {V, F, A});
+  set(OpCode::AbsoluteJumpIfVariableLt0, {V, F, A});
+  set(OpCode::AbsoluteJumpIfVariableEq0, {V, F, A});
+  set(OpCode::UnconditionalJumpToAbsoluteAddress, {A});
+  set(OpCode::UnconditionalJumpToAbsoluteVariableAddress, {V, F});
+  set(OpCode::UnconditionalJumpToRelativeAddress, {R});
+  set(OpCode::UnconditionalJumpToRelativeVariableAddress, {V, F});
+
+  // I/O
+  set(OpCode::CheckIfVariableIsInput, {V, F, V, F});
+  set(OpCode::CheckIfVariableIsOutput, {V, F, V, F});
+  set(OpCode::LoadInputCountIntoVariable, {V, F});
+  set(OpCode::LoadOutputCountIntoVariable, {V, F});
+  set(OpCode::CheckIfInputWasSet, {V, F, V, F});
+
+  // Printing and string table
+  set(OpCode::PrintVariable, {V, F, F});
+  set(OpCode::SetStringTableEntry, {S, T});
+  set(OpCode::PrintStringFromStringTable, {S});
+  set(OpCode::LoadStringTableLimitIntoVariable, {V, F});
+  set(OpCode::LoadStringTableItemLengthLimitIntoVariable, {V, F});
+  set(OpCode::SetVariableStringTableEntry, {V, F, T});
+  set(OpCode::PrintVariableStringFromStringTable, {V, F});
+  set(OpCode::LoadVariableStringItemLengthIntoVariable, {V, F, V, F});
+  set(OpCode::LoadVariableStringItemIntoVariables, {V, F, V, F});
+  set(OpCode::LoadStringItemLengthIntoVariable, {S, V, F});
+  set(OpCode::LoadStringItemIntoVariables, {S, V, F});
+
+  // Stack
+  set(OpCode::PushVariableOnStack, {V, F, V, F});
+  set(OpCode::PushConstantOnStack, {V, F, C4});
+  set(OpCode::PopVariableFromStack, {V, F, V, F});
+  set(OpCode::PopTopItemFromStack, {V, F});
+  set(OpCode::CheckIfStackIsEmpty, {V, F, V, F});
+
+  return table;
+}
+
+/**
+ * @brief Returns the operand layouts of all operators, building them on first use
+ */
+const std::array<std::vector<OperandType>, kOperatorCount>& getOperandTable() {
+  static const std::array<std::vector<OperandType>, kOperatorCount> table = makeOperandTable();
+  return table;
+}
+
+int32_t readData4(ProgramView code, size_t offset) {
+  int32_t data = 0;
+  std::memcpy(&data, code.getData() + offset, 4);
+  return data;
+}
+
+void writeData4(std::vector<unsigned char>& code, size_t offset, int32_t data) {
+  std::memcpy(&code[offset], &data, 4);
+}
+}  // namespace
+
+const std::vector<InstructionDecoder::OperandType>& InstructionDecoder::getOperandTypes(
+    OpCode opcode) {
+  const auto index = static_cast<size_t>(static_cast<uint8_t>(opcode));
+  if (index >= kOperatorCount) {
+    throw std::invalid_argument("Unknown operator.");
+  }
+  return getOperandTable()[index];
+}
+
+size_t InstructionDecoder::getOperandSize(OperandType type) noexcept {
+  switch (type) {
+  case OperandType::Flag:
+  case OperandType::Constant1:
+    return 1;
+
+  case OperandType::String:
+    return 2;
+
+  default:
+    return 4;
+  }
+}
+
+bool InstructionDecoder::isKnownOpCode(unsigned char byte) noexcept {
+  return byte < kOperatorCount;
+}
+
+std::optional<InstructionDecoder::Instruction> InstructionDecoder::decode(
+    ProgramView code, size_t offset) noexcept {
+  if (offset >= code.getSize() || !isKnownOpCode(code[offset])) {
+    return std::nullopt;
+  }
+
+  Instruction instruction;
+  instruction.offset = offset;
+  instruction.opcode = static_cast<OpCode>(code[offset]);
+  size_t size = 1;
+  for (const OperandType type : getOperandTable()[code[offset]]) {
+    const size_t operand_size = getOperandSize(type);
+    if (offset + size + operand_size > code.getSize()) {
+      return std::nullopt;
+    }
+    if (type == OperandType::String) {
+      int16_t length = 0;
+      std::memcpy(&length, code.getData() + offset + size, 2);
+      if (length < 0) {
+        return std::nullopt;
+      }
+      size += static_cast<size_t>(length);
+    }
+    size += operand_size;
+  }
+  if (offset + size > code.getSize()) {
+    return std::nullopt;
+  }
+
+  instruction.size = size;
+  return instruction;
+}
+
+std::vector<InstructionDecoder::Instruction> InstructionDecoder::decodeAll(ProgramView code) {
+  std::vector<Instruction> instructions;
+  size_t offset = 0;
+  while (const std::optional<Instruction> instruction = decode(code, offset)) {
+    instructions.push_back(*instruction);
+    offset += instruction->size;
+  }
+  return instructions;
+}
+
+std::optional<size_t> InstructionDecoder::getOperandOffset(
+    ProgramView code, const Instruction& instruction, OperandType type) {
+  size_t offset = instruction.offset + 1;
+  for (const OperandType operand_type : getOperandTypes(instruction.opcode)) {
+    if (operand_type == type) {
+      return offset;
+    }
+    if (operand_type == OperandType::String) {
+      int16_t length = 0;
+      std::memcpy(&length, code.getData() + offset, 2);
+      offset += static_cast<size_t>(length);
+    }
+    offset += getOperandSize(operand_type);
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> InstructionDecoder::getJumpTarget(
+    ProgramView code, const Instruction& instruction) {
+  if (const std::optional<size_t> offset =
+          getOperandOffset(code, instruction, OperandType::AbsoluteAddress)) {
+    return readData4(code, *offset);
+  }
+  if (const std::optional<size_t> offset =
+          getOperandOffset(code, instruction, OperandType::RelativeAddress)) {
+    return static_cast<int64_t>(instruction.offset + instruction.size) + readData4(code, *offset);
+  }
+  return std::nullopt;
+}
+
+void InstructionDecoder::setJumpTarget(
+    std::vector<unsigned char>& code, const Instruction& instruction, int64_t target) {
+  if (const std::optional<size_t> offset =
+          getOperandOffset(code, instruction, OperandType::AbsoluteAddress)) {
+    writeData4(code, *offset, static_cast<int32_t>(target));
+  } else if (const std::optional<size_t> offset =
+                 getOperandOffset(code, instruction, OperandType::RelativeAddress)) {
+    writeData4(
+        code, *offset,
+        static_cast<int32_t>(target - static_cast<int64_t>(instruction.offset + instruction.size)));
+  }
+}
+
+}  // namespace beast
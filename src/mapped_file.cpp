@@ -0,0 +1,127 @@
+#include <beast/mapped_file.hpp>
+
+// Standard
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace beast {
+
+namespace {
+#ifndef _WIN32
+/**
+ * @brief Writes an entire buffer to a file descriptor, retrying on partial writes
+ *
+ * @return `true` if all bytes were written, `false` otherwise
+ */
+bool writeAll(int file_descriptor, const unsigned char* data, size_t size) noexcept {
+  while (size > 0) {
+    const ssize_t written = ::write(file_descriptor, data, size);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+#endif
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Unable to open file: " + path);
+  }
+  buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  data_ = buffer_.empty() ? nullptr : buffer_.data();
+  size_ = buffer_.size();
+#else
+  const int file_descriptor = ::open(path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    throw std::runtime_error("Unable to open file: " + path);
+  }
+  struct stat file_status {};
+  if (::fstat(file_descriptor, &file_status) != 0) {
+    ::close(file_descriptor);
+    throw std::runtime_error("Unable to inspect file: " + path);
+  }
+  size_ = static_cast<size_t>(file_status.st_size);
+  if (size_ > 0) {
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(file_descriptor);
+      throw std::runtime_error("Unable to map file: " + path);
+    }
+    data_ = static_cast<const unsigned char*>(mapping);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  ::close(file_descriptor);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (data_ != nullptr) {
+    ::munmap(const_cast<unsigned char*>(data_), size_);
+  }
+#endif
+}
+
+const unsigned char* MappedFile::getData() const noexcept {
+  return data_;
+}
+
+size_t MappedFile::getSize() const noexcept {
+  return size_;
+}
+
+void MappedFile::writeAtomically(const std::string& path, const std::vector<unsigned char>& data) {
+  const std::string temporary_path = path + ".tmp";
+
+#ifdef _WIN32
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    file.flush();
+    if (!file) {
+      throw std::runtime_error("Unable to write file: " + temporary_path);
+    }
+  }
+  if (MoveFileExA(temporary_path.c_str(), path.c_str(),
+                  MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == 0) {
+    throw std::runtime_error("Unable to replace file: " + path);
+  }
+#else
+  const int file_descriptor = ::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file_descriptor < 0) {
+    throw std::runtime_error("Unable to create file: " + temporary_path);
+  }
+  // The data must be on disk before the rename makes it visible under the target name.
+  const bool written =
+      writeAll(file_descriptor, data.data(), data.size()) && ::fsync(file_descriptor) == 0;
+  ::close(file_descriptor);
+  if (!written) {
+    std::remove(temporary_path.c_str());
+    throw std::runtime_error("Unable to write file: " + temporary_path);
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    throw std::runtime_error("Unable to replace file: " + path);
+  }
+#endif
+}
+
+}  // namespace beast
@@ -0,0 +1,158 @@
+#include <beast/message_sink.hpp>
+
+// Standard
+#include <ctime>
+#include <stdexcept>
+
+// Internal
+#include <beast/time_functions.hpp>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Returns the formatted local time of a time point, formatting only once per second
+ */
+const std::string& getTimestamp(std::chrono::system_clock::time_point time) {
+  thread_local std::time_t cached_time = 0;
+  thread_local std::string cached_timestamp;
+
+  const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+  if (seconds != cached_time || cached_timestamp.empty()) {
+    char timestamp_buffer[100];
+    struct tm result{};
+    const size_t timestamp_length =
+        std::strftime(timestamp_buffer, sizeof(timestamp_buffer), "%F %T",
+                      localtime_r(&seconds, &result));
+    cached_timestamp.assign(timestamp_buffer, timestamp_length);
+    cached_time = seconds;
+  }
+  return cached_timestamp;
+}
+
+/**
+ * @brief Number of empty polls after which the drain thread starts sleeping between polls
+ */
+const uint32_t kSpinPolls = 64;
+}  // namespace
+
+ConsoleMessageSink::ConsoleMessageSink(std::ostream& out_stream) : out_stream_{out_stream} {
+}
+
+void ConsoleMessageSink::write(
+    VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+    const std::string& message) noexcept {
+  try {
+    const std::string line = formatMessage(severity, time, message);
+    std::scoped_lock lock(mutex_);
+    out_stream_ << line << std::flush;
+  } catch (...) {
+    // Messages that can't be written are dropped.
+  }
+}
+
+std::string ConsoleMessageSink::formatMessage(
+    VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+    const std::string& message) {
+  const char* color = "";
+  const char* prefix = "";
+
+  switch (severity) {
+  case VirtualMachine::MessageSeverity::Debug: {
+    color = "90";
+    prefix = "DBG";
+  } break;
+
+  case VirtualMachine::MessageSeverity::Info: {
+    color = "97";
+    prefix = "INF";
+  } break;
+
+  case VirtualMachine::MessageSeverity::Warning: {
+    color = "33";
+    prefix = "WRN";
+  } break;
+
+  case VirtualMachine::MessageSeverity::Error: {
+    color = "31";
+    prefix = "ERR";
+  } break;
+
+  case VirtualMachine::MessageSeverity::Panic: {
+    color = "31;107";
+    prefix = "PNC";
+  } break;
+  }
+
+  const std::string& timestamp = getTimestamp(time);
+  std::string line;
+  line.reserve(timestamp.size() + message.size() + 32);
+  line.append("\033[1;").append(color).append("m[").append(timestamp).append(" ");
+  line.append(prefix).append("] ").append(message).append("\033[0m\n");
+  return line;
+}
+
+AsyncMessageSink::AsyncMessageSink(std::shared_ptr<MessageSink> target, size_t capacity)
+  : target_{std::move(target)}, queue_{capacity} {
+  if (!target_) {
+    throw std::invalid_argument("Target message sink must not be null.");
+  }
+  thread_ = std::thread([this]() { drainLoop(); });
+}
+
+AsyncMessageSink::~AsyncMessageSink() {
+  stopping_.store(true, std::memory_order_release);
+  thread_.join();
+}
+
+void AsyncMessageSink::write(
+    VirtualMachine::MessageSeverity severity, std::chrono::system_clock::time_point time,
+    const std::string& message) noexcept {
+  try {
+    PendingMessage pending{severity, time, message};
+    if (queue_.tryPush(std::move(pending))) {
+      accepted_count_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+  } catch (...) {
+    // Falls through to counting the message as dropped.
+  }
+  dropped_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncMessageSink::flush() const {
+  const uint64_t accepted_count = accepted_count_.load(std::memory_order_acquire);
+  while (forwarded_count_.load(std::memory_order_acquire) < accepted_count) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+uint64_t AsyncMessageSink::getDroppedCount() const noexcept {
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+void AsyncMessageSink::drainLoop() {
+  uint32_t empty_polls = 0;
+  while (true) {
+    std::optional<PendingMessage> pending = queue_.tryPop();
+    if (pending) {
+      target_->write(pending->severity, pending->time, pending->message);
+      forwarded_count_.fetch_add(1, std::memory_order_release);
+      empty_polls = 0;
+      continue;
+    }
+
+    // Only stop once the queue was found empty after the stop request, so nothing is lost.
+    if (stopping_.load(std::memory_order_acquire) && queue_.getApproximateSize() == 0) {
+      break;
+    }
+
+    if (++empty_polls < kSpinPolls) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+}  // namespace beast
@@ -1,25 +1,529 @@
 #include <beast/pipe.hpp>
 
 // Standard
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Internal
+#include <beast/genetic_operators.hpp>
 
 // GAlib
 // NOTE: For these includes, the `register` error needs to be ignored as this 3rdparty library uses
 // outdated code. This is not an issue for the library using it though.
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wregister"
-#include <ga/GAListGenome.h>
+#include <ga/GAGenome.h>
+#include <ga/GASStateGA.h>
 #include <ga/GASimpleGA.h>
 #pragma GCC diagnostic pop
 
 namespace beast {
 
 namespace {
+/**
+ * @brief Evaluation state shared between the genome and population evaluators of one evolution
+ *
+ * Genomes that need a score register themselves in `pending` while `collecting` is set, so that the
+ * population evaluator can score all of them in a single Pipe::evaluateBatch call. While racing,
+ * `elite_scores` holds the best complete scores of this evolution, worst first. When resuming from
+ * a checkpoint, the initial population is taken from it instead of the input pool.
+ */
+struct EvaluationContext {
+  Pipe* pipe;                       ///< The pipe whose evaluation functions are used
+  bool collecting = false;          ///< Whether genomes are currently being collected
+  std::vector<GAGenome*> pending;   ///< Genomes waiting for their score
+  std::priority_queue<double, std::vector<double>, std::greater<>> elite_scores;  ///< Best scores
+  const MappedEvolutionCheckpoint* checkpoint = nullptr;  ///< The population to start from, if any
+  size_t restored_count = 0;        ///< How many individuals were restored from the checkpoint
+};
+
+/**
+ * @brief Returns the score a raced candidate needs to reach to be evaluated completely
+ */
+double getRacingThreshold(const EvaluationContext& context) {
+  const double cut_off_score = context.pipe->getCutOffScore();
+  const uint32_t elite_count = context.pipe->getRacingEliteCount();
+  if (elite_count == 0 || context.elite_scores.size() < elite_count) {
+    return cut_off_score;
+  }
+  return std::max(cut_off_score, context.elite_scores.top());
+}
+
+/**
+ * @brief Records a complete score, keeping the best ones as the elite candidates are raced against
+ */
+void recordRacingScore(EvaluationContext& context, double score) {
+  const uint32_t elite_count = context.pipe->getRacingEliteCount();
+  if (elite_count == 0) {
+    return;
+  }
+  if (context.elite_scores.size() < elite_count) {
+    context.elite_scores.push(score);
+  } else if (score > context.elite_scores.top()) {
+    context.elite_scores.pop();
+    context.elite_scores.push(score);
+  }
+}
+
+/**
+ * @brief GAlib class ID of the ByteArrayGenome (IDs below 200 are reserved for GAlib's own classes)
+ */
+const int kByteArrayGenomeClassId = 201;
+
+/**
+ * @class ByteArrayGenome
+ * @brief A GAlib genome holding program code in a contiguous byte array
+ *
+ * Mutation and crossover work on the byte array directly, and evaluation functions receive a
+ * reference to it, so the program code is never copied byte by byte. This matters for large
+ * programs, where walking a node-based genome can cost more than running the program itself. Both
+ * operators respect instruction boundaries (see GeneticOperators), so offspring don't waste
+ * evaluations on instructions that were cut in half.
+ */
+class ByteArrayGenome : public GAGenome {
+ public:
+  GADefineIdentity("ByteArrayGenome", kByteArrayGenomeClassId);
+
+  /**
+   * @brief Constructs an empty genome scored by the given evaluator
+   */
+  explicit ByteArrayGenome(Evaluator evaluator_function)
+    : GAGenome(initializeEmpty, mutateInstructions, compareBytes) {
+    evaluator(evaluator_function);
+    crossover(crossOverInstructions);
+  }
+
+  ByteArrayGenome(const ByteArrayGenome& other) : GAGenome(other), data_{other.data_} {
+  }
+
+  ByteArrayGenome& operator=(const GAGenome& other) {
+    copy(other);
+    return *this;
+  }
+
+  ~ByteArrayGenome() override = default;
+
+  GAGenome* clone(CloneMethod flag = CONTENTS) const override {
+    auto* genome = new ByteArrayGenome(*this);
+    if (flag == ATTRIBUTES) {
+      genome->data_.clear();
+    }
+    return genome;
+  }
+
+  void copy(const GAGenome& other) override {
+    if (&other == this) {
+      return;
+    }
+    GAGenome::copy(other);
+    data_ = dynamic_cast<const ByteArrayGenome&>(other).data_;
+  }
+
+  int equal(const GAGenome& other) const override {
+    return data_ == dynamic_cast<const ByteArrayGenome&>(other).data_ ? 1 : 0;
+  }
+
+  /**
+   * @brief Returns the program code held by this genome
+   */
+  [[nodiscard]] const std::vector<unsigned char>& getData() const noexcept {
+    return data_;
+  }
+
+  /**
+   * @brief Lends the program code held by this genome
+   *
+   * Allows to move the code into a batch without copying it. The caller must move it back before
+   * the genome is used again.
+   */
+  [[nodiscard]] std::vector<unsigned char>& borrowData() noexcept {
+    return data_;
+  }
+
+  /**
+   * @brief Replaces the program code held by this genome
+   */
+  void setData(std::vector<unsigned char> data) {
+    data_ = std::move(data);
+    _evaluated = gaFalse;
+  }
+
+  /**
+   * @brief Reseeds GAlib's and this thread's genetic operator random number generators
+   */
+  static void reseedRandomNumberGenerators(uint32_t seed) {
+    getRandomNumberGenerator().seed(seed);
+    GAResetRNG(seed);
+  }
+
+ private:
+  /**
+   * @brief Default initializer leaving the genome empty
+   */
+  static void initializeEmpty(GAGenome& genome) {
+    dynamic_cast<ByteArrayGenome&>(genome).setData({});
+  }
+
+  /**
+   * @brief Returns the random number generator used by the genetic operators of this thread
+   *
+   * It is seeded from GAlib's random number generator, so that seeding GAlib keeps evolution runs
+   * reproducible.
+   */
+  static std::mt19937& getRandomNumberGenerator() {
+    thread_local std::mt19937 rng(static_cast<std::mt19937::result_type>(GARandomInt()));
+    return rng;
+  }
+
+  /**
+   * @brief Mutates whole instructions and their operands, see GeneticOperators::mutate
+   *
+   * @return The number of applied mutations
+   */
+  static int mutateInstructions(GAGenome& genome, float probability) {
+    auto& byte_genome = dynamic_cast<ByteArrayGenome&>(genome);
+    const uint32_t mutations =
+        GeneticOperators::mutate(byte_genome.data_, probability, getRandomNumberGenerator());
+    if (mutations > 0) {
+      byte_genome._evaluated = gaFalse;
+    }
+    return static_cast<int>(mutations);
+  }
+
+  /**
+   * @brief Returns the share of differing bytes between two genomes, from 0.0 to 1.0
+   *
+   * Bytes beyond the end of the shorter genome count as differing.
+   */
+  static float compareBytes(const GAGenome& first, const GAGenome& second) {
+    const std::vector<unsigned char>& first_data =
+        dynamic_cast<const ByteArrayGenome&>(first).data_;
+    const std::vector<unsigned char>& second_data =
+        dynamic_cast<const ByteArrayGenome&>(second).data_;
+    const size_t longest = std::max(first_data.size(), second_data.size());
+    if (longest == 0) {
+      return 0.0F;
+    }
+
+    const size_t shortest = std::min(first_data.size(), second_data.size());
+    size_t differences = longest - shortest;
+    for (size_t idx = 0; idx < shortest; ++idx) {
+      if (first_data[idx] != second_data[idx]) {
+        differences++;
+      }
+    }
+    return static_cast<float>(differences) / static_cast<float>(longest);
+  }
+
+  /**
+   * @brief One-point crossover at instruction boundaries, see GeneticOperators::crossOver
+   *
+   * @return The number of children produced
+   */
+  static int crossOverInstructions(
+      const GAGenome& mother, const GAGenome& father, GAGenome* first_child,
+      GAGenome* second_child) {
+    auto [first_data, second_data] = GeneticOperators::crossOver(
+        dynamic_cast<const ByteArrayGenome&>(mother).data_,
+        dynamic_cast<const ByteArrayGenome&>(father).data_, getRandomNumberGenerator());
+
+    int children = 0;
+    if (first_child != nullptr) {
+      dynamic_cast<ByteArrayGenome*>(first_child)->setData(std::move(first_data));
+      children++;
+    }
+    if (second_child != nullptr) {
+      dynamic_cast<ByteArrayGenome*>(second_child)->setData(std::move(second_data));
+      children++;
+    }
+    return children;
+  }
+
+  /**
+   * @brief The program code
+   */
+  std::vector<unsigned char> data_;
+};
+
+/**
+ * @brief A program's score, and whether it was only predicted by the pipe's surrogate model
+ */
+struct ProgramScore {
+  double score = 0.0;      ///< The score
+  bool predicted = false;  ///< Whether the score was predicted instead of evaluated
+  std::optional<std::vector<float>> behavior;  ///< The behavior descriptor, if evaluated while
+                                               ///  searching for novelty
+};
+
+/**
+ * @brief Returns the surrogate's predicted score if a program is a likely loser to skip
+ *
+ * A program is a likely loser if its predicted score plus the surrogate's mean absolute error stays
+ * below the skip threshold. Even then, it is evaluated with the configured exploration probability.
+ * Programs predicted to reach the cut-off score are always evaluated, so that no finalist is stored
+ * with a score it never achieved.
+ * If the pipe has a surrogate model attached, `features` receives the program's features, so that
+ * the model can be trained with the program's actual score.
+ *
+ * @return The predicted score, clamped to 0.0 - 1.0, or no value if the program is to be evaluated
+ */
+std::optional<double> prefilterProgram(
+    Pipe& pipe, const std::vector<unsigned char>& program, std::vector<double>& features) {
+  const std::shared_ptr<SurrogateModel>& surrogate = pipe.getSurrogateModel();
+  if (!surrogate) {
+    return std::nullopt;
+  }
+
+  features = SurrogateModel::extractFeatures(program);
+  const Pipe::SurrogateParameters& parameters = pipe.getSurrogateParameters();
+  if (surrogate->getSampleCount() < parameters.warm_up_samples) {
+    return std::nullopt;
+  }
+  const double prediction = surrogate->predict(features);
+  const double predicted_score = std::clamp(prediction, 0.0, 1.0);
+  if (prediction + surrogate->getMeanAbsoluteError() >= parameters.skip_threshold ||
+      predicted_score >= pipe.getCutOffScore() ||
+      GAFlipCoin(static_cast<float>(parameters.exploration_rate)) != 0) {
+    return std::nullopt;
+  }
+  return predicted_score;
+}
+
+/**
+ * @brief Trains the pipe's surrogate model with an evaluated program's score, if one is attached
+ */
+void trainSurrogate(Pipe& pipe, const std::vector<double>& features, double score) {
+  if (const std::shared_ptr<SurrogateModel>& surrogate = pipe.getSurrogateModel()) {
+    surrogate->train(features, score);
+  }
+}
+
+/**
+ * @brief Scores a single program, consulting the pipe's fitness cache and surrogate model if
+ *        attached
+ *
+ * While racing, the program is evaluated against the current racing threshold.
+ */
+ProgramScore scoreProgram(EvaluationContext& context, const std::vector<unsigned char>& program) {
+  Pipe& pipe = *context.pipe;
+  const std::shared_ptr<FitnessCache>& cache = pipe.getFitnessCache();
+  // The key is computed once, as canonical keys make it as costly as the determinism check.
+  const std::optional<FitnessCache::Key> key =
+      cache ? cache->getCacheableKey(program, pipe.getFitnessCacheConfiguration()) : std::nullopt;
+  if (key) {
+    if (const std::optional<FitnessCache::Entry> entry = cache->lookup(*key)) {
+      recordRacingScore(context, entry->score);
+      return {entry->score, false, std::nullopt};
+    }
+  }
+  std::vector<double> features;
+  if (const std::optional<double> prediction = prefilterProgram(pipe, program, features)) {
+    return {*prediction, true, std::nullopt};
+  }
+
+  Pipe::RacingScore result{0.0, false};
+  std::optional<std::vector<float>> behavior;
+  if (pipe.getBehaviorArchive()) {
+    Pipe::BehaviorScore evaluation = pipe.evaluateWithBehavior(program);
+    result.score = evaluation.score;
+    behavior = std::move(evaluation.behavior);
+  } else if (pipe.isRacing()) {
+    result = pipe.evaluateRacing(program, getRacingThreshold(context));
+  } else {
+    result.score = pipe.evaluate(program);
+  }
+  if (result.abandoned) {
+    return {result.score, false, std::nullopt};
+  }
+
+  recordRacingScore(context, result.score);
+  trainSurrogate(pipe, features, result.score);
+  if (key) {
+    cache->store(*key, {result.score, std::nullopt});
+  }
+  return {result.score, false, std::move(behavior)};
+}
+
+/**
+ * @brief Passes borrowed programs to Pipe::evaluateBatch without copying them
+ *
+ * While the pipe searches for novelty, Pipe::evaluateBatchWithBehavior is called instead, and the
+ * results hold the programs' behavior descriptors. The program buffers are moved into the batch for
+ * the duration of the call and moved back afterwards, also if the evaluation throws.
+ */
+std::vector<Pipe::BehaviorScore> evaluateBorrowed(
+    Pipe& pipe, const std::vector<std::vector<unsigned char>*>& programs) {
+  std::vector<std::vector<unsigned char>> batch;
+  batch.reserve(programs.size());
+  for (std::vector<unsigned char>* program : programs) {
+    batch.push_back(std::move(*program));
+  }
+  const auto give_back = [&]() {
+    for (size_t idx = 0; idx < programs.size(); ++idx) {
+      *programs[idx] = std::move(batch[idx]);
+    }
+  };
+
+  std::vector<Pipe::BehaviorScore> evaluations;
+  try {
+    if (pipe.getBehaviorArchive()) {
+      evaluations = pipe.evaluateBatchWithBehavior(batch);
+    } else {
+      for (const double score : pipe.evaluateBatch(batch)) {
+        evaluations.push_back({score, {}});
+      }
+    }
+  } catch (...) {
+    give_back();
+    throw;
+  }
+  give_back();
+  if (evaluations.size() != programs.size()) {
+    throw std::runtime_error("Batch evaluation returned a wrong number of scores.");
+  }
+  return evaluations;
+}
+
+/**
+ * @brief Scores a batch of programs, consulting the pipe's fitness cache and surrogate model if
+ *        attached
+ *
+ * The programs are borrowed from their genomes rather than copied (see evaluateBorrowed). Only
+ * programs without a cached score that the surrogate doesn't skip are passed on to
+ * Pipe::evaluateBatch, and cacheable programs that occur several times in the batch are passed on
+ * only once.
+ */
+std::vector<ProgramScore> scorePrograms(
+    Pipe& pipe, const std::vector<std::vector<unsigned char>*>& programs) {
+  const std::shared_ptr<FitnessCache>& cache = pipe.getFitnessCache();
+  const bool describes_behavior = pipe.getBehaviorArchive() != nullptr;
+  std::vector<ProgramScore> scores(programs.size());
+  if (!cache && !pipe.getSurrogateModel()) {
+    std::vector<Pipe::BehaviorScore> evaluations = evaluateBorrowed(pipe, programs);
+    for (size_t idx = 0; idx < programs.size(); ++idx) {
+      scores[idx].score = evaluations[idx].score;
+      if (describes_behavior) {
+        scores[idx].behavior = std::move(evaluations[idx].behavior);
+      }
+    }
+    return scores;
+  }
+
+  const uint64_t configuration = pipe.getFitnessCacheConfiguration();
+  std::vector<std::vector<unsigned char>*> misses;
+  std::vector<std::vector<double>> miss_features;
+  std::vector<std::vector<size_t>> miss_targets;  // The indices in `scores` each miss determines
+  std::vector<std::optional<FitnessCache::Key>> miss_keys;
+  std::map<std::pair<uint64_t, uint64_t>, size_t> miss_by_key;
+  for (size_t idx = 0; idx < programs.size(); ++idx) {
+    const std::optional<FitnessCache::Key> key =
+        cache ? cache->getCacheableKey(*programs[idx], configuration) : std::nullopt;
+    if (key) {
+      if (const std::optional<FitnessCache::Entry> entry = cache->lookup(*key)) {
+        scores[idx].score = entry->score;
+        continue;
+      }
+    }
+    std::vector<double> features;
+    if (const std::optional<double> prediction = prefilterProgram(pipe, *programs[idx], features)) {
+      scores[idx] = {*prediction, true, std::nullopt};
+      continue;
+    }
+
+    if (key) {
+      const auto [iterator, inserted] =
+          miss_by_key.try_emplace({key->high, key->low}, misses.size());
+      if (!inserted) {
+        miss_targets[iterator->second].push_back(idx);
+        continue;
+      }
+    }
+    misses.push_back(programs[idx]);
+    miss_features.push_back(std::move(features));
+    miss_targets.push_back({idx});
+    miss_keys.push_back(key);
+  }
+
+  if (misses.empty()) {
+    return scores;
+  }
+  std::vector<Pipe::BehaviorScore> evaluations = evaluateBorrowed(pipe, misses);
+  for (size_t miss_idx = 0; miss_idx < misses.size(); ++miss_idx) {
+    const double score = evaluations[miss_idx].score;
+    trainSurrogate(pipe, miss_features[miss_idx], score);
+    if (miss_keys[miss_idx]) {
+      cache->store(*miss_keys[miss_idx], {score, std::nullopt});
+    }
+    for (const size_t idx : miss_targets[miss_idx]) {
+      scores[idx].score = score;
+    }
+    // Repetitions of the program within the batch aren't novel.
+    if (describes_behavior) {
+      scores[miss_targets[miss_idx].front()].behavior = std::move(evaluations[miss_idx].behavior);
+    }
+  }
+  return scores;
+}
+
+/**
+ * @brief Blends a program's novelty into its score if the pipe searches for novelty
+ *
+ * The behavior the program showed during its evaluation is compared against the pipe's archive,
+ * and added to it if it is novel enough (see Pipe::setNoveltySearch). Programs that weren't
+ * evaluated have no behavior and count as not novel.
+ */
+double applyNovelty(Pipe& pipe, const ProgramScore& score) {
+  const std::shared_ptr<BehaviorArchive>& archive = pipe.getBehaviorArchive();
+  if (!archive) {
+    return score.score;
+  }
+
+  const Pipe::NoveltyParameters& parameters = pipe.getNoveltyParameters();
+  double novelty = 0.0;
+  if (score.behavior) {
+    novelty = archive->computeNovelty(*score.behavior, parameters.neighbour_count);
+    if (novelty >= parameters.archive_threshold ||
+        archive->getSize() < parameters.neighbour_count) {
+      archive->insert(*score.behavior);
+    }
+  }
+  return (1.0 - parameters.novelty_weight) * score.score +
+         parameters.novelty_weight * novelty / (1.0 + novelty);
+}
+
+/**
+ * @brief Returns the fitness a genome gets for a program's score
+ *
+ * Blends in the program's novelty (see applyNovelty). Fitness derived from a predicted score stays
+ * below the cut-off score, so that programs that were never evaluated don't become finalists.
+ */
+float getFitness(Pipe& pipe, const ProgramScore& score) {
+  const auto fitness = static_cast<float>(applyNovelty(pipe, score));
+  if (!score.predicted) {
+    return fitness;
+  }
+  // Predictions are only used below the cut-off score, which is therefore greater than 0.0.
+  return std::min(fitness, std::nextafter(static_cast<float>(pipe.getCutOffScore()), 0.0F));
+}
+
 /**
  * @brief Intermediary function to trigger evaluation of Genomes
  *
- * The pipe object is dereferences from the genome's user data to trigger the instance's evaluation
- * function. The resulting score value is then returned to the GAlib mechanism.
+ * The evaluation context is dereferenced from the genome's user data. While the population
+ * evaluator collects a batch, the genome is only registered for scoring and the returned
+ * placeholder score is overwritten later on. Otherwise the pipe's evaluation function is called
+ * directly and the resulting score value is returned to the GAlib mechanism.
  *
  * The function needs to be excluded from the clang-tidy linting process because the parameter would
  * need to be made const, which does not match GAlib's evaluator signature. Ignoring it does no harm
@@ -30,21 +534,64 @@ namespace {
  */
 // NOLINTNEXTLINE
 float staticEvaluatorWrapper(GAGenome& genome) {
-  auto& list_genome = dynamic_cast<GAListGenome<unsigned char>&>(genome);
-  std::vector<unsigned char> data;
-  for (uint32_t idx = 0; idx < list_genome.size(); ++idx) {
-    data.push_back(*list_genome[idx]);
+  auto* context = static_cast<EvaluationContext*>(genome.userData());
+  if (context->collecting) {
+    context->pending.push_back(&genome);
+    return 0.0F;
+  }
+
+  const std::vector<unsigned char>& program = dynamic_cast<ByteArrayGenome&>(genome).getData();
+  return getFitness(*context->pipe, scoreProgram(*context, program));
+}
+
+/**
+ * @brief Intermediary function to evaluate an entire population in one batch
+ *
+ * Collects all genomes of the population that have not been scored yet and passes their program
+ * code to the pipe's batch evaluation function, which allows to amortize per-candidate overhead
+ * (e.g. network round trips) over a whole generation.
+ *
+ * @param population The GAlib population to evaluate
+ */
+void staticPopulationEvaluatorWrapper(GAPopulation& population) {
+  auto* context = static_cast<EvaluationContext*>(population.userData());
+  context->pending.clear();
+  context->collecting = true;
+  for (int pop_idx = 0; pop_idx < population.size(); ++pop_idx) {
+    population.individual(pop_idx).evaluate();
+  }
+  context->collecting = false;
+
+  // Racing thresholds depend on the scores before, so raced candidates are scored one by one.
+  // Novelty search evaluates candidates completely, so they are scored in a batch.
+  if (context->pipe->isRacing() && !context->pipe->getBehaviorArchive()) {
+    for (GAGenome* genome : context->pending) {
+      const std::vector<unsigned char>& program = dynamic_cast<ByteArrayGenome*>(genome)->getData();
+      genome->score(getFitness(*context->pipe, scoreProgram(*context, program)));
+    }
+    context->pending.clear();
+    return;
+  }
+
+  std::vector<std::vector<unsigned char>*> programs;
+  programs.reserve(context->pending.size());
+  for (GAGenome* genome : context->pending) {
+    programs.push_back(&dynamic_cast<ByteArrayGenome*>(genome)->borrowData());
   }
 
-  Pipe* pipe = static_cast<Pipe*>(genome.userData());
-  return static_cast<float>(pipe->evaluate(data));
+  const std::vector<ProgramScore> scores = scorePrograms(*context->pipe, programs);
+  for (size_t idx = 0; idx < scores.size(); ++idx) {
+    context->pending[idx]->score(getFitness(*context->pipe, scores[idx]));
+  }
+  context->pending.clear();
 }
 
 /**
  * @brief Intermediary function to initialize Genomes
  *
- * The pipe object is dereferences from the genome's user data to draw from the instance's initial
- * population candidates. The GAlib genomes are then initialized with that data.
+ * The pipe object is dereferenced via the genome's user data to draw from the instance's initial
+ * population candidates, or from the population of the checkpoint it resumes from. The GAlib
+ * genomes are then initialized with that data.
  *
  * The function needs to be excluded from the clang-tidy linting process because the parameter would
  * need to be made const, which does not match GAlib's evaluator signature. Ignoring it does no harm
@@ -54,92 +601,467 @@ float staticEvaluatorWrapper(GAGenome& genome) {
  */
 // NOLINTNEXTLINE
 void staticInitializerWrapper(GAGenome& genome) {
-  auto& list_genome = dynamic_cast<GAListGenome<unsigned char>&>(genome);
-  auto* pipe = static_cast<Pipe*>(genome.userData());
-  std::vector<unsigned char> item = pipe->drawInput();
-  for (unsigned char value : item) {
-    list_genome.insert(value);
+  auto* context = static_cast<EvaluationContext*>(genome.userData());
+  auto& byte_genome = dynamic_cast<ByteArrayGenome&>(genome);
+  if (context->checkpoint == nullptr) {
+    byte_genome.setData(context->pipe->drawInput());
+    return;
   }
+
+  // Restored individuals keep their score, so they aren't evaluated again.
+  const size_t index = context->restored_count++;
+  const EvolutionCheckpoint::Section section = EvolutionCheckpoint::Section::Population;
+  byte_genome.setData(context->checkpoint->copyRecord(section, index));
+  byte_genome.score(static_cast<float>(context->checkpoint->getRecord(section, index).score));
 }
+
+/**
+ * @class SteadyStateAlgorithm
+ * @brief A GAlib steady-state algorithm whose population accepts immigrants between steps
+ */
+class SteadyStateAlgorithm : public GASteadyStateGA {
+ public:
+  explicit SteadyStateAlgorithm(const GAPopulation& population) : GASteadyStateGA(population) {
+  }
+
+  /**
+   * @brief Replaces the worst individual of the population, taking ownership of the immigrant
+   */
+  void replaceWorst(GAGenome* immigrant) {
+    delete pop->replace(immigrant, &pop->worst());
+  }
+};
+
+/**
+ * @brief Identifies emitted finalists by their content
+ */
+using FinalistKey = std::pair<uint64_t, uint64_t>;
 }  // namespace
 
-Pipe::Pipe(uint32_t max_candidates)
-  : max_candidates_{max_candidates} {
+Pipe::Pipe(uint32_t max_candidates, size_t output_capacity)
+  // Twice the population size leaves room for producers that passed hasSpace() at the same time.
+  : max_candidates_{max_candidates}, input_{std::max<size_t>(2 * size_t{max_candidates}, 1)}
+  , output_{output_capacity} {
 }
 
-void Pipe::addInput(const std::vector<unsigned char>& candidate) {
-  input_.push_back(candidate);
+Pipe::~Pipe() {
+  // By now the subclass is gone, so an evolution thread that is still around might have been
+  // calling into it. Subclasses must stop in their own destructor; this join is only a fallback.
+  assert(!evolution_thread_.joinable() && "Pipe subclasses must call stop() in their destructor.");
+  stop_requested_ = true;
+  if (evolution_thread_.joinable()) {
+    evolution_thread_.join();
+  }
+}
+
+void Pipe::addInput(
+    std::vector<unsigned char> candidate, std::chrono::steady_clock::duration timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (uint32_t attempt = 0; !tryAddInput(std::move(candidate)); ++attempt) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      throw std::overflow_error("Input pool stayed full.");
+    }
+    // Back off like the queue's own blocking operations, but respect the population size.
+    if (attempt >= 64) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+}
+
+bool Pipe::tryAddInput(std::vector<unsigned char>&& candidate) {
+  return hasSpace() && input_.tryPush(std::move(candidate));
 }
 
 void Pipe::evolve() {
-   GAListGenome<unsigned char> genome(staticEvaluatorWrapper);
+  evolveFrom(nullptr);
+}
+
+void Pipe::resume(const std::string& checkpoint_path) {
+  if (isRunning()) {
+    throw std::logic_error("Batch evolution is not possible while steady-state evolution runs.");
+  }
+
+  const MappedEvolutionCheckpoint checkpoint(checkpoint_path);
+  if (checkpoint.getRecordCount(EvolutionCheckpoint::Section::Population) != max_candidates_) {
+    throw std::invalid_argument("Checkpoint population size differs from the pipe's.");
+  }
+  const size_t input_count = checkpoint.getRecordCount(EvolutionCheckpoint::Section::Inputs);
+  if (input_.getApproximateSize() + input_count > max_candidates_) {
+    throw std::overflow_error("Input pool can't take the checkpoint's inputs.");
+  }
+
+  for (size_t idx = 0; idx < input_count; ++idx) {
+    input_.push(checkpoint.copyRecord(EvolutionCheckpoint::Section::Inputs, idx));
+  }
+  const size_t output_count = checkpoint.getRecordCount(EvolutionCheckpoint::Section::Outputs);
+  for (size_t idx = 0; idx < output_count; ++idx) {
+    const MappedEvolutionCheckpoint::Record record =
+        checkpoint.getRecord(EvolutionCheckpoint::Section::Outputs, idx);
+    offerFinalist({{record.data, record.data + record.size}, record.score});
+  }
+
+  evolveFrom(&checkpoint);
+}
+
+void Pipe::setCheckpointing(std::string path, uint32_t interval) {
+  checkpoint_path_ = std::move(path);
+  checkpoint_interval_ = interval;
+}
+
+const std::string& Pipe::getCheckpointPath() const noexcept {
+  return checkpoint_path_;
+}
+
+uint32_t Pipe::getCheckpointInterval() const noexcept {
+  return checkpoint_interval_;
+}
+
+void Pipe::evolveFrom(const MappedEvolutionCheckpoint* checkpoint) {
+  if (isRunning()) {
+    throw std::logic_error("Batch evolution is not possible while steady-state evolution runs.");
+  }
+
+  EvaluationContext context{this, false, {}, {}, checkpoint, 0};
+
+  ByteArrayGenome genome(staticEvaluatorWrapper);
   genome.initializer(staticInitializerWrapper);
-  genome.userData(this);
+  genome.userData(&context);
 
-  GASimpleGA algorithm(genome);
+  GAPopulation population(genome, max_candidates_);
+  population.evaluator(staticPopulationEvaluatorWrapper);
+  population.userData(&context);
+
+  GASimpleGA algorithm(population);
   algorithm.populationSize(max_candidates_);
-  
-  /* TODO(fairlight1337): Fill and parameterize the GA here.
-   *
-   * GAParameterList params{};
-   * GASimpleGA::registerDefaultParameters(params);
-   * algorithm.parameters(params);
-   */
-  
-  algorithm.evolve();
-
-  // Save the finalists if they pass the cut-off score.
-  const GAPopulation& population = algorithm.population();
-  for (uint32_t pop_idx = 0; pop_idx < population.size(); ++pop_idx) {
-    GAGenome& individual = population.individual(pop_idx);
-    auto& list_genome = dynamic_cast<GAListGenome<unsigned char>&>(individual);
-    if (list_genome.size() > 0 && individual.score() >= cut_off_score_) {
-      std::vector<unsigned char> data;
-      for (uint32_t idx = 0; idx < list_genome.size(); ++idx) {
-        data.push_back(*list_genome[idx]);
+  algorithm.nGenerations(evolution_parameters_.generations);
+  algorithm.pMutation(static_cast<float>(evolution_parameters_.mutation_probability));
+  algorithm.pCrossover(static_cast<float>(evolution_parameters_.crossover_probability));
+  algorithm.elitist(evolution_parameters_.elitism ? gaTrue : gaFalse);
+
+  // Generations are stepped here rather than in GASimpleGA::evolve, to take checkpoints in between.
+  algorithm.initialize();
+  uint32_t generation = 0;
+  if (checkpoint != nullptr) {
+    generation = checkpoint->getGeneration();
+    ByteArrayGenome::reseedRandomNumberGenerators(checkpoint->getRandomSeed());
+  }
+
+  std::future<void> pending_write;
+  while (generation < evolution_parameters_.generations) {
+    algorithm.step();
+    ++generation;
+    if (checkpoint_interval_ == 0 || generation % checkpoint_interval_ != 0 ||
+        generation == evolution_parameters_.generations) {
+      continue;
+    }
+
+    if (pending_write.valid()) {
+      pending_write.get();
+    }
+    const auto seed = static_cast<uint32_t>(GARandomInt());
+    ByteArrayGenome::reseedRandomNumberGenerators(seed);
+
+    EvolutionCheckpoint snapshot(generation, seed);
+    const GAPopulation& current_population = algorithm.population();
+    for (int pop_idx = 0; pop_idx < current_population.size(); ++pop_idx) {
+      const auto& individual =
+          dynamic_cast<const ByteArrayGenome&>(current_population.individual(pop_idx));
+      snapshot.addRecord(
+          EvolutionCheckpoint::Section::Population, individual.getData(), individual.score());
+    }
+    addBufferedItems(snapshot);
+    pending_write = std::async(
+        std::launch::async, [snapshot = std::move(snapshot), path = checkpoint_path_]() {
+          snapshot.write(path);
+        });
+  }
+  if (pending_write.valid()) {
+    pending_write.get();
+  }
+
+  // Save the finalists if they pass the cut-off score. Nothing drains the output buffer while this
+  // thread evolves, so the best finalists go first and the ones that don't fit are dropped.
+  const GAPopulation& final_population = algorithm.population();
+  for (uint32_t pop_idx = 0; pop_idx < final_population.size(); ++pop_idx) {
+    auto& individual =
+        dynamic_cast<ByteArrayGenome&>(final_population.best(pop_idx, GAPopulation::RAW));
+    if (!individual.getData().empty() && individual.score() >= cut_off_score_) {
+      offerFinalist({individual.getData(), static_cast<double>(individual.score())});
+    }
+  }
+}
+
+void Pipe::addBufferedItems(EvolutionCheckpoint& checkpoint) const {
+  input_.forEach([&checkpoint](const std::vector<unsigned char>& input) {
+    checkpoint.addRecord(EvolutionCheckpoint::Section::Inputs, input);
+  });
+  output_.forEach([&checkpoint](const OutputItem& output) {
+    checkpoint.addRecord(EvolutionCheckpoint::Section::Outputs, output.data, output.score);
+  });
+}
+
+void Pipe::start() {
+  if (isRunning()) {
+    throw std::logic_error("Steady-state evolution is already running.");
+  }
+  if (evolution_thread_.joinable()) {
+    evolution_thread_.join();
+  }
+
+  stop_requested_ = false;
+  evolution_error_ = nullptr;
+  evolution_thread_ = std::thread(&Pipe::runSteadyState, this);
+}
+
+void Pipe::stop() {
+  stop(std::nothrow);
+  if (evolution_error_) {
+    std::rethrow_exception(std::exchange(evolution_error_, nullptr));
+  }
+}
+
+void Pipe::stop(std::nothrow_t /*nothrow*/) noexcept {
+  stop_requested_ = true;
+  if (evolution_thread_.joinable()) {
+    evolution_thread_.join();
+  }
+}
+
+bool Pipe::isRunning() const noexcept {
+  return evolution_thread_.joinable() && !stop_requested_;
+}
+
+void Pipe::setEvolutionParameters(const EvolutionParameters& parameters) {
+  evolution_parameters_ = parameters;
+}
+
+const Pipe::EvolutionParameters& Pipe::getEvolutionParameters() const noexcept {
+  return evolution_parameters_;
+}
+
+void Pipe::runSteadyState() {
+  while (input_.getApproximateSize() < max_candidates_) {
+    if (stop_requested_) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  try {
+    EvaluationContext context{this, false, {}, {}};
+
+    ByteArrayGenome genome(staticEvaluatorWrapper);
+    genome.initializer(staticInitializerWrapper);
+    genome.userData(&context);
+
+    GAPopulation population(genome, max_candidates_);
+    population.evaluator(staticPopulationEvaluatorWrapper);
+    population.userData(&context);
+
+    SteadyStateAlgorithm algorithm(population);
+    algorithm.pMutation(static_cast<float>(evolution_parameters_.mutation_probability));
+    algorithm.pCrossover(static_cast<float>(evolution_parameters_.crossover_probability));
+    algorithm.pReplacement(static_cast<float>(evolution_parameters_.replacement_probability));
+    algorithm.initialize();
+
+    // Finalists stay emitted as long as they are part of the population, so that surviving
+    // individuals are not emitted again after every step.
+    std::set<FinalistKey> emitted;
+    while (true) {
+      std::set<FinalistKey> still_emitted;
+      const GAPopulation& current_population = algorithm.population();
+      for (int pop_idx = 0; pop_idx < current_population.size(); ++pop_idx) {
+        auto& individual = dynamic_cast<ByteArrayGenome&>(current_population.individual(pop_idx));
+        if (individual.getData().empty() || individual.score() < cut_off_score_) {
+          continue;
+        }
+        const FitnessCache::Key key = FitnessCache::makeKey(individual.getData(), 0);
+        const FinalistKey finalist_key{key.high, key.low};
+        if (emitted.count(finalist_key) == 0 &&
+            !emitFinalist(individual.getData(), individual.score())) {
+          break;
+        }
+        still_emitted.insert(finalist_key);
       }
+      emitted = std::move(still_emitted);
 
-      storeFinalist(data, individual.score());
+      if (stop_requested_) {
+        break;
+      }
+
+      // Inputs that arrived in the meantime replace the worst individuals.
+      for (uint32_t immigrant_idx = 0; immigrant_idx < max_candidates_; ++immigrant_idx) {
+        std::optional<std::vector<unsigned char>> input = tryDrawInput();
+        if (!input) {
+          break;
+        }
+        auto* immigrant = dynamic_cast<ByteArrayGenome*>(genome.clone(GAGenome::ATTRIBUTES));
+        immigrant->setData(std::move(*input));
+        immigrant->evaluate();
+        algorithm.replaceWorst(immigrant);
+      }
+
+      algorithm.step();
     }
+  } catch (...) {
+    evolution_error_ = std::current_exception();
+  }
+  stop_requested_ = true;
+}
+
+bool Pipe::emitFinalist(const std::vector<unsigned char>& finalist, float score) {
+  OutputItem item{finalist, static_cast<double>(score)};
+  while (!output_.tryPushFor(std::move(item), std::chrono::milliseconds(10))) {
+    if (stop_requested_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Pipe::offerFinalist(OutputItem&& finalist) {
+  if (output_.tryPush(std::move(finalist))) {
+    return true;
+  }
+  dropped_finalist_count_++;
+  return false;
+}
+
+std::vector<double> Pipe::evaluateBatch(const std::vector<std::vector<unsigned char>>& programs) {
+  std::vector<double> scores;
+  scores.reserve(programs.size());
+  for (const std::vector<unsigned char>& program : programs) {
+    scores.push_back(evaluate(program));
   }
+  return scores;
+}
+
+Pipe::RacingScore Pipe::evaluateRacing(
+    const std::vector<unsigned char>& program_data, double /*threshold*/) {
+  return {evaluate(program_data), false};
+}
+
+Pipe::BehaviorScore Pipe::evaluateWithBehavior(
+    const std::vector<unsigned char>& /*program_data*/) {
+  throw std::logic_error("Novelty search requires the pipe to implement evaluateWithBehavior.");
+}
+
+std::vector<Pipe::BehaviorScore> Pipe::evaluateBatchWithBehavior(
+    const std::vector<std::vector<unsigned char>>& programs) {
+  std::vector<BehaviorScore> evaluations;
+  evaluations.reserve(programs.size());
+  for (const std::vector<unsigned char>& program : programs) {
+    evaluations.push_back(evaluateWithBehavior(program));
+  }
+  return evaluations;
 }
 
 bool Pipe::hasSpace() const {
-  return input_.size() < max_candidates_;
+  return input_.getApproximateSize() < max_candidates_;
 }
 
 std::vector<unsigned char> Pipe::drawInput() {
-  if (input_.empty()) {
+  std::optional<std::vector<unsigned char>> item = input_.tryPop();
+  if (!item) {
     throw std::underflow_error("No input candidates available to draw.");
   }
 
-  std::vector<unsigned char> item = input_.front();
-  input_.pop_front();
+  return std::move(*item);
+}
 
-  return item;
+std::optional<std::vector<unsigned char>> Pipe::tryDrawInput() {
+  return input_.tryPop();
 }
 
 bool Pipe::hasOutput() const {
-  return !output_.empty();
+  return output_.getApproximateSize() > 0;
 }
 
 Pipe::OutputItem Pipe::drawOutput() {
-  if (output_.empty()) {
+  std::optional<OutputItem> item = output_.tryPop();
+  if (!item) {
     throw std::underflow_error("No output candidates available to draw.");
   }
 
-  OutputItem item = output_.front();
-  output_.pop_front();
+  return std::move(*item);
+}
+
+std::optional<Pipe::OutputItem> Pipe::tryDrawOutput() {
+  return output_.tryPop();
+}
+
+std::optional<Pipe::OutputItem> Pipe::drawOutputFor(std::chrono::milliseconds timeout) {
+  return output_.tryPopFor(timeout);
+}
 
-  return item;
+uint64_t Pipe::getDroppedFinalistCount() const noexcept {
+  return dropped_finalist_count_;
 }
 
 void Pipe::setCutOffScore(double cut_off_score) {
   cut_off_score_ = cut_off_score;
 }
 
+double Pipe::getCutOffScore() const noexcept {
+  return cut_off_score_;
+}
+
+void Pipe::setRacing(bool enabled, uint32_t elite_count) {
+  racing_ = enabled;
+  racing_elite_count_ = elite_count;
+}
+
+bool Pipe::isRacing() const noexcept {
+  return racing_;
+}
+
+uint32_t Pipe::getRacingEliteCount() const noexcept {
+  return racing_elite_count_;
+}
+
+void Pipe::setFitnessCache(std::shared_ptr<FitnessCache> cache, uint64_t configuration) {
+  fitness_cache_ = std::move(cache);
+  fitness_cache_configuration_ = configuration;
+}
+
+const std::shared_ptr<FitnessCache>& Pipe::getFitnessCache() const noexcept {
+  return fitness_cache_;
+}
+
+uint64_t Pipe::getFitnessCacheConfiguration() const noexcept {
+  return fitness_cache_configuration_;
+}
+
+void Pipe::setNoveltySearch(
+    std::shared_ptr<BehaviorArchive> archive, const NoveltyParameters& parameters) {
+  behavior_archive_ = std::move(archive);
+  novelty_parameters_ = parameters;
+}
+
+const std::shared_ptr<BehaviorArchive>& Pipe::getBehaviorArchive() const noexcept {
+  return behavior_archive_;
+}
+
+const Pipe::NoveltyParameters& Pipe::getNoveltyParameters() const noexcept {
+  return novelty_parameters_;
+}
+
+void Pipe::setSurrogateModel(
+    std::shared_ptr<SurrogateModel> model, const SurrogateParameters& parameters) {
+  surrogate_model_ = std::move(model);
+  surrogate_parameters_ = parameters;
+}
+
+const std::shared_ptr<SurrogateModel>& Pipe::getSurrogateModel() const noexcept {
+  return surrogate_model_;
+}
+
+const Pipe::SurrogateParameters& Pipe::getSurrogateParameters() const noexcept {
+  return surrogate_parameters_;
+}
+
 void Pipe::storeFinalist(const std::vector<unsigned char>& finalist, float score) {
-  output_.push_back({finalist, static_cast<double>(score)});
+  output_.push({finalist, static_cast<double>(score)});
 }
 
 }  // namespace beast
@@ -0,0 +1,311 @@
+#include <beast/pipeline.hpp>
+
+// Standard
+#include <stdexcept>
+#include <utility>
+
+namespace beast {
+
+Pipeline::~Pipeline() {
+  stop_requested_ = true;
+  joinExecutors();
+}
+
+Pipeline::NodeId Pipeline::addFactory(
+    std::shared_ptr<ProgramFactoryBase> factory, const FactoryParameters& parameters) {
+  if (!factory) {
+    throw std::invalid_argument("Factory node requires a factory.");
+  }
+
+  auto node = std::make_unique<Node>();
+  node->kind = NodeKind::Factory;
+  node->factory = std::move(factory);
+  node->factory_parameters = parameters;
+  return addNode(std::move(node));
+}
+
+Pipeline::NodeId Pipeline::addPipe(std::shared_ptr<Pipe> pipe) {
+  if (!pipe) {
+    throw std::invalid_argument("Pipe node requires a pipe.");
+  }
+
+  auto node = std::make_unique<Node>();
+  node->kind = NodeKind::Pipe;
+  node->pipe = std::move(pipe);
+  return addNode(std::move(node));
+}
+
+Pipeline::NodeId Pipeline::addSink(Sink sink) {
+  if (!sink) {
+    throw std::invalid_argument("Sink node requires a sink function.");
+  }
+
+  auto node = std::make_unique<Node>();
+  node->kind = NodeKind::Sink;
+  node->sink = std::move(sink);
+  return addNode(std::move(node));
+}
+
+void Pipeline::connect(NodeId from, NodeId to, size_t capacity) {
+  if (isRunning()) {
+    throw std::logic_error("Nodes can't be connected while the pipeline runs.");
+  }
+  if (from >= nodes_.size() || to >= nodes_.size()) {
+    throw std::out_of_range("Unknown pipeline node.");
+  }
+  if (nodes_[from]->kind == NodeKind::Sink) {
+    throw std::invalid_argument("Sink nodes have no outputs.");
+  }
+  if (nodes_[to]->kind == NodeKind::Factory) {
+    throw std::invalid_argument("Factory nodes have no inputs.");
+  }
+  if (capacity == 0) {
+    throw std::invalid_argument("Edge capacity must be greater than 0.");
+  }
+  for (const Edge* edge : nodes_[from]->outputs) {
+    if (edge->to == to) {
+      throw std::invalid_argument("Nodes are already connected.");
+    }
+  }
+
+  // The edge closes a cycle if `from` can already be reached from `to`.
+  std::vector<bool> visited(nodes_.size(), false);
+  std::vector<NodeId> open_nodes = {to};
+  while (!open_nodes.empty()) {
+    const NodeId node_id = open_nodes.back();
+    open_nodes.pop_back();
+    if (node_id == from) {
+      throw std::invalid_argument("Edge would close a cycle.");
+    }
+    if (visited[node_id]) {
+      continue;
+    }
+    visited[node_id] = true;
+    for (const Edge* edge : nodes_[node_id]->outputs) {
+      open_nodes.push_back(edge->to);
+    }
+  }
+
+  edges_.push_back(std::make_unique<Edge>(from, to, capacity));
+  nodes_[from]->outputs.push_back(edges_.back().get());
+  nodes_[to]->inputs.push_back(edges_.back().get());
+}
+
+void Pipeline::start() {
+  if (isRunning()) {
+    throw std::logic_error("Pipeline is already running.");
+  }
+  // A pipeline that failed on its own still has executors to collect.
+  joinExecutors();
+  {
+    std::scoped_lock lock(state_mutex_);
+    error_ = nullptr;
+    run_started_ = std::chrono::steady_clock::now();
+    started_ = true;
+  }
+
+  stop_requested_ = false;
+  for (const std::unique_ptr<Node>& node : nodes_) {
+    if (node->kind == NodeKind::Pipe) {
+      try {
+        node->pipe->start();
+      } catch (...) {
+        stop_requested_ = true;
+        joinExecutors();
+        throw;
+      }
+    }
+  }
+  for (const std::unique_ptr<Node>& node : nodes_) {
+    node->executor = std::thread(&Pipeline::runNode, this, std::ref(*node));
+  }
+}
+
+void Pipeline::stop() {
+  stop_requested_ = true;
+  joinExecutors();
+
+  std::scoped_lock lock(state_mutex_);
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+bool Pipeline::isRunning() const noexcept {
+  return started_ && !stop_requested_;
+}
+
+size_t Pipeline::getNodeCount() const noexcept {
+  return nodes_.size();
+}
+
+Pipeline::NodeStatistics Pipeline::getNodeStatistics(NodeId node_id) const {
+  if (node_id >= nodes_.size()) {
+    throw std::out_of_range("Unknown pipeline node.");
+  }
+
+  const Node& node = *nodes_[node_id];
+  NodeStatistics statistics{};
+  statistics.kind = node.kind;
+  statistics.items_received = node.items_received;
+  statistics.items_emitted = node.items_emitted;
+  for (const Edge* edge : node.inputs) {
+    statistics.queue_depth += edge->queue.getApproximateSize();
+    statistics.queue_capacity += edge->queue.getCapacity();
+  }
+
+  const double seconds = getRunningSeconds();
+  if (seconds > 0.0) {
+    statistics.received_per_second = static_cast<double>(statistics.items_received) / seconds;
+    statistics.emitted_per_second = static_cast<double>(statistics.items_emitted) / seconds;
+  }
+  return statistics;
+}
+
+Pipeline::NodeId Pipeline::addNode(std::unique_ptr<Node> node) {
+  if (isRunning()) {
+    throw std::logic_error("Nodes can't be added while the pipeline runs.");
+  }
+
+  nodes_.push_back(std::move(node));
+  return nodes_.size() - 1;
+}
+
+void Pipeline::runNode(Node& node) {
+  try {
+    uint32_t idle_iterations = 0;
+    while (!stop_requested_) {
+      if (stepNode(node)) {
+        idle_iterations = 0;
+      } else if (++idle_iterations >= 64) {
+        // Nothing moved for a while; don't burn a core waiting for the neighbouring nodes.
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  } catch (...) {
+    recordError(std::current_exception());
+    stop_requested_ = true;
+  }
+}
+
+bool Pipeline::stepNode(Node& node) {
+  bool moved = false;
+  switch (node.kind) {
+    case NodeKind::Factory: {
+      const FactoryParameters& parameters = node.factory_parameters;
+      const bool exhausted = parameters.program_count > 0 &&
+                             node.programs_generated >= parameters.program_count;
+      if (!node.pending_output && !node.outputs.empty() && !exhausted) {
+        Program program = node.factory->generate(
+            parameters.program_size, parameters.memory_size, parameters.string_table_size,
+            parameters.string_table_item_length);
+        node.pending_output = Pipe::OutputItem{program.getData(), 0.0};
+        ++node.programs_generated;
+      }
+      moved = emit(node);
+      break;
+    }
+
+    case NodeKind::Pipe: {
+      if (!node.pipe->isRunning()) {
+        // The evolution ended on its own, which only happens on errors; stop() rethrows them.
+        node.pipe->stop();
+      }
+      if (node.pending_input || receive(node)) {
+        // Pipe::tryAddInput leaves the candidate untouched if the input pool is full.
+        if (node.pipe->tryAddInput(std::move(node.pending_input->data))) {
+          node.pending_input.reset();
+          moved = true;
+        }
+      }
+      if (!node.pending_output && !node.outputs.empty()) {
+        node.pending_output = node.pipe->tryDrawOutput();
+      }
+      moved = emit(node) || moved;
+      break;
+    }
+
+    case NodeKind::Sink: {
+      if (receive(node)) {
+        Pipe::OutputItem item = std::move(*node.pending_input);
+        node.pending_input.reset();
+        node.sink(std::move(item));
+        moved = true;
+      }
+      break;
+    }
+  }
+  return moved;
+}
+
+bool Pipeline::receive(Node& node) {
+  for (size_t attempt = 0; attempt < node.inputs.size(); ++attempt) {
+    Edge& edge = *node.inputs[node.next_input];
+    node.next_input = (node.next_input + 1) % node.inputs.size();
+    if (std::optional<Pipe::OutputItem> item = edge.queue.tryPop()) {
+      node.pending_input = std::move(item);
+      ++node.items_received;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Pipeline::emit(Node& node) {
+  if (!node.pending_output) {
+    return false;
+  }
+
+  for (size_t attempt = 0; attempt < node.outputs.size(); ++attempt) {
+    Edge& edge = *node.outputs[node.next_output];
+    node.next_output = (node.next_output + 1) % node.outputs.size();
+    // BoundedQueue::tryPush leaves the item untouched if the edge is full.
+    if (edge.queue.tryPush(std::move(*node.pending_output))) {
+      node.pending_output.reset();
+      ++node.items_emitted;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Pipeline::joinExecutors() {
+  for (const std::unique_ptr<Node>& node : nodes_) {
+    if (node->executor.joinable()) {
+      node->executor.join();
+    }
+  }
+  for (const std::unique_ptr<Node>& node : nodes_) {
+    if (node->kind == NodeKind::Pipe) {
+      try {
+        node->pipe->stop();
+      } catch (...) {
+        recordError(std::current_exception());
+      }
+    }
+  }
+
+  std::scoped_lock lock(state_mutex_);
+  if (started_) {
+    previous_runs_duration_ += std::chrono::steady_clock::now() - run_started_;
+    started_ = false;
+  }
+}
+
+void Pipeline::recordError(std::exception_ptr error) {
+  std::scoped_lock lock(state_mutex_);
+  if (!error_) {
+    error_ = std::move(error);
+  }
+}
+
+double Pipeline::getRunningSeconds() const {
+  std::scoped_lock lock(state_mutex_);
+  std::chrono::steady_clock::duration duration = previous_runs_duration_;
+  if (started_) {
+    duration += std::chrono::steady_clock::now() - run_started_;
+  }
+  return std::chrono::duration<double>(duration).count();
+}
+
+}  // namespace beast
@@ -1,6 +1,7 @@
 #include <beast/program.hpp>
 
 // Standard
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
@@ -18,7 +19,7 @@ size_t Program::getSize() const noexcept {
   return data_.size();
 }
 
-int32_t Program::getData4(int32_t offset) {
+int32_t Program::getData4(int32_t offset) const {
   if ((offset + 4) > getSize()) {
     throw std::underflow_error("Unable to retrieve data (not enough data left).");
   }
@@ -28,7 +29,7 @@ int32_t Program::getData4(int32_t offset) {
   return buffer;
 }
 
-int16_t Program::getData2(int32_t offset) {
+int16_t Program::getData2(int32_t offset) const {
   if ((offset + 2) > getSize()) {
     throw std::underflow_error("Unable to retrieve data (not enough data left).");
   }
@@ -38,7 +39,7 @@ int16_t Program::getData2(int32_t offset) {
   return buffer;
 }
 
-int8_t Program::getData1(int32_t offset) {
+int8_t Program::getData1(int32_t offset) const {
   if ((offset + 1) > getSize()) {
     throw std::underflow_error("Unable to retrieve data (not enough data left).");
   }
@@ -57,8 +58,9 @@ void Program::insertProgram(const Program& other) {
   if (!canFit(static_cast<uint32_t>(to_fit))) {
     throw std::overflow_error("Unable to fit other program into program.");
   }
-  for (uint32_t idx = 0; idx < to_fit; ++idx) {
-    data_[pointer_ + idx] = other.getData()[idx];
+  if (to_fit > 0) {
+    // `other` may be this program itself.
+    std::memmove(&data_[pointer_], other.getData().data(), to_fit);
   }
   pointer_ += static_cast<uint32_t>(to_fit);
 }
@@ -763,6 +765,9 @@ void Program::appendCode1(OpCode opcode) {
 
 void Program::ensureSize(uint32_t size) noexcept {
   if (data_.size() < size) {
+    if (data_.capacity() < size) {
+      data_.reserve(std::max<size_t>(size, 2 * data_.capacity()));
+    }
     data_.resize(size);
   }
 }
@@ -0,0 +1,91 @@
+#include <beast/program_builder.hpp>
+
+// Standard
+#include <stdexcept>
+#include <utility>
+
+namespace beast {
+
+ProgramBuilder::ProgramBuilder(size_t capacity) {
+  data_.reserve(capacity);
+}
+
+ProgramBuilder::Label ProgramBuilder::createLabel() {
+  label_addresses_.emplace_back(std::nullopt);
+  return Label(label_addresses_.size() - 1);
+}
+
+void ProgramBuilder::bindLabel(Label label) {
+  checkLabel(label);
+  std::optional<uint32_t>& address = label_addresses_[label.index_];
+  if (address.has_value()) {
+    throw std::logic_error("Unable to bind label, it is already bound.");
+  }
+  address = getPointer();
+}
+
+std::optional<uint32_t> ProgramBuilder::getLabelAddress(Label label) const {
+  checkLabel(label);
+  return label_addresses_[label.index_];
+}
+
+void ProgramBuilder::jumpToLabel(Label label) {
+  checkLabel(label);
+  const uint32_t offset = getPointer();
+  unconditionalJumpToRelativeAddress(0);
+  addFixup(offset, OpCode::UnconditionalJumpToRelativeAddress, label);
+}
+
+void ProgramBuilder::jumpToLabelIfVariableGreaterThanZero(
+    int32_t variable_index, bool follow_links, Label label) {
+  checkLabel(label);
+  const uint32_t offset = getPointer();
+  relativeJumpToAddressIfVariableGreaterThanZero(variable_index, follow_links, 0);
+  addFixup(offset, OpCode::RelativeJumpIfVariableGt0, label);
+}
+
+void ProgramBuilder::jumpToLabelIfVariableLessThanZero(
+    int32_t variable_index, bool follow_links, Label label) {
+  checkLabel(label);
+  const uint32_t offset = getPointer();
+  relativeJumpToAddressIfVariableLessThanZero(variable_index, follow_links, 0);
+  addFixup(offset, OpCode::RelativeJumpIfVariableLt0, label);
+}
+
+void ProgramBuilder::jumpToLabelIfVariableEqualsZero(
+    int32_t variable_index, bool follow_links, Label label) {
+  checkLabel(label);
+  const uint32_t offset = getPointer();
+  relativeJumpToAddressIfVariableEqualsZero(variable_index, follow_links, 0);
+  addFixup(offset, OpCode::RelativeJumpIfVariableEq0, label);
+}
+
+Program ProgramBuilder::build() {
+  for (const Fixup& fixup : fixups_) {
+    if (!label_addresses_[fixup.label_index].has_value()) {
+      throw std::logic_error("Unable to build program, a jump targets an unbound label.");
+    }
+  }
+  for (const Fixup& fixup : fixups_) {
+    InstructionDecoder::setJumpTarget(
+        data_, fixup.instruction, *label_addresses_[fixup.label_index]);
+  }
+
+  Program program(std::move(static_cast<Program&>(*this)));
+  static_cast<Program&>(*this) = Program();
+  label_addresses_.clear();
+  fixups_.clear();
+  return program;
+}
+
+void ProgramBuilder::checkLabel(Label label) const {
+  if (label.index_ >= label_addresses_.size()) {
+    throw std::invalid_argument("Unknown label.");
+  }
+}
+
+void ProgramBuilder::addFixup(uint32_t offset, OpCode opcode, Label label) {
+  fixups_.push_back({{offset, getPointer() - offset, opcode}, label.index_});
+}
+
+}  // namespace beast
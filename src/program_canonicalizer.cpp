@@ -0,0 +1,167 @@
+#include <beast/program_canonicalizer.hpp>
+
+// Standard
+#include <cstring>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Internal
+#include <beast/control_flow_graph.hpp>
+#include <beast/instruction_decoder.hpp>
+#include <beast/program_optimizer.hpp>
+
+namespace beast {
+
+namespace {
+using Instruction = InstructionDecoder::Instruction;
+using OperandType = InstructionDecoder::OperandType;
+
+/**
+ * @brief The maximum number of optimizer passes; every pass but the last shrinks or rewrites code
+ */
+constexpr size_t kMaxOptimizerPasses = 16;
+
+/**
+ * @brief Calls `visit` with the type and offset of every operand of an instruction
+ */
+template <typename Visitor>
+void visitOperands(ProgramView code, const Instruction& instruction, Visitor&& visit) {
+  size_t offset = instruction.offset + 1;
+  for (const OperandType type : InstructionDecoder::getOperandTypes(instruction.opcode)) {
+    visit(type, offset);
+    if (type == OperandType::String) {
+      int16_t length = 0;
+      std::memcpy(&length, code.getData() + offset, 2);
+      offset += static_cast<size_t>(length);
+    }
+    offset += InstructionDecoder::getOperandSize(type);
+  }
+}
+
+/**
+ * @brief Returns the decodable part of byte code if no execution path reaches the bytes after it
+ *
+ * Execution reaches trailing bytes by running into them, by jumping to them or to the end of the
+ * code, or possibly through a jump to a variable address.
+ */
+std::vector<unsigned char> removeUnreachableTail(ProgramView code) {
+  const ControlFlowGraph graph(code);
+  const size_t decoded_size = graph.getDecodedSize();
+  std::vector<unsigned char> result(code.getData(), code.getData() + code.getSize());
+  if (decoded_size == code.getSize() || graph.hasUnknownSuccessors()) {
+    return result;
+  }
+
+  const std::vector<ControlFlowGraph::BasicBlock>& blocks = graph.getBlocks();
+  const std::vector<bool> reachable = graph.getReachableBlocks();
+  for (size_t idx = 0; idx < blocks.size(); ++idx) {
+    if (!reachable[idx] || !blocks[idx].is_exit) {
+      continue;
+    }
+    const Instruction& last = blocks[idx].instructions.back();
+    const ControlFlowGraph::FlowType flow = ControlFlowGraph::getFlowType(last.opcode);
+    if (flow == ControlFlowGraph::FlowType::Terminate) {
+      continue;
+    }
+    if (flow != ControlFlowGraph::FlowType::Jump && idx + 1 == blocks.size()) {
+      return result;  // Runs into the trailing bytes.
+    }
+    if (const std::optional<int64_t> target = InstructionDecoder::getJumpTarget(code, last)) {
+      if (*target >= static_cast<int64_t>(decoded_size) &&
+          *target <= static_cast<int64_t>(code.getSize())) {
+        return result;
+      }
+    }
+  }
+  result.resize(decoded_size);
+  return result;
+}
+
+/**
+ * @brief Sets all flag operands to `0x0` or `0x1`; the code must decode completely
+ */
+void normalizeFlags(std::vector<unsigned char>& code) {
+  for (const Instruction& instruction : InstructionDecoder::decodeAll(code)) {
+    visitOperands(code, instruction, [&code](OperandType type, size_t offset) {
+      if (type == OperandType::Flag) {
+        code[offset] = code[offset] == 0x0 ? 0x0 : 0x1;
+      }
+    });
+  }
+}
+
+/**
+ * @brief Renumbers variables in order of their first mention; the code must decode completely
+ *
+ * Variables in `fixed_variables` keep their index, and no other variable is renamed to one of them.
+ */
+void renameVariables(std::vector<unsigned char>& code, const std::set<int32_t>& fixed_variables) {
+  const std::vector<Instruction> instructions = InstructionDecoder::decodeAll(code);
+  for (const Instruction& instruction : instructions) {
+    if (ControlFlowGraph::usesVariableIo(instruction.opcode)) {
+      return;
+    }
+    if (instruction.opcode == OpCode::DeclareVariable &&
+        code[*InstructionDecoder::getOperandOffset(code, instruction, OperandType::Constant1)] ==
+            static_cast<unsigned char>(Program::VariableType::Link)) {
+      return;
+    }
+  }
+
+  std::unordered_map<int32_t, int32_t> names;
+  int32_t next_name = 0;
+  for (const Instruction& instruction : instructions) {
+    visitOperands(code, instruction, [&](OperandType type, size_t offset) {
+      if (type != OperandType::Variable) {
+        return;
+      }
+      int32_t variable = 0;
+      std::memcpy(&variable, code.data() + offset, 4);
+      if (fixed_variables.count(variable) > 0) {
+        return;
+      }
+      auto [name, inserted] = names.try_emplace(variable, next_name);
+      if (inserted) {
+        while (fixed_variables.count(name->second) > 0) {
+          ++name->second;
+        }
+        next_name = name->second + 1;
+      }
+      std::memcpy(code.data() + offset, &name->second, 4);
+    });
+  }
+}
+}  // namespace
+
+Program ProgramCanonicalizer::canonicalize(
+    ProgramView code, bool rename_variables, const std::set<int32_t>& fixed_variables) {
+  std::vector<unsigned char> canonical = removeUnreachableTail(code);
+  if (!ProgramOptimizer::isRelocatable(canonical)) {
+    return Program(std::move(canonical));
+  }
+
+  normalizeFlags(canonical);
+  for (size_t pass = 0; pass < kMaxOptimizerPasses; ++pass) {
+    std::vector<unsigned char> optimized = ProgramOptimizer::optimize(canonical).program.getData();
+    if (optimized == canonical) {
+      break;
+    }
+    canonical = std::move(optimized);
+  }
+  if (rename_variables) {
+    renameVariables(canonical, fixed_variables);
+  }
+  return Program(std::move(canonical));
+}
+
+FitnessCache::Key ProgramCanonicalizer::makeKey(
+    ProgramView code, uint64_t configuration, bool rename_variables,
+    const std::set<int32_t>& fixed_variables) {
+  return FitnessCache::makeKey(
+      canonicalize(code, rename_variables, fixed_variables).getData(), configuration);
+}
+
+}  // namespace beast
@@ -0,0 +1,437 @@
+#include <beast/program_corpus.hpp>
+
+// Standard
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Identifies corpus files
+ */
+const std::array<char, 8> kMagic = {'B', 'E', 'A', 'S', 'T', 'C', 'R', 'P'};
+
+/**
+ * @brief The version of the file format
+ */
+const uint32_t kFormatVersion = 1;
+
+/**
+ * @brief Reads differently if the file was written on a host with a different byte order
+ */
+const uint32_t kByteOrderMark = 0x01020304;
+
+/**
+ * @brief The fixed size header at the start of every corpus file
+ */
+struct FileHeader {
+  std::array<char, 8> magic;  ///< Always kMagic
+  uint32_t version;           ///< Always kFormatVersion
+  uint32_t byte_order_mark;   ///< Always kByteOrderMark
+  uint32_t compressed;        ///< Whether programs are stored in compressed blocks
+  uint32_t reserved;          ///< Always 0
+  uint64_t record_count;      ///< The number of programs
+  uint64_t block_count;       ///< The number of compression blocks; 0 if uncompressed
+  uint64_t file_size;         ///< The size of the whole file, to detect truncation
+};
+
+/**
+ * @brief Locates a program and holds its metadata; the index holds one per program
+ */
+struct IndexEntry {
+  uint64_t offset;      ///< The program's offset from the start of the file, or of its block
+  uint64_t size;        ///< The number of bytes
+  uint64_t hash_high;   ///< The upper 64 bits of the content hash
+  uint64_t hash_low;    ///< The lower 64 bits of the content hash
+  double score;         ///< The score the program achieved
+  uint32_t generation;  ///< The generation the program was found in
+  uint32_t block;       ///< The block holding the program; 0 if uncompressed
+};
+
+/**
+ * @brief Locates a compression block; the block table follows the index
+ */
+struct BlockEntry {
+  uint64_t offset;       ///< The offset of the stored block from the start of the file
+  uint64_t stored_size;  ///< The number of stored bytes
+  uint64_t raw_size;     ///< The number of bytes after decompression; equal if stored as is
+};
+
+static_assert(sizeof(FileHeader) % alignof(IndexEntry) == 0, "Index must be aligned.");
+static_assert(sizeof(IndexEntry) % alignof(BlockEntry) == 0, "Block table must be aligned.");
+
+/**
+ * @brief The shortest repetition the codec encodes as a match
+ */
+const size_t kMinimumMatchLength = 4;
+
+/**
+ * @brief The number of bits of the codec's match finder hash
+ */
+const uint32_t kHashBits = 12;
+
+/**
+ * @brief The farthest back a match can reach
+ */
+const size_t kMaximumMatchOffset = 0xffff;
+
+/**
+ * @brief Appends the part of a length that exceeds its four bit token field
+ */
+void appendLengthExtension(std::vector<unsigned char>& output, size_t length) {
+  while (length >= 0xff) {
+    output.push_back(0xff);
+    length -= 0xff;
+  }
+  output.push_back(static_cast<unsigned char>(length));
+}
+
+/**
+ * @brief Appends literals, followed by a match unless `match_length` is 0
+ *
+ * Every sequence starts with a token holding four bits of the literal count and four bits of the
+ * match length beyond the minimum; values of 15 are extended by subsequent bytes.
+ */
+void appendSequence(
+    std::vector<unsigned char>& output, const unsigned char* literals, size_t literal_count,
+    size_t match_offset, size_t match_length) {
+  const size_t match_code = match_length == 0 ? 0 : match_length - kMinimumMatchLength;
+  output.push_back(static_cast<unsigned char>(
+      (std::min<size_t>(literal_count, 15) << 4U) | std::min<size_t>(match_code, 15)));
+  if (literal_count >= 15) {
+    appendLengthExtension(output, literal_count - 15);
+  }
+  output.insert(output.end(), literals, literals + literal_count);
+  if (match_length == 0) {
+    return;
+  }
+  const auto offset = static_cast<uint16_t>(match_offset);
+  const size_t offset_position = output.size();
+  output.resize(offset_position + sizeof(offset));
+  std::memcpy(&output[offset_position], &offset, sizeof(offset));
+  if (match_code >= 15) {
+    appendLengthExtension(output, match_code - 15);
+  }
+}
+
+/**
+ * @brief Compresses a block with a greedy LZ77 codec; the last sequence holds literals only
+ */
+std::vector<unsigned char> compressBlock(const unsigned char* data, size_t size) {
+  std::vector<unsigned char> output;
+  output.reserve(size / 2 + 16);
+  std::vector<size_t> last_positions(size_t{1} << kHashBits, std::numeric_limits<size_t>::max());
+
+  size_t literal_start = 0;
+  size_t position = 0;
+  while (position + kMinimumMatchLength <= size) {
+    uint32_t sequence = 0;
+    std::memcpy(&sequence, data + position, sizeof(sequence));
+    const size_t slot = (sequence * 2654435761U) >> (32U - kHashBits);
+    const size_t candidate = last_positions[slot];
+    last_positions[slot] = position;
+    if (candidate == std::numeric_limits<size_t>::max() ||
+        position - candidate > kMaximumMatchOffset ||
+        std::memcmp(data + candidate, data + position, kMinimumMatchLength) != 0) {
+      position++;
+      continue;
+    }
+
+    size_t match_length = kMinimumMatchLength;
+    while (position + match_length < size &&
+           data[candidate + match_length] == data[position + match_length]) {
+      match_length++;
+    }
+    appendSequence(output, data + literal_start, position - literal_start, position - candidate,
+                   match_length);
+    position += match_length;
+    literal_start = position;
+  }
+  appendSequence(output, data + literal_start, size - literal_start, 0, 0);
+  return output;
+}
+
+/**
+ * @brief Reads the part of a length that exceeds its four bit token field
+ */
+size_t readLengthExtension(const unsigned char* input, size_t size, size_t& position) {
+  size_t length = 0;
+  unsigned char byte = 0xff;
+  while (byte == 0xff) {
+    if (position >= size) {
+      throw std::runtime_error("Corpus block is corrupt.");
+    }
+    byte = input[position++];
+    length += byte;
+  }
+  return length;
+}
+
+/**
+ * @brief Decompresses a block written by compressBlock(), throwing if it is corrupt
+ */
+void decompressBlock(
+    const unsigned char* input, size_t size, size_t raw_size, std::vector<unsigned char>& output) {
+  output.clear();
+  output.reserve(raw_size);
+  size_t position = 0;
+  while (position < size) {
+    const unsigned char token = input[position++];
+    size_t literal_count = token >> 4U;
+    if (literal_count == 15) {
+      literal_count += readLengthExtension(input, size, position);
+    }
+    if (literal_count > size - position || literal_count > raw_size - output.size()) {
+      throw std::runtime_error("Corpus block is corrupt.");
+    }
+    output.insert(output.end(), input + position, input + position + literal_count);
+    position += literal_count;
+    if (position == size) {
+      break;
+    }
+
+    uint16_t match_offset = 0;
+    if (size - position < sizeof(match_offset)) {
+      throw std::runtime_error("Corpus block is corrupt.");
+    }
+    std::memcpy(&match_offset, input + position, sizeof(match_offset));
+    position += sizeof(match_offset);
+    size_t match_length = (token & 0x0fU) + kMinimumMatchLength;
+    if ((token & 0x0fU) == 15) {
+      match_length += readLengthExtension(input, size, position);
+    }
+    if (match_offset == 0 || match_offset > output.size() ||
+        match_length > raw_size - output.size()) {
+      throw std::runtime_error("Corpus block is corrupt.");
+    }
+    // Matches may overlap the bytes they produce, so they are copied byte by byte.
+    const size_t match_start = output.size() - match_offset;
+    for (size_t idx = 0; idx < match_length; ++idx) {
+      output.push_back(output[match_start + idx]);
+    }
+  }
+  if (output.size() != raw_size) {
+    throw std::runtime_error("Corpus block is corrupt.");
+  }
+}
+
+/**
+ * @brief Returns the header of a mapped corpus file
+ */
+FileHeader readHeader(const MappedFile& file) noexcept {
+  FileHeader header{};
+  std::memcpy(&header, file.getData(), sizeof(FileHeader));
+  return header;
+}
+
+/**
+ * @brief Returns the index entry of a program in a mapped corpus file, which must be in range
+ */
+IndexEntry readIndexEntry(const MappedFile& file, size_t index) noexcept {
+  IndexEntry entry{};
+  std::memcpy(&entry, file.getData() + sizeof(FileHeader) + index * sizeof(IndexEntry),
+              sizeof(IndexEntry));
+  return entry;
+}
+
+/**
+ * @brief Returns whether a region lies within a mapped file
+ */
+bool liesWithin(const MappedFile& file, uint64_t offset, uint64_t size) noexcept {
+  return offset <= file.getSize() && size <= file.getSize() - offset;
+}
+}  // namespace
+
+ProgramCorpus::ProgramCorpus(size_t block_size) : block_size_{block_size} {
+}
+
+void ProgramCorpus::addProgram(ProgramView program, double score, uint32_t generation) {
+  const Metadata metadata{score, FitnessCache::makeKey(program, 0), generation};
+  records_.push_back({data_.size(), program.getSize(), metadata});
+  data_.insert(data_.end(), program.begin(), program.end());
+}
+
+size_t ProgramCorpus::getRecordCount() const noexcept {
+  return records_.size();
+}
+
+std::vector<unsigned char> ProgramCorpus::serialize() const {
+  std::vector<IndexEntry> index;
+  index.reserve(records_.size());
+  for (const Record& record : records_) {
+    index.push_back({record.offset, record.size, record.metadata.hash.high,
+                     record.metadata.hash.low, record.metadata.score, record.metadata.generation,
+                     0});
+  }
+
+  // Blocks end after the first record that fills them up to the block size.
+  std::vector<BlockEntry> blocks;
+  std::vector<std::vector<unsigned char>> stored_blocks;
+  if (block_size_ > 0) {
+    size_t block_start = 0;
+    for (size_t record_idx = 0; record_idx < records_.size(); ++record_idx) {
+      const Record& record = records_[record_idx];
+      index[record_idx].offset = record.offset - block_start;
+      index[record_idx].block = static_cast<uint32_t>(blocks.size());
+      const size_t block_end = record.offset + record.size;
+      if (block_end - block_start >= block_size_ || record_idx + 1 == records_.size()) {
+        std::vector<unsigned char> stored =
+            compressBlock(data_.data() + block_start, block_end - block_start);
+        if (stored.size() >= block_end - block_start) {
+          stored.assign(data_.begin() + static_cast<std::ptrdiff_t>(block_start),
+                        data_.begin() + static_cast<std::ptrdiff_t>(block_end));
+        }
+        blocks.push_back({0, stored.size(), block_end - block_start});
+        stored_blocks.push_back(std::move(stored));
+        block_start = block_end;
+      }
+    }
+    if (blocks.size() > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("Corpus has too many blocks.");
+    }
+  }
+
+  FileHeader header{};
+  header.magic = kMagic;
+  header.version = kFormatVersion;
+  header.byte_order_mark = kByteOrderMark;
+  header.compressed = block_size_ > 0 ? 1 : 0;
+  header.record_count = records_.size();
+  header.block_count = blocks.size();
+  const size_t blob_offset =
+      sizeof(FileHeader) + index.size() * sizeof(IndexEntry) + blocks.size() * sizeof(BlockEntry);
+  size_t blob_size = data_.size();
+  if (block_size_ > 0) {
+    blob_size = 0;
+    for (BlockEntry& block : blocks) {
+      block.offset = blob_offset + blob_size;
+      blob_size += block.stored_size;
+    }
+  } else {
+    for (IndexEntry& entry : index) {
+      entry.offset += blob_offset;
+    }
+  }
+  header.file_size = blob_offset + blob_size;
+
+  std::vector<unsigned char> buffer(header.file_size);
+  std::memcpy(buffer.data(), &header, sizeof(FileHeader));
+  if (!index.empty()) {
+    std::memcpy(&buffer[sizeof(FileHeader)], index.data(), index.size() * sizeof(IndexEntry));
+  }
+  if (!blocks.empty()) {
+    std::memcpy(&buffer[sizeof(FileHeader) + index.size() * sizeof(IndexEntry)], blocks.data(),
+                blocks.size() * sizeof(BlockEntry));
+  }
+  if (block_size_ > 0) {
+    for (size_t block_idx = 0; block_idx < blocks.size(); ++block_idx) {
+      std::copy(stored_blocks[block_idx].begin(), stored_blocks[block_idx].end(),
+                buffer.begin() + static_cast<std::ptrdiff_t>(blocks[block_idx].offset));
+    }
+  } else {
+    std::copy(data_.begin(), data_.end(),
+              buffer.begin() + static_cast<std::ptrdiff_t>(blob_offset));
+  }
+  return buffer;
+}
+
+void ProgramCorpus::write(const std::string& path) const {
+  MappedFile::writeAtomically(path, serialize());
+}
+
+MappedProgramCorpus::MappedProgramCorpus(const std::string& path) : file_{path} {
+  const size_t size = file_.getSize();
+  bool valid = size >= sizeof(FileHeader);
+  if (valid) {
+    const FileHeader header = readHeader(file_);
+    const uint64_t table_capacity = size - sizeof(FileHeader);
+    valid = header.magic == kMagic && header.version == kFormatVersion &&
+            header.byte_order_mark == kByteOrderMark && header.file_size == size &&
+            header.record_count <= table_capacity / sizeof(IndexEntry) &&
+            header.block_count <=
+                (table_capacity - header.record_count * sizeof(IndexEntry)) / sizeof(BlockEntry) &&
+            (header.compressed != 0 || header.block_count == 0);
+  }
+  if (!valid) {
+    throw std::runtime_error("Not a valid program corpus: " + path);
+  }
+}
+
+size_t MappedProgramCorpus::getRecordCount() const noexcept {
+  return static_cast<size_t>(readHeader(file_).record_count);
+}
+
+bool MappedProgramCorpus::isCompressed() const noexcept {
+  return readHeader(file_).compressed != 0;
+}
+
+ProgramCorpus::Metadata MappedProgramCorpus::getMetadata(size_t index) const {
+  if (index >= getRecordCount()) {
+    throw std::out_of_range("Corpus record index out of range.");
+  }
+  const IndexEntry entry = readIndexEntry(file_, index);
+  return {entry.score, {entry.hash_high, entry.hash_low}, entry.generation};
+}
+
+MappedProgramCorpus::Record MappedProgramCorpus::getRecord(size_t index) const {
+  if (isCompressed()) {
+    throw std::logic_error("Records of compressed corpora need a block cache.");
+  }
+  BlockCache unused_cache;
+  return getRecord(index, unused_cache);
+}
+
+MappedProgramCorpus::Record MappedProgramCorpus::getRecord(size_t index, BlockCache& cache) const {
+  const ProgramCorpus::Metadata metadata = getMetadata(index);
+  const IndexEntry entry = readIndexEntry(file_, index);
+  const FileHeader header = readHeader(file_);
+  if (header.compressed == 0) {
+    if (!liesWithin(file_, entry.offset, entry.size)) {
+      throw std::runtime_error("Corpus record lies outside of the file.");
+    }
+    return {ProgramView(file_.getData() + entry.offset, static_cast<size_t>(entry.size)), metadata};
+  }
+
+  if (entry.block >= header.block_count) {
+    throw std::runtime_error("Corpus record lies outside of the blocks.");
+  }
+  BlockEntry block{};
+  std::memcpy(&block,
+              file_.getData() + sizeof(FileHeader) + header.record_count * sizeof(IndexEntry) +
+                  entry.block * sizeof(BlockEntry),
+              sizeof(BlockEntry));
+  if (!liesWithin(file_, block.offset, block.stored_size) || block.stored_size > block.raw_size ||
+      entry.offset > block.raw_size || entry.size > block.raw_size - entry.offset) {
+    throw std::runtime_error("Corpus record lies outside of the file.");
+  }
+  if (block.stored_size == block.raw_size) {
+    // Blocks that didn't shrink are stored as they are and can be viewed in place.
+    return {ProgramView(file_.getData() + block.offset + entry.offset,
+                        static_cast<size_t>(entry.size)),
+            metadata};
+  }
+
+  if (cache.corpus_ != this || cache.block_ != entry.block) {
+    // Invalidate the cache first, so a corrupt block doesn't leave a partial block behind.
+    cache.corpus_ = nullptr;
+    decompressBlock(file_.getData() + block.offset, static_cast<size_t>(block.stored_size),
+                    static_cast<size_t>(block.raw_size), cache.data_);
+    cache.corpus_ = this;
+    cache.block_ = entry.block;
+  }
+  return {ProgramView(cache.data_.data() + entry.offset, static_cast<size_t>(entry.size)),
+          metadata};
+}
+
+std::vector<unsigned char> MappedProgramCorpus::copyProgram(size_t index) const {
+  BlockCache cache;
+  const ProgramView program = getRecord(index, cache).program;
+  return {program.getData(), program.getData() + program.getSize()};
+}
+
+}  // namespace beast
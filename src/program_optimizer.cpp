@@ -0,0 +1,502 @@
+#include <beast/program_optimizer.hpp>
+
+// Standard
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Internal
+#include <beast/control_flow_graph.hpp>
+#include <beast/instruction_decoder.hpp>
+#include <beast/opcodes.hpp>
+
+namespace beast {
+
+namespace {
+using Instruction = InstructionDecoder::Instruction;
+
+/**
+ * @brief Marks instructions without a constant jump target
+ */
+constexpr size_t kNoTarget = std::numeric_limits<size_t>::max();
+
+/**
+ * @brief An instruction of the byte code being optimized
+ */
+struct Node {
+  Instruction instruction;    ///< The instruction as decoded from the original byte code
+  OpCode opcode;              ///< The instruction's current operator
+  size_t target = kNoTarget;  ///< The index of the jump target's node; the node count denotes the
+                              ///  end of the code
+  bool rewritten = false;     ///< Whether the instruction became an unconditional absolute jump
+  bool removed = false;       ///< Whether the instruction is dropped from the optimized code
+};
+
+/**
+ * @brief Denotes whether execution never continues with the next instruction
+ */
+bool endsFlow(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::Terminate:
+  case OpCode::TerminateWithVariableReturnCode:
+  case OpCode::UnconditionalJumpToAbsoluteAddress:
+  case OpCode::UnconditionalJumpToRelativeAddress:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Denotes whether an operator jumps to a constant address if a variable's value qualifies
+ */
+bool isConditionalJump(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::RelativeJumpIfVariableGt0:
+  case OpCode::RelativeJumpIfVariableLt0:
+  case OpCode::RelativeJumpIfVariableEq0:
+  case OpCode::AbsoluteJumpIfVariableGt0:
+  case OpCode::AbsoluteJumpIfVariableLt0:
+  case OpCode::AbsoluteJumpIfVariableEq0:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Denotes whether an operator's behavior depends on the addresses of instructions
+ */
+bool dependsOnLayout(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::LoadCurrentAddressIntoVariable:
+  case OpCode::RelativeJumpToVariableAddressIfVariableGt0:
+  case OpCode::RelativeJumpToVariableAddressIfVariableLt0:
+  case OpCode::RelativeJumpToVariableAddressIfVariableEq0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableGt0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableLt0:
+  case OpCode::AbsoluteJumpToVariableAddressIfVariableEq0:
+  case OpCode::UnconditionalJumpToAbsoluteVariableAddress:
+  case OpCode::UnconditionalJumpToRelativeVariableAddress:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Denotes whether an operator is known to modify no variables
+ *
+ * Value tracking forgets all known values at every other operator.
+ */
+bool preservesVariables(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::NoOp:
+  case OpCode::Terminate:
+  case OpCode::TerminateWithVariableReturnCode:
+  case OpCode::UnconditionalJumpToAbsoluteAddress:
+  case OpCode::UnconditionalJumpToRelativeAddress:
+  case OpCode::PrintVariable:
+  case OpCode::SetStringTableEntry:
+  case OpCode::PrintStringFromStringTable:
+  case OpCode::PrintVariableStringFromStringTable:
+    return true;
+
+  default:
+    return isConditionalJump(opcode);
+  }
+}
+
+int32_t readData4(ProgramView code, size_t offset) {
+  int32_t data = 0;
+  std::memcpy(&data, code.getData() + offset, 4);
+  return data;
+}
+
+/**
+ * @brief Returns the offsets of all operands of an instruction, in encoding order
+ */
+std::vector<size_t> getOperandOffsets(ProgramView code, const Instruction& instruction) {
+  std::vector<size_t> offsets;
+  size_t offset = instruction.offset + 1;
+  for (const InstructionDecoder::OperandType type :
+       InstructionDecoder::getOperandTypes(instruction.opcode)) {
+    offsets.push_back(offset);
+    if (type == InstructionDecoder::OperandType::String) {
+      int16_t length = 0;
+      std::memcpy(&length, code.getData() + offset, 2);
+      offset += static_cast<size_t>(length);
+    }
+    offset += InstructionDecoder::getOperandSize(type);
+  }
+  return offsets;
+}
+
+/**
+ * @brief Decodes relocatable byte code into nodes whose jump targets refer to other nodes
+ */
+std::vector<Node> makeNodes(ProgramView code) {
+  std::vector<Node> nodes;
+  std::vector<size_t> node_at(code.getSize() + 1, kNoTarget);
+  for (const Instruction& instruction : InstructionDecoder::decodeAll(code)) {
+    node_at[instruction.offset] = nodes.size();
+    nodes.push_back({instruction, instruction.opcode});
+  }
+  node_at[code.getSize()] = nodes.size();
+
+  for (Node& node : nodes) {
+    if (const std::optional<int64_t> target =
+            InstructionDecoder::getJumpTarget(code, node.instruction)) {
+      node.target = node_at[static_cast<size_t>(*target)];
+    }
+  }
+  return nodes;
+}
+
+/**
+ * @brief Determines whether the values of variables can be tracked through the code
+ */
+bool allowsValueTracking(ProgramView code, const std::vector<Node>& nodes) {
+  for (const Node& node : nodes) {
+    if (ControlFlowGraph::usesVariableIo(node.opcode)) {
+      return false;
+    }
+    if (node.opcode == OpCode::DeclareVariable &&
+        code[getOperandOffsets(code, node.instruction)[1]] ==
+            static_cast<unsigned char>(Program::VariableType::Link)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Determines whether a comparison holds for two values
+ */
+bool compare(OpCode opcode, int32_t value_a, int32_t value_b) noexcept {
+  switch (opcode) {
+  case OpCode::CompareIfVariableGtConstant:
+  case OpCode::CompareIfVariableGtVariable:
+    return value_a > value_b;
+
+  case OpCode::CompareIfVariableLtConstant:
+  case OpCode::CompareIfVariableLtVariable:
+    return value_a < value_b;
+
+  default:
+    return value_a == value_b;
+  }
+}
+
+/**
+ * @brief Determines whether a conditional jump is taken for a condition variable's value
+ */
+bool isJumpTaken(OpCode opcode, int32_t value) noexcept {
+  switch (opcode) {
+  case OpCode::RelativeJumpIfVariableGt0:
+  case OpCode::AbsoluteJumpIfVariableGt0:
+    return value > 0;
+
+  case OpCode::RelativeJumpIfVariableLt0:
+  case OpCode::AbsoluteJumpIfVariableLt0:
+    return value < 0;
+
+  default:
+    return value == 0;
+  }
+}
+
+/**
+ * @brief Tracks variable values through straight-line code to fold jumps and drop stores
+ *
+ * Known values are forgotten at every instruction that can be entered by a jump, so every removal
+ * holds for all paths through the instruction.
+ */
+void foldValues(ProgramView code, std::vector<Node>& nodes) {
+  std::vector<bool> entered_by_jump(nodes.size(), false);
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    if (nodes[idx].target < nodes.size()) {
+      entered_by_jump[nodes[idx].target] = true;
+    }
+  }
+
+  std::map<int32_t, int32_t> values;
+  // The last kept instruction, if it is a SetVariable; removed instructions don't interrupt it.
+  size_t last_store = kNoTarget;
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    Node& node = nodes[idx];
+    if (entered_by_jump[idx]) {
+      values.clear();
+    }
+    const std::vector<size_t> operands = getOperandOffsets(code, node.instruction);
+
+    switch (node.opcode) {
+    case OpCode::NoOp:
+      break;
+
+    case OpCode::SetVariable: {
+      const int32_t variable = readData4(code, operands[0]);
+      const int32_t value = readData4(code, operands[2]);
+      const auto known = values.find(variable);
+      if (known != values.end() && known->second == value) {
+        node.removed = true;
+        break;
+      }
+      if (last_store != kNoTarget) {
+        // The previous store is overwritten before anything could read it.
+        const std::vector<size_t> last_operands =
+            getOperandOffsets(code, nodes[last_store].instruction);
+        if (readData4(code, last_operands[0]) == variable &&
+            code[last_operands[1]] == code[operands[1]]) {
+          nodes[last_store].removed = true;
+        }
+      }
+      values[variable] = value;
+      last_store = idx;
+    } break;
+
+    case OpCode::CompareIfVariableGtConstant:
+    case OpCode::CompareIfVariableLtConstant:
+    case OpCode::CompareIfVariableEqConstant:
+    case OpCode::CompareIfVariableGtVariable:
+    case OpCode::CompareIfVariableLtVariable:
+    case OpCode::CompareIfVariableEqVariable: {
+      const bool constant_operand = node.opcode == OpCode::CompareIfVariableGtConstant ||
+                                    node.opcode == OpCode::CompareIfVariableLtConstant ||
+                                    node.opcode == OpCode::CompareIfVariableEqConstant;
+      const auto value_a = values.find(readData4(code, operands[0]));
+      const auto value_b =
+          constant_operand ? values.end() : values.find(readData4(code, operands[2]));
+      const int32_t target_variable = readData4(code, operands[constant_operand ? 3 : 4]);
+      if (value_a != values.end() && (constant_operand || value_b != values.end())) {
+        const int32_t operand_b = constant_operand ? readData4(code, operands[2]) : value_b->second;
+        values[target_variable] = compare(node.opcode, value_a->second, operand_b) ? 0x1 : 0x0;
+      } else {
+        values.erase(target_variable);
+      }
+      last_store = kNoTarget;
+    } break;
+
+    default:
+      if (isConditionalJump(node.opcode)) {
+        const auto value = values.find(readData4(code, operands[0]));
+        if (value != values.end()) {
+          if (isJumpTaken(node.opcode, value->second)) {
+            node.opcode = OpCode::UnconditionalJumpToAbsoluteAddress;
+            node.rewritten = true;
+          } else {
+            node.removed = true;
+            break;
+          }
+        }
+      } else if (!preservesVariables(node.opcode)) {
+        values.clear();
+      }
+      last_store = kNoTarget;
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Retargets jumps that lead to unconditional jumps to the final target of the chain
+ */
+void threadJumps(std::vector<Node>& nodes) {
+  for (Node& node : nodes) {
+    if (node.removed || node.target == kNoTarget) {
+      continue;
+    }
+    std::set<size_t> visited;
+    size_t target = node.target;
+    while (target < nodes.size() && visited.insert(target).second) {
+      const Node& next = nodes[target];
+      if (next.removed || next.opcode == OpCode::NoOp) {
+        ++target;
+      } else if (next.opcode == OpCode::UnconditionalJumpToAbsoluteAddress ||
+                 next.opcode == OpCode::UnconditionalJumpToRelativeAddress) {
+        target = next.target;
+      } else {
+        break;
+      }
+    }
+    node.target = target;
+  }
+}
+
+/**
+ * @brief Removes all instructions that can't be reached from the first one
+ */
+void removeUnreachable(std::vector<Node>& nodes) {
+  std::vector<bool> reached(nodes.size(), false);
+  std::vector<size_t> open_nodes;
+  if (!nodes.empty()) {
+    open_nodes.push_back(0);
+  }
+  while (!open_nodes.empty()) {
+    const size_t idx = open_nodes.back();
+    open_nodes.pop_back();
+    if (idx >= nodes.size() || reached[idx]) {
+      continue;
+    }
+    reached[idx] = true;
+
+    // Removed instructions pass execution on to the next one.
+    const Node& node = nodes[idx];
+    if (node.removed || !endsFlow(node.opcode)) {
+      open_nodes.push_back(idx + 1);
+    }
+    if (!node.removed && node.target != kNoTarget) {
+      open_nodes.push_back(node.target);
+    }
+  }
+
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    nodes[idx].removed = nodes[idx].removed || !reached[idx];
+  }
+}
+
+/**
+ * @brief Returns, for every node index and the end of the code, the index of the next kept node
+ */
+std::vector<size_t> getNextKept(const std::vector<Node>& nodes) {
+  std::vector<size_t> next_kept(nodes.size() + 1, nodes.size());
+  for (size_t idx = nodes.size(); idx > 0; --idx) {
+    next_kept[idx - 1] = nodes[idx - 1].removed ? next_kept[idx] : idx - 1;
+  }
+  return next_kept;
+}
+
+/**
+ * @brief Removes NoOps and unconditional jumps to the instruction that is executed next anyway
+ */
+void removeIdleInstructions(std::vector<Node>& nodes) {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    const std::vector<size_t> next_kept = getNextKept(nodes);
+    for (size_t idx = 0; idx < nodes.size(); ++idx) {
+      Node& node = nodes[idx];
+      if (node.removed) {
+        continue;
+      }
+      if (node.opcode == OpCode::NoOp ||
+          (endsFlow(node.opcode) && node.target != kNoTarget &&
+           next_kept[node.target] == next_kept[idx + 1])) {
+        node.removed = true;
+        changed = true;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Encodes the kept nodes and relocates their jump targets
+ */
+ProgramOptimizer::Result emit(ProgramView code, const std::vector<Node>& nodes) {
+  Program absolute_jump;
+  absolute_jump.unconditionalJumpToAbsoluteAddress(0);
+  const std::vector<unsigned char>& absolute_jump_code = absolute_jump.getData();
+
+  // Removed nodes get the address of the next kept one, which is where jumps to them now land.
+  std::vector<size_t> new_offsets(nodes.size() + 1, 0);
+  size_t offset = 0;
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    new_offsets[idx] = offset;
+    if (!nodes[idx].removed) {
+      offset += nodes[idx].rewritten ? absolute_jump_code.size() : nodes[idx].instruction.size;
+    }
+  }
+  new_offsets[nodes.size()] = offset;
+
+  ProgramOptimizer::Result result;
+  std::vector<unsigned char> optimized;
+  optimized.reserve(offset);
+  for (size_t idx = 0; idx < nodes.size(); ++idx) {
+    const Node& node = nodes[idx];
+    if (node.removed) {
+      continue;
+    }
+    Instruction instruction = node.instruction;
+    instruction.offset = optimized.size();
+    if (node.rewritten) {
+      instruction.size = absolute_jump_code.size();
+      instruction.opcode = node.opcode;
+      optimized.insert(optimized.end(), absolute_jump_code.begin(), absolute_jump_code.end());
+    } else {
+      const unsigned char* begin = code.getData() + node.instruction.offset;
+      optimized.insert(optimized.end(), begin, begin + node.instruction.size);
+    }
+    if (node.target != kNoTarget) {
+      InstructionDecoder::setJumpTarget(
+          optimized, instruction, static_cast<int64_t>(new_offsets[node.target]));
+    }
+    result.address_map[node.instruction.offset] = instruction.offset;
+  }
+
+  if (optimized.empty() && !nodes.empty()) {
+    // Empty byte code fails on its first step, while the original code ran to its end.
+    optimized.push_back(static_cast<unsigned char>(OpCode::NoOp));
+  }
+
+  result.program = Program(std::move(optimized));
+  return result;
+}
+}  // namespace
+
+ProgramOptimizer::Result ProgramOptimizer::optimize(ProgramView code) {
+  if (!isRelocatable(code)) {
+    Result result;
+    result.program = code.toProgram();
+    for (const Instruction& instruction : InstructionDecoder::decodeAll(code)) {
+      result.address_map[instruction.offset] = instruction.offset;
+    }
+    return result;
+  }
+
+  std::vector<Node> nodes = makeNodes(code);
+  if (allowsValueTracking(code, nodes)) {
+    foldValues(code, nodes);
+  }
+  threadJumps(nodes);
+  removeUnreachable(nodes);
+  removeIdleInstructions(nodes);
+  return emit(code, nodes);
+}
+
+bool ProgramOptimizer::isRelocatable(ProgramView code) {
+  const std::vector<Instruction> instructions = InstructionDecoder::decodeAll(code);
+  std::vector<bool> instruction_starts(code.getSize() + 1, false);
+  size_t decoded_size = 0;
+  for (const Instruction& instruction : instructions) {
+    if (dependsOnLayout(instruction.opcode)) {
+      return false;
+    }
+    instruction_starts[instruction.offset] = true;
+    decoded_size += instruction.size;
+  }
+  if (decoded_size != code.getSize()) {
+    return false;
+  }
+  // Jumping to the end of the code terminates the program regularly.
+  instruction_starts[code.getSize()] = true;
+
+  for (const Instruction& instruction : instructions) {
+    if (const std::optional<int64_t> target =
+            InstructionDecoder::getJumpTarget(code, instruction)) {
+      if (*target < 0 || *target > static_cast<int64_t>(code.getSize()) ||
+          !instruction_starts[static_cast<size_t>(*target)]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace beast
@@ -0,0 +1,81 @@
+#include <beast/program_verifier.hpp>
+
+// Standard
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+// Internal
+#include <beast/instruction_decoder.hpp>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief Returns a failed verification result
+ */
+ProgramVerifier::Result fail(size_t offset, std::string error) {
+  ProgramVerifier::Result result;
+  result.offset = offset;
+  result.error = std::move(error);
+  return result;
+}
+}  // namespace
+
+ProgramVerifier::Result ProgramVerifier::verify(ProgramView code, size_t variable_count) {
+  using OperandType = InstructionDecoder::OperandType;
+
+  std::vector<bool> instruction_starts(code.getSize(), false);
+  std::vector<std::pair<size_t, int64_t>> jumps;
+  size_t offset = 0;
+  while (offset < code.getSize()) {
+    const std::optional<InstructionDecoder::Instruction> instruction =
+        InstructionDecoder::decode(code, offset);
+    if (!instruction) {
+      return fail(
+          offset, InstructionDecoder::isKnownOpCode(code[offset]) ? "Truncated instruction."
+                                                                  : "Unknown operator.");
+    }
+    instruction_starts[offset] = true;
+
+    size_t operand_offset = offset + 1;
+    for (const OperandType type : InstructionDecoder::getOperandTypes(instruction->opcode)) {
+      if (type == OperandType::Variable) {
+        int32_t variable_index = 0;
+        std::memcpy(&variable_index, code.getData() + operand_offset, 4);
+        if (variable_index < 0 || static_cast<size_t>(variable_index) >= variable_count) {
+          return fail(offset, "Variable index out of range.");
+        }
+      } else if (type == OperandType::String) {
+        int16_t length = 0;
+        std::memcpy(&length, code.getData() + operand_offset, 2);
+        operand_offset += static_cast<size_t>(length);
+      }
+      operand_offset += InstructionDecoder::getOperandSize(type);
+    }
+
+    if (const std::optional<int64_t> target =
+            InstructionDecoder::getJumpTarget(code, *instruction)) {
+      jumps.emplace_back(offset, *target);
+    }
+    offset += instruction->size;
+  }
+
+  // Targets can point backwards and forwards, so they are checked once all boundaries are known.
+  // Jumping to the end of the code ends the program regularly.
+  for (const auto& [jump_offset, target] : jumps) {
+    if (target < 0 || target > static_cast<int64_t>(code.getSize()) ||
+        (target < static_cast<int64_t>(code.getSize()) &&
+         !instruction_starts[static_cast<size_t>(target)])) {
+      return fail(jump_offset, "Jump target is not on an instruction boundary.");
+    }
+  }
+
+  Result result;
+  result.valid = true;
+  result.instruction_starts = std::move(instruction_starts);
+  return result;
+}
+
+}  // namespace beast
@@ -0,0 +1,75 @@
+#include <beast/program_view.hpp>
+
+// Standard
+#include <cstring>
+#include <stdexcept>
+
+namespace beast {
+
+ProgramView::ProgramView(const unsigned char* data, size_t size) noexcept
+  : data_{data}, size_{size} {
+}
+
+ProgramView::ProgramView(const std::vector<unsigned char>& data) noexcept
+  : data_{data.data()}, size_{data.size()} {
+}
+
+ProgramView::ProgramView(const Program& program) noexcept : ProgramView(program.getData()) {
+}
+
+const unsigned char* ProgramView::getData() const noexcept {
+  return data_;
+}
+
+size_t ProgramView::getSize() const noexcept {
+  return size_;
+}
+
+bool ProgramView::empty() const noexcept {
+  return size_ == 0;
+}
+
+const unsigned char* ProgramView::begin() const noexcept {
+  return data_;
+}
+
+const unsigned char* ProgramView::end() const noexcept {
+  return data_ + size_;
+}
+
+unsigned char ProgramView::operator[](size_t offset) const noexcept {
+  return data_[offset];
+}
+
+int32_t ProgramView::getData4(int32_t offset) const {
+  checkRange(offset, 4);
+  int32_t buffer = 0x0;
+  std::memcpy(&buffer, data_ + offset, 4);
+  return buffer;
+}
+
+int16_t ProgramView::getData2(int32_t offset) const {
+  checkRange(offset, 2);
+  int16_t buffer = 0x0;
+  std::memcpy(&buffer, data_ + offset, 2);
+  return buffer;
+}
+
+int8_t ProgramView::getData1(int32_t offset) const {
+  checkRange(offset, 1);
+  int8_t buffer = 0x0;
+  std::memcpy(&buffer, data_ + offset, 1);
+  return buffer;
+}
+
+Program ProgramView::toProgram() const {
+  return Program(std::vector<unsigned char>(begin(), end()));
+}
+
+void ProgramView::checkRange(int32_t offset, size_t size) const {
+  if (offset < 0 || static_cast<size_t>(offset) + size > size_) {
+    throw std::underflow_error("Unable to retrieve data (not enough data left).");
+  }
+}
+
+}  // namespace beast
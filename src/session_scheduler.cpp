@@ -0,0 +1,230 @@
+#include <beast/session_scheduler.hpp>
+
+// Standard
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief The pass increment of a priority 1 session for one full time slice
+ *
+ * Strides are computed by dividing this constant by the session priority, so it needs to be large
+ * enough to keep the relative error of the integer division small for all sensible priorities.
+ */
+const uint64_t kStrideNumerator = 1U << 20U;
+
+/**
+ * @brief Computes the stride of a session from its priority, throwing for priority 0
+ */
+uint64_t strideForPriority(uint32_t priority) {
+  if (priority == 0) {
+    throw std::invalid_argument("Session priority must be greater than 0.");
+  }
+  return kStrideNumerator / priority;
+}
+}  // namespace
+
+SessionScheduler::SessionScheduler(
+    VirtualMachine& virtual_machine, uint32_t thread_count, uint32_t step_quantum)
+  : virtual_machine_{virtual_machine}, step_quantum_{std::max(step_quantum, 1U)} {
+  for (uint32_t idx = 0; idx < thread_count; ++idx) {
+    threads_.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+SessionScheduler::~SessionScheduler() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+  }
+  queue_changed_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+SessionScheduler::SessionId SessionScheduler::addSession(VmSession session, uint32_t priority) {
+  const uint64_t stride = strideForPriority(priority);
+  auto entry = std::make_shared<Entry>(std::move(session));
+  entry->stride = stride;
+
+  std::scoped_lock lock(mutex_);
+  const SessionId session_id = next_session_id_++;
+  Entry& entry_reference = *entry;
+  sessions_[session_id] = std::move(entry);
+
+  if (entry_reference.session.isAtEnd()) {
+    entry_reference.state = SessionState::Finished;
+  } else if (entry_reference.session.isWaitingForInput()) {
+    entry_reference.state = SessionState::WaitingForInput;
+  } else {
+    makeRunnable(session_id, entry_reference);
+  }
+
+  return session_id;
+}
+
+VmSession SessionScheduler::removeSession(SessionId session_id) {
+  std::unique_lock lock(mutex_);
+  const std::shared_ptr<Entry> entry = getEntry(session_id);
+  session_released_.wait(lock, [&entry]() { return entry->state != SessionState::Running; });
+
+  if (entry->state == SessionState::Runnable) {
+    run_queue_.erase({entry->pass, session_id});
+  }
+  entry->removed = true;
+  sessions_.erase(session_id);
+  lock.unlock();
+
+  // Accessors that got hold of the entry before may still be running; the session's mutex is
+  // acquired before `mutex_`, so it is only taken once the entry is unreachable.
+  std::scoped_lock session_lock(entry->mutex);
+  return std::move(entry->session);
+}
+
+void SessionScheduler::setPriority(SessionId session_id, uint32_t priority) {
+  const uint64_t stride = strideForPriority(priority);
+  std::scoped_lock lock(mutex_);
+  getEntry(session_id)->stride = stride;
+}
+
+void SessionScheduler::setInput(SessionId session_id, int32_t variable_index, int32_t value) {
+  accessSession(session_id, [variable_index, value](VmSession& session) {
+    session.setVariableValue(variable_index, true, value);
+  });
+}
+
+void SessionScheduler::accessSession(
+    SessionId session_id, const std::function<void(VmSession&)>& accessor) {
+  std::shared_ptr<Entry> entry;
+  {
+    std::scoped_lock lock(mutex_);
+    entry = getEntry(session_id);
+  }
+
+  std::scoped_lock session_lock(entry->mutex);
+  if (entry->removed) {
+    throw std::invalid_argument("Unknown session id: " + std::to_string(session_id));
+  }
+  accessor(entry->session);
+  wakeIfInputArrived(session_id, *entry);
+}
+
+SessionScheduler::SessionState SessionScheduler::getState(SessionId session_id) const {
+  std::scoped_lock lock(mutex_);
+  return getEntry(session_id)->state;
+}
+
+size_t SessionScheduler::getSessionCount() const {
+  std::scoped_lock lock(mutex_);
+  return sessions_.size();
+}
+
+bool SessionScheduler::runQuantum() {
+  std::unique_lock lock(mutex_);
+  if (run_queue_.empty()) {
+    return false;
+  }
+
+  const auto [session_id, entry] = dispatchNext();
+  lock.unlock();
+
+  executeQuantum(session_id, *entry);
+  return true;
+}
+
+void SessionScheduler::waitUntilIdle() {
+  std::unique_lock lock(mutex_);
+  session_released_.wait(lock, [this]() { return run_queue_.empty() && running_count_ == 0; });
+}
+
+const std::shared_ptr<SessionScheduler::Entry>& SessionScheduler::getEntry(
+    SessionId session_id) const {
+  const auto iterator = sessions_.find(session_id);
+  if (iterator == sessions_.end()) {
+    throw std::invalid_argument("Unknown session id: " + std::to_string(session_id));
+  }
+  return iterator->second;
+}
+
+std::pair<SessionScheduler::SessionId, std::shared_ptr<SessionScheduler::Entry>>
+SessionScheduler::dispatchNext() {
+  const auto [pass, session_id] = *run_queue_.begin();
+  run_queue_.erase(run_queue_.begin());
+  global_pass_ = pass;
+
+  const std::shared_ptr<Entry>& entry = sessions_.at(session_id);
+  entry->state = SessionState::Running;
+  running_count_++;
+
+  return {session_id, entry};
+}
+
+void SessionScheduler::makeRunnable(SessionId session_id, Entry& entry) {
+  entry.pass = std::max(entry.pass, global_pass_);
+  entry.state = SessionState::Runnable;
+  run_queue_.emplace(entry.pass, session_id);
+  queue_changed_.notify_one();
+}
+
+void SessionScheduler::wakeIfInputArrived(SessionId session_id, Entry& entry) {
+  std::scoped_lock lock(mutex_);
+  if (!entry.removed && entry.state == SessionState::WaitingForInput &&
+      !entry.session.isWaitingForInput()) {
+    makeRunnable(session_id, entry);
+  }
+}
+
+void SessionScheduler::executeQuantum(SessionId session_id, Entry& entry) {
+  std::scoped_lock session_lock(entry.mutex);
+
+  uint32_t steps = 0;
+  bool active = !entry.session.isAtEnd();
+  while (active && steps < step_quantum_ && !entry.session.isWaitingForInput()) {
+    try {
+      active = virtual_machine_.step(entry.session, false);
+    } catch (...) {
+      // Programs that throw are treated like programs that crashed.
+      entry.session.setExitedAbnormally();
+      active = false;
+    }
+    steps++;
+  }
+
+  {
+    std::scoped_lock lock(mutex_);
+    running_count_--;
+    // Sessions that yield early (e.g. to wait for input) are only charged for what they used.
+    entry.pass += std::max<uint64_t>(entry.stride * steps / step_quantum_, 1);
+    if (!active) {
+      entry.state = SessionState::Finished;
+    } else if (entry.session.isWaitingForInput()) {
+      entry.state = SessionState::WaitingForInput;
+    } else {
+      entry.state = SessionState::Runnable;
+      run_queue_.emplace(entry.pass, session_id);
+      queue_changed_.notify_one();
+    }
+  }
+  session_released_.notify_all();
+}
+
+void SessionScheduler::workerLoop() {
+  while (true) {
+    std::unique_lock lock(mutex_);
+    queue_changed_.wait(lock, [this]() { return !run_queue_.empty() || stopping_; });
+    if (stopping_) {
+      break;
+    }
+
+    const auto [session_id, entry] = dispatchNext();
+    lock.unlock();
+
+    executeQuantum(session_id, *entry);
+  }
+}
+
+}  // namespace beast
@@ -0,0 +1,185 @@
+#include <beast/surrogate_model.hpp>
+
+// Standard
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Internal
+#include <beast/instruction_decoder.hpp>
+#include <beast/opcodes.hpp>
+
+namespace beast {
+
+namespace {
+/**
+ * @brief The features preceding the operator shares: bias, size, and reachable fraction
+ */
+constexpr size_t kLeadingFeatureCount = 3;
+
+/**
+ * @brief Denotes whether execution never continues with the next instruction
+ */
+bool endsFlow(OpCode opcode) noexcept {
+  switch (opcode) {
+    case OpCode::Terminate:
+    case OpCode::TerminateWithVariableReturnCode:
+    case OpCode::UnconditionalJumpToAbsoluteAddress:
+    case OpCode::UnconditionalJumpToAbsoluteVariableAddress:
+    case OpCode::UnconditionalJumpToRelativeAddress:
+    case OpCode::UnconditionalJumpToRelativeVariableAddress:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Denotes whether an operator jumps to an address held in a variable
+ */
+bool jumpsToVariableAddress(OpCode opcode) noexcept {
+  switch (opcode) {
+    case OpCode::RelativeJumpToVariableAddressIfVariableGt0:
+    case OpCode::RelativeJumpToVariableAddressIfVariableLt0:
+    case OpCode::RelativeJumpToVariableAddressIfVariableEq0:
+    case OpCode::AbsoluteJumpToVariableAddressIfVariableGt0:
+    case OpCode::AbsoluteJumpToVariableAddressIfVariableLt0:
+    case OpCode::AbsoluteJumpToVariableAddressIfVariableEq0:
+    case OpCode::UnconditionalJumpToAbsoluteVariableAddress:
+    case OpCode::UnconditionalJumpToRelativeVariableAddress:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Returns the fraction of the code's bytes that belong to instructions reachable from the
+ *        first one
+ */
+double getReachableFraction(ProgramView program,
+    const std::vector<InstructionDecoder::Instruction>& instructions) {
+  if (program.empty()) {
+    return 0.0;
+  }
+
+  std::vector<bool> reached(instructions.size(), false);
+  std::vector<size_t> open_instructions;
+  if (!instructions.empty()) {
+    open_instructions.push_back(0);
+  }
+  size_t reachable_bytes = 0;
+  while (!open_instructions.empty()) {
+    const size_t idx = open_instructions.back();
+    open_instructions.pop_back();
+    if (reached[idx]) {
+      continue;
+    }
+    reached[idx] = true;
+
+    const InstructionDecoder::Instruction& instruction = instructions[idx];
+    reachable_bytes += instruction.size;
+    if (jumpsToVariableAddress(instruction.opcode)) {
+      return 1.0;
+    }
+    if (!endsFlow(instruction.opcode) && idx + 1 < instructions.size()) {
+      open_instructions.push_back(idx + 1);
+    }
+    if (const std::optional<int64_t> target =
+            InstructionDecoder::getJumpTarget(program, instruction)) {
+      // Targets that don't hit an instruction boundary end execution with an error.
+      const auto match = std::lower_bound(
+          instructions.begin(), instructions.end(), *target,
+          [](const InstructionDecoder::Instruction& candidate, int64_t offset) {
+            return static_cast<int64_t>(candidate.offset) < offset;
+          });
+      if (match != instructions.end() && static_cast<int64_t>(match->offset) == *target) {
+        open_instructions.push_back(static_cast<size_t>(match - instructions.begin()));
+      }
+    }
+  }
+  return static_cast<double>(reachable_bytes) / static_cast<double>(program.getSize());
+}
+}  // namespace
+
+SurrogateModel::SurrogateModel(double learning_rate)
+  : learning_rate_{learning_rate}, weights_(getFeatureCount(), 0.0) {
+  if (!(learning_rate > 0.0 && learning_rate < 2.0)) {
+    throw std::invalid_argument("Surrogate learning rate must be within (0.0, 2.0).");
+  }
+}
+
+std::vector<double> SurrogateModel::extractFeatures(ProgramView program) {
+  const std::vector<InstructionDecoder::Instruction> instructions =
+      InstructionDecoder::decodeAll(program);
+
+  std::vector<double> features(getFeatureCount(), 0.0);
+  features[0] = 1.0;
+  // Sizes span orders of magnitude; their logarithm keeps the feature in the range of the others.
+  features[1] = std::log2(1.0 + static_cast<double>(program.getSize())) / 16.0;
+  features[2] = getReachableFraction(program, instructions);
+  for (const InstructionDecoder::Instruction& instruction : instructions) {
+    features[kLeadingFeatureCount + static_cast<size_t>(instruction.opcode)] += 1.0;
+  }
+  if (!instructions.empty()) {
+    for (size_t idx = kLeadingFeatureCount; idx < features.size(); ++idx) {
+      features[idx] /= static_cast<double>(instructions.size());
+    }
+  }
+  return features;
+}
+
+size_t SurrogateModel::getFeatureCount() noexcept {
+  return kLeadingFeatureCount + static_cast<size_t>(OpCode::Size);
+}
+
+double SurrogateModel::predict(const std::vector<double>& features) const {
+  if (features.size() != weights_.size()) {
+    throw std::invalid_argument("Surrogate features have the wrong size.");
+  }
+
+  std::scoped_lock lock(mutex_);
+  return predictUnlocked(features);
+}
+
+void SurrogateModel::train(const std::vector<double>& features, double score) {
+  if (features.size() != weights_.size()) {
+    throw std::invalid_argument("Surrogate features have the wrong size.");
+  }
+
+  double squared_norm = 0.0;
+  for (const double feature : features) {
+    squared_norm += feature * feature;
+  }
+
+  std::scoped_lock lock(mutex_);
+  const double error = score - predictUnlocked(features);
+  const double step = learning_rate_ * error / (squared_norm + 1e-9);
+  for (size_t idx = 0; idx < weights_.size(); ++idx) {
+    weights_[idx] += step * features[idx];
+  }
+
+  ++sample_count_;
+  const double error_weight = 1.0 / static_cast<double>(std::min<uint64_t>(sample_count_, 64));
+  mean_absolute_error_ += error_weight * (std::abs(error) - mean_absolute_error_);
+}
+
+uint64_t SurrogateModel::getSampleCount() const {
+  std::scoped_lock lock(mutex_);
+  return sample_count_;
+}
+
+double SurrogateModel::getMeanAbsoluteError() const {
+  std::scoped_lock lock(mutex_);
+  return mean_absolute_error_;
+}
+
+double SurrogateModel::predictUnlocked(const std::vector<double>& features) const {
+  double prediction = 0.0;
+  for (size_t idx = 0; idx < weights_.size(); ++idx) {
+    prediction += weights_[idx] * features[idx];
+  }
+  return prediction;
+}
+
+}  // namespace beast
@@ -1,47 +1,75 @@
 #include <beast/virtual_machine.hpp>
 
+// Standard
+#include <chrono>
+
+// Internal
+#include <beast/message_sink.hpp>
+
 namespace beast {
 
 void VirtualMachine::setMinimumMessageSeverity(MessageSeverity minimum_severity) noexcept {
-  minimum_severity_ = minimum_severity;
+  minimum_severity_.store(minimum_severity, std::memory_order_relaxed);
+}
+
+void VirtualMachine::setMessageSink(std::shared_ptr<MessageSink> sink) noexcept {
+  message_sink_ = std::move(sink);
+}
+
+const std::shared_ptr<MessageSink>& VirtualMachine::getMessageSink() const noexcept {
+  return message_sink_;
 }
 
 void VirtualMachine::debug(const std::string& message) noexcept {
-  if (shouldDisplayMessageWithSeverity(MessageSeverity::Debug) && !silent_) {
-    this->message(MessageSeverity::Debug, message);
+  if (shouldDisplayMessageWithSeverity(MessageSeverity::Debug)) {
+    emitMessage(MessageSeverity::Debug, message);
   }
 }
 
 void VirtualMachine::info(const std::string& message) noexcept {
-  if (shouldDisplayMessageWithSeverity(MessageSeverity::Info) && !silent_) {
-    this->message(MessageSeverity::Info, message);
+  if (shouldDisplayMessageWithSeverity(MessageSeverity::Info)) {
+    emitMessage(MessageSeverity::Info, message);
   }
 }
 
 void VirtualMachine::warning(const std::string& message) noexcept {
-  if (shouldDisplayMessageWithSeverity(MessageSeverity::Warning) && !silent_) {
-    this->message(MessageSeverity::Warning, message);
+  if (shouldDisplayMessageWithSeverity(MessageSeverity::Warning)) {
+    emitMessage(MessageSeverity::Warning, message);
   }
 }
 
 void VirtualMachine::error(const std::string& message) noexcept {
-  if (shouldDisplayMessageWithSeverity(MessageSeverity::Error) && !silent_) {
-    this->message(MessageSeverity::Error, message);
+  if (shouldDisplayMessageWithSeverity(MessageSeverity::Error)) {
+    emitMessage(MessageSeverity::Error, message);
   }
 }
 
 void VirtualMachine::panic(const std::string& message) noexcept {
-  if (shouldDisplayMessageWithSeverity(MessageSeverity::Panic) && !silent_) {
-    this->message(MessageSeverity::Panic, message);
+  if (shouldDisplayMessageWithSeverity(MessageSeverity::Panic)) {
+    emitMessage(MessageSeverity::Panic, message);
   }
 }
 
 bool VirtualMachine::shouldDisplayMessageWithSeverity(MessageSeverity severity) const noexcept {
-  return static_cast<uint32_t>(severity) >= static_cast<uint32_t>(minimum_severity_);
+  return !silent_.load(std::memory_order_relaxed) &&
+         static_cast<uint32_t>(severity) >=
+             static_cast<uint32_t>(minimum_severity_.load(std::memory_order_relaxed));
+}
+
+void VirtualMachine::emitMessage(MessageSeverity severity, const std::string& message) noexcept {
+  if (message_sink_) {
+    message_sink_->write(severity, std::chrono::system_clock::now(), message);
+  } else {
+    this->message(severity, message);
+  }
+}
+
+bool VirtualMachine::stepBlock(VmSession& session, bool dry_run) {
+  return step(session, dry_run);
 }
 
-void VirtualMachine::setSilent(bool silent) {
-  silent_ = silent;
+void VirtualMachine::setSilent(bool silent) noexcept {
+  silent_.store(silent, std::memory_order_relaxed);
 }
 
 }  // namespace beast
@@ -2,20 +2,60 @@
 
 // Standard
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <random>
 #include <set>
 #include <stdexcept>
+#include <utility>
 
 // Internal
+#include <beast/control_flow_graph.hpp>
 #include <beast/time_functions.hpp>
 
 namespace beast {
 
+namespace {
+/**
+ * @brief How many steps pass between two wall clock checks
+ *
+ * Reading the clock is comparably expensive, so the time limit is only checked every this many
+ * steps. Must be a power of two.
+ */
+const uint32_t kWallTimeCheckInterval = 256;
+
+/**
+ * @brief Determines whether an operator may stop execution or make the session wait for input
+ *
+ * Execution blocks end after these operators, so that callers notice right after the block.
+ */
+bool mayStopExecution(OpCode opcode) noexcept {
+  switch (opcode) {
+  case OpCode::PrintVariable:
+  case OpCode::PrintStringFromStringTable:
+  case OpCode::PrintVariableStringFromStringTable:
+  case OpCode::CheckIfInputWasSet:
+    return true;
+
+  default:
+    return false;
+  }
+}
+}  // namespace
+
 VmSession::VmSession(
     Program program, size_t variable_count, size_t string_table_count,
-    size_t max_string_size)
-  : program_{std::move(program)}, variable_count_{variable_count}
+    size_t max_string_size, ProgramEncoding encoding)
+  : program_{std::make_shared<const Program>(std::move(program))}, code_{*program_}
+  , encoding_{encoding}, variable_count_{variable_count}, string_table_count_{string_table_count}
+  , max_string_size_{max_string_size} {
+  resetRuntimeStatistics();
+}
+
+VmSession::VmSession(
+    ProgramView program, size_t variable_count, size_t string_table_count,
+    size_t max_string_size, ProgramEncoding encoding)
+  : code_{program}, encoding_{encoding}, variable_count_{variable_count}
   , string_table_count_{string_table_count}, max_string_size_{max_string_size} {
   resetRuntimeStatistics();
 }
@@ -28,6 +68,8 @@ void VmSession::informAboutStep(OpCode operator_code) noexcept {
 
 void VmSession::resetRuntimeStatistics() noexcept {
   runtime_statistics_ = RuntimeStatistics{};
+  print_output_size_ = 0;
+  covered_blocks_.assign(covered_blocks_.size(), false);
 }
 
 void VmSession::reset() noexcept {
@@ -36,12 +78,37 @@ void VmSession::reset() noexcept {
   string_table_ = std::map<int32_t, std::string>{};
   print_buffer_ = "";
   pointer_ = 0;
+  unchecked_instruction_ = false;
+  replaying_ = false;
+  waiting_for_input_ = false;
+  if (random_seed_.has_value()) {
+    random_engine_.seed(*random_seed_);
+  }
 }
 
 const VmSession::RuntimeStatistics& VmSession::getRuntimeStatistics() const noexcept {
   return runtime_statistics_;
 }
 
+const Program& VmSession::getProgram() const {
+  if (program_ == nullptr) {
+    throw std::logic_error("Session executes a program view and holds no program.");
+  }
+  return *program_;
+}
+
+ProgramView VmSession::getProgramView() const noexcept {
+  return code_;
+}
+
+ProgramEncoding VmSession::getProgramEncoding() const noexcept {
+  return encoding_;
+}
+
+int32_t VmSession::getPointer() const noexcept {
+  return pointer_;
+}
+
 void VmSession::setVariableBehavior(int32_t variable_index, VariableIoBehavior behavior) {
   VariableDescriptor descriptor({Program::VariableType::Int32, behavior, false});
   variables_[variable_index] = std::make_pair(descriptor, 0);
@@ -71,24 +138,436 @@ void VmSession::setMaximumPrintBufferLength(size_t maximum_print_buffer_length)
   maximum_print_buffer_length_ = maximum_print_buffer_length;
 }
 
+void VmSession::setExecutionLimits(const ExecutionLimits& limits) noexcept {
+  execution_limits_ = limits;
+  // Limits set on a program that already runs are measured from now on.
+  execution_start_ = std::chrono::steady_clock::now();
+}
+
+const VmSession::ExecutionLimits& VmSession::getExecutionLimits() const noexcept {
+  return execution_limits_;
+}
+
+void VmSession::setCancellationToken(std::shared_ptr<const CancellationToken> token) noexcept {
+  cancellation_token_ = std::move(token);
+}
+
+void VmSession::setRandomSeed(uint32_t seed) noexcept {
+  random_seed_ = seed;
+  random_engine_.seed(seed);
+}
+
+std::optional<uint32_t> VmSession::getRandomSeed() const noexcept {
+  return random_seed_;
+}
+
+bool VmSession::checkExecutionLimits() noexcept {
+  if (cancellation_token_ && cancellation_token_->isCancelled()) {
+    runtime_statistics_.cancelled = true;
+  }
+
+  const uint32_t steps = runtime_statistics_.steps_executed;
+  if (execution_limits_.max_steps > 0 && steps >= execution_limits_.max_steps) {
+    runtime_statistics_.step_limit_exceeded = true;
+  }
+
+  if (execution_limits_.max_wall_time.count() > 0) {
+    if (steps == 0) {
+      execution_start_ = std::chrono::steady_clock::now();
+    } else if ((steps & (kWallTimeCheckInterval - 1)) == 0 &&
+               std::chrono::steady_clock::now() - execution_start_ >
+                   execution_limits_.max_wall_time) {
+      runtime_statistics_.time_limit_exceeded = true;
+    }
+  }
+
+  return !runtime_statistics_.cancelled && !runtime_statistics_.step_limit_exceeded &&
+         !runtime_statistics_.time_limit_exceeded && !runtime_statistics_.print_limit_exceeded;
+}
+
+void VmSession::prepareBasicBlocks() {
+  if (basic_blocks_ != nullptr) {
+    return;
+  }
+
+  auto table = std::make_shared<BasicBlockTable>();
+  table->block_at.assign(code_.getSize(), 0);
+  const ControlFlowGraph graph(code_, encoding_);
+  for (const ControlFlowGraph::BasicBlock& graph_block : graph.getBlocks()) {
+    BasicBlockSummary* block = nullptr;
+    for (const InstructionDecoder::Instruction& instruction : graph_block.instructions) {
+      if (block == nullptr) {
+        block = &table->blocks.emplace_back();
+        block->index = table->blocks.size() - 1;
+        block->begin = instruction.offset;
+        table->block_at[instruction.offset] = table->blocks.size();
+      }
+      // The executed index is the instruction pointer after fetching the operator (and the flag
+      // byte of compact instructions with several flags).
+      size_t executed_index = instruction.offset + 1;
+      if (encoding_ == ProgramEncoding::Compact &&
+          (code_[instruction.offset] & CompactEncoding::kFlagBit) != 0 &&
+          CompactEncoding::getFlagCount(instruction.opcode) > 1) {
+        executed_index++;
+      }
+      block->operators.push_back(instruction.opcode);
+      block->executed_indices.push_back(static_cast<uint32_t>(executed_index));
+      if (mayStopExecution(instruction.opcode)) {
+        block = nullptr;
+      }
+    }
+  }
+
+  for (BasicBlockSummary& block : table->blocks) {
+    block.instruction_count = static_cast<uint32_t>(block.operators.size());
+    std::map<OpCode, uint32_t> operator_counts;
+    for (const OpCode opcode : block.operators) {
+      operator_counts[opcode]++;
+    }
+    block.operator_counts.assign(operator_counts.begin(), operator_counts.end());
+  }
+  covered_blocks_.assign(table->blocks.size(), false);
+  basic_blocks_ = std::move(table);
+}
+
+const VmSession::BasicBlockSummary* VmSession::beginBasicBlock() {
+  prepareBasicBlocks();
+  if (pointer_ < 0 || static_cast<size_t>(pointer_) >= code_.getSize()) {
+    return nullptr;
+  }
+  const size_t entry = basic_blocks_->block_at[static_cast<size_t>(pointer_)];
+  if (entry == 0 || !checkExecutionLimits()) {
+    return nullptr;
+  }
+
+  const BasicBlockSummary& block = basic_blocks_->blocks[entry - 1];
+  const uint64_t steps = runtime_statistics_.steps_executed;
+  const uint64_t last_step = steps + block.instruction_count - 1;
+  if (execution_limits_.max_steps > 0 && last_step >= execution_limits_.max_steps) {
+    // Single steps stop exactly at the limit.
+    return nullptr;
+  }
+  if (execution_limits_.max_wall_time.count() > 0 &&
+      last_step / kWallTimeCheckInterval > steps / kWallTimeCheckInterval &&
+      std::chrono::steady_clock::now() - execution_start_ > execution_limits_.max_wall_time) {
+    // One of the block's steps would have consulted the clock.
+    runtime_statistics_.time_limit_exceeded = true;
+    return nullptr;
+  }
+  return &block;
+}
+
+void VmSession::endBasicBlock(const BasicBlockSummary& block, size_t executed_count) noexcept {
+  runtime_statistics_.steps_executed += static_cast<uint32_t>(executed_count);
+  if (executed_count < block.instruction_count) {
+    for (size_t idx = 0; idx < executed_count; ++idx) {
+      runtime_statistics_.operator_executions[block.operators[idx]]++;
+      runtime_statistics_.executed_indices.insert(block.executed_indices[idx]);
+    }
+    return;
+  }
+
+  for (const auto& [opcode, count] : block.operator_counts) {
+    runtime_statistics_.operator_executions[opcode] += count;
+  }
+  // Executed indices stay recorded until the runtime statistics are reset.
+  if (!covered_blocks_[block.index]) {
+    runtime_statistics_.executed_indices.insert(
+        block.executed_indices.begin(), block.executed_indices.end());
+    covered_blocks_[block.index] = true;
+  }
+}
+
 int32_t VmSession::getData4() {
-  int32_t data = program_.getData4(pointer_);
-  pointer_ += 4;
+  if (replaying_) {
+    return replayOperand();
+  }
+
+  int32_t data = 0;
+  if (encoding_ == ProgramEncoding::Compact) {
+    nextCompactOperand();
+    data = CompactEncoding::toSigned(fetchVarint());
+  } else {
+    if (unchecked_instruction_) {
+      std::memcpy(&data, code_.getData() + pointer_, 4);
+    } else {
+      data = code_.getData4(pointer_);
+    }
+    pointer_ += 4;
+  }
   return data;
 }
 
 int16_t VmSession::getData2() {
-  int16_t data = program_.getData2(pointer_);
+  // Only strings have two byte operands, and instructions with strings are never cached.
+  if (encoding_ == ProgramEncoding::Compact) {
+    // The string's characters follow the length.
+    nextCompactOperand();
+    const uint32_t length = fetchVarint();
+    compact_string_bytes_ = length;
+    return static_cast<int16_t>(length);
+  }
+
+  int16_t data = 0;
+  if (unchecked_instruction_) {
+    std::memcpy(&data, code_.getData() + pointer_, 2);
+  } else {
+    data = code_.getData2(pointer_);
+  }
   pointer_ += 2;
   return data;
 }
 
 int8_t VmSession::getData1() {
-  int8_t data = program_.getData1(pointer_);
-  pointer_ += 1;
+  if (replaying_) {
+    return static_cast<int8_t>(replayOperand());
+  }
+
+  int8_t data = 0;
+  if (encoding_ == ProgramEncoding::Compact) {
+    if (compact_string_bytes_ > 0) {
+      compact_string_bytes_--;
+      data = static_cast<int8_t>(fetchByte());
+    } else if (nextCompactOperand() == InstructionDecoder::OperandType::Flag) {
+      data = static_cast<int8_t>((compact_flags_ >> compact_flag_++) & 0x1);
+    } else {
+      data = static_cast<int8_t>(fetchByte());
+    }
+  } else {
+    if (unchecked_instruction_) {
+      std::memcpy(&data, code_.getData() + pointer_, 1);
+    } else {
+      data = code_.getData1(pointer_);
+    }
+    pointer_ += 1;
+  }
   return data;
 }
 
+ProgramVerifier::Result VmSession::verifyProgram() {
+  if (encoding_ == ProgramEncoding::Compact) {
+    return verifyCompactProgram();
+  }
+
+  ProgramVerifier::Result result = ProgramVerifier::verify(code_, variable_count_);
+  instruction_starts_ = result.valid
+      ? std::make_shared<const std::vector<bool>>(result.instruction_starts)
+      : nullptr;
+  return result;
+}
+
+bool VmSession::isProgramVerified() const noexcept {
+  return instruction_starts_ != nullptr;
+}
+
+int8_t VmSession::beginInstruction() {
+  replaying_ = false;
+  if (decode_cache_ != nullptr && pointer_ >= 0 &&
+      static_cast<size_t>(pointer_) < decode_cache_->instruction_at.size()) {
+    const uint32_t entry = decode_cache_->instruction_at[static_cast<size_t>(pointer_)];
+    if (entry > 0) {
+      // The operands are replayed, so nothing is read from the byte code during this step.
+      unchecked_instruction_ = false;
+      compact_operands_ = nullptr;
+      pending_instruction_ = decode_cache_->instructions[entry - 1];
+      pending_offset_ = pointer_;
+      pending_operand_ = 0;
+      pointer_ += pending_instruction_.operand_count > 0 ? pending_instruction_.prefix_size
+                                                         : pending_instruction_.size;
+      replaying_ = pending_instruction_.operand_count > 0;
+      return pending_instruction_.opcode;
+    }
+  }
+
+  // The verified boundaries guarantee that the whole instruction lies within the program. Jumps to
+  // variable addresses may land anywhere, so the boundary is checked for every instruction.
+  unchecked_instruction_ =
+      instruction_starts_ != nullptr && pointer_ >= 0 &&
+      static_cast<size_t>(pointer_) < instruction_starts_->size() &&
+      (*instruction_starts_)[static_cast<size_t>(pointer_)];
+  if (encoding_ == ProgramEncoding::Compact) {
+    return beginCompactInstruction();
+  }
+  return getData1();
+}
+
+void VmSession::setDecodeCacheEnabled(bool enabled) {
+  replaying_ = false;
+  if (!enabled) {
+    decode_cache_ = nullptr;
+    return;
+  }
+  if (decode_cache_ != nullptr) {
+    return;
+  }
+
+  auto table = std::make_shared<DecodeTable>();
+  table->instruction_at.assign(code_.getSize(), 0);
+  const bool is_compact = encoding_ == ProgramEncoding::Compact;
+  const std::vector<InstructionDecoder::Instruction> instructions =
+      is_compact ? CompactEncoding::decodeAll(code_) : InstructionDecoder::decodeAll(code_);
+  for (const InstructionDecoder::Instruction& instruction : instructions) {
+    const std::vector<InstructionDecoder::OperandType>& operands =
+        InstructionDecoder::getOperandTypes(instruction.opcode);
+    if (operands.size() > kMaxDecodedOperands) {
+      continue;
+    }
+
+    // Holds the operands as getData4() and getData1() would return them.
+    DecodedInstruction decoded;
+    decoded.opcode = static_cast<int8_t>(instruction.opcode);
+    decoded.size = static_cast<uint8_t>(instruction.size);
+    decoded.operand_count = static_cast<uint8_t>(operands.size());
+    size_t offset = instruction.offset + 1;
+    uint32_t flags = 0;
+    if (is_compact && (code_[instruction.offset] & CompactEncoding::kFlagBit) != 0) {
+      flags = CompactEncoding::getFlagCount(instruction.opcode) == 1 ? 0x1 : code_[offset++];
+    }
+    decoded.prefix_size = static_cast<uint8_t>(offset - instruction.offset);
+    size_t flag = 0;
+    bool cacheable = true;
+    for (size_t idx = 0; idx < operands.size() && cacheable; ++idx) {
+      const InstructionDecoder::OperandType type = operands[idx];
+      if (type == InstructionDecoder::OperandType::String) {
+        cacheable = false;
+      } else if (is_compact && type == InstructionDecoder::OperandType::Flag) {
+        decoded.operands[idx] = static_cast<int32_t>((flags >> flag++) & 0x1);
+      } else if (InstructionDecoder::getOperandSize(type) == 1) {
+        decoded.operands[idx] = static_cast<int8_t>(code_[offset++]);
+      } else if (is_compact) {
+        const std::optional<CompactEncoding::Varint> varint =
+            CompactEncoding::readVarint(code_, offset);
+        decoded.operands[idx] = CompactEncoding::toSigned(varint->value);
+        offset += varint->size;
+      } else {
+        std::memcpy(&decoded.operands[idx], code_.getData() + offset, 4);
+        offset += 4;
+      }
+    }
+    if (cacheable) {
+      table->instructions.push_back(decoded);
+      table->instruction_at[instruction.offset] = static_cast<uint32_t>(table->instructions.size());
+    }
+  }
+  decode_cache_ = std::move(table);
+}
+
+size_t VmSession::getDecodedInstructionCount() const noexcept {
+  return decode_cache_ != nullptr ? decode_cache_->instructions.size() : 0;
+}
+
+int32_t VmSession::replayOperand() noexcept {
+  const int32_t value = pending_instruction_.operands[pending_operand_++];
+  if (pending_operand_ == pending_instruction_.operand_count) {
+    replaying_ = false;
+    pointer_ = pending_offset_ + static_cast<int32_t>(pending_instruction_.size);
+  }
+  return value;
+}
+
+ProgramVerifier::Result VmSession::verifyCompactProgram() {
+  using Instruction = InstructionDecoder::Instruction;
+
+  instruction_starts_ = nullptr;
+  const std::vector<Instruction> instructions = CompactEncoding::decodeAll(code_);
+  std::vector<bool> instruction_starts(code_.getSize(), false);
+  size_t offset = 0;
+  for (const Instruction& instruction : instructions) {
+    instruction_starts[instruction.offset] = true;
+    offset += instruction.size;
+  }
+
+  ProgramVerifier::Result result;
+  if (offset < code_.getSize()) {
+    result.offset = offset;
+    result.error = "Undecodable compact instruction.";
+    return result;
+  }
+  for (const Instruction& instruction : instructions) {
+    const std::optional<int64_t> target = CompactEncoding::getJumpTarget(code_, instruction);
+    if (target.has_value() &&
+        (*target < 0 || *target > static_cast<int64_t>(code_.getSize()) ||
+         (*target < static_cast<int64_t>(code_.getSize()) &&
+          !instruction_starts[static_cast<size_t>(*target)]))) {
+      result.offset = instruction.offset;
+      result.error = "Jump target is not on an instruction boundary.";
+      return result;
+    }
+  }
+
+  // Both encodings hold the same instructions in the same order.
+  const std::vector<unsigned char> standard_code = CompactEncoding::expand(code_);
+  result = ProgramVerifier::verify(standard_code, variable_count_);
+  if (!result.valid) {
+    const std::vector<Instruction> standard_instructions =
+        InstructionDecoder::decodeAll(standard_code);
+    for (size_t idx = 0; idx < standard_instructions.size(); ++idx) {
+      if (standard_instructions[idx].offset == result.offset) {
+        result.offset = instructions[idx].offset;
+        break;
+      }
+    }
+    return result;
+  }
+  result.instruction_starts = std::move(instruction_starts);
+  instruction_starts_ = std::make_shared<const std::vector<bool>>(result.instruction_starts);
+  return result;
+}
+
+unsigned char VmSession::fetchByte() {
+  unsigned char byte = 0;
+  if (unchecked_instruction_) {
+    byte = code_[static_cast<size_t>(pointer_)];
+  } else {
+    byte = static_cast<unsigned char>(code_.getData1(pointer_));
+  }
+  pointer_ += 1;
+  return byte;
+}
+
+uint32_t VmSession::fetchVarint() {
+  uint32_t value = 0;
+  for (uint32_t shift = 0; shift < 35; shift += 7) {
+    const unsigned char byte = fetchByte();
+    value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::underflow_error("Unable to retrieve data (varint too long).");
+}
+
+int8_t VmSession::beginCompactInstruction() {
+  compact_operands_ = nullptr;
+  compact_operand_ = 0;
+  compact_flags_ = 0;
+  compact_flag_ = 0;
+  compact_string_bytes_ = 0;
+
+  const unsigned char byte = fetchByte();
+  const auto opcode = static_cast<unsigned char>(byte & ~CompactEncoding::kFlagBit);
+  if (!InstructionDecoder::isKnownOpCode(opcode)) {
+    return static_cast<int8_t>(byte);
+  }
+  const size_t flag_count = CompactEncoding::getFlagCount(static_cast<OpCode>(opcode));
+  if ((byte & CompactEncoding::kFlagBit) != 0) {
+    if (flag_count == 0) {
+      // Not a valid compact OpCode; the virtual machine rejects it as an unknown operator.
+      return static_cast<int8_t>(byte);
+    }
+    compact_flags_ = flag_count == 1 ? 0x1 : fetchByte();
+  }
+  compact_operands_ = &InstructionDecoder::getOperandTypes(static_cast<OpCode>(opcode));
+  return static_cast<int8_t>(opcode);
+}
+
+InstructionDecoder::OperandType VmSession::nextCompactOperand() {
+  if (compact_operands_ == nullptr || compact_operand_ >= compact_operands_->size()) {
+    throw std::underflow_error("Unable to retrieve data (no operand left).");
+  }
+  return (*compact_operands_)[compact_operand_++];
+}
+
 int32_t VmSession::getVariableValue(int32_t variable_index, bool follow_links) {
   auto& [variable, value] = variables_[getRealVariableIndex(variable_index, follow_links)];
   if (variable.behavior == VariableIoBehavior::Output) {
@@ -109,6 +588,7 @@ void VmSession::setVariableValue(int32_t variable_index, bool follow_links, int3
   auto& [variable, current_value] = variables_[getRealVariableIndex(variable_index, follow_links)];
   if (variable.behavior == VariableIoBehavior::Input) {
     variable.changed_since_last_interaction = true;
+    waiting_for_input_ = false;
   }
   current_value = value;
 }
@@ -122,13 +602,19 @@ void VmSession::setVariableValueInternal(int32_t variable_index, bool follow_lin
 }
 
 bool VmSession::isAtEnd() const noexcept {
-  return runtime_statistics_.terminated || pointer_ >= program_.getSize();
+  return runtime_statistics_.terminated || pointer_ >= code_.getSize() ||
+         runtime_statistics_.step_limit_exceeded || runtime_statistics_.time_limit_exceeded ||
+         runtime_statistics_.print_limit_exceeded || runtime_statistics_.cancelled;
 }
 
 void VmSession::setExitedAbnormally() {
   runtime_statistics_.abnormal_exit = true;
 }
 
+bool VmSession::isWaitingForInput() const noexcept {
+  return waiting_for_input_;
+}
+
 void VmSession::registerVariable(int32_t variable_index, Program::VariableType variable_type) {
   if (variable_index < 0 || variable_index >= variable_count_) {
     throw std::out_of_range("Invalid variable index.");
@@ -215,10 +701,17 @@ const std::string& VmSession::getStringTableEntry(int32_t string_table_index) co
 }
 
 void VmSession::appendToPrintBuffer(std::string_view string) {
+  if (execution_limits_.max_print_output > 0 &&
+      print_output_size_ + string.size() > execution_limits_.max_print_output) {
+    // Not an error of the program itself; execution stops before the next step.
+    runtime_statistics_.print_limit_exceeded = true;
+    return;
+  }
   if (print_buffer_.size() + string.size() > maximum_print_buffer_length_) {
     throw std::overflow_error("Print buffer overflow.");
   }
   print_buffer_ += string;
+  print_output_size_ += string.size();
 }
 
 void VmSession::appendVariableToPrintBuffer(
@@ -444,6 +937,7 @@ void VmSession::checkIfInputWasSet(
   setVariableValueInternal(
       destination_variable, follow_destination_links,
       variable.changed_since_last_interaction ? 0x1 : 0x0);
+  waiting_for_input_ = !variable.changed_since_last_interaction;
   variable.changed_since_last_interaction = false;
 }
 
@@ -457,6 +951,12 @@ void VmSession::loadStringTableItemLengthLimitIntoVariable(
 }
 
 void VmSession::loadRandomValueIntoVariable(int32_t variable_index, bool follow_links) {
+  std::uniform_int_distribution<int32_t> distribution;
+  if (random_seed_.has_value()) {
+    setVariableValueInternal(variable_index, follow_links, distribution(random_engine_));
+    return;
+  }
+
   // NOTE(fairlight1337): The initialization of the `rng` variable is not linted here to prevent
   // clang-tidy from complaining about seeding with a value from the default constructor. Since
   // we're using `random_device` to seed `rng` right after, this warning is discarded explicitly.
@@ -464,7 +964,6 @@ void VmSession::loadRandomValueIntoVariable(int32_t variable_index, bool follow_
   std::mt19937 rng;
   std::random_device random_device;
   rng.seed(random_device());
-  std::uniform_int_distribution<int32_t> distribution;
   setVariableValueInternal(variable_index, follow_links, distribution(rng));
 }
 
@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Returns the distances to the `count` nearest descriptors by scanning all of them
+ */
+std::vector<double> findNearestDistancesLinearly(
+    const std::vector<std::vector<float>>& descriptors, const std::vector<float>& query,
+    size_t count) {
+  std::vector<double> distances;
+  for (const std::vector<float>& descriptor : descriptors) {
+    double sum = 0.0;
+    for (size_t idx = 0; idx < query.size(); ++idx) {
+      const double difference = descriptor[idx] - query[idx];
+      sum += difference * difference;
+    }
+    distances.push_back(std::sqrt(sum));
+  }
+  std::sort(distances.begin(), distances.end());
+  distances.resize(std::min(count, distances.size()));
+  return distances;
+}
+
+std::vector<float> makeDescriptor(std::mt19937& rng, size_t dimension) {
+  std::uniform_real_distribution<float> distribution(0.0F, 1.0F);
+  std::vector<float> descriptor(dimension);
+  for (float& value : descriptor) {
+    value = distribution(rng);
+  }
+  return descriptor;
+}
+}  // namespace
+
+TEST_CASE("behavior_archive_finds_the_same_neighbours_as_a_linear_scan", "behavior_archive") {
+  // 37 dimensions exercise both the vectorized blocks and the remainder of the distance kernel.
+  const size_t dimension = 37;
+  std::mt19937 rng(42);
+  beast::BehaviorArchive archive(dimension);
+  std::vector<std::vector<float>> descriptors;
+
+  // Enough descriptors for several trees of different sizes, plus a partially filled buffer.
+  for (size_t idx = 0; idx < 1900; ++idx) {
+    descriptors.push_back(makeDescriptor(rng, dimension));
+    archive.insert(descriptors.back());
+  }
+  REQUIRE(archive.getSize() == 1900);
+  REQUIRE(archive.getDimension() == dimension);
+
+  for (size_t query_idx = 0; query_idx < 20; ++query_idx) {
+    const std::vector<float> query = makeDescriptor(rng, dimension);
+    for (const size_t count : {size_t{1}, size_t{15}, size_t{2000}}) {
+      const std::vector<double> expected = findNearestDistancesLinearly(descriptors, query, count);
+      const std::vector<double> actual = archive.findNearestDistances(query, count);
+      REQUIRE(actual.size() == expected.size());
+      for (size_t idx = 0; idx < expected.size(); ++idx) {
+        REQUIRE(actual[idx] == Approx(expected[idx]).epsilon(1e-4));
+      }
+    }
+  }
+
+  // Archived descriptors are their own nearest neighbour.
+  REQUIRE(archive.findNearestDistances(descriptors[123], 1)[0] == Approx(0.0).margin(1e-3));
+}
+
+TEST_CASE("behavior_archive_computes_novelty_as_mean_neighbour_distance", "behavior_archive") {
+  beast::BehaviorArchive archive(2);
+  REQUIRE(archive.computeNovelty({0.0F, 0.0F}, 3) == 0.0);
+  REQUIRE(archive.findNearestDistances({0.0F, 0.0F}, 0).empty() == true);
+
+  archive.insert({1.0F, 0.0F});
+  archive.insert({0.0F, 2.0F});
+  archive.insert({0.0F, -4.0F});
+  REQUIRE(archive.computeNovelty({0.0F, 0.0F}, 2) == Approx(1.5));
+  REQUIRE(archive.computeNovelty({0.0F, 0.0F}, 5) == Approx(7.0 / 3.0));
+
+  REQUIRE_THROWS_AS(beast::BehaviorArchive(0), std::invalid_argument);
+  REQUIRE_THROWS_AS(archive.insert({1.0F}), std::invalid_argument);
+  REQUIRE_THROWS_AS(archive.computeNovelty({1.0F, 2.0F, 3.0F}, 1), std::invalid_argument);
+}
+
+TEST_CASE("behavior_archive_describes_operator_usage_as_shares_of_executions", "behavior_archive") {
+  beast::VmSession::RuntimeStatistics statistics{};
+  REQUIRE(beast::BehaviorArchive::describeOperatorUsage(statistics) ==
+          std::vector<float>(beast::BehaviorArchive::getOperatorUsageDimension(), 0.0F));
+
+  statistics.operator_executions[beast::OpCode::NoOp] = 3;
+  statistics.operator_executions[beast::OpCode::PushConstantOnStack] = 1;
+  const std::vector<float> descriptor = beast::BehaviorArchive::describeOperatorUsage(statistics);
+  REQUIRE(descriptor.size() == static_cast<size_t>(beast::OpCode::Size));
+  REQUIRE(descriptor[static_cast<size_t>(beast::OpCode::NoOp)] == Approx(0.75));
+  REQUIRE(descriptor[static_cast<size_t>(beast::OpCode::PushConstantOnStack)] == Approx(0.25));
+  REQUIRE(descriptor[static_cast<size_t>(beast::OpCode::Terminate)] == 0.0F);
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch.hpp>
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <beast/beast.hpp>
+
+TEST_CASE("bounded_queue_is_fifo_and_bounded", "bounded_queue") {
+  beast::BoundedQueue<int> queue(3);
+  REQUIRE(queue.getCapacity() == 4);
+
+  for (int value = 0; value < 4; ++value) {
+    REQUIRE(queue.tryPush(int(value)) == true);
+  }
+  REQUIRE(queue.tryPush(4) == false);
+  REQUIRE(queue.getApproximateSize() == 4);
+
+  for (int value = 0; value < 4; ++value) {
+    REQUIRE(queue.tryPop() == value);
+  }
+  REQUIRE(queue.tryPop().has_value() == false);
+  REQUIRE_THROWS_AS(beast::BoundedQueue<int>(0), std::invalid_argument);
+}
+
+TEST_CASE("bounded_queue_transfers_all_items_between_many_threads", "bounded_queue") {
+  const uint32_t producer_count = 4;
+  const uint32_t items_per_producer = 20000;
+  beast::BoundedQueue<uint64_t> queue(64);
+  std::atomic<uint64_t> popped_sum{0};
+  std::atomic<uint32_t> popped_count{0};
+
+  std::vector<std::thread> threads;
+  for (uint32_t producer = 0; producer < producer_count; ++producer) {
+    threads.emplace_back([&queue]() {
+      for (uint64_t item = 1; item <= items_per_producer; ++item) {
+        while (!queue.tryPush(uint64_t(item))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&]() {
+      while (popped_count < producer_count * items_per_producer) {
+        if (const std::optional<uint64_t> item = queue.tryPop()) {
+          popped_sum += *item;
+          popped_count++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  const uint64_t expected_sum =
+      producer_count * (uint64_t{items_per_producer} * (items_per_producer + 1) / 2);
+  REQUIRE(popped_count == producer_count * items_per_producer);
+  REQUIRE(popped_sum == expected_sum);
+}
+
+TEST_CASE("bounded_queue_blocking_operations_wait_for_the_other_side", "bounded_queue") {
+  beast::BoundedQueue<std::unique_ptr<int>> queue(2);
+  queue.push(std::make_unique<int>(1));
+  queue.push(std::make_unique<int>(2));
+  REQUIRE(queue.tryPushFor(std::make_unique<int>(0), std::chrono::milliseconds(5)) == false);
+
+  // The blocking push only returns once the consumer made room.
+  std::thread consumer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(*queue.pop() == 1);
+  });
+  queue.push(std::make_unique<int>(3));
+  consumer.join();
+
+  REQUIRE(*queue.pop() == 2);
+  REQUIRE(*queue.pop() == 3);
+  REQUIRE(queue.tryPopFor(std::chrono::milliseconds(5)).has_value() == false);
+
+  std::thread producer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.push(std::make_unique<int>(4));
+  });
+  const std::optional<std::unique_ptr<int>> item = queue.tryPopFor(std::chrono::seconds(10));
+  producer.join();
+  REQUIRE(item.has_value() == true);
+  REQUIRE(**item == 4);
+}
+
+TEST_CASE("bounded_queue_visits_items_without_removing_them", "bounded_queue") {
+  beast::BoundedQueue<int> queue(4);
+  for (int value = 0; value < 3; ++value) {
+    queue.push(int(value));
+  }
+  REQUIRE(queue.tryPop() == 0);
+  queue.push(3);
+  queue.push(4);
+
+  std::vector<int> visited;
+  queue.forEach([&visited](const int& value) { visited.push_back(value); });
+  REQUIRE(visited == std::vector<int>{1, 2, 3, 4});
+  REQUIRE(queue.getApproximateSize() == 4);
+  REQUIRE(queue.tryPop() == 1);
+
+  // Visiting while a producer pushes sees a prefix of the pushed items.
+  beast::BoundedQueue<int> filling_queue(1024);
+  std::thread producer([&filling_queue]() {
+    for (int value = 0; value < 1000; ++value) {
+      filling_queue.push(int(value));
+    }
+  });
+  for (uint32_t visit = 0; visit < 100; ++visit) {
+    int expected = 0;
+    filling_queue.forEach([&expected](const int& value) { REQUIRE(value == expected++); });
+  }
+  producer.join();
+}
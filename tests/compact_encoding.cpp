@@ -0,0 +1,157 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Runs byte code to its end and returns the values of the first `variable_count` variables,
+ *        followed by the length of the print buffer
+ */
+std::vector<int32_t> run(
+    beast::ProgramView code, beast::ProgramEncoding encoding, int32_t variable_count,
+    bool verify) {
+  beast::VmSession session(code, static_cast<size_t>(variable_count), 2, 16, encoding);
+  if (verify) {
+    REQUIRE(session.verifyProgram().valid);
+  }
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE_FALSE(session.getRuntimeStatistics().abnormal_exit);
+
+  std::vector<int32_t> values;
+  for (int32_t idx = 0; idx < variable_count; ++idx) {
+    values.push_back(session.getVariableValue(idx, false));
+  }
+  values.push_back(static_cast<int32_t>(session.getPrintBuffer().size()));
+  return values;
+}
+}  // namespace
+
+TEST_CASE("compact_encoding_shrinks_operands", "compact_encoding") {
+  beast::Program prg;
+  prg.addVariableToVariable(1, false, 2, false);
+  REQUIRE(prg.getSize() == 11);
+  REQUIRE(beast::CompactEncoding::compact(prg.getData()) ==
+          std::vector<unsigned char>{0x0d, 0x02, 0x04});
+
+  // Any set flag adds a flag byte for operators with several flags.
+  prg = beast::Program();
+  prg.addVariableToVariable(1, false, 2, true);
+  REQUIRE(beast::CompactEncoding::compact(prg.getData()) ==
+          std::vector<unsigned char>{0x8d, 0x02, 0x02, 0x04});
+
+  // A single flag goes into the OpCode, and large or negative values take more bytes.
+  prg = beast::Program();
+  prg.setVariable(3, -1, true);
+  prg.setVariable(3, 100000, false);
+  REQUIRE(beast::CompactEncoding::compact(prg.getData()) ==
+          std::vector<unsigned char>{0x88, 0x06, 0x01, 0x08, 0x06, 0xc0, 0x9a, 0x0c});
+}
+
+TEST_CASE("compact_encoding_executes_like_standard_encoding", "compact_encoding") {
+  beast::ProgramBuilder builder;
+  builder.declareVariable(0, beast::Program::VariableType::Int32);
+  builder.declareVariable(1, beast::Program::VariableType::Int32);
+  builder.declareVariable(2, beast::Program::VariableType::Link);
+  builder.declareVariable(3, beast::Program::VariableType::Int32);
+  builder.setVariable(2, 1, false);
+  builder.setStringTableEntry(0, "sum");
+  const beast::ProgramBuilder::Label loop_start = builder.createLabel();
+  const beast::ProgramBuilder::Label loop_end = builder.createLabel();
+  builder.bindLabel(loop_start);
+  builder.addConstantToVariable(0, 1, true);
+  builder.addVariableToVariable(0, true, 2, true);
+  builder.compareIfVariableGtConstant(0, true, 199, 3, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(3, true, loop_end);
+  builder.jumpToLabel(loop_start);
+  builder.bindLabel(loop_end);
+  builder.printStringFromStringTable(0);
+  builder.printVariable(1, true, false);
+  builder.bitShiftVariableLeft(1, true, 2);
+  const beast::Program program = builder.build();
+
+  const std::vector<unsigned char> compact = beast::CompactEncoding::compact(program.getData());
+  REQUIRE(compact.size() < program.getSize() / 2);
+  REQUIRE(beast::CompactEncoding::expand(compact) == program.getData());
+  REQUIRE(beast::CompactEncoding::compact(beast::CompactEncoding::expand(compact)) == compact);
+
+  const std::vector<int32_t> expected{200, 4 * 20100, 1, 1, 8};
+  REQUIRE(run(program.getData(), beast::ProgramEncoding::Standard, 4, false) == expected);
+  REQUIRE(run(compact, beast::ProgramEncoding::Compact, 4, false) == expected);
+  REQUIRE(run(compact, beast::ProgramEncoding::Compact, 4, true) == expected);
+}
+
+TEST_CASE("compact_encoding_round_trips_random_programs", "compact_encoding") {
+  beast::RandomProgramFactory factory;
+  for (uint32_t idx = 0; idx < 100; ++idx) {
+    const beast::Program program = factory.generate(400, 20, 5, 10);
+    const std::vector<unsigned char>& code = program.getData();
+    if (!beast::ProgramOptimizer::isRelocatable(code)) {
+      REQUIRE_THROWS_AS(beast::CompactEncoding::compact(code), std::invalid_argument);
+    }
+
+    // Random jumps rarely hit instruction boundaries, so only the other instructions are kept,
+    // followed by a jump back to the start.
+    std::vector<unsigned char> relocatable;
+    for (const auto& instruction : beast::InstructionDecoder::decodeAll(code)) {
+      const std::vector<unsigned char> single(
+          code.begin() + instruction.offset, code.begin() + instruction.offset + instruction.size);
+      if (!beast::InstructionDecoder::getJumpTarget(code, instruction).has_value() &&
+          beast::ProgramOptimizer::isRelocatable(single)) {
+        relocatable.insert(relocatable.end(), single.begin(), single.end());
+      }
+    }
+    beast::ProgramBuilder builder;
+    const beast::ProgramBuilder::Label start = builder.createLabel();
+    builder.bindLabel(start);
+    builder.insertProgram(beast::Program(relocatable));
+    builder.jumpToLabelIfVariableEqualsZero(0, true, start);
+    const beast::Program reduced = builder.build();
+
+    const std::vector<unsigned char> compact = beast::CompactEncoding::compact(reduced.getData());
+    REQUIRE(compact.size() < reduced.getSize());
+    REQUIRE(beast::CompactEncoding::decodeAll(compact).size() ==
+            beast::InstructionDecoder::decodeAll(reduced.getData()).size());
+    REQUIRE(beast::CompactEncoding::expand(compact) == reduced.getData());
+    REQUIRE(beast::CompactEncoding::compact(beast::CompactEncoding::expand(compact)) == compact);
+  }
+}
+
+TEST_CASE("compact_encoding_rejects_invalid_byte_code", "compact_encoding") {
+  beast::Program layout_dependent;
+  layout_dependent.loadCurrentAddressIntoVariable(0, true);
+  REQUIRE_THROWS_AS(
+      beast::CompactEncoding::compact(layout_dependent.getData()), std::invalid_argument);
+
+  // Flagless operators don't use the flag bit, and varints end within five bytes.
+  const std::vector<unsigned char> flagged_noop{0x80};
+  const std::vector<unsigned char> truncated{0x01, 0x80};
+  const std::vector<unsigned char> overlong{0x0c, 0x80, 0x80, 0x80, 0x80, 0x10};
+  REQUIRE_FALSE(beast::CompactEncoding::decode(flagged_noop, 0).has_value());
+  REQUIRE_FALSE(beast::CompactEncoding::decode(truncated, 0).has_value());
+  REQUIRE_FALSE(beast::CompactEncoding::decode(overlong, 0).has_value());
+  REQUIRE_THROWS_AS(beast::CompactEncoding::expand(truncated), std::invalid_argument);
+
+  // An unconditional jump into its own operand.
+  const std::vector<unsigned char> misaligned{0x00, 0x34, 0x04};
+  REQUIRE_THROWS_AS(beast::CompactEncoding::expand(misaligned), std::invalid_argument);
+  beast::VmSession session(misaligned, 1, 0, 0, beast::ProgramEncoding::Compact);
+  const beast::ProgramVerifier::Result result = session.verifyProgram();
+  REQUIRE_FALSE(result.valid);
+  REQUIRE(result.offset == 1);
+
+  // Verification errors of the standard encoding refer to compact offsets.
+  beast::Program out_of_range;
+  out_of_range.noop();
+  out_of_range.setVariable(5, 1, true);
+  const std::vector<unsigned char> compact =
+      beast::CompactEncoding::compact(out_of_range.getData());
+  beast::VmSession compact_session(compact, 1, 0, 0, beast::ProgramEncoding::Compact);
+  REQUIRE(compact_session.verifyProgram().offset == 1);
+  REQUIRE_FALSE(compact_session.isProgramVerified());
+}
@@ -0,0 +1,153 @@
+#include <catch2/catch.hpp>
+
+#include <optional>
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Builds two nested loops, followed by a block that is never reached
+ *
+ * The blocks are: 0 (entry), 1 (outer loop header), 2 (inner loop), 3 (outer loop condition),
+ * 4 (terminate), and 5 (unreachable jump back into the outer loop).
+ */
+beast::Program buildNestedLoops() {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label outer = builder.createLabel();
+  const beast::ProgramBuilder::Label inner = builder.createLabel();
+  builder.setVariable(0, 1, true);
+  builder.bindLabel(outer);
+  builder.noop();
+  builder.bindLabel(inner);
+  builder.noop();
+  builder.jumpToLabelIfVariableGreaterThanZero(1, true, inner);
+  builder.jumpToLabelIfVariableGreaterThanZero(0, true, outer);
+  builder.terminate(0);
+  builder.noop();
+  builder.jumpToLabel(outer);
+  return builder.build();
+}
+
+/**
+ * @brief Returns the successors of every block
+ */
+std::vector<std::vector<size_t>> getSuccessors(const beast::ControlFlowGraph& graph) {
+  std::vector<std::vector<size_t>> successors;
+  for (const beast::ControlFlowGraph::BasicBlock& block : graph.getBlocks()) {
+    successors.push_back(block.successors);
+  }
+  return successors;
+}
+}  // namespace
+
+TEST_CASE("control_flow_graph_splits_blocks_at_jumps", "control_flow_graph") {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label skip = builder.createLabel();
+  builder.noop();
+  builder.jumpToLabelIfVariableGreaterThanZero(0, true, skip);
+  builder.noop();
+  builder.terminate(0);
+  builder.bindLabel(skip);
+  builder.noop();
+  const beast::Program program = builder.build();
+
+  const beast::ControlFlowGraph graph(program.getData());
+  const std::vector<beast::ControlFlowGraph::BasicBlock>& blocks = graph.getBlocks();
+  REQUIRE(blocks.size() == 3);
+  REQUIRE(blocks[0].begin == 0);
+  REQUIRE(blocks[0].end == 11);
+  REQUIRE(blocks[0].instructions.size() == 2);
+  REQUIRE(blocks[1].begin == 11);
+  REQUIRE(blocks[2].begin == 14);
+  REQUIRE(getSuccessors(graph) == std::vector<std::vector<size_t>>{{2, 1}, {}, {}});
+  REQUIRE(blocks[2].predecessors == std::vector<size_t>{0});
+  REQUIRE(graph.getExitBlocks() == std::vector<size_t>{1, 2});
+  REQUIRE(graph.getInstructionCount() == 5);
+  REQUIRE(graph.getDecodedSize() == program.getSize());
+  REQUIRE(graph.getBlockAt(5) == std::optional<size_t>{0});
+  REQUIRE(graph.getBlockAt(14) == std::optional<size_t>{2});
+  REQUIRE_FALSE(graph.getBlockAt(15).has_value());
+  REQUIRE_FALSE(graph.hasUnknownSuccessors());
+
+  // Jumps out of the code end execution, jumps into an operand go somewhere unknown.
+  beast::Program jumps;
+  jumps.unconditionalJumpToAbsoluteAddress(100);
+  jumps.unconditionalJumpToAbsoluteAddress(2);
+  const beast::ControlFlowGraph jump_graph(jumps.getData());
+  REQUIRE(jump_graph.getBlocks().size() == 2);
+  REQUIRE(jump_graph.getBlocks()[0].is_exit);
+  REQUIRE(jump_graph.getBlocks()[0].successors.empty());
+  REQUIRE(jump_graph.getBlocks()[1].has_unknown_successors);
+  REQUIRE_FALSE(jump_graph.getBlocks()[1].is_exit);
+  // Only the entry block is reachable, and it leaves the code.
+  REQUIRE_FALSE(jump_graph.hasUnknownSuccessors());
+}
+
+TEST_CASE("control_flow_graph_marks_variable_jumps_as_unknown", "control_flow_graph") {
+  beast::Program program;
+  program.relativeJumpToVariableAddressIfVariableEqualsZero(0, true, 1, true);
+  program.noop();
+  program.unconditionalJumpToAbsoluteVariableAddress(1, true);
+  program.noop();
+
+  const beast::ControlFlowGraph graph(program.getData());
+  const std::vector<beast::ControlFlowGraph::BasicBlock>& blocks = graph.getBlocks();
+  REQUIRE(blocks.size() == 3);
+  REQUIRE(blocks[0].has_unknown_successors);
+  REQUIRE(blocks[0].successors == std::vector<size_t>{1});
+  REQUIRE(blocks[1].has_unknown_successors);
+  REQUIRE(blocks[1].successors.empty());
+  REQUIRE_FALSE(blocks[2].has_unknown_successors);
+  REQUIRE(graph.getExitBlocks() == std::vector<size_t>{2});
+  REQUIRE(graph.hasUnknownSuccessors());
+  REQUIRE(graph.getReachableBlocks() == std::vector<bool>{true, true, false});
+
+  // Only complete instructions are covered.
+  std::vector<unsigned char> truncated = program.getData();
+  truncated.push_back(static_cast<unsigned char>(beast::OpCode::SetVariable));
+  const beast::ControlFlowGraph truncated_graph(truncated);
+  REQUIRE(truncated_graph.getDecodedSize() == program.getSize());
+  REQUIRE(truncated_graph.getInstructionCount() == 4);
+  REQUIRE(beast::ControlFlowGraph(std::vector<unsigned char>{}).getBlocks().empty());
+}
+
+TEST_CASE("control_flow_graph_finds_dominators_and_loops", "control_flow_graph") {
+  const beast::Program program = buildNestedLoops();
+  const beast::ControlFlowGraph graph(program.getData());
+  REQUIRE(getSuccessors(graph) ==
+          std::vector<std::vector<size_t>>{{1}, {2}, {2, 3}, {1, 4}, {}, {1}});
+  REQUIRE(graph.getReachableBlocks() ==
+          std::vector<bool>{true, true, true, true, true, false});
+  REQUIRE(graph.getImmediateDominators() ==
+          std::vector<std::optional<size_t>>{0, 0, 1, 2, 3, std::nullopt});
+  REQUIRE(graph.dominates(1, 3));
+  REQUIRE(graph.dominates(3, 3));
+  REQUIRE_FALSE(graph.dominates(3, 1));
+  REQUIRE_FALSE(graph.dominates(5, 1));
+  REQUIRE_FALSE(graph.dominates(0, 5));
+
+  const std::vector<beast::ControlFlowGraph::Loop> loops = graph.getLoops();
+  REQUIRE(loops.size() == 2);
+  REQUIRE(loops[0].header == 1);
+  REQUIRE(loops[0].blocks == std::vector<size_t>{1, 2, 3});
+  REQUIRE(loops[0].back_edges == std::vector<size_t>{3});
+  REQUIRE(loops[1].header == 2);
+  REQUIRE(loops[1].blocks == std::vector<size_t>{2});
+  REQUIRE(loops[1].back_edges == std::vector<size_t>{2});
+}
+
+TEST_CASE("control_flow_graph_is_independent_of_encoding", "control_flow_graph") {
+  const beast::Program program = buildNestedLoops();
+  const std::vector<unsigned char> compact = beast::CompactEncoding::compact(program.getData());
+  const beast::ControlFlowGraph standard_graph(program.getData());
+  const beast::ControlFlowGraph compact_graph(compact, beast::ProgramEncoding::Compact);
+
+  REQUIRE(getSuccessors(compact_graph) == getSuccessors(standard_graph));
+  REQUIRE(compact_graph.getInstructionCount() == standard_graph.getInstructionCount());
+  REQUIRE(compact_graph.getDecodedSize() == compact.size());
+  REQUIRE(compact_graph.getLoops().size() == 2);
+  for (const beast::ControlFlowGraph::BasicBlock& block : compact_graph.getBlocks()) {
+    REQUIRE(compact_graph.getBlockAt(block.begin).has_value());
+  }
+}
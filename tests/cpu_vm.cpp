@@ -1,7 +1,48 @@
 #include <catch2/catch.hpp>
 
+#include <utility>
+#include <vector>
+
 #include <beast/beast.hpp>
 
+namespace {
+/**
+ * @brief Runs a session to its end, either step by step or block by block
+ *
+ * Exceptions end the run like in FitnessCaseRunner. Returns the number of calls it took.
+ */
+size_t runSession(beast::VmSession& session, bool by_block) {
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  size_t calls = 0;
+  try {
+    while (by_block ? vm.stepBlock(session, false) : vm.step(session, false)) {
+      calls++;
+    }
+  } catch (...) {
+    session.setExitedAbnormally();
+  }
+  return calls + 1;
+}
+
+/**
+ * @brief Requires two sessions to have equal runtime statistics and print buffers
+ */
+void requireEqualOutcome(beast::VmSession& stepped, beast::VmSession& blocked) {
+  const beast::VmSession::RuntimeStatistics& expected = stepped.getRuntimeStatistics();
+  const beast::VmSession::RuntimeStatistics& actual = blocked.getRuntimeStatistics();
+  REQUIRE(actual.steps_executed == expected.steps_executed);
+  REQUIRE(actual.operator_executions == expected.operator_executions);
+  REQUIRE(actual.executed_indices == expected.executed_indices);
+  REQUIRE(actual.terminated == expected.terminated);
+  REQUIRE(actual.abnormal_exit == expected.abnormal_exit);
+  REQUIRE(actual.return_code == expected.return_code);
+  REQUIRE(actual.step_limit_exceeded == expected.step_limit_exceeded);
+  REQUIRE(actual.print_limit_exceeded == expected.print_limit_exceeded);
+  REQUIRE(blocked.getPrintBuffer() == stepped.getPrintBuffer());
+}
+}  // namespace
+
 TEST_CASE("stepping_outside_of_bounds_is_rejected_by_vm", "cpu_vm") {
   beast::Program prg(2);
   prg.noop();
@@ -47,3 +88,182 @@ TEST_CASE("when_invalid_opcode_is_encoutered_vm_throws", "cpu_vm") {
 
   REQUIRE(threw == true);
 }
+
+TEST_CASE("executing_basic_blocks_yields_the_same_runtime_statistics", "cpu_vm") {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label outer = builder.createLabel();
+  const beast::ProgramBuilder::Label inner = builder.createLabel();
+  builder.declareVariable(0, beast::Program::VariableType::Int32);
+  builder.declareVariable(1, beast::Program::VariableType::Int32);
+  builder.setVariable(0, 5, true);
+  builder.bindLabel(outer);
+  builder.setVariable(1, 3, true);
+  builder.bindLabel(inner);
+  builder.noop();
+  builder.printVariable(1, true, false);
+  builder.addConstantToVariable(1, -1, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(1, true, inner);
+  builder.addConstantToVariable(0, -1, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(0, true, outer);
+  builder.terminate(7);
+  const beast::Program program = builder.build();
+  const std::vector<unsigned char> compact = beast::CompactEncoding::compact(program.getData());
+
+  for (const auto encoding : {beast::ProgramEncoding::Standard, beast::ProgramEncoding::Compact}) {
+    const beast::ProgramView code =
+        encoding == beast::ProgramEncoding::Standard ? program.getData() : compact;
+    beast::VmSession stepped(code, 2, 0, 0, encoding);
+    beast::VmSession blocked(code, 2, 0, 0, encoding);
+    const size_t steps = runSession(stepped, false);
+    const size_t blocks = runSession(blocked, true);
+    requireEqualOutcome(stepped, blocked);
+    REQUIRE(blocked.getRuntimeStatistics().return_code == 7);
+    REQUIRE(blocks < steps);
+
+    // Step limits stop block execution at the same instruction.
+    for (const uint32_t max_steps : {1U, 6U, 17U}) {
+      beast::VmSession limited_stepped(code, 2, 0, 0, encoding);
+      beast::VmSession limited_blocked(code, 2, 0, 0, encoding);
+      limited_stepped.setExecutionLimits({max_steps, {}, 0});
+      limited_blocked.setExecutionLimits({max_steps, {}, 0});
+      runSession(limited_stepped, false);
+      runSession(limited_blocked, true);
+      requireEqualOutcome(limited_stepped, limited_blocked);
+      REQUIRE(limited_blocked.getRuntimeStatistics().steps_executed == max_steps);
+    }
+  }
+}
+
+TEST_CASE("executing_basic_blocks_of_random_programs_matches_stepping", "cpu_vm") {
+  beast::RandomProgramFactory factory;
+  for (uint32_t idx = 0; idx < 200; ++idx) {
+    const beast::Program program = factory.generate(300, 10, 5, 10);
+    beast::VmSession stepped(program, 10, 5, 10);
+    beast::VmSession blocked(program, 10, 5, 10);
+    for (beast::VmSession* session : {&stepped, &blocked}) {
+      session->setRandomSeed(idx);
+      session->setExecutionLimits({500, {}, 100});
+    }
+    if (!beast::FitnessCache::isDeterministic(program.getData())) {
+      continue;
+    }
+    runSession(stepped, false);
+    runSession(blocked, true);
+    requireEqualOutcome(stepped, blocked);
+  }
+}
+
+TEST_CASE("basic_blocks_end_when_waiting_for_input", "cpu_vm") {
+  beast::Program program;
+  program.declareVariable(1, beast::Program::VariableType::Int32);
+  program.checkIfInputWasSet(0, true, 1, true);
+  program.noop();
+
+  beast::VmSession session(program, 2, 0, 0);
+  session.setVariableBehavior(0, beast::VmSession::VariableIoBehavior::Input);
+  beast::CpuVirtualMachine vm;
+  REQUIRE(vm.stepBlock(session, false));
+  REQUIRE(session.isWaitingForInput());
+  REQUIRE(session.getRuntimeStatistics().steps_executed == 2);
+  REQUIRE_FALSE(vm.stepBlock(session, false));
+  REQUIRE(session.getRuntimeStatistics().steps_executed == 3);
+}
+
+TEST_CASE("decode_cache_executes_jumps_into_instructions_uncached", "cpu_vm") {
+  // Jumps one byte into `setVariable(0, 0, false)`, whose remaining nine bytes are all NoOps.
+  const auto make_program = [](int32_t jump_address) {
+    beast::Program program;
+    program.declareVariable(0, beast::Program::VariableType::Int32);
+    program.declareVariable(1, beast::Program::VariableType::Int32);
+    program.declareVariable(2, beast::Program::VariableType::Int32);
+    program.setVariable(1, 3, true);
+    program.setVariable(2, jump_address, true);
+    program.setVariable(0, 0, false);
+    program.addConstantToVariable(1, -1, true);
+    program.absoluteJumpToVariableAddressIfVariableGreaterThanZero(1, true, 2, true);
+    program.terminate(0);
+    return program;
+  };
+  const int32_t target = static_cast<int32_t>(
+      beast::InstructionDecoder::decodeAll(make_program(0).getData())[5].offset + 1);
+  const beast::Program program = make_program(target);
+
+  beast::VmSession uncached(program, 3, 0, 0);
+  beast::VmSession cached(program, 3, 0, 0);
+  cached.setDecodeCacheEnabled(true);
+  runSession(uncached, false);
+  runSession(cached, false);
+  requireEqualOutcome(uncached, cached);
+  REQUIRE(uncached.getDecodedInstructionCount() == 0);
+  REQUIRE(cached.getRuntimeStatistics().terminated == true);
+  REQUIRE(cached.getRuntimeStatistics().operator_executions.at(beast::OpCode::NoOp) == 18);
+  // Only the program's own instructions are cached, not the NoOps inside `setVariable`.
+  REQUIRE(cached.getDecodedInstructionCount() == 9);
+
+  // Copies and resets keep the cache, as the program doesn't change.
+  beast::VmSession copy = cached;
+  copy.reset();
+  runSession(copy, false);
+  requireEqualOutcome(uncached, copy);
+  REQUIRE(copy.getDecodedInstructionCount() == 9);
+  copy.setDecodeCacheEnabled(false);
+  REQUIRE(copy.getDecodedInstructionCount() == 0);
+  REQUIRE(cached.getDecodedInstructionCount() == 9);
+}
+
+TEST_CASE("decode_cache_decodes_every_instruction_once", "cpu_vm") {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label loop = builder.createLabel();
+  builder.declareVariable(0, beast::Program::VariableType::Int32);
+  builder.declareVariable(1, beast::Program::VariableType::Int32);
+  builder.setVariable(0, 20, true);
+  builder.bindLabel(loop);
+  builder.compareIfVariableGtVariable(0, true, 1, false, 1, true);
+  builder.printVariable(1, true, false);
+  builder.addConstantToVariable(0, -1, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(0, true, loop);
+  builder.setStringTableEntry(0, "done");
+  builder.printStringFromStringTable(0);
+  const beast::Program program = builder.build();
+  const std::vector<unsigned char> compact = beast::CompactEncoding::compact(program.getData());
+
+  for (const auto encoding : {beast::ProgramEncoding::Standard, beast::ProgramEncoding::Compact}) {
+    const beast::ProgramView code =
+        encoding == beast::ProgramEncoding::Standard ? program.getData() : compact;
+    beast::VmSession uncached(code, 2, 1, 4, encoding);
+    beast::VmSession cached(code, 2, 1, 4, encoding);
+    cached.setDecodeCacheEnabled(true);
+    runSession(uncached, false);
+    runSession(cached, false);
+    requireEqualOutcome(uncached, cached);
+    REQUIRE(cached.getRuntimeStatistics().steps_executed == 85);
+    // Instructions with string operands are never cached.
+    REQUIRE(cached.getDecodedInstructionCount() == 8);
+  }
+}
+
+TEST_CASE("decode_cache_matches_uncached_execution_of_random_programs", "cpu_vm") {
+  beast::RandomProgramFactory factory;
+  for (uint32_t idx = 0; idx < 200; ++idx) {
+    const beast::Program program = factory.generate(300, 10, 5, 10);
+    // Only byte code that doesn't depend on its layout can be compacted.
+    std::vector<std::pair<std::vector<unsigned char>, beast::ProgramEncoding>> codes{
+        {program.getData(), beast::ProgramEncoding::Standard}};
+    if (beast::ProgramOptimizer::isRelocatable(program.getData())) {
+      codes.emplace_back(
+          beast::CompactEncoding::compact(program.getData()), beast::ProgramEncoding::Compact);
+    }
+    for (const auto& [code, encoding] : codes) {
+      beast::VmSession uncached(code, 10, 5, 10, encoding);
+      beast::VmSession cached(code, 10, 5, 10, encoding);
+      cached.setDecodeCacheEnabled(true);
+      for (beast::VmSession* session : {&uncached, &cached}) {
+        session->setRandomSeed(idx);
+        session->setExecutionLimits({500, {}, 100});
+      }
+      runSession(uncached, false);
+      runSession(cached, true);
+      requireEqualOutcome(uncached, cached);
+    }
+  }
+}
@@ -0,0 +1,295 @@
+#include <catch2/catch.hpp>
+
+// Standard
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Waits until the coordinator has accepted the expected number of workers
+ */
+bool waitForWorkers(const beast::EvaluationCoordinator& coordinator, size_t count) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (coordinator.getWorkerCount() != count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+/**
+ * @brief A simple evaluation function: the program's first byte divided by 255
+ */
+double scoreFirstByte(beast::ProgramView program) {
+  return program.empty() ? 0.0 : static_cast<double>(program[0]) / 255.0;
+}
+
+std::vector<std::vector<unsigned char>> makePrograms(uint32_t count) {
+  std::vector<std::vector<unsigned char>> programs;
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    programs.push_back({static_cast<unsigned char>(idx % 256), 0x01, 0x02});
+  }
+  return programs;
+}
+
+class BatchCountingPipe : public beast::Pipe {
+ public:
+  explicit BatchCountingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+  [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+    return 1.0;
+  }
+
+  [[nodiscard]] std::vector<double> evaluateBatch(
+      const std::vector<std::vector<unsigned char>>& programs) override {
+    batch_call_count_++;
+    evaluated_count_ += static_cast<uint32_t>(programs.size());
+    return beast::Pipe::evaluateBatch(programs);
+  }
+
+  [[nodiscard]] uint32_t getBatchCallCount() const { return batch_call_count_; }
+
+  [[nodiscard]] uint32_t getEvaluatedCount() const { return evaluated_count_; }
+
+ private:
+  uint32_t batch_call_count_ = 0;
+
+  uint32_t evaluated_count_ = 0;
+};
+}  // namespace
+
+TEST_CASE("wire_protocol_round_trips_batches", "distributed") {
+  beast::WireProtocol::EvaluationBatch batch;
+  batch.batch_id = 0x0102030405060708ULL;
+  batch.programs = {{}, {0x00, 0xff}, {0x10, 0x20, 0x30}};
+
+  const std::vector<unsigned char> payload = beast::WireProtocol::encodeBatch(batch);
+  REQUIRE(beast::WireProtocol::getMessageType(payload) ==
+          beast::WireProtocol::MessageType::EvaluateBatch);
+
+  const beast::WireProtocol::EvaluationBatch decoded = beast::WireProtocol::decodeBatch(payload);
+  REQUIRE(decoded.batch_id == batch.batch_id);
+  REQUIRE(decoded.programs == batch.programs);
+
+  // Views point into the payload itself.
+  const beast::WireProtocol::EvaluationBatchView view = beast::WireProtocol::viewBatch(payload);
+  REQUIRE(view.batch_id == batch.batch_id);
+  REQUIRE(view.programs.size() == batch.programs.size());
+  REQUIRE(view.programs[2].getData() > payload.data());
+  REQUIRE(view.programs[2].getData() + 3 == payload.data() + payload.size());
+  REQUIRE(std::equal(view.programs[1].begin(), view.programs[1].end(),
+                     batch.programs[1].begin(), batch.programs[1].end()));
+}
+
+TEST_CASE("wire_protocol_round_trips_results", "distributed") {
+  const beast::WireProtocol::EvaluationResults results{17, {0.0, 0.25, 1.0, -3.5}};
+
+  const beast::WireProtocol::EvaluationResults decoded =
+      beast::WireProtocol::decodeResults(beast::WireProtocol::encodeResults(results));
+  REQUIRE(decoded.batch_id == results.batch_id);
+  REQUIRE(decoded.scores == results.scores);
+}
+
+TEST_CASE("wire_protocol_rejects_truncated_messages", "distributed") {
+  std::vector<unsigned char> payload =
+      beast::WireProtocol::encodeBatch({1, {{0x01, 0x02, 0x03}}});
+  payload.pop_back();
+
+  REQUIRE_THROWS_AS(beast::WireProtocol::decodeBatch(payload), std::underflow_error);
+  const std::vector<unsigned char> goodbye =
+      beast::WireProtocol::encodeSignal(beast::WireProtocol::MessageType::Goodbye);
+  REQUIRE_THROWS_AS(beast::WireProtocol::decodeResults(goodbye), std::invalid_argument);
+}
+
+TEST_CASE("coordinator_distributes_batches_over_workers", "distributed") {
+  beast::EvaluationCoordinator coordinator(0, 4, "127.0.0.1");
+
+  beast::EvaluationWorker worker_a(scoreFirstByte);
+  beast::EvaluationWorker worker_b(scoreFirstByte);
+  std::atomic<uint64_t> evaluated_a{0};
+  std::atomic<uint64_t> evaluated_b{0};
+  std::thread thread_a([&]() { evaluated_a = worker_a.run("127.0.0.1", coordinator.getPort()); });
+  std::thread thread_b([&]() { evaluated_b = worker_b.run("127.0.0.1", coordinator.getPort()); });
+  REQUIRE(waitForWorkers(coordinator, 2));
+
+  const std::vector<std::vector<unsigned char>> programs = makePrograms(50);
+  const std::vector<double> scores = coordinator.evaluate(programs);
+
+  REQUIRE(scores.size() == programs.size());
+  for (size_t idx = 0; idx < programs.size(); ++idx) {
+    REQUIRE(scores[idx] == Approx(scoreFirstByte(programs[idx])));
+  }
+
+  worker_a.stop();
+  worker_b.stop();
+  thread_a.join();
+  thread_b.join();
+  REQUIRE(evaluated_a + evaluated_b == programs.size());
+}
+
+TEST_CASE("coordinator_reassigns_batches_of_leaving_workers", "distributed") {
+  beast::EvaluationCoordinator coordinator(0, 1, "127.0.0.1");
+
+  // The first worker leaves while it evaluates its first program; the second one joins later and
+  // has to pick up the complete generation, including the abandoned batch.
+  std::atomic<bool> leaving_worker_started{false};
+  beast::EvaluationWorker* leaving_worker_pointer = nullptr;
+  beast::EvaluationWorker leaving_worker([&](beast::ProgramView program) {
+    leaving_worker_started = true;
+    leaving_worker_pointer->stop();
+    return scoreFirstByte(program);
+  });
+  leaving_worker_pointer = &leaving_worker;
+  std::thread leaving_thread(
+      [&]() { (void)leaving_worker.run("127.0.0.1", coordinator.getPort()); });
+  REQUIRE(waitForWorkers(coordinator, 1));
+
+  const std::vector<std::vector<unsigned char>> programs = makePrograms(10);
+  std::vector<double> scores;
+  std::thread evaluation_thread([&]() { scores = coordinator.evaluate(programs); });
+
+  leaving_thread.join();
+  REQUIRE(leaving_worker_started);
+
+  beast::EvaluationWorker joining_worker(scoreFirstByte);
+  std::thread joining_thread(
+      [&]() { (void)joining_worker.run("127.0.0.1", coordinator.getPort()); });
+  evaluation_thread.join();
+
+  REQUIRE(scores.size() == programs.size());
+  for (size_t idx = 0; idx < programs.size(); ++idx) {
+    REQUIRE(scores[idx] == Approx(scoreFirstByte(programs[idx])));
+  }
+
+  joining_worker.stop();
+  joining_thread.join();
+}
+
+TEST_CASE("coordinator_shuts_down_connected_workers", "distributed") {
+  beast::EvaluationWorker worker(scoreFirstByte);
+  std::thread worker_thread;
+  {
+    beast::EvaluationCoordinator coordinator(0, 8, "127.0.0.1");
+    worker_thread = std::thread([&]() { (void)worker.run("127.0.0.1", coordinator.getPort()); });
+    REQUIRE(waitForWorkers(coordinator, 1));
+  }
+
+  // Returns because the coordinator sent a shutdown signal.
+  worker_thread.join();
+}
+
+TEST_CASE("coordinator_serves_workers_that_join_behind_a_silent_peer", "distributed") {
+  beast::EvaluationWorker worker(scoreFirstByte);
+  std::thread worker_thread;
+  std::chrono::steady_clock::time_point destruction_start;
+  {
+    beast::EvaluationCoordinator coordinator(0, 8, "127.0.0.1");
+
+    // Connects, but never sends a Hello.
+    beast::TcpConnection silent_peer = beast::TcpConnection::connect("127.0.0.1",
+                                                                     coordinator.getPort());
+    worker_thread = std::thread([&]() { (void)worker.run("127.0.0.1", coordinator.getPort()); });
+    REQUIRE(waitForWorkers(coordinator, 1));
+
+    const std::vector<std::vector<unsigned char>> programs = makePrograms(20);
+    REQUIRE(coordinator.evaluate(programs).size() == programs.size());
+    destruction_start = std::chrono::steady_clock::now();
+  }
+
+  // The coordinator didn't wait for the silent peer's handshake to time out.
+  REQUIRE(std::chrono::steady_clock::now() - destruction_start < std::chrono::seconds(4));
+  worker_thread.join();
+}
+
+TEST_CASE("coordinator_reassigns_batches_of_workers_that_never_answer", "distributed") {
+  beast::EvaluationCoordinator coordinator(0, 4, "127.0.0.1");
+  coordinator.setBatchTimeout(std::chrono::milliseconds(200));
+  REQUIRE(coordinator.getBatchTimeout() == std::chrono::milliseconds(200));
+
+  // Greets the coordinator and takes a batch, but never answers.
+  beast::TcpConnection stuck_worker =
+      beast::TcpConnection::connect("127.0.0.1", coordinator.getPort());
+  REQUIRE(stuck_worker.sendMessage(beast::WireProtocol::encodeHello()));
+  REQUIRE(waitForWorkers(coordinator, 1));
+
+  const std::vector<std::vector<unsigned char>> programs = makePrograms(20);
+  std::vector<double> scores;
+  std::thread evaluation_thread([&]() { scores = coordinator.evaluate(programs); });
+  std::vector<unsigned char> payload;
+  REQUIRE(stuck_worker.receiveMessage(payload, std::chrono::seconds(10)));
+  REQUIRE(beast::WireProtocol::getMessageType(payload) ==
+          beast::WireProtocol::MessageType::EvaluateBatch);
+
+  beast::EvaluationWorker worker(scoreFirstByte);
+  std::thread worker_thread([&]() { (void)worker.run("127.0.0.1", coordinator.getPort()); });
+  evaluation_thread.join();
+
+  REQUIRE(scores.size() == programs.size());
+  for (size_t idx = 0; idx < programs.size(); ++idx) {
+    REQUIRE(scores[idx] == Approx(scoreFirstByte(programs[idx])));
+  }
+  // The coordinator dropped the stuck worker.
+  REQUIRE(stuck_worker.receiveMessage(payload, std::chrono::seconds(10)) == false);
+
+  worker.stop();
+  worker_thread.join();
+}
+
+TEST_CASE("coordinator_fails_evaluations_without_workers", "distributed") {
+  beast::EvaluationCoordinator coordinator(0, 4, "127.0.0.1");
+  coordinator.setIdleTimeout(std::chrono::milliseconds(200));
+  REQUIRE(coordinator.getIdleTimeout() == std::chrono::milliseconds(200));
+
+  REQUIRE_THROWS_AS(coordinator.evaluate(makePrograms(10)), std::runtime_error);
+
+  // The coordinator stays usable once a worker joins.
+  beast::EvaluationWorker worker(scoreFirstByte);
+  std::thread worker_thread([&]() { (void)worker.run("127.0.0.1", coordinator.getPort()); });
+  REQUIRE(waitForWorkers(coordinator, 1));
+  REQUIRE(coordinator.evaluate(makePrograms(10)).size() == 10);
+  worker.stop();
+  worker_thread.join();
+}
+
+TEST_CASE("worker_leaves_on_unknown_message_types", "distributed") {
+  beast::TcpListener listener(0, "127.0.0.1");
+  beast::EvaluationWorker worker(scoreFirstByte);
+  std::atomic<uint64_t> evaluated{1};
+  std::thread worker_thread([&]() { evaluated = worker.run("127.0.0.1", listener.getPort()); });
+
+  beast::TcpConnection connection = listener.accept(std::chrono::seconds(10));
+  REQUIRE(connection.isOpen());
+  std::vector<unsigned char> payload;
+  REQUIRE(connection.receiveMessage(payload));
+  REQUIRE(beast::WireProtocol::decodeHello(payload) == beast::WireProtocol::kVersion);
+
+  REQUIRE(connection.sendMessage({0xff}));
+  REQUIRE(connection.receiveMessage(payload));
+  REQUIRE(beast::WireProtocol::getMessageType(payload) ==
+          beast::WireProtocol::MessageType::Goodbye);
+
+  worker_thread.join();
+  REQUIRE(evaluated == 0);
+}
+
+TEST_CASE("pipe_evaluates_generations_in_batches", "distributed") {
+  const std::vector<unsigned char> candidate = {0x00};
+  const uint32_t max_population = 10;
+
+  BatchCountingPipe pipe(max_population);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(candidate);
+  }
+
+  pipe.evolve();
+
+  REQUIRE(pipe.getBatchCallCount() > 0);
+  REQUIRE(pipe.getEvaluatedCount() > pipe.getBatchCallCount());
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <beast/beast.hpp>
+
+namespace {
+const char* const kCheckpointPath = "evolution_checkpoint_test.ckpt";
+}  // namespace
+
+TEST_CASE("evolution_checkpoints_round_trip_through_mapped_files", "evolution_checkpoint") {
+  using Section = beast::EvolutionCheckpoint::Section;
+
+  beast::EvolutionCheckpoint checkpoint(12, 345);
+  checkpoint.addRecord(Section::Population, {1, 2, 3}, 0.5);
+  checkpoint.addRecord(Section::Population, {}, 0.25);
+  checkpoint.addRecord(Section::Inputs, {4, 5});
+  checkpoint.addRecord(Section::Outputs, {6}, 0.75);
+  REQUIRE(checkpoint.getRecordCount(Section::Population) == 2);
+  checkpoint.write(kCheckpointPath);
+
+  {
+    const beast::MappedEvolutionCheckpoint mapped(kCheckpointPath);
+    REQUIRE(mapped.getGeneration() == 12);
+    REQUIRE(mapped.getRandomSeed() == 345);
+    REQUIRE(mapped.getRecordCount(Section::Population) == 2);
+    REQUIRE(mapped.getRecordCount(Section::Inputs) == 1);
+    REQUIRE(mapped.getRecordCount(Section::Outputs) == 1);
+
+    REQUIRE(mapped.copyRecord(Section::Population, 0) == std::vector<unsigned char>{1, 2, 3});
+    REQUIRE(mapped.getRecord(Section::Population, 0).score == Approx(0.5));
+    REQUIRE(mapped.getRecord(Section::Population, 1).size == 0);
+    REQUIRE(mapped.getRecord(Section::Population, 1).score == Approx(0.25));
+    REQUIRE(mapped.copyRecord(Section::Inputs, 0) == std::vector<unsigned char>{4, 5});
+    REQUIRE(mapped.copyRecord(Section::Outputs, 0) == std::vector<unsigned char>{6});
+    REQUIRE(mapped.getRecord(Section::Outputs, 0).score == Approx(0.75));
+    REQUIRE_THROWS_AS(mapped.getRecord(Section::Inputs, 1), std::out_of_range);
+  }
+
+  // Writing again replaces the file as a whole.
+  beast::EvolutionCheckpoint empty_checkpoint(13, 0);
+  empty_checkpoint.write(kCheckpointPath);
+  const beast::MappedEvolutionCheckpoint mapped(kCheckpointPath);
+  REQUIRE(mapped.getGeneration() == 13);
+  REQUIRE(mapped.getRecordCount(Section::Population) == 0);
+  std::remove(kCheckpointPath);
+}
+
+TEST_CASE("mapped_evolution_checkpoints_reject_invalid_files", "evolution_checkpoint") {
+  REQUIRE_THROWS_AS(
+      beast::MappedEvolutionCheckpoint("missing_evolution_checkpoint.ckpt"), std::runtime_error);
+
+  {
+    std::ofstream file(kCheckpointPath, std::ios::binary);
+    file << "Not a checkpoint, but long enough to hold a checkpoint header.";
+  }
+  REQUIRE_THROWS_AS(beast::MappedEvolutionCheckpoint(kCheckpointPath), std::runtime_error);
+
+  // A truncated checkpoint is detected by its size.
+  beast::EvolutionCheckpoint checkpoint(1, 1);
+  checkpoint.addRecord(beast::EvolutionCheckpoint::Section::Population, {1, 2, 3}, 1.0);
+  std::vector<unsigned char> data = checkpoint.serialize();
+  data.pop_back();
+  {
+    std::ofstream file(kCheckpointPath, std::ios::binary);
+    file.write(
+        reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+  }
+  REQUIRE_THROWS_AS(beast::MappedEvolutionCheckpoint(kCheckpointPath), std::runtime_error);
+  std::remove(kCheckpointPath);
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+
+// Standard
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief A program that loops forever
+ */
+beast::Program makeEndlessProgram() {
+  beast::Program prg;
+  prg.noop();
+  prg.unconditionalJumpToAbsoluteAddress(0);
+  return prg;
+}
+
+/**
+ * @brief A program that prints a variable forever
+ */
+beast::Program makeEndlessPrintingProgram() {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 7, true);
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.printVariable(0, true, false);
+  prg.unconditionalJumpToAbsoluteAddress(loop_start_address);
+  return prg;
+}
+
+bool noLimitExceeded(const beast::VmSession::RuntimeStatistics& statistics) {
+  return !statistics.step_limit_exceeded && !statistics.time_limit_exceeded &&
+         !statistics.print_limit_exceeded && !statistics.cancelled;
+}
+}  // namespace
+
+TEST_CASE("unbounded_sessions_report_no_exceeded_limits", "execution_limits") {
+  beast::Program prg;
+  prg.noop();
+  prg.terminate(3);
+  beast::VmSession session(std::move(prg), 0, 0, 0);
+  beast::CpuVirtualMachine virtual_machine;
+
+  while (virtual_machine.step(session, false)) {}
+
+  REQUIRE(session.getRuntimeStatistics().terminated == true);
+  REQUIRE(session.getRuntimeStatistics().return_code == 3);
+  REQUIRE(noLimitExceeded(session.getRuntimeStatistics()));
+}
+
+TEST_CASE("step_limit_stops_endless_programs", "execution_limits") {
+  beast::VmSession session(makeEndlessProgram(), 0, 0, 0);
+  beast::VmSession::ExecutionLimits limits;
+  limits.max_steps = 1000;
+  session.setExecutionLimits(limits);
+  beast::CpuVirtualMachine virtual_machine;
+
+  while (virtual_machine.step(session, false)) {}
+
+  const beast::VmSession::RuntimeStatistics& statistics = session.getRuntimeStatistics();
+  REQUIRE(statistics.steps_executed == 1000);
+  REQUIRE(statistics.step_limit_exceeded == true);
+  REQUIRE(statistics.terminated == false);
+  REQUIRE(statistics.abnormal_exit == false);
+  REQUIRE(session.isAtEnd() == true);
+}
+
+TEST_CASE("time_limit_stops_endless_programs", "execution_limits") {
+  beast::VmSession session(makeEndlessProgram(), 0, 0, 0);
+  beast::VmSession::ExecutionLimits limits;
+  limits.max_wall_time = std::chrono::milliseconds(20);
+  session.setExecutionLimits(limits);
+  beast::CpuVirtualMachine virtual_machine;
+
+  const auto start = std::chrono::steady_clock::now();
+  while (virtual_machine.step(session, false)) {}
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  REQUIRE(session.getRuntimeStatistics().time_limit_exceeded == true);
+  REQUIRE(session.getRuntimeStatistics().step_limit_exceeded == false);
+  REQUIRE(elapsed >= std::chrono::milliseconds(20));
+}
+
+TEST_CASE("print_limit_stops_programs_printing_too_much", "execution_limits") {
+  beast::VmSession session(makeEndlessPrintingProgram(), 1, 0, 0);
+  beast::VmSession::ExecutionLimits limits;
+  limits.max_print_output = 10;
+  session.setExecutionLimits(limits);
+  beast::CpuVirtualMachine virtual_machine;
+
+  // Clearing the print buffer does not reset the print output budget.
+  while (virtual_machine.step(session, false)) {
+    session.clearPrintBuffer();
+  }
+
+  const beast::VmSession::RuntimeStatistics& statistics = session.getRuntimeStatistics();
+  REQUIRE(statistics.print_limit_exceeded == true);
+  REQUIRE(statistics.abnormal_exit == false);
+  REQUIRE(statistics.operator_executions.at(beast::OpCode::PrintVariable) == 11);
+}
+
+TEST_CASE("cancellation_token_stops_execution_from_other_thread", "execution_limits") {
+  auto token = std::make_shared<beast::CancellationToken>();
+  beast::VmSession session(makeEndlessProgram(), 0, 0, 0);
+  session.setCancellationToken(token);
+  beast::CpuVirtualMachine virtual_machine;
+
+  std::thread canceller([token]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    token->cancel();
+  });
+  while (virtual_machine.step(session, false)) {}
+  canceller.join();
+
+  REQUIRE(session.getRuntimeStatistics().cancelled == true);
+  REQUIRE(session.getRuntimeStatistics().steps_executed > 0);
+
+  // A reset token allows the same session to continue.
+  token->reset();
+  session.resetRuntimeStatistics();
+  REQUIRE(virtual_machine.step(session, false) == true);
+}
+
+TEST_CASE("limits_do_not_affect_static_runtime_statistics_evaluation", "execution_limits") {
+  beast::Program prg;
+  for (uint32_t idx = 0; idx < 10; ++idx) {
+    prg.noop();
+  }
+  prg.terminate(0);
+
+  beast::VmSession unbounded_session(prg, 0, 0, 0);
+  beast::VmSession bounded_session(prg, 0, 0, 0);
+  beast::VmSession::ExecutionLimits limits;
+  limits.max_steps = 5;
+  bounded_session.setExecutionLimits(limits);
+
+  beast::CpuVirtualMachine virtual_machine;
+  for (uint32_t idx = 0; idx < 5; ++idx) {
+    (void)virtual_machine.step(unbounded_session, false);
+    (void)virtual_machine.step(bounded_session, false);
+  }
+  REQUIRE(virtual_machine.step(bounded_session, false) == false);
+
+  beast::RuntimeStatisticsEvaluator evaluator(0.2, 0.3);
+  REQUIRE(evaluator.evaluate(bounded_session) == Approx(evaluator.evaluate(unbounded_session)));
+}
@@ -0,0 +1,224 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief A deterministic program whose code differs with the given constant
+ */
+std::vector<unsigned char> makeProgram(int32_t constant) {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, constant, true);
+  prg.terminate(0);
+  return prg.getData();
+}
+}  // namespace
+
+TEST_CASE("fitness_cache_serves_stored_scores_by_content_and_configuration", "fitness_cache") {
+  beast::FitnessCache cache(16);
+  const std::vector<unsigned char> program = makeProgram(5);
+
+  REQUIRE(cache.lookup(program, 0).has_value() == false);
+  REQUIRE(cache.store(program, 0, {0.75, std::nullopt}) == true);
+
+  const std::optional<beast::FitnessCache::Entry> entry = cache.lookup(makeProgram(5), 0);
+  REQUIRE(entry.has_value() == true);
+  REQUIRE(entry->score == Approx(0.75));
+  REQUIRE(cache.lookup(makeProgram(6), 0).has_value() == false);
+  REQUIRE(cache.lookup(program, 1).has_value() == false);
+
+  REQUIRE(cache.getHitCount() == 1);
+  REQUIRE(cache.getMissCount() == 3);
+  REQUIRE(cache.getSize() == 1);
+
+  cache.clear();
+  REQUIRE(cache.getSize() == 0);
+  REQUIRE(cache.getHitCount() == 0);
+  REQUIRE(cache.lookup(program, 0).has_value() == false);
+}
+
+TEST_CASE("fitness_cache_keeps_runtime_statistics", "fitness_cache") {
+  beast::FitnessCache cache(16);
+  const std::vector<unsigned char> program = makeProgram(5);
+
+  beast::VmSession::RuntimeStatistics statistics{};
+  statistics.steps_executed = 3;
+  statistics.terminated = true;
+  REQUIRE(cache.store(program, 0, {0.5, statistics}) == true);
+
+  const std::optional<beast::FitnessCache::Entry> entry = cache.lookup(program, 0);
+  REQUIRE(entry.has_value() == true);
+  REQUIRE(entry->statistics.has_value() == true);
+  REQUIRE(entry->statistics->steps_executed == 3);
+  REQUIRE(entry->statistics->terminated == true);
+}
+
+TEST_CASE("fitness_cache_refuses_nondeterministic_programs_unless_allowed", "fitness_cache") {
+  beast::Program random_prg;
+  random_prg.declareVariable(0, beast::Program::VariableType::Int32);
+  random_prg.loadRandomValueIntoVariable(0, true);
+  beast::Program clock_prg;
+  clock_prg.declareVariable(0, beast::Program::VariableType::Int32);
+  clock_prg.performSystemCall(0, 2, 0, true);
+  const std::vector<unsigned char> truncated = {
+      static_cast<unsigned char>(beast::OpCode::Terminate)};
+
+  REQUIRE(beast::FitnessCache::isDeterministic(makeProgram(1)) == true);
+  REQUIRE(beast::FitnessCache::isDeterministic(random_prg.getData()) == false);
+  REQUIRE(beast::FitnessCache::isDeterministic(clock_prg.getData()) == false);
+  REQUIRE(beast::FitnessCache::isDeterministic(truncated) == false);
+
+  beast::FitnessCache cache(16);
+  REQUIRE(cache.store(random_prg.getData(), 0, {1.0, std::nullopt}) == false);
+  REQUIRE(cache.lookup(random_prg.getData(), 0).has_value() == false);
+  REQUIRE(cache.getSize() == 0);
+
+  cache.setAllowNondeterministic(true);
+  REQUIRE(cache.store(random_prg.getData(), 0, {1.0, std::nullopt}) == true);
+  REQUIRE(cache.lookup(random_prg.getData(), 0).has_value() == true);
+}
+
+TEST_CASE("fitness_cache_inspects_operand_bytes_that_jumps_land_in", "fitness_cache") {
+  // The constant's first byte is read as LoadRandomValueIntoVariable when jumped to.
+  const auto make_program = [](int32_t jump_address) {
+    beast::Program prg;
+    prg.declareVariable(0, beast::Program::VariableType::Int32);
+    prg.unconditionalJumpToAbsoluteAddress(jump_address);
+    prg.setVariable(0, static_cast<int32_t>(beast::OpCode::LoadRandomValueIntoVariable), true);
+    prg.noop();
+    prg.noop();
+    prg.terminate(0);
+    return prg.getData();
+  };
+  const std::vector<unsigned char> code = make_program(0);
+  const std::vector<beast::InstructionDecoder::Instruction> instructions =
+      beast::InstructionDecoder::decodeAll(code);
+  const auto constant = static_cast<int32_t>(*beast::InstructionDecoder::getOperandOffset(
+      code, instructions[2], beast::InstructionDecoder::OperandType::Constant4));
+
+  REQUIRE(beast::FitnessCache::isDeterministic(make_program(
+      static_cast<int32_t>(instructions[2].offset))) == true);
+  REQUIRE(beast::FitnessCache::isDeterministic(make_program(constant)) == false);
+
+  beast::Program variable_jump;
+  variable_jump.declareVariable(0, beast::Program::VariableType::Int32);
+  variable_jump.unconditionalJumpToAbsoluteVariableAddress(0, true);
+  variable_jump.setVariable(0, static_cast<int32_t>(beast::OpCode::LoadRandomValueIntoVariable),
+                            true);
+  variable_jump.noop();
+  variable_jump.noop();
+  REQUIRE(beast::FitnessCache::isDeterministic(variable_jump.getData()) == false);
+}
+
+TEST_CASE("fitness_cache_serves_and_stores_by_precomputed_key", "fitness_cache") {
+  beast::FitnessCache cache(16);
+  beast::Program random_prg;
+  random_prg.declareVariable(0, beast::Program::VariableType::Int32);
+  random_prg.loadRandomValueIntoVariable(0, true);
+  REQUIRE(cache.getCacheableKey(random_prg.getData(), 0).has_value() == false);
+
+  const std::optional<beast::FitnessCache::Key> key = cache.getCacheableKey(makeProgram(5), 3);
+  REQUIRE(key.has_value() == true);
+  REQUIRE(*key == cache.getKey(makeProgram(5), 3));
+  REQUIRE(cache.lookup(*key).has_value() == false);
+  cache.store(*key, {0.25, std::nullopt});
+  REQUIRE(cache.lookup(makeProgram(5), 3)->score == Approx(0.25));
+  REQUIRE(cache.lookup(*key)->score == Approx(0.25));
+  REQUIRE(cache.getHitCount() == 2);
+  REQUIRE(cache.getMissCount() == 1);
+}
+
+TEST_CASE("fitness_cache_evicts_least_recently_used_entries", "fitness_cache") {
+  beast::FitnessCache cache(2, 1);
+  REQUIRE(cache.getCapacity() == 2);
+
+  REQUIRE(cache.store(makeProgram(1), 0, {0.1, std::nullopt}) == true);
+  REQUIRE(cache.store(makeProgram(2), 0, {0.2, std::nullopt}) == true);
+  REQUIRE(cache.lookup(makeProgram(1), 0).has_value() == true);
+  REQUIRE(cache.store(makeProgram(3), 0, {0.3, std::nullopt}) == true);
+
+  REQUIRE(cache.getSize() == 2);
+  REQUIRE(cache.lookup(makeProgram(1), 0).has_value() == true);
+  REQUIRE(cache.lookup(makeProgram(2), 0).has_value() == false);
+  REQUIRE(cache.lookup(makeProgram(3), 0).has_value() == true);
+}
+
+TEST_CASE("fitness_cache_shares_scores_between_canonically_equal_programs", "fitness_cache") {
+  beast::FitnessCache cache(16);
+  std::vector<unsigned char> padded = makeProgram(5);
+  padded.insert(padded.begin(), static_cast<unsigned char>(beast::OpCode::NoOp));
+  REQUIRE(cache.store(makeProgram(5), 0, {0.5, std::nullopt}) == true);
+  REQUIRE(cache.lookup(padded, 0).has_value() == false);
+
+  cache.setCanonicalKeys(true);
+  REQUIRE(cache.getCanonicalKeys() == true);
+  REQUIRE(cache.getKey(padded, 0) == cache.getKey(makeProgram(5), 0));
+  REQUIRE(cache.store(makeProgram(5), 0, {0.5, std::nullopt}) == true);
+  const std::optional<beast::FitnessCache::Entry> entry = cache.lookup(padded, 0);
+  REQUIRE(entry.has_value() == true);
+  REQUIRE(entry->score == Approx(0.5));
+  REQUIRE(cache.lookup(makeProgram(6), 0).has_value() == false);
+}
+
+TEST_CASE("fitness_cache_rejects_zero_capacity", "fitness_cache") {
+  REQUIRE_THROWS_AS(beast::FitnessCache(0), std::invalid_argument);
+  REQUIRE_THROWS_AS(beast::FitnessCache(16, 0), std::invalid_argument);
+}
+
+TEST_CASE("fitness_cache_can_be_shared_between_threads", "fitness_cache") {
+  beast::FitnessCache cache(1024, 8);
+  const int32_t thread_count = 4;
+  const int32_t programs_per_thread = 100;
+
+  std::vector<std::thread> threads;
+  for (int32_t thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+    threads.emplace_back([&cache]() {
+      for (int32_t idx = 0; idx < programs_per_thread; ++idx) {
+        const std::vector<unsigned char> program = makeProgram(idx);
+        if (!cache.lookup(program, 0)) {
+          cache.store(program, 0, {static_cast<double>(idx), std::nullopt});
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(cache.getSize() == programs_per_thread);
+  REQUIRE(cache.getHitCount() + cache.getMissCount() == thread_count * programs_per_thread);
+  for (int32_t idx = 0; idx < programs_per_thread; ++idx) {
+    const std::optional<beast::FitnessCache::Entry> entry = cache.lookup(makeProgram(idx), 0);
+    REQUIRE(entry.has_value() == true);
+    REQUIRE(entry->score == Approx(static_cast<double>(idx)));
+  }
+}
+
+TEST_CASE("seeded_sessions_draw_reproducible_random_values", "fitness_cache") {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.declareVariable(1, beast::Program::VariableType::Int32);
+  prg.loadRandomValueIntoVariable(0, true);
+  prg.loadRandomValueIntoVariable(1, true);
+
+  beast::CpuVirtualMachine virtual_machine;
+  const auto run = [&virtual_machine](beast::VmSession& session) {
+    while (virtual_machine.step(session, false)) {}
+    return std::make_pair(session.getVariableValue(0, true), session.getVariableValue(1, true));
+  };
+
+  beast::VmSession first_session(prg, 2, 0, 0);
+  first_session.setRandomSeed(42);
+  REQUIRE(first_session.getRandomSeed() == 42);
+  beast::VmSession second_session(prg, 2, 0, 0);
+  second_session.setRandomSeed(42);
+
+  const std::pair<int32_t, int32_t> first_values = run(first_session);
+  REQUIRE(run(second_session) == first_values);
+
+  first_session.reset();
+  REQUIRE(run(first_session) == first_values);
+}
@@ -0,0 +1,207 @@
+#include <catch2/catch.hpp>
+
+#include <beast/beast.hpp>
+
+namespace {
+const int32_t kFirstInputVariable = 0;
+const int32_t kSecondInputVariable = 1;
+const int32_t kOutputVariable = 2;
+const int32_t kConstantVariable = 3;
+
+/**
+ * @brief A program computing `first input + second input + 5` after a five instruction prologue
+ */
+beast::Program makeSumProgram() {
+  beast::Program prg;
+  prg.declareVariable(kOutputVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kOutputVariable, 0, true);
+  prg.declareVariable(kConstantVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kConstantVariable, 5, true);
+  prg.setStringTableEntry(0, "sum");
+  prg.copyVariable(kFirstInputVariable, true, kOutputVariable, true);
+  prg.addVariableToVariable(kSecondInputVariable, true, kOutputVariable, true);
+  prg.addVariableToVariable(kConstantVariable, true, kOutputVariable, true);
+  prg.terminate(0);
+  return prg;
+}
+
+/**
+ * @brief Runs a program with the given inputs in a fresh session and returns the session
+ */
+beast::VmSession runFreshSession(const beast::Program& prg, int32_t first, int32_t second) {
+  beast::VmSession session(prg, 10, 1, 10);
+  session.setVariableBehavior(kFirstInputVariable, beast::VmSession::VariableIoBehavior::Input);
+  session.setVariableBehavior(kSecondInputVariable, beast::VmSession::VariableIoBehavior::Input);
+  session.setVariableValue(kFirstInputVariable, true, first);
+  session.setVariableValue(kSecondInputVariable, true, second);
+
+  beast::CpuVirtualMachine virtual_machine;
+  while (virtual_machine.step(session, false)) {}
+  return session;
+}
+}  // namespace
+
+TEST_CASE("fitness_case_table_rejects_mismatching_cases", "fitness_case_runner") {
+  beast::FitnessCaseTable table({kFirstInputVariable, kSecondInputVariable}, {kOutputVariable});
+
+  REQUIRE_THROWS_AS(table.addCase({1}, {2}), std::invalid_argument);
+  REQUIRE_THROWS_AS(table.addCase({1, 2}, {3, 4}), std::invalid_argument);
+  table.addCase({1, 2}, {8});
+  REQUIRE(table.getCaseCount() == 1);
+  REQUIRE(table.getInput(0, 1) == 2);
+  REQUIRE(table.getExpectedOutput(0, 0) == 8);
+}
+
+TEST_CASE("fitness_case_runner_matches_fresh_sessions", "fitness_case_runner") {
+  const beast::Program prg = makeSumProgram();
+  beast::FitnessCaseTable table({kFirstInputVariable, kSecondInputVariable}, {kOutputVariable});
+  table.addCase({1, 2}, {8});
+  table.addCase({-7, 3}, {1});
+  table.addCase({10, 20}, {30});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  std::vector<uint32_t> steps_per_case;
+  const beast::ScoreMatrix matrix = runner.run(
+      beast::VmSession(prg, 10, 1, 10), table,
+      [&steps_per_case](size_t /*case_index*/, const beast::VmSession& session) {
+        steps_per_case.push_back(session.getRuntimeStatistics().steps_executed);
+      });
+
+  REQUIRE(runner.getPrologueSteps() == 5);
+  REQUIRE(matrix.getCaseCount() == 3);
+  REQUIRE(matrix.getOutputCount() == 1);
+  REQUIRE(steps_per_case.size() == 3);
+  for (size_t case_index = 0; case_index < table.getCaseCount(); ++case_index) {
+    beast::VmSession fresh = runFreshSession(
+        prg, table.getInput(case_index, 0), table.getInput(case_index, 1));
+    REQUIRE(matrix.getOutput(case_index, 0) == fresh.getVariableValue(kOutputVariable, true));
+    REQUIRE(steps_per_case[case_index] == fresh.getRuntimeStatistics().steps_executed);
+  }
+
+  REQUIRE(matrix.getScore(0, 0) == Approx(1.0));
+  REQUIRE(matrix.getScore(1, 0) == Approx(1.0));
+  // 10 + 20 + 5 is off by 5.
+  REQUIRE(matrix.getScore(2, 0) == Approx(1.0 / 6.0));
+  REQUIRE(matrix.getMeanScore() == Approx((2.0 + 1.0 / 6.0) / 3.0));
+}
+
+TEST_CASE("fitness_case_runner_stops_prologue_at_input_assignments", "fitness_case_runner") {
+  beast::Program prg;
+  prg.declareVariable(kOutputVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kFirstInputVariable, 100, true);
+  prg.copyVariable(kFirstInputVariable, true, kOutputVariable, true);
+  prg.terminate(0);
+
+  beast::FitnessCaseTable table({kFirstInputVariable}, {kOutputVariable});
+  table.addCase({1}, {100});
+  table.addCase({2}, {100});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  const beast::ScoreMatrix matrix = runner.run(beast::VmSession(prg, 10, 0, 0), table);
+
+  // Overwriting the input must happen after the input was injected, as in a fresh session.
+  REQUIRE(runner.getPrologueSteps() == 1);
+  REQUIRE(matrix.getOutput(0, 0) == 100);
+  REQUIRE(matrix.getOutput(1, 0) == 100);
+  REQUIRE(matrix.getMeanScore() == Approx(1.0));
+}
+
+TEST_CASE("fitness_case_runner_scores_failing_cases_zero", "fitness_case_runner") {
+  beast::Program prg;
+  prg.declareVariable(kOutputVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kOutputVariable, 4, true);
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  // Loops as long as the input is greater than zero.
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(
+      kFirstInputVariable, true, loop_start_address);
+  prg.terminate(0);
+
+  beast::VmSession prototype(prg, 10, 0, 0);
+  beast::VmSession::ExecutionLimits limits;
+  limits.max_steps = 100;
+  prototype.setExecutionLimits(limits);
+
+  beast::FitnessCaseTable table({kFirstInputVariable}, {kOutputVariable});
+  table.addCase({0}, {4});
+  table.addCase({1}, {4});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  const beast::ScoreMatrix matrix = runner.run(prototype, table);
+
+  REQUIRE(matrix.getCaseScore(0) == Approx(1.0));
+  REQUIRE(matrix.getOutput(1, 0) == 4);
+  REQUIRE(matrix.getCaseScore(1) == Approx(0.0));
+}
+
+TEST_CASE("fitness_case_runner_ends_cases_waiting_for_more_input", "fitness_case_runner") {
+  const int32_t input_changed_variable = 4;
+  beast::Program prg;
+  prg.declareVariable(kOutputVariable, beast::Program::VariableType::Int32);
+  prg.declareVariable(input_changed_variable, beast::Program::VariableType::Int32);
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.checkIfInputWasSet(kFirstInputVariable, true, input_changed_variable, true);
+  prg.absoluteJumpToAddressIfVariableEqualsZero(
+      input_changed_variable, true, loop_start_address);
+  prg.addVariableToVariable(kFirstInputVariable, true, kOutputVariable, true);
+  prg.unconditionalJumpToAbsoluteAddress(loop_start_address);
+
+  beast::FitnessCaseTable table({kFirstInputVariable}, {kOutputVariable});
+  table.addCase({3}, {3});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  const beast::ScoreMatrix matrix = runner.run(beast::VmSession(prg, 10, 0, 0), table);
+
+  REQUIRE(matrix.getOutput(0, 0) == 3);
+  REQUIRE(matrix.getScore(0, 0) == Approx(1.0));
+}
+
+TEST_CASE("fitness_case_runner_abandons_races_that_cannot_reach_the_threshold",
+          "fitness_case_runner") {
+  const beast::Program prg = makeSumProgram();
+  beast::FitnessCaseTable table({kFirstInputVariable, kSecondInputVariable}, {kOutputVariable});
+  // Every case expects the sum without the constant, so each one is off by 5.
+  table.addCase({1, 2}, {3});
+  table.addCase({3, 4}, {7});
+  table.addCase({5, 6}, {11});
+  table.addCase({7, 8}, {15});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  size_t observed_cases = 0;
+  const beast::FitnessCaseRunner::RaceResult result = runner.race(
+      beast::VmSession(prg, 10, 1, 10), table, 0.7,
+      [&observed_cases](size_t /*case_index*/, const beast::VmSession& /*session*/) {
+        observed_cases++;
+      });
+
+  // After two cases scoring 1/6, at most (2/6 + 2) / 4 = 0.583 is achievable.
+  REQUIRE(result.abandoned == true);
+  REQUIRE(result.cases_run == 2);
+  REQUIRE(observed_cases == 2);
+  REQUIRE(result.upper_bound == Approx((2.0 / 6.0 + 2.0) / 4.0));
+  REQUIRE(result.scores.getScore(1, 0) == Approx(1.0 / 6.0));
+  REQUIRE(result.scores.getScore(2, 0) == Approx(0.0));
+}
+
+TEST_CASE("fitness_case_runner_completes_races_that_can_reach_the_threshold",
+          "fitness_case_runner") {
+  const beast::Program prg = makeSumProgram();
+  beast::FitnessCaseTable table({kFirstInputVariable, kSecondInputVariable}, {kOutputVariable});
+  table.addCase({1, 2}, {8});
+  table.addCase({-7, 3}, {1});
+  table.addCase({10, 20}, {30});
+
+  beast::CpuVirtualMachine virtual_machine;
+  beast::FitnessCaseRunner runner(virtual_machine);
+  const beast::FitnessCaseRunner::RaceResult result =
+      runner.race(beast::VmSession(prg, 10, 1, 10), table, 0.7);
+
+  REQUIRE(result.abandoned == false);
+  REQUIRE(result.cases_run == 3);
+  REQUIRE(result.upper_bound == Approx((2.0 + 1.0 / 6.0) / 3.0));
+  REQUIRE(result.upper_bound == Approx(result.scores.getMeanScore()));
+}
@@ -0,0 +1,300 @@
+#include <catch2/catch.hpp>
+
+// Standard
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief A program using every operator at least once, including forward and backward jumps
+ */
+beast::Program makeProgramWithAllOperators() {
+  beast::Program prg;
+  prg.noop();
+  prg.loadMemorySizeIntoVariable(0, true);
+  prg.loadCurrentAddressIntoVariable(0, true);
+  prg.terminateWithVariableReturnCode(0, true);
+  prg.performSystemCall(0, 1, 0, true);
+  prg.loadRandomValueIntoVariable(0, true);
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.setVariable(0, 17, true);
+  prg.undeclareVariable(1);
+  prg.copyVariable(0, true, 1, false);
+  prg.swapVariables(0, true, 1, true);
+  prg.addConstantToVariable(0, 3, true);
+  prg.addVariableToVariable(0, true, 1, true);
+  prg.subtractConstantFromVariable(0, 3, true);
+  prg.subtractVariableFromVariable(0, true, 1, true);
+  prg.compareIfVariableGtConstant(0, true, 5, 1, true);
+  prg.compareIfVariableLtConstant(0, true, 5, 1, true);
+  prg.compareIfVariableEqConstant(0, true, 5, 1, true);
+  prg.compareIfVariableGtVariable(0, true, 1, true, 2, true);
+  prg.compareIfVariableLtVariable(0, true, 1, true, 2, true);
+  prg.compareIfVariableEqVariable(0, true, 1, true, 2, true);
+  prg.getMaxOfVariableAndConstant(0, true, 5, 1, true);
+  prg.getMinOfVariableAndConstant(0, true, 5, 1, true);
+  prg.getMaxOfVariableAndVariable(0, true, 1, true, 2, true);
+  prg.getMinOfVariableAndVariable(0, true, 1, true, 2, true);
+  prg.moduloVariableByConstant(0, true, 7);
+  prg.moduloVariableByVariable(0, true, 1, true);
+  prg.bitShiftVariableLeft(0, true, 2);
+  prg.bitShiftVariableRight(0, true, 2);
+  prg.bitWiseInvertVariable(0, true);
+  prg.bitWiseAndTwoVariables(0, true, 1, true);
+  prg.bitWiseOrTwoVariables(0, true, 1, true);
+  prg.bitWiseXorTwoVariables(0, true, 1, true);
+  prg.rotateVariableLeft(0, true, 2);
+  prg.rotateVariableRight(0, true, 2);
+  prg.variableBitShiftVariableLeft(0, true, 1, true);
+  prg.variableBitShiftVariableRight(0, true, 1, true);
+  prg.variableRotateVariableLeft(0, true, 1, true);
+  prg.variableRotateVariableRight(0, true, 1, true);
+  prg.relativeJumpToVariableAddressIfVariableGreaterThanZero(0, true, 1, true);
+  prg.relativeJumpToVariableAddressIfVariableLessThanZero(0, true, 1, true);
+  prg.relativeJumpToVariableAddressIfVariableEqualsZero(0, true, 1, true);
+  prg.absoluteJumpToVariableAddressIfVariableGreaterThanZero(0, true, 1, true);
+  prg.absoluteJumpToVariableAddressIfVariableLessThanZero(0, true, 1, true);
+  prg.absoluteJumpToVariableAddressIfVariableEqualsZero(0, true, 1, true);
+  // Skips the next instruction (5 bytes).
+  prg.relativeJumpToAddressIfVariableGreaterThanZero(0, true, 5);
+  prg.unconditionalJumpToRelativeAddress(0);
+  prg.relativeJumpToAddressIfVariableLessThanZero(0, true, 0);
+  prg.relativeJumpToAddressIfVariableEqualsZero(0, true, 0);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(0, true, loop_start_address);
+  prg.absoluteJumpToAddressIfVariableLessThanZero(0, true, loop_start_address);
+  prg.absoluteJumpToAddressIfVariableEqualsZero(0, true, loop_start_address);
+  prg.unconditionalJumpToAbsoluteAddress(loop_start_address);
+  prg.unconditionalJumpToAbsoluteVariableAddress(0, true);
+  prg.unconditionalJumpToRelativeVariableAddress(0, true);
+  prg.checkIfVariableIsInput(0, true, 1, true);
+  prg.checkIfVariableIsOutput(0, true, 1, true);
+  prg.loadInputCountIntoVariable(0, true);
+  prg.loadOutputCountIntoVariable(0, true);
+  prg.checkIfInputWasSet(0, true, 1, true);
+  prg.printVariable(0, true, false);
+  prg.setStringTableEntry(0, "some text");
+  prg.printStringFromStringTable(0);
+  prg.loadStringTableLimitIntoVariable(0, true);
+  prg.loadStringTableItemLengthLimitIntoVariable(0, true);
+  prg.setVariableStringTableEntry(0, true, "more");
+  prg.printVariableStringFromStringTable(0, true);
+  prg.loadVariableStringItemLengthIntoVariable(0, true, 1, true);
+  prg.loadVariableStringItemIntoVariables(0, true, 1, true);
+  prg.loadStringItemLengthIntoVariable(0, 1, true);
+  prg.loadStringItemIntoVariables(0, 1, true);
+  prg.pushVariableOnStack(0, true, 1, true);
+  prg.pushConstantOnStack(0, true, 42);
+  prg.popVariableFromStack(0, true, 1, true);
+  prg.popTopItemFromStack(0, true);
+  prg.checkIfStackIsEmpty(0, true, 1, true);
+  prg.terminate(0);
+  return prg;
+}
+
+/**
+ * @brief Whether code decodes completely and all constant jump targets hit instruction boundaries
+ */
+bool isWellFormed(const std::vector<unsigned char>& code) {
+  const std::vector<beast::InstructionDecoder::Instruction> instructions =
+      beast::InstructionDecoder::decodeAll(code);
+  const size_t decoded_end =
+      instructions.empty() ? 0 : instructions.back().offset + instructions.back().size;
+  if (decoded_end != code.size()) {
+    return false;
+  }
+
+  std::vector<int64_t> boundaries;
+  for (const beast::InstructionDecoder::Instruction& instruction : instructions) {
+    boundaries.push_back(static_cast<int64_t>(instruction.offset));
+  }
+  boundaries.push_back(static_cast<int64_t>(code.size()));
+
+  return std::all_of(
+      instructions.begin(), instructions.end(),
+      [&](const beast::InstructionDecoder::Instruction& instruction) {
+        const std::optional<int64_t> target =
+            beast::InstructionDecoder::getJumpTarget(code, instruction);
+        return !target || std::binary_search(boundaries.begin(), boundaries.end(), *target);
+      });
+}
+}  // namespace
+
+TEST_CASE("decoder_matches_program_encoding_of_all_operators", "genetic_operators") {
+  const std::vector<unsigned char> code = makeProgramWithAllOperators().getData();
+  const std::vector<beast::InstructionDecoder::Instruction> instructions =
+      beast::InstructionDecoder::decodeAll(code);
+
+  REQUIRE(instructions.back().offset + instructions.back().size == code.size());
+  for (int32_t opcode = 0; opcode < static_cast<int32_t>(beast::OpCode::Size); ++opcode) {
+    const bool used = std::any_of(
+        instructions.begin(), instructions.end(),
+        [opcode](const beast::InstructionDecoder::Instruction& instruction) {
+          return static_cast<int32_t>(instruction.opcode) == opcode;
+        });
+    REQUIRE(used == true);
+  }
+  REQUIRE(isWellFormed(code));
+}
+
+TEST_CASE("decoder_rejects_unknown_and_truncated_instructions", "genetic_operators") {
+  beast::Program prg;
+  prg.setVariable(0, 1, true);
+  std::vector<unsigned char> code = prg.getData();
+
+  REQUIRE(beast::InstructionDecoder::decode(code, 0)->size == 10);
+  code.pop_back();
+  REQUIRE(beast::InstructionDecoder::decode(code, 0).has_value() == false);
+  const std::vector<unsigned char> unknown_operator{0x7f};
+  REQUIRE(beast::InstructionDecoder::decode(unknown_operator, 0).has_value() == false);
+  REQUIRE(beast::InstructionDecoder::isKnownOpCode(static_cast<unsigned char>(beast::OpCode::Size))
+          == false);
+
+  // Strings with a negative length can't be decoded.
+  const std::vector<unsigned char> negative_string = {
+      static_cast<unsigned char>(beast::OpCode::SetStringTableEntry), 0, 0, 0, 0, 0xff, 0xff};
+  REQUIRE(beast::InstructionDecoder::decode(negative_string, 0).has_value() == false);
+}
+
+TEST_CASE("decoder_reads_and_writes_jump_targets", "genetic_operators") {
+  beast::Program prg;
+  prg.noop();
+  prg.unconditionalJumpToAbsoluteAddress(0);
+  prg.unconditionalJumpToRelativeAddress(-11);
+  std::vector<unsigned char> code = prg.getData();
+  const std::vector<beast::InstructionDecoder::Instruction> instructions =
+      beast::InstructionDecoder::decodeAll(code);
+
+  REQUIRE(beast::InstructionDecoder::getJumpTarget(code, instructions[0]).has_value() == false);
+  REQUIRE(beast::InstructionDecoder::getJumpTarget(code, instructions[1]) == 0);
+  // Relative jumps are relative to the end of the instruction at offset 6.
+  REQUIRE(beast::InstructionDecoder::getJumpTarget(code, instructions[2]) == 0);
+
+  beast::InstructionDecoder::setJumpTarget(code, instructions[2], 1);
+  REQUIRE(beast::InstructionDecoder::getJumpTarget(code, instructions[2]) == 1);
+  REQUIRE(beast::Program(code).getData4(7) == -10);
+}
+
+TEST_CASE("crossover_produces_decodable_children", "genetic_operators") {
+  std::mt19937 rng(42);
+  const std::vector<unsigned char> mother = makeProgramWithAllOperators().getData();
+  beast::Program father_program;
+  father_program.declareVariable(3, beast::Program::VariableType::Int32);
+  father_program.setVariable(3, 10, true);
+  const auto loop_start_address = static_cast<int32_t>(father_program.getPointer());
+  father_program.subtractConstantFromVariable(3, 1, true);
+  father_program.absoluteJumpToAddressIfVariableGreaterThanZero(3, true, loop_start_address);
+  father_program.terminate(1);
+  const std::vector<unsigned char> father = father_program.getData();
+  REQUIRE(isWellFormed(father));
+
+  for (uint32_t idx = 0; idx < 500; ++idx) {
+    const auto [first_child, second_child] = beast::GeneticOperators::crossOver(mother, father, rng);
+    REQUIRE(isWellFormed(first_child));
+    REQUIRE(isWellFormed(second_child));
+    REQUIRE(first_child.size() + second_child.size() == mother.size() + father.size());
+  }
+}
+
+TEST_CASE("mutation_keeps_code_decodable", "genetic_operators") {
+  std::mt19937 rng(7);
+  std::vector<unsigned char> code = makeProgramWithAllOperators().getData();
+
+  uint32_t mutations = 0;
+  for (uint32_t idx = 0; idx < 200 && !code.empty(); ++idx) {
+    mutations += beast::GeneticOperators::mutate(code, 0.2, rng);
+    REQUIRE(isWellFormed(code));
+  }
+  REQUIRE(mutations > 0);
+}
+
+TEST_CASE("mutation_saturates_operands_at_their_limits", "genetic_operators") {
+  const int32_t largest_index = std::numeric_limits<int32_t>::max();
+  beast::Program prg;
+  prg.loadMemorySizeIntoVariable(largest_index, true);
+  const std::vector<unsigned char> original = prg.getData();
+
+  std::mt19937 rng(5);
+  for (uint32_t attempt = 0; attempt < 200; ++attempt) {
+    std::vector<unsigned char> code = original;
+    (void)beast::GeneticOperators::mutate(code, 1.0, rng);
+    if (code.size() != original.size()) {
+      // The instruction was removed or duplicated.
+      continue;
+    }
+    int32_t index = 0;
+    std::memcpy(&index, &code[1], 4);
+    REQUIRE(index >= largest_index - 2);
+  }
+}
+
+TEST_CASE("mutation_keeps_the_undecodable_tail_behind_the_rebuilt_code", "genetic_operators") {
+  beast::Program prg;
+  for (int32_t idx = 0; idx < 50; ++idx) {
+    prg.addConstantToVariable(0, idx, true);
+  }
+  const size_t original_instruction_size = prg.getData().size() / 50;
+  std::vector<unsigned char> original = prg.getData();
+  original.insert(original.end(), 8, 0xff);
+
+  // Removals and duplications move the tail; mutating it must not write outside of it.
+  std::mt19937 rng(11);
+  for (uint32_t attempt = 0; attempt < 200; ++attempt) {
+    std::vector<unsigned char> code = original;
+    (void)beast::GeneticOperators::mutate(code, 0.9, rng);
+    REQUIRE(code.size() >= 8);
+    const size_t tail_begin = code.size() - 8;
+    REQUIRE(std::count(code.begin() + static_cast<std::ptrdiff_t>(tail_begin), code.end(), 0xff) >=
+            7);
+
+    const std::vector<unsigned char> head(
+        code.begin(), code.begin() + static_cast<std::ptrdiff_t>(tail_begin));
+    const std::vector<beast::InstructionDecoder::Instruction> instructions =
+        beast::InstructionDecoder::decodeAll(head);
+    REQUIRE(instructions.size() * original_instruction_size == head.size());
+    for (const beast::InstructionDecoder::Instruction& instruction : instructions) {
+      REQUIRE(instruction.opcode == beast::OpCode::AddConstantToVariable);
+    }
+  }
+}
+
+TEST_CASE("removing_instructions_relocates_jumps", "genetic_operators") {
+  beast::Program prg;
+  prg.noop();
+  prg.noop();
+  prg.terminate(0);
+  prg.unconditionalJumpToAbsoluteAddress(2);
+  const std::vector<unsigned char> original = prg.getData();
+
+  // Mutate until a variant lost exactly one of the leading NoOps, but kept the other instructions.
+  std::mt19937 rng(3);
+  for (uint32_t attempt = 0; attempt < 1000; ++attempt) {
+    std::vector<unsigned char> code = original;
+    (void)beast::GeneticOperators::mutate(code, 0.3, rng);
+    const std::vector<beast::InstructionDecoder::Instruction> instructions =
+        beast::InstructionDecoder::decodeAll(code);
+    if (code.size() != original.size() - 1 || instructions.size() != 3 ||
+        instructions[1].opcode != beast::OpCode::Terminate ||
+        instructions[2].opcode != beast::OpCode::UnconditionalJumpToAbsoluteAddress) {
+      continue;
+    }
+    REQUIRE(beast::InstructionDecoder::getJumpTarget(code, instructions[2]) == 1);
+    return;
+  }
+  FAIL("No matching mutation was produced.");
+}
+
+TEST_CASE("operators_keep_undecodable_code_intact", "genetic_operators") {
+  std::mt19937 rng(1);
+  const std::vector<unsigned char> data = {0x7f, 0x7e, 0x7d};
+
+  for (uint32_t idx = 0; idx < 50; ++idx) {
+    const auto [first_child, second_child] = beast::GeneticOperators::crossOver(data, data, rng);
+    REQUIRE((first_child.empty() || first_child == data || first_child.size() == 6));
+    REQUIRE(first_child.size() + second_child.size() == 6);
+  }
+}
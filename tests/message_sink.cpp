@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+// Standard
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief A sink collecting all messages it receives
+ */
+class CollectingMessageSink : public beast::MessageSink {
+ public:
+  void write(
+      beast::VirtualMachine::MessageSeverity /*severity*/,
+      std::chrono::system_clock::time_point /*time*/,
+      const std::string& message) noexcept override {
+    std::scoped_lock lock(mutex_);
+    messages_.push_back(message);
+  }
+
+  [[nodiscard]] std::vector<std::string> getMessages() {
+    std::scoped_lock lock(mutex_);
+    return messages_;
+  }
+
+ private:
+  std::mutex mutex_;
+
+  std::vector<std::string> messages_;
+};
+
+/**
+ * @brief A program counting a variable down from `count` to zero
+ */
+beast::Program makeCountdownProgram(int32_t count) {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, count, true);
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.subtractConstantFromVariable(0, 1, true);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(0, true, loop_start_address);
+  prg.terminate(0);
+  return prg;
+}
+}  // namespace
+
+TEST_CASE("console_message_sink_formats_single_lines", "message_sink") {
+  std::ostringstream stream;
+  beast::ConsoleMessageSink sink(stream);
+
+  sink.write(beast::VirtualMachine::MessageSeverity::Warning, std::chrono::system_clock::now(),
+             "careful");
+
+  const std::string line = stream.str();
+  REQUIRE(line.find("WRN] careful") != std::string::npos);
+  REQUIRE(line.back() == '\n');
+}
+
+TEST_CASE("async_message_sink_forwards_messages_in_order", "message_sink") {
+  auto target = std::make_shared<CollectingMessageSink>();
+  {
+    beast::AsyncMessageSink sink(target, 16);
+    for (uint32_t idx = 0; idx < 100; ++idx) {
+      sink.write(beast::VirtualMachine::MessageSeverity::Info, std::chrono::system_clock::now(),
+                 std::to_string(idx));
+      sink.flush();
+    }
+    REQUIRE(sink.getDroppedCount() == 0);
+  }
+
+  const std::vector<std::string> messages = target->getMessages();
+  REQUIRE(messages.size() == 100);
+  for (uint32_t idx = 0; idx < 100; ++idx) {
+    REQUIRE(messages[idx] == std::to_string(idx));
+  }
+}
+
+TEST_CASE("virtual_machine_steps_sessions_concurrently", "message_sink") {
+  const uint32_t thread_count = 4;
+  const int32_t count = 1000;
+
+  auto target = std::make_shared<CollectingMessageSink>();
+  auto sink = std::make_shared<beast::AsyncMessageSink>(target, 1U << 16U);
+  beast::CpuVirtualMachine virtual_machine;
+  virtual_machine.setMinimumMessageSeverity(beast::VirtualMachine::MessageSeverity::Debug);
+  virtual_machine.setMessageSink(sink);
+
+  std::vector<beast::VmSession> sessions;
+  for (uint32_t idx = 0; idx < thread_count; ++idx) {
+    sessions.emplace_back(makeCountdownProgram(count), 1, 0, 0);
+  }
+
+  std::vector<std::thread> threads;
+  for (beast::VmSession& session : sessions) {
+    threads.emplace_back([&virtual_machine, &session]() {
+      while (virtual_machine.step(session, false)) {}
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  sink->flush();
+
+  uint64_t total_steps = 0;
+  for (beast::VmSession& session : sessions) {
+    REQUIRE(session.getRuntimeStatistics().terminated == true);
+    REQUIRE(session.getVariableValue(0, true) == 0);
+    total_steps += session.getRuntimeStatistics().steps_executed;
+  }
+  REQUIRE(target->getMessages().size() + sink->getDroppedCount() >= total_steps);
+}
@@ -1,5 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
 #include <beast/beast.hpp>
 
 class MockPipe : public beast::Pipe {
@@ -44,3 +51,514 @@ TEST_CASE("pipe_calls_evaluate_on_evolve", "pipe") {
 
   REQUIRE(pipe.getEvaluateCallCount() > 0);
 }
+
+TEST_CASE("pipe_finalists_keep_the_code_they_were_scored_with", "pipe") {
+  class LengthScoringPipe : public beast::Pipe {
+   public:
+    explicit LengthScoringPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+      return static_cast<double>(program_data.size()) / 1000.0;
+    }
+  };
+
+  const uint32_t max_population = 10;
+  LengthScoringPipe pipe(max_population);
+  // Scoring by length rewards bloat, so only a few generations are run.
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 5;
+  pipe.setEvolutionParameters(parameters);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(std::vector<unsigned char>(100 + idx * 10, static_cast<unsigned char>(idx)));
+  }
+
+  pipe.evolve();
+
+  REQUIRE(pipe.hasOutput() == true);
+  while (pipe.hasOutput()) {
+    const beast::Pipe::OutputItem item = pipe.drawOutput();
+    REQUIRE(item.data.empty() == false);
+    REQUIRE(item.score == Approx(static_cast<double>(item.data.size()) / 1000.0));
+  }
+}
+
+TEST_CASE("pipe_with_fitness_cache_evaluates_identical_programs_once", "pipe") {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 1, true);
+
+  const uint32_t max_population = 10;
+  MockPipe pipe(max_population);
+  auto cache = std::make_shared<beast::FitnessCache>(64);
+  pipe.setFitnessCache(cache, 7);
+  REQUIRE(pipe.getFitnessCache() == cache);
+  REQUIRE(pipe.getFitnessCacheConfiguration() == 7);
+
+  // A cached score for the initial candidate spares every evaluation of unchanged copies.
+  REQUIRE(cache->store(prg.getData(), 7, {0.5, std::nullopt}) == true);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(prg.getData());
+  }
+
+  pipe.evolve();
+
+  REQUIRE(cache->getHitCount() > 0);
+  REQUIRE(pipe.getEvaluateCallCount() <= cache->getMissCount());
+  REQUIRE(pipe.getEvaluateCallCount() < cache->getHitCount() + cache->getMissCount());
+}
+
+TEST_CASE("racing_pipe_passes_cut_off_score_and_never_caches_abandoned_scores", "pipe") {
+  class RacingPipe : public beast::Pipe {
+   public:
+    explicit RacingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+      return 1.0;
+    }
+
+    [[nodiscard]] RacingScore evaluateRacing(
+        const std::vector<unsigned char>& /*program_data*/, double threshold) override {
+      thresholds.push_back(threshold);
+      return {0.25, true};
+    }
+
+    std::vector<double> thresholds;
+  };
+
+  const uint32_t max_population = 10;
+  RacingPipe pipe(max_population);
+  pipe.setCutOffScore(0.5);
+  pipe.setRacing(true, 3);
+  REQUIRE(pipe.isRacing() == true);
+  REQUIRE(pipe.getRacingEliteCount() == 3);
+  auto cache = std::make_shared<beast::FitnessCache>(64);
+  cache->setAllowNondeterministic(true);
+  pipe.setFitnessCache(cache);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(std::vector<unsigned char>(10, static_cast<unsigned char>(idx)));
+  }
+
+  pipe.evolve();
+
+  REQUIRE(pipe.thresholds.empty() == false);
+  for (const double threshold : pipe.thresholds) {
+    REQUIRE(threshold == Approx(0.5));
+  }
+  REQUIRE(cache->getSize() == 0);
+  REQUIRE(pipe.hasOutput() == false);
+}
+
+TEST_CASE("pipe_applies_evolution_parameters", "pipe") {
+  const uint32_t max_population = 10;
+  MockPipe pipe(max_population);
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 0;
+  pipe.setEvolutionParameters(parameters);
+  REQUIRE(pipe.getEvolutionParameters().generations == 0);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput({});
+  }
+
+  pipe.evolve();
+
+  // Without any generations, only the initial population is evaluated.
+  REQUIRE(pipe.getEvaluateCallCount() == max_population);
+}
+
+TEST_CASE("pipe_streams_finalists_while_accepting_inputs", "pipe") {
+  class LengthScoringPipe : public beast::Pipe {
+   public:
+    explicit LengthScoringPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+    ~LengthScoringPipe() override { stop(std::nothrow); }
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+      return static_cast<double>(program_data.size()) / 1000.0;
+    }
+  };
+
+  const uint32_t max_population = 10;
+  LengthScoringPipe pipe(max_population);
+  pipe.setCutOffScore(0.1);
+  pipe.start();
+  REQUIRE(pipe.isRunning() == true);
+  REQUIRE_THROWS_AS(pipe.start(), std::logic_error);
+  REQUIRE_THROWS_AS(pipe.evolve(), std::logic_error);
+
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(std::vector<unsigned char>(50, static_cast<unsigned char>(idx)));
+  }
+  // Inputs arriving while the evolution runs immigrate into the population.
+  pipe.addInput(std::vector<unsigned char>(200, 0));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!pipe.hasOutput() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(pipe.isRunning() == true);
+  pipe.stop();
+  REQUIRE(pipe.isRunning() == false);
+
+  REQUIRE(pipe.hasOutput() == true);
+  while (pipe.hasOutput()) {
+    const beast::Pipe::OutputItem item = pipe.drawOutput();
+    REQUIRE(item.data.size() >= 100);
+    REQUIRE(item.score == Approx(static_cast<double>(item.data.size()) / 1000.0));
+  }
+}
+
+TEST_CASE("pipe_rethrows_evaluation_errors_of_streaming_evolution", "pipe") {
+  class FailingPipe : public beast::Pipe {
+   public:
+    explicit FailingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+    ~FailingPipe() override { stop(std::nothrow); }
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+      throw std::runtime_error("Evaluation failed.");
+    }
+  };
+
+  const uint32_t max_population = 4;
+  FailingPipe pipe(max_population);
+  pipe.start();
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput({0});
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (pipe.isRunning() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(pipe.isRunning() == false);
+  // Stopping without throwing keeps the error for the next stop().
+  pipe.stop(std::nothrow);
+  REQUIRE_THROWS_AS(pipe.stop(), std::runtime_error);
+  REQUIRE_NOTHROW(pipe.stop());
+}
+
+TEST_CASE("pipe_buffers_offer_non_blocking_and_blocking_access", "pipe") {
+  class PublicPipe : public beast::Pipe {
+   public:
+    PublicPipe(uint32_t max_candidates, size_t output_capacity)
+      : beast::Pipe(max_candidates, output_capacity) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+      return 1.0;
+    }
+
+    using beast::Pipe::storeFinalist;
+  };
+
+  PublicPipe pipe(2, 2);
+  std::vector<unsigned char> candidate = {1, 2, 3};
+  REQUIRE(pipe.tryAddInput(std::move(candidate)) == true);
+  REQUIRE(pipe.tryAddInput({4}) == true);
+  std::vector<unsigned char> rejected = {5};
+  REQUIRE(pipe.tryAddInput(std::move(rejected)) == false);
+  REQUIRE(rejected.size() == 1);
+  REQUIRE(pipe.hasSpace() == false);
+  // Nothing draws from the input pool, so waiting for space gives up.
+  REQUIRE_THROWS_AS(pipe.addInput({5}, std::chrono::milliseconds(5)), std::overflow_error);
+
+  REQUIRE(pipe.drawInput() == std::vector<unsigned char>{1, 2, 3});
+  REQUIRE(pipe.tryDrawInput() == std::vector<unsigned char>{4});
+  REQUIRE(pipe.tryDrawInput().has_value() == false);
+  REQUIRE_THROWS_AS(pipe.drawInput(), std::underflow_error);
+
+  REQUIRE(pipe.tryDrawOutput().has_value() == false);
+  REQUIRE(pipe.drawOutputFor(std::chrono::milliseconds(5)).has_value() == false);
+  pipe.storeFinalist({6}, 0.25F);
+  pipe.storeFinalist({7}, 0.5F);
+
+  // The output buffer is full, so storing another finalist waits for the consumer.
+  std::thread consumer([&pipe]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(pipe.tryDrawOutput()->data == std::vector<unsigned char>{6});
+  });
+  pipe.storeFinalist({8}, 0.75F);
+  consumer.join();
+
+  REQUIRE(pipe.drawOutput().data == std::vector<unsigned char>{7});
+  const std::optional<beast::Pipe::OutputItem> item =
+      pipe.drawOutputFor(std::chrono::milliseconds(5));
+  REQUIRE(item.has_value() == true);
+  REQUIRE(item->data == std::vector<unsigned char>{8});
+  REQUIRE(item->score == Approx(0.75));
+  REQUIRE_THROWS_AS(pipe.drawOutput(), std::underflow_error);
+}
+
+TEST_CASE("pipe_batch_evolution_drops_finalists_that_do_not_fit_the_output_buffer", "pipe") {
+  class SmallOutputPipe : public beast::Pipe {
+   public:
+    SmallOutputPipe(uint32_t max_candidates, size_t output_capacity)
+      : beast::Pipe(max_candidates, output_capacity) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+      return static_cast<double>(program_data.size()) / 1000.0;
+    }
+  };
+
+  // Nobody draws outputs while evolve() runs, so waiting for space would never end.
+  const uint32_t max_population = 16;
+  SmallOutputPipe pipe(max_population, 4);
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 2;
+  pipe.setEvolutionParameters(parameters);
+  uint64_t dropped_count = 0;
+  for (uint32_t round = 0; round < 2; ++round) {
+    for (uint32_t idx = 0; idx < max_population; ++idx) {
+      pipe.addInput(std::vector<unsigned char>(10 + idx, static_cast<unsigned char>(idx)));
+    }
+    pipe.evolve();
+    REQUIRE(pipe.getDroppedFinalistCount() > dropped_count);
+    dropped_count = pipe.getDroppedFinalistCount();
+  }
+
+  double previous_score = 1.0;
+  for (uint32_t idx = 0; idx < 4; ++idx) {
+    const beast::Pipe::OutputItem item = pipe.drawOutput();
+    REQUIRE(item.score <= previous_score);
+    previous_score = item.score;
+  }
+  REQUIRE(pipe.hasOutput() == false);
+}
+
+TEST_CASE("pipe_resumes_checkpointed_evolution_like_the_uninterrupted_run", "pipe") {
+  class LengthScoringPipe : public beast::Pipe {
+   public:
+    explicit LengthScoringPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+      evaluate_call_count_++;
+      return static_cast<double>(program_data.size()) / 1000.0;
+    }
+
+    [[nodiscard]] uint32_t getEvaluateCallCount() const { return evaluate_call_count_; }
+
+   private:
+    uint32_t evaluate_call_count_ = 0;
+  };
+
+  const char* const checkpoint_path = "pipe_checkpoint_test.ckpt";
+  const uint32_t max_population = 6;
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 4;
+
+  LengthScoringPipe uninterrupted_pipe(max_population);
+  uninterrupted_pipe.setEvolutionParameters(parameters);
+  uninterrupted_pipe.setCheckpointing(checkpoint_path, 2);
+  REQUIRE(uninterrupted_pipe.getCheckpointInterval() == 2);
+  REQUIRE(uninterrupted_pipe.getCheckpointPath() == checkpoint_path);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    beast::Program prg;
+    for (uint32_t instruction_idx = 0; instruction_idx <= idx; ++instruction_idx) {
+      prg.setVariable(static_cast<int32_t>(instruction_idx), static_cast<int32_t>(idx), true);
+    }
+    uninterrupted_pipe.addInput(prg.getData());
+  }
+  uninterrupted_pipe.evolve();
+
+  // The checkpoint was taken after the second of four generations.
+  {
+    const beast::MappedEvolutionCheckpoint checkpoint(checkpoint_path);
+    REQUIRE(checkpoint.getGeneration() == 2);
+    REQUIRE(checkpoint.getRecordCount(beast::EvolutionCheckpoint::Section::Population) ==
+            max_population);
+    REQUIRE(checkpoint.getRecordCount(beast::EvolutionCheckpoint::Section::Inputs) == 0);
+    const beast::MappedEvolutionCheckpoint::Record record =
+        checkpoint.getRecord(beast::EvolutionCheckpoint::Section::Population, 0);
+    REQUIRE(record.score == Approx(static_cast<double>(record.size) / 1000.0));
+  }
+
+  LengthScoringPipe resumed_pipe(max_population);
+  resumed_pipe.setEvolutionParameters(parameters);
+  resumed_pipe.resume(checkpoint_path);
+  std::remove(checkpoint_path);
+
+  // The restored population is not evaluated again.
+  REQUIRE(resumed_pipe.getEvaluateCallCount() < uninterrupted_pipe.getEvaluateCallCount());
+  REQUIRE(uninterrupted_pipe.hasOutput() == true);
+  while (uninterrupted_pipe.hasOutput()) {
+    REQUIRE(resumed_pipe.hasOutput() == true);
+    const beast::Pipe::OutputItem expected = uninterrupted_pipe.drawOutput();
+    const beast::Pipe::OutputItem actual = resumed_pipe.drawOutput();
+    REQUIRE(actual.data == expected.data);
+    REQUIRE(actual.score == Approx(expected.score));
+  }
+  REQUIRE(resumed_pipe.hasOutput() == false);
+
+  REQUIRE_THROWS_AS(resumed_pipe.resume("missing_pipe_checkpoint.ckpt"), std::runtime_error);
+}
+
+TEST_CASE("pipe_blends_behavior_novelty_into_scores", "pipe") {
+  class NoveltyPipe : public beast::Pipe {
+   public:
+    explicit NoveltyPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+      evaluate_call_count_++;
+      return 0.0;
+    }
+
+    [[nodiscard]] BehaviorScore evaluateWithBehavior(
+        const std::vector<unsigned char>& program_data) override {
+      return {0.0, {static_cast<float>(program_data.size())}};
+    }
+
+    [[nodiscard]] uint32_t getEvaluateCallCount() const { return evaluate_call_count_; }
+
+   private:
+    uint32_t evaluate_call_count_ = 0;
+  };
+
+  const uint32_t max_population = 6;
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 2;
+  auto archive = std::make_shared<beast::BehaviorArchive>(1);
+  beast::Pipe::NoveltyParameters novelty_parameters;
+  novelty_parameters.neighbour_count = 2;
+  novelty_parameters.archive_threshold = 1.0;
+
+  NoveltyPipe pipe(max_population);
+  pipe.setEvolutionParameters(parameters);
+  pipe.setNoveltySearch(archive, novelty_parameters);
+  // The behavior is described by the evaluation, which doesn't fall back to racing.
+  pipe.setRacing(true);
+  REQUIRE(pipe.getBehaviorArchive() == archive);
+  REQUIRE(pipe.getNoveltyParameters().neighbour_count == 2);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    pipe.addInput(std::vector<unsigned char>(10 * (idx + 1), 0));
+  }
+  pipe.evolve();
+
+  // Only behaviors at least one unit away from their neighbours were archived.
+  REQUIRE(archive->getSize() >= novelty_parameters.neighbour_count);
+  REQUIRE(archive->getSize() <= max_population * (parameters.generations + 1));
+  bool found_novel_finalist = false;
+  while (pipe.hasOutput()) {
+    const beast::Pipe::OutputItem item = pipe.drawOutput();
+    REQUIRE(item.score >= 0.0);
+    REQUIRE(item.score < 1.0);
+    found_novel_finalist = found_novel_finalist || item.score > 0.0;
+  }
+  REQUIRE(found_novel_finalist == true);
+  REQUIRE(pipe.getEvaluateCallCount() == 0);
+
+  // Pipes that don't describe behaviors can't search for novelty.
+  MockPipe mock_pipe(max_population);
+  mock_pipe.setNoveltySearch(archive, novelty_parameters);
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    mock_pipe.addInput({});
+  }
+  REQUIRE_THROWS_AS(mock_pipe.evolve(), std::logic_error);
+}
+
+TEST_CASE("pipe_skips_evaluating_candidates_the_surrogate_predicts_to_lose", "pipe") {
+  class LosingPipe : public beast::Pipe {
+   public:
+    explicit LosingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+      evaluate_call_count_++;
+      return 0.0;
+    }
+
+    [[nodiscard]] uint32_t getEvaluateCallCount() const { return evaluate_call_count_; }
+
+   private:
+    uint32_t evaluate_call_count_ = 0;
+  };
+
+  const uint32_t max_population = 10;
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 5;
+  const auto run_evolution = [&](LosingPipe& pipe) {
+    pipe.setEvolutionParameters(parameters);
+    for (uint32_t idx = 0; idx < max_population; ++idx) {
+      beast::Program prg;
+      for (uint32_t instruction_idx = 0; instruction_idx <= idx; ++instruction_idx) {
+        prg.noop();
+      }
+      pipe.addInput(prg.getData());
+    }
+    pipe.evolve();
+  };
+
+  LosingPipe plain_pipe(max_population);
+  run_evolution(plain_pipe);
+  REQUIRE(plain_pipe.getEvaluateCallCount() > max_population);
+
+  // Once the model learned from the initial population, it predicts every offspring to lose.
+  beast::Pipe::SurrogateParameters surrogate_parameters;
+  surrogate_parameters.skip_threshold = 0.5;
+  surrogate_parameters.exploration_rate = 0.0;
+  surrogate_parameters.warm_up_samples = max_population;
+  auto model = std::make_shared<beast::SurrogateModel>();
+  LosingPipe skipping_pipe(max_population);
+  // Predictions are only used below the cut-off score.
+  skipping_pipe.setCutOffScore(0.5);
+  skipping_pipe.setSurrogateModel(model, surrogate_parameters);
+  REQUIRE(skipping_pipe.getSurrogateModel() == model);
+  REQUIRE(skipping_pipe.getSurrogateParameters().skip_threshold == 0.5);
+  run_evolution(skipping_pipe);
+  REQUIRE(skipping_pipe.getEvaluateCallCount() == max_population);
+  REQUIRE(model->getSampleCount() == max_population);
+
+  // Exploring every likely loser evaluates all candidates, and trains the model with each of them.
+  surrogate_parameters.exploration_rate = 1.0;
+  auto exploring_model = std::make_shared<beast::SurrogateModel>();
+  LosingPipe exploring_pipe(max_population);
+  exploring_pipe.setCutOffScore(0.5);
+  exploring_pipe.setSurrogateModel(exploring_model, surrogate_parameters);
+  run_evolution(exploring_pipe);
+  REQUIRE(exploring_pipe.getEvaluateCallCount() > max_population);
+  REQUIRE(exploring_model->getSampleCount() == exploring_pipe.getEvaluateCallCount());
+}
+
+TEST_CASE("pipe_never_stores_finalists_with_predicted_scores", "pipe") {
+  class PassingPipe : public beast::Pipe {
+   public:
+    explicit PassingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+
+    [[nodiscard]] double evaluate(const std::vector<unsigned char>& program_data) override {
+      evaluated_.insert(program_data);
+      return 0.6;
+    }
+
+    [[nodiscard]] const std::set<std::vector<unsigned char>>& getEvaluated() const {
+      return evaluated_;
+    }
+
+   private:
+    std::set<std::vector<unsigned char>> evaluated_;
+  };
+
+  const uint32_t max_population = 10;
+  PassingPipe pipe(max_population);
+  beast::Pipe::EvolutionParameters parameters;
+  parameters.generations = 5;
+  pipe.setEvolutionParameters(parameters);
+  pipe.setCutOffScore(0.1);
+
+  // The skip threshold lies above the cut-off score, so the model would skip candidates it predicts
+  // to pass.
+  beast::Pipe::SurrogateParameters surrogate_parameters;
+  surrogate_parameters.skip_threshold = 2.0;
+  surrogate_parameters.exploration_rate = 0.0;
+  surrogate_parameters.warm_up_samples = max_population;
+  pipe.setSurrogateModel(std::make_shared<beast::SurrogateModel>(), surrogate_parameters);
+
+  for (uint32_t idx = 0; idx < max_population; ++idx) {
+    beast::Program prg;
+    for (uint32_t instruction_idx = 0; instruction_idx <= idx; ++instruction_idx) {
+      prg.noop();
+    }
+    pipe.addInput(prg.getData());
+  }
+  pipe.evolve();
+
+  REQUIRE(pipe.hasOutput() == true);
+  while (std::optional<beast::Pipe::OutputItem> item = pipe.tryDrawOutput()) {
+    REQUIRE(pipe.getEvaluated().count(item->data) == 1);
+    REQUIRE(item->score == Approx(0.6));
+  }
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief A pipe rating every program as perfect, so that its whole population streams out
+ */
+class PassingPipe : public beast::Pipe {
+ public:
+  explicit PassingPipe(uint32_t max_candidates) : beast::Pipe(max_candidates) {}
+  ~PassingPipe() override { stop(std::nothrow); }
+
+  [[nodiscard]] double evaluate(const std::vector<unsigned char>& /*program_data*/) override {
+    return 1.0;
+  }
+};
+
+/**
+ * @brief Waits until the condition holds or ten seconds passed
+ */
+template <typename Condition>
+bool waitFor(const Condition& condition) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return condition();
+}
+
+beast::Pipeline::FactoryParameters makeFactoryParameters(uint64_t program_count) {
+  beast::Pipeline::FactoryParameters parameters;
+  parameters.program_size = 20;
+  parameters.program_count = program_count;
+  return parameters;
+}
+}  // namespace
+
+TEST_CASE("pipeline_rejects_invalid_graphs", "pipeline") {
+  beast::Pipeline pipeline;
+  REQUIRE_THROWS_AS(
+      pipeline.addFactory(nullptr, makeFactoryParameters(0)), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.addPipe(nullptr), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.addSink(nullptr), std::invalid_argument);
+
+  const beast::Pipeline::NodeId factory = pipeline.addFactory(
+      std::make_shared<beast::RandomProgramFactory>(), makeFactoryParameters(0));
+  const beast::Pipeline::NodeId first_pipe = pipeline.addPipe(std::make_shared<PassingPipe>(4));
+  const beast::Pipeline::NodeId second_pipe = pipeline.addPipe(std::make_shared<PassingPipe>(4));
+  const beast::Pipeline::NodeId sink = pipeline.addSink([](beast::Pipe::OutputItem /*item*/) {});
+  REQUIRE(pipeline.getNodeCount() == 4);
+
+  pipeline.connect(factory, first_pipe);
+  pipeline.connect(first_pipe, second_pipe);
+  REQUIRE_THROWS_AS(pipeline.connect(second_pipe, first_pipe), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(first_pipe, first_pipe), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(first_pipe, second_pipe), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(sink, first_pipe), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(first_pipe, factory), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(second_pipe, sink, 0), std::invalid_argument);
+  REQUIRE_THROWS_AS(pipeline.connect(second_pipe, 4), std::out_of_range);
+  REQUIRE_THROWS_AS(pipeline.getNodeStatistics(4), std::out_of_range);
+}
+
+TEST_CASE("pipeline_edges_exert_backpressure_on_fast_producers", "pipeline") {
+  beast::Pipeline pipeline;
+  std::atomic<uint32_t> consumed_count{0};
+  std::atomic<bool> sizes_match{true};
+  const beast::Pipeline::NodeId factory = pipeline.addFactory(
+      std::make_shared<beast::RandomProgramFactory>(), makeFactoryParameters(0));
+  // Catch assertions aren't thread-safe, so sinks only record what they observe.
+  const beast::Pipeline::NodeId sink =
+      pipeline.addSink([&consumed_count, &sizes_match](beast::Pipe::OutputItem item) {
+        sizes_match = sizes_match && item.data.size() == 20;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ++consumed_count;
+      });
+  pipeline.connect(factory, sink, 4);
+
+  pipeline.start();
+  REQUIRE(pipeline.isRunning() == true);
+  REQUIRE_THROWS_AS(pipeline.start(), std::logic_error);
+  REQUIRE_THROWS_AS(pipeline.connect(factory, sink), std::logic_error);
+  REQUIRE(waitFor([&consumed_count]() { return consumed_count >= 20; }) == true);
+  pipeline.stop();
+  REQUIRE(pipeline.isRunning() == false);
+  REQUIRE(sizes_match == true);
+
+  // The unlimited factory only got ahead of the slow sink by what fits into the edge.
+  const beast::Pipeline::NodeStatistics factory_statistics = pipeline.getNodeStatistics(factory);
+  const beast::Pipeline::NodeStatistics sink_statistics = pipeline.getNodeStatistics(sink);
+  REQUIRE(factory_statistics.kind == beast::Pipeline::NodeKind::Factory);
+  REQUIRE(factory_statistics.items_received == 0);
+  REQUIRE(sink_statistics.kind == beast::Pipeline::NodeKind::Sink);
+  REQUIRE(sink_statistics.items_emitted == 0);
+  REQUIRE(sink_statistics.queue_capacity == 4);
+  REQUIRE(sink_statistics.queue_depth <= 4);
+  REQUIRE(sink_statistics.items_received >= 20);
+  REQUIRE(factory_statistics.items_emitted ==
+          sink_statistics.items_received + sink_statistics.queue_depth);
+  REQUIRE(sink_statistics.received_per_second > 0.0);
+  REQUIRE(factory_statistics.emitted_per_second >= sink_statistics.received_per_second);
+}
+
+TEST_CASE("pipeline_runs_multi_stage_evolution", "pipeline") {
+  beast::Pipeline pipeline;
+  std::atomic<uint32_t> finalist_count{0};
+  std::atomic<bool> scores_match{true};
+  const beast::Pipeline::NodeId factory = pipeline.addFactory(
+      std::make_shared<beast::RandomProgramFactory>(), makeFactoryParameters(0));
+  const beast::Pipeline::NodeId coarse_pipe = pipeline.addPipe(std::make_shared<PassingPipe>(4));
+  const beast::Pipeline::NodeId refining_pipe =
+      pipeline.addPipe(std::make_shared<PassingPipe>(4));
+  const beast::Pipeline::NodeId sink =
+      pipeline.addSink([&finalist_count, &scores_match](beast::Pipe::OutputItem item) {
+        scores_match = scores_match && item.score == 1.0;
+        ++finalist_count;
+      });
+  pipeline.connect(factory, coarse_pipe, 8);
+  pipeline.connect(coarse_pipe, refining_pipe, 8);
+  pipeline.connect(refining_pipe, sink, 8);
+
+  pipeline.start();
+  REQUIRE(waitFor([&finalist_count]() { return finalist_count >= 10; }) == true);
+  pipeline.stop();
+
+  REQUIRE(scores_match == true);
+  REQUIRE(pipeline.getNodeStatistics(coarse_pipe).items_received >= 4);
+  REQUIRE(pipeline.getNodeStatistics(coarse_pipe).items_emitted >= 4);
+  REQUIRE(pipeline.getNodeStatistics(refining_pipe).items_received >= 4);
+  REQUIRE(pipeline.getNodeStatistics(refining_pipe).items_emitted >= 10);
+  REQUIRE(pipeline.getNodeStatistics(sink).items_received >= 10);
+
+  // Items in flight stay in place, and the pipeline can be started again.
+  const uint32_t first_run_count = finalist_count;
+  pipeline.start();
+  REQUIRE(waitFor([&]() { return finalist_count > first_run_count; }) == true);
+  pipeline.stop();
+}
+
+TEST_CASE("pipeline_stops_and_rethrows_node_errors", "pipeline") {
+  beast::Pipeline pipeline;
+  const beast::Pipeline::NodeId factory = pipeline.addFactory(
+      std::make_shared<beast::RandomProgramFactory>(), makeFactoryParameters(3));
+  const beast::Pipeline::NodeId sink = pipeline.addSink([](beast::Pipe::OutputItem /*item*/) {
+    throw std::runtime_error("Sink failed.");
+  });
+  pipeline.connect(factory, sink);
+
+  pipeline.start();
+  REQUIRE(waitFor([&pipeline]() { return !pipeline.isRunning(); }) == true);
+  REQUIRE_THROWS_AS(pipeline.stop(), std::runtime_error);
+  REQUIRE(pipeline.getNodeStatistics(factory).items_emitted <= 3);
+  REQUIRE(pipeline.getNodeStatistics(sink).items_received == 1);
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Runs byte code to its end and returns the values of the first `variable_count` variables
+ */
+std::vector<int32_t> run(beast::ProgramView code, int32_t variable_count) {
+  beast::VmSession session(code, static_cast<size_t>(variable_count), 0, 0);
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE_FALSE(session.getRuntimeStatistics().abnormal_exit);
+
+  std::vector<int32_t> values;
+  for (int32_t idx = 0; idx < variable_count; ++idx) {
+    values.push_back(session.getVariableValue(idx, true));
+  }
+  return values;
+}
+}  // namespace
+
+TEST_CASE("program_builder_resolves_forward_and_backward_jumps", "program_builder") {
+  beast::ProgramBuilder builder;
+  builder.declareVariable(0, beast::Program::VariableType::Int32);
+  builder.declareVariable(1, beast::Program::VariableType::Int32);
+  builder.declareVariable(2, beast::Program::VariableType::Int32);
+  const beast::ProgramBuilder::Label loop_start = builder.createLabel();
+  const beast::ProgramBuilder::Label skip = builder.createLabel();
+  builder.bindLabel(loop_start);
+  REQUIRE(builder.getLabelAddress(loop_start) == builder.getPointer());
+  REQUIRE_FALSE(builder.getLabelAddress(skip).has_value());
+
+  // Counts variable 0 to 5, and adds 10 to variable 2 only while variable 0 is below 3.
+  builder.addConstantToVariable(0, 1, true);
+  builder.compareIfVariableLtConstant(0, true, 3, 1, true);
+  builder.jumpToLabelIfVariableEqualsZero(1, true, skip);
+  builder.addConstantToVariable(2, 10, true);
+  builder.bindLabel(skip);
+  builder.compareIfVariableLtConstant(0, true, 5, 1, true);
+  builder.jumpToLabelIfVariableGreaterThanZero(1, true, loop_start);
+
+  const beast::Program program = builder.build();
+  REQUIRE(run(program.getData(), 3) == std::vector<int32_t>{5, 0, 20});
+  REQUIRE(beast::ProgramVerifier::verify(program.getData(), 3).valid);
+}
+
+TEST_CASE("program_builder_matches_hand_computed_addresses", "program_builder") {
+  beast::ProgramBuilder builder;
+  builder.declareVariable(0, beast::Program::VariableType::Int32);
+  builder.setVariable(0, -1, true);
+  const beast::ProgramBuilder::Label negative = builder.createLabel();
+  const beast::ProgramBuilder::Label end = builder.createLabel();
+  const uint32_t first_jump_end = builder.getPointer() + 10;
+  builder.jumpToLabelIfVariableLessThanZero(0, true, negative);
+  builder.unconditionalJumpToAbsoluteAddress(0);
+  builder.bindLabel(negative);
+  builder.setVariable(0, 7, true);
+  const uint32_t last_jump = builder.getPointer();
+  builder.jumpToLabel(end);
+  builder.bindLabel(end);
+  const uint32_t negative_address = *builder.getLabelAddress(negative);
+  const uint32_t end_address = *builder.getLabelAddress(end);
+  REQUIRE(end_address == last_jump + 5);
+
+  beast::Program expected;
+  expected.declareVariable(0, beast::Program::VariableType::Int32);
+  expected.setVariable(0, -1, true);
+  expected.relativeJumpToAddressIfVariableLessThanZero(
+      0, true, static_cast<int32_t>(negative_address - first_jump_end));
+  expected.unconditionalJumpToAbsoluteAddress(0);
+  expected.setVariable(0, 7, true);
+  // The last jump targets the position right after itself.
+  expected.unconditionalJumpToRelativeAddress(0);
+
+  const beast::Program program = builder.build();
+  REQUIRE(program.getData() == expected.getData());
+  REQUIRE(program.getPointer() == expected.getPointer());
+  REQUIRE(run(program.getData(), 1) == std::vector<int32_t>{7});
+}
+
+TEST_CASE("program_builder_output_can_be_inserted_anywhere", "program_builder") {
+  beast::ProgramBuilder builder(64);
+  const beast::ProgramBuilder::Label skip = builder.createLabel();
+  builder.jumpToLabelIfVariableGreaterThanZero(0, true, skip);
+  builder.setVariable(1, 3, true);
+  builder.bindLabel(skip);
+  const beast::Program block = builder.build();
+
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.declareVariable(1, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 1, true);
+  prg.insertProgram(block);
+  prg.setVariable(0, 0, true);
+  prg.insertProgram(block);
+  REQUIRE(run(prg.getData(), 2) == std::vector<int32_t>{0, 3});
+
+  // A program can be inserted into itself.
+  beast::Program twice = block;
+  twice.insertProgram(twice);
+  REQUIRE(twice.getSize() == 2 * block.getSize());
+  REQUIRE(std::vector<unsigned char>(twice.getData().begin() + block.getSize(),
+                                     twice.getData().end()) == block.getData());
+}
+
+TEST_CASE("program_builder_rejects_invalid_labels", "program_builder") {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label label = builder.createLabel();
+  builder.bindLabel(label);
+  REQUIRE_THROWS_AS(builder.bindLabel(label), std::logic_error);
+
+  const beast::ProgramBuilder::Label unbound = builder.createLabel();
+  builder.noop();
+  builder.jumpToLabel(unbound);
+  const std::vector<unsigned char> code = builder.getData();
+  REQUIRE_THROWS_AS(builder.build(), std::logic_error);
+  REQUIRE(builder.getData() == code);
+
+  // Building leaves the builder empty and discards its labels.
+  builder.bindLabel(unbound);
+  const beast::Program program = builder.build();
+  REQUIRE(program.getSize() == code.size());
+  REQUIRE(builder.getSize() == 0);
+  REQUIRE(builder.getPointer() == 0);
+  REQUIRE_THROWS_AS(builder.jumpToLabel(label), std::invalid_argument);
+  REQUIRE_THROWS_AS(builder.getLabelAddress(unbound), std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Runs byte code to its end and returns the values of the first `variable_count` variables
+ */
+std::vector<int32_t> run(beast::ProgramView code, int32_t variable_count) {
+  beast::VmSession session(code, static_cast<size_t>(variable_count), 0, 0);
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE_FALSE(session.getRuntimeStatistics().abnormal_exit);
+
+  std::vector<int32_t> values;
+  for (int32_t idx = 0; idx < variable_count; ++idx) {
+    values.push_back(session.getVariableValue(idx, true));
+  }
+  return values;
+}
+
+/**
+ * @brief Sums up the numbers from 1 to 10 in variable `sum`, using `counter` as loop counter
+ */
+beast::Program makeSum(int32_t sum, int32_t counter, bool padded) {
+  beast::ProgramBuilder builder;
+  const beast::ProgramBuilder::Label loop = builder.createLabel();
+  builder.declareVariable(sum, beast::Program::VariableType::Int32);
+  builder.declareVariable(counter, beast::Program::VariableType::Int32);
+  builder.setVariable(counter, 10, true);
+  builder.bindLabel(loop);
+  if (padded) {
+    builder.noop();
+  }
+  builder.addVariableToVariable(counter, true, sum, true);
+  builder.addConstantToVariable(counter, -1, true);
+  if (padded) {
+    builder.noop();
+    builder.noop();
+  }
+  builder.jumpToLabelIfVariableGreaterThanZero(counter, true, loop);
+  builder.terminate(0);
+  if (padded) {
+    builder.printVariable(sum, true, false);
+  }
+  return builder.build();
+}
+}  // namespace
+
+TEST_CASE("program_canonicalizer_removes_padding_tails_and_flag_values", "program_canonicalizer") {
+  const beast::Program plain = makeSum(0, 1, false);
+  const beast::Program canonical = beast::ProgramCanonicalizer::canonicalize(plain.getData());
+  REQUIRE(run(canonical.getData(), 2) == std::vector<int32_t>{55, 0});
+
+  std::vector<unsigned char> padded = makeSum(0, 1, true).getData();
+  padded.push_back(0xff);
+  padded.push_back(static_cast<unsigned char>(beast::OpCode::SetVariable));
+  REQUIRE(beast::ProgramCanonicalizer::canonicalize(padded).getData() == canonical.getData());
+
+  // Flags are read as booleans, so any non-zero value is the same as 0x1.
+  std::vector<unsigned char> flagged = plain.getData();
+  const std::vector<beast::InstructionDecoder::Instruction> instructions =
+      beast::InstructionDecoder::decodeAll(flagged);
+  flagged[*beast::InstructionDecoder::getOperandOffset(
+      flagged, instructions[2], beast::InstructionDecoder::OperandType::Flag)] = 0x7f;
+  REQUIRE(flagged != plain.getData());
+  REQUIRE(run(flagged, 2) == std::vector<int32_t>{55, 0});
+  REQUIRE(beast::ProgramCanonicalizer::makeKey(flagged, 0) ==
+          beast::ProgramCanonicalizer::makeKey(plain.getData(), 0));
+  REQUIRE_FALSE(beast::ProgramCanonicalizer::makeKey(plain.getData(), 0) ==
+                beast::ProgramCanonicalizer::makeKey(plain.getData(), 1));
+
+  // Trailing bytes that execution runs into are kept.
+  beast::Program open_ended;
+  open_ended.noop();
+  std::vector<unsigned char> reachable_tail = open_ended.getData();
+  reachable_tail.push_back(0xff);
+  REQUIRE(beast::ProgramCanonicalizer::canonicalize(reachable_tail).getData() == reachable_tail);
+}
+
+TEST_CASE("program_canonicalizer_renames_variables_on_request", "program_canonicalizer") {
+  const beast::Program original = makeSum(7, 3, false);
+  const beast::Program renamed = makeSum(0, 1, true);
+  REQUIRE_FALSE(beast::ProgramCanonicalizer::makeKey(original.getData(), 0) ==
+                beast::ProgramCanonicalizer::makeKey(renamed.getData(), 0));
+  REQUIRE(beast::ProgramCanonicalizer::makeKey(original.getData(), 0, true) ==
+          beast::ProgramCanonicalizer::makeKey(renamed.getData(), 0, true));
+
+  // Variables are numbered by their first mention, not by their index.
+  const beast::Program swapped = makeSum(1, 0, false);
+  REQUIRE(beast::ProgramCanonicalizer::canonicalize(swapped.getData(), true).getData() ==
+          beast::ProgramCanonicalizer::canonicalize(original.getData(), true).getData());
+  REQUIRE(run(beast::ProgramCanonicalizer::canonicalize(original.getData(), true).getData(), 2) ==
+          std::vector<int32_t>{55, 0});
+
+  // Links refer to variables by index, so programs declaring them keep their variables.
+  beast::Program linked;
+  linked.declareVariable(4, beast::Program::VariableType::Int32);
+  linked.declareVariable(2, beast::Program::VariableType::Link);
+  linked.setVariable(2, 4, false);
+  linked.setVariable(2, 9, true);
+  REQUIRE(beast::ProgramCanonicalizer::canonicalize(linked.getData(), true).getData() ==
+          beast::ProgramCanonicalizer::canonicalize(linked.getData()).getData());
+}
+
+TEST_CASE("program_canonicalizer_keeps_fixed_variables_when_renaming", "program_canonicalizer") {
+  // The host reads the sum from variable 0, so programs summing into other variables differ.
+  const beast::Program original = makeSum(0, 1, false);
+  const beast::Program swapped = makeSum(1, 0, false);
+  REQUIRE(beast::ProgramCanonicalizer::makeKey(original.getData(), 0, true) ==
+          beast::ProgramCanonicalizer::makeKey(swapped.getData(), 0, true));
+  REQUIRE_FALSE(beast::ProgramCanonicalizer::makeKey(original.getData(), 0, true, {0}) ==
+                beast::ProgramCanonicalizer::makeKey(swapped.getData(), 0, true, {0}));
+  REQUIRE(run(beast::ProgramCanonicalizer::canonicalize(swapped.getData(), true, {0}).getData(),
+              2) == run(swapped.getData(), 2));
+
+  // Other variables are renamed around the fixed ones.
+  const beast::Program canonical =
+      beast::ProgramCanonicalizer::canonicalize(makeSum(7, 3, false).getData(), true, {1, 7});
+  REQUIRE(canonical.getData() ==
+          beast::ProgramCanonicalizer::canonicalize(makeSum(7, 0, false).getData()).getData());
+}
+
+TEST_CASE("program_canonicalizer_is_idempotent", "program_canonicalizer") {
+  beast::RandomProgramFactory factory;
+  for (uint32_t idx = 0; idx < 100; ++idx) {
+    const beast::Program program = factory.generate(200, 20, 5, 10);
+    for (const bool rename_variables : {false, true}) {
+      const beast::Program canonical =
+          beast::ProgramCanonicalizer::canonicalize(program.getData(), rename_variables);
+      REQUIRE(canonical.getSize() <= program.getSize());
+      REQUIRE(beast::ProgramCanonicalizer::canonicalize(canonical.getData(), rename_variables)
+                  .getData() == canonical.getData());
+    }
+  }
+}
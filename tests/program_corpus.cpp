@@ -0,0 +1,180 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include <beast/beast.hpp>
+
+namespace {
+const char* const kCorpusPath = "program_corpus_test.corpus";
+
+/**
+ * @brief Returns a program that adds `summand` to a variable initialized with 1
+ */
+std::vector<unsigned char> makeAddingProgram(int32_t summand) {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 1, true);
+  prg.addConstantToVariable(0, summand, true);
+  return prg.getData();
+}
+}  // namespace
+
+TEST_CASE("sessions_execute_program_views_in_place", "program_corpus") {
+  const std::vector<unsigned char> code = makeAddingProgram(41);
+  const beast::ProgramView view(code);
+  REQUIRE(view.getData() == code.data());
+  REQUIRE(view.getSize() == code.size());
+  REQUIRE(view.getData1(0) == static_cast<int8_t>(beast::OpCode::DeclareVariable));
+  REQUIRE_THROWS_AS(view.getData4(static_cast<int32_t>(code.size()) - 3), std::underflow_error);
+  REQUIRE_THROWS_AS(view.getData1(-1), std::underflow_error);
+  REQUIRE(view.toProgram().getData() == code);
+
+  beast::VmSession session(view, 1, 0, 0);
+  REQUIRE(session.getProgramView().getData() == code.data());
+  REQUIRE_THROWS_AS(session.getProgram(), std::logic_error);
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE(session.getVariableValue(0, true) == 42);
+
+  // Copies of the session keep viewing the same bytes.
+  session.reset();
+  beast::VmSession copy = session;
+  REQUIRE(copy.getProgramView().getData() == code.data());
+  while (vm.step(copy, false)) {}
+  REQUIRE(copy.getVariableValue(0, true) == 42);
+}
+
+TEST_CASE("byte_code_apis_accept_views_of_any_buffer", "program_corpus") {
+  // Two programs back to back in one buffer, as in a network message or a corpus block.
+  const std::vector<unsigned char> first = makeAddingProgram(1);
+  std::vector<unsigned char> buffer = first;
+  const std::vector<unsigned char> second = makeAddingProgram(2);
+  buffer.insert(buffer.end(), second.begin(), second.end());
+  const beast::ProgramView view(buffer.data() + first.size(), second.size());
+
+  REQUIRE(beast::InstructionDecoder::decodeAll(view).size() ==
+          beast::InstructionDecoder::decodeAll(second).size());
+  REQUIRE(beast::ProgramVerifier::verify(view, 1).valid);
+  REQUIRE(beast::FitnessCache::makeKey(view, 0) == beast::FitnessCache::makeKey(second, 0));
+  REQUIRE(beast::SurrogateModel::extractFeatures(view) ==
+          beast::SurrogateModel::extractFeatures(second));
+
+  // Vectors convert to views implicitly, so a genome is executed without copying it.
+  beast::VmSession session(second, 1, 0, 0);
+  REQUIRE(session.getProgramView().getData() == second.data());
+  REQUIRE(session.verifyProgram().valid);
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE(session.getVariableValue(0, true) == 3);
+}
+
+TEST_CASE("program_corpora_round_trip_through_mapped_files", "program_corpus") {
+  beast::ProgramCorpus corpus;
+  corpus.addProgram(makeAddingProgram(1), 0.5, 3);
+  corpus.addProgram({}, 0.0, 4);
+  corpus.addProgram(makeAddingProgram(2), 0.75, 5);
+  REQUIRE(corpus.getRecordCount() == 3);
+  corpus.write(kCorpusPath);
+
+  {
+    const beast::MappedProgramCorpus mapped(kCorpusPath);
+    REQUIRE(mapped.getRecordCount() == 3);
+    REQUIRE_FALSE(mapped.isCompressed());
+    REQUIRE(mapped.copyProgram(0) == makeAddingProgram(1));
+    REQUIRE(mapped.copyProgram(1).empty());
+
+    const beast::MappedProgramCorpus::Record record = mapped.getRecord(2);
+    REQUIRE(record.metadata.score == 0.75);
+    REQUIRE(record.metadata.generation == 5);
+    REQUIRE(record.metadata.hash == beast::FitnessCache::makeKey(makeAddingProgram(2), 0));
+    REQUIRE(mapped.getMetadata(2).hash == record.metadata.hash);
+    REQUIRE_THROWS_AS(mapped.getMetadata(3), std::out_of_range);
+
+    // The record is executed straight from the mapped file.
+    beast::VmSession session(record.program, 1, 0, 0);
+    beast::CpuVirtualMachine vm;
+    vm.setSilent(true);
+    while (vm.step(session, false)) {}
+    REQUIRE(session.getVariableValue(0, true) == 3);
+  }
+
+  const beast::ProgramCorpus empty_corpus;
+  empty_corpus.write(kCorpusPath);
+  REQUIRE(beast::MappedProgramCorpus(kCorpusPath).getRecordCount() == 0);
+  std::remove(kCorpusPath);
+}
+
+TEST_CASE("compressed_program_corpora_decompress_records_by_block", "program_corpus") {
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<int32_t> summands(0, 3);
+  std::vector<std::vector<unsigned char>> programs;
+  beast::ProgramCorpus plain;
+  beast::ProgramCorpus compressed(256);
+  for (uint32_t idx = 0; idx < 200; ++idx) {
+    // Evolved programs repeat operator sequences, which is what makes them compress well.
+    std::vector<unsigned char> program;
+    for (size_t part = 0; part < 8; ++part) {
+      const std::vector<unsigned char> part_code = makeAddingProgram(summands(engine));
+      program.insert(program.end(), part_code.begin(), part_code.end());
+    }
+    programs.push_back(program);
+    plain.addProgram(programs.back(), static_cast<double>(idx), idx);
+    compressed.addProgram(programs.back(), static_cast<double>(idx), idx);
+  }
+  // Random bytes don't compress, so their block is stored as it is.
+  std::vector<unsigned char> noise(300);
+  for (unsigned char& byte : noise) {
+    byte = static_cast<unsigned char>(engine());
+  }
+  programs.push_back(noise);
+  plain.addProgram(noise, 0.0, 200);
+  compressed.addProgram(noise, 0.0, 200);
+  REQUIRE(compressed.serialize().size() < plain.serialize().size() / 2);
+
+  compressed.write(kCorpusPath);
+  {
+    const beast::MappedProgramCorpus mapped(kCorpusPath);
+    REQUIRE(mapped.isCompressed());
+    REQUIRE(mapped.getRecordCount() == programs.size());
+    REQUIRE_THROWS_AS(mapped.getRecord(0), std::logic_error);
+
+    beast::MappedProgramCorpus::BlockCache cache;
+    for (size_t idx = 0; idx < programs.size(); ++idx) {
+      const beast::MappedProgramCorpus::Record record = mapped.getRecord(idx, cache);
+      const std::vector<unsigned char> bytes(
+          record.program.getData(), record.program.getData() + record.program.getSize());
+      REQUIRE(bytes == programs[idx]);
+      REQUIRE(record.metadata.generation == idx);
+    }
+    REQUIRE(mapped.copyProgram(3) == programs[3]);
+  }
+  std::remove(kCorpusPath);
+}
+
+TEST_CASE("mapped_program_corpora_reject_invalid_files", "program_corpus") {
+  REQUIRE_THROWS_AS(
+      beast::MappedProgramCorpus("missing_program_corpus.corpus"), std::runtime_error);
+
+  beast::ProgramCorpus corpus;
+  corpus.addProgram(makeAddingProgram(1), 1.0, 1);
+  std::vector<unsigned char> data = corpus.serialize();
+  data.pop_back();
+  {
+    std::ofstream file(kCorpusPath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+  }
+  REQUIRE_THROWS_AS(beast::MappedProgramCorpus(kCorpusPath), std::runtime_error);
+
+  {
+    std::ofstream file(kCorpusPath, std::ios::binary);
+    file << "Not a corpus, but long enough to hold a corpus header.";
+  }
+  REQUIRE_THROWS_AS(beast::MappedProgramCorpus(kCorpusPath), std::runtime_error);
+  std::remove(kCorpusPath);
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Runs byte code to its end and returns the values of the first `variable_count` variables
+ */
+std::vector<int32_t> run(beast::ProgramView code, int32_t variable_count) {
+  beast::VmSession session(code, static_cast<size_t>(variable_count), 0, 0);
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(session, false)) {}
+  REQUIRE_FALSE(session.getRuntimeStatistics().abnormal_exit);
+
+  std::vector<int32_t> values;
+  for (int32_t idx = 0; idx < variable_count; ++idx) {
+    values.push_back(session.getVariableValue(idx, true));
+  }
+  return values;
+}
+}  // namespace
+
+TEST_CASE("program_optimizer_strips_noops_unreachable_code_and_jump_chains", "program_optimizer") {
+  // The program is built twice: the first pass determines the forward jump targets.
+  int32_t first_hop = 0;
+  int32_t second_hop = 0;
+  beast::Program prg;
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    prg = beast::Program();
+    prg.declareVariable(0, beast::Program::VariableType::Int32);
+    prg.noop();
+    prg.unconditionalJumpToAbsoluteAddress(first_hop);
+    prg.setVariable(0, 99, true);
+    first_hop = static_cast<int32_t>(prg.getPointer());
+    prg.noop();
+    prg.unconditionalJumpToAbsoluteAddress(second_hop);
+    second_hop = static_cast<int32_t>(prg.getPointer());
+    prg.setVariable(0, 7, true);
+    prg.unconditionalJumpToRelativeAddress(0);
+    prg.noop();
+  }
+  REQUIRE(beast::ProgramOptimizer::isRelocatable(prg.getData()));
+
+  const beast::ProgramOptimizer::Result result = beast::ProgramOptimizer::optimize(prg.getData());
+  beast::Program expected;
+  expected.declareVariable(0, beast::Program::VariableType::Int32);
+  expected.setVariable(0, 7, true);
+  REQUIRE(result.program.getData() == expected.getData());
+  REQUIRE(result.address_map.size() == 2);
+  REQUIRE(result.address_map.at(0) == 0);
+  REQUIRE(result.address_map.at(static_cast<size_t>(second_hop)) == 6);
+  REQUIRE(run(result.program.getData(), 1) == run(prg.getData(), 1));
+}
+
+TEST_CASE("program_optimizer_folds_known_values", "program_optimizer") {
+  int32_t target = 0;
+  beast::Program prg;
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    prg = beast::Program();
+    prg.declareVariable(0, beast::Program::VariableType::Int32);
+    prg.declareVariable(1, beast::Program::VariableType::Int32);
+    prg.setVariable(0, 5, true);
+    prg.setVariable(0, 5, true);
+    prg.compareIfVariableGtConstant(0, true, 3, 1, true);
+    prg.absoluteJumpToAddressIfVariableGreaterThanZero(1, true, target);
+    prg.setVariable(0, 100, true);
+    prg.terminate(1);
+    target = static_cast<int32_t>(prg.getPointer());
+    prg.setVariable(1, 2, true);
+    prg.setVariable(1, 3, true);
+  }
+
+  // The redundant and the overwritten store go, and the jump is always taken to where execution
+  // continues anyway.
+  const beast::ProgramOptimizer::Result result = beast::ProgramOptimizer::optimize(prg.getData());
+  beast::Program expected;
+  expected.declareVariable(0, beast::Program::VariableType::Int32);
+  expected.declareVariable(1, beast::Program::VariableType::Int32);
+  expected.setVariable(0, 5, true);
+  expected.compareIfVariableGtConstant(0, true, 3, 1, true);
+  expected.setVariable(1, 3, true);
+  REQUIRE(result.program.getData() == expected.getData());
+  REQUIRE(run(result.program.getData(), 2) == std::vector<int32_t>{5, 3});
+  REQUIRE(run(prg.getData(), 2) == std::vector<int32_t>{5, 3});
+}
+
+TEST_CASE("program_optimizer_relocates_loops", "program_optimizer") {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.declareVariable(1, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 0, true);
+  const auto loop_start = static_cast<int32_t>(prg.getPointer());
+  prg.noop();
+  prg.noop();
+  prg.addConstantToVariable(0, 1, true);
+  prg.compareIfVariableLtConstant(0, true, 5, 1, true);
+  // Relative jumps count from the end of the jump instruction.
+  prg.relativeJumpToAddressIfVariableGreaterThanZero(
+      1, true, loop_start - static_cast<int32_t>(prg.getPointer()) - 10);
+
+  // The loop condition isn't known at the loop's start, so only the NoOps go.
+  const beast::ProgramOptimizer::Result result = beast::ProgramOptimizer::optimize(prg.getData());
+  REQUIRE(result.program.getSize() == prg.getSize() - 2);
+  REQUIRE(result.address_map.at(static_cast<size_t>(loop_start) + 2) ==
+          static_cast<size_t>(loop_start));
+  REQUIRE(run(result.program.getData(), 2) == std::vector<int32_t>{5, 0});
+  REQUIRE(run(prg.getData(), 2) == std::vector<int32_t>{5, 0});
+}
+
+TEST_CASE("program_optimizer_keeps_layout_dependent_code", "program_optimizer") {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.noop();
+  prg.loadCurrentAddressIntoVariable(0, true);
+  REQUIRE_FALSE(beast::ProgramOptimizer::isRelocatable(prg.getData()));
+  beast::ProgramOptimizer::Result result = beast::ProgramOptimizer::optimize(prg.getData());
+  REQUIRE(result.program.getData() == prg.getData());
+  REQUIRE(result.address_map.size() == 3);
+
+  // Undecodable bytes and jumps off instruction boundaries can't be relocated either.
+  const std::vector<unsigned char> truncated{0x00, 0x08};
+  REQUIRE_FALSE(beast::ProgramOptimizer::isRelocatable(truncated));
+  beast::Program misaligned;
+  misaligned.noop();
+  misaligned.unconditionalJumpToAbsoluteAddress(2);
+  REQUIRE_FALSE(beast::ProgramOptimizer::isRelocatable(misaligned.getData()));
+  result = beast::ProgramOptimizer::optimize(misaligned.getData());
+  REQUIRE(result.program.getData() == misaligned.getData());
+
+  REQUIRE(beast::ProgramOptimizer::optimize({}).program.getSize() == 0);
+  // Empty code would fail on its first step, so code that optimizes away keeps a NoOp.
+  const std::vector<unsigned char> noops{0x00, 0x00, 0x00};
+  REQUIRE(beast::ProgramOptimizer::optimize(noops).program.getData() ==
+          std::vector<unsigned char>{0x00});
+}
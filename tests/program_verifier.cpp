@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+
+#include <beast/beast.hpp>
+
+TEST_CASE("program_verifier_accepts_well_formed_programs", "program_verifier") {
+  REQUIRE(beast::ProgramVerifier::verify({}, 0).valid);
+
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 3, true);
+  const int32_t loop_start = prg.getPointer();
+  prg.subtractConstantFromVariable(0, 1, true);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(0, true, loop_start);
+  prg.setStringTableEntry(0, "done");
+  // Jumping to the end of the code ends the program regularly.
+  prg.unconditionalJumpToRelativeAddress(0);
+
+  const beast::ProgramVerifier::Result result = beast::ProgramVerifier::verify(prg.getData(), 1);
+  REQUIRE(result.valid);
+  REQUIRE(result.error.empty());
+  REQUIRE(result.instruction_starts.size() == prg.getSize());
+  REQUIRE(result.instruction_starts[0]);
+  REQUIRE(result.instruction_starts[static_cast<size_t>(loop_start)]);
+  REQUIRE_FALSE(result.instruction_starts[1]);
+}
+
+TEST_CASE("program_verifier_rejects_malformed_programs", "program_verifier") {
+  // Unknown operator
+  beast::ProgramVerifier::Result result = beast::ProgramVerifier::verify(
+      std::vector<unsigned char>{0x0, 0xff}, 0);
+  REQUIRE_FALSE(result.valid);
+  REQUIRE(result.offset == 1);
+  REQUIRE(result.instruction_starts.empty());
+
+  // Truncated operands
+  beast::Program truncated;
+  truncated.noop();
+  truncated.setVariable(0, 5, true);
+  std::vector<unsigned char> code = truncated.getData();
+  code.pop_back();
+  result = beast::ProgramVerifier::verify(code, 1);
+  REQUIRE_FALSE(result.valid);
+  REQUIRE(result.offset == 1);
+
+  // Variable index beyond the variable memory
+  beast::Program out_of_range;
+  out_of_range.declareVariable(4, beast::Program::VariableType::Int32);
+  REQUIRE(beast::ProgramVerifier::verify(out_of_range.getData(), 5).valid);
+  REQUIRE_FALSE(beast::ProgramVerifier::verify(out_of_range.getData(), 4).valid);
+
+  // Jump into the middle of an instruction
+  beast::Program misaligned;
+  misaligned.unconditionalJumpToAbsoluteAddress(6);
+  misaligned.setVariable(0, 5, true);
+  result = beast::ProgramVerifier::verify(misaligned.getData(), 1);
+  REQUIRE_FALSE(result.valid);
+  REQUIRE(result.offset == 0);
+
+  // Jump beyond the end of the code
+  beast::Program beyond;
+  beyond.unconditionalJumpToRelativeAddress(1);
+  REQUIRE_FALSE(beast::ProgramVerifier::verify(beyond.getData(), 0).valid);
+}
+
+TEST_CASE("verified_sessions_execute_like_checked_sessions", "program_verifier") {
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 4, true);
+  prg.declareVariable(1, beast::Program::VariableType::Int32);
+  prg.setVariable(1, 0, true);
+  const int32_t loop_start = prg.getPointer();
+  prg.subtractConstantFromVariable(0, 1, true);
+  prg.addConstantToVariable(1, 3, true);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(0, true, loop_start);
+  prg.setStringTableEntry(0, "done");
+  prg.printStringFromStringTable(0);
+
+  beast::VmSession checked(prg, 2, 1, 10);
+  beast::VmSession verified(prg, 2, 1, 10);
+  REQUIRE_FALSE(verified.isProgramVerified());
+  REQUIRE(verified.verifyProgram().valid);
+  REQUIRE(verified.isProgramVerified());
+
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  while (vm.step(checked, false)) {}
+  while (vm.step(verified, false)) {}
+  REQUIRE(verified.getVariableValue(1, true) == 12);
+  REQUIRE(verified.getVariableValue(1, true) == checked.getVariableValue(1, true));
+  REQUIRE(verified.getPrintBuffer() == checked.getPrintBuffer());
+  REQUIRE(verified.getRuntimeStatistics().steps_executed ==
+          checked.getRuntimeStatistics().steps_executed);
+  REQUIRE_FALSE(verified.getRuntimeStatistics().abnormal_exit);
+
+  // Sessions that fail verification keep the checked path.
+  beast::VmSession unverifiable(prg, 1, 1, 10);
+  REQUIRE_FALSE(unverifiable.verifyProgram().valid);
+  REQUIRE_FALSE(unverifiable.isProgramVerified());
+}
+
+TEST_CASE("verified_sessions_check_instructions_reached_through_variable_jumps",
+          "program_verifier") {
+  // The variable jump lands on the last byte of the code, which is an operand, not an operator.
+  beast::Program prg;
+  prg.declareVariable(0, beast::Program::VariableType::Int32);
+  prg.setVariable(0, 31, true);
+  prg.unconditionalJumpToAbsoluteVariableAddress(0, true);
+  prg.setVariable(0, 0x01010101, true);
+  REQUIRE(prg.getSize() == 32);
+
+  beast::VmSession session(prg, 1, 0, 0);
+  REQUIRE(session.verifyProgram().valid);
+
+  // The byte is read as an operator loading the memory size, whose operands lie beyond the code.
+  // The checked fetch notices that instead of reading past the end.
+  beast::CpuVirtualMachine vm;
+  vm.setSilent(true);
+  REQUIRE(vm.step(session, false));
+  REQUIRE(vm.step(session, false));
+  REQUIRE(vm.step(session, false));
+  REQUIRE(session.getPointer() == 31);
+  REQUIRE_THROWS_AS(vm.step(session, false), std::underflow_error);
+}
@@ -0,0 +1,199 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <beast/beast.hpp>
+
+namespace {
+const int32_t kInputVariable = 0;
+const int32_t kCountVariable = 1;
+const int32_t kInputChangedVariable = 2;
+
+/**
+ * @brief A program that loops forever
+ */
+beast::VmSession makeEndlessSession() {
+  beast::Program prg;
+  prg.noop();
+  prg.unconditionalJumpToAbsoluteAddress(0);
+  return beast::VmSession(std::move(prg), 10, 0, 0);
+}
+
+/**
+ * @brief A program that polls its input variable and terminates after `count` inputs
+ */
+beast::VmSession makeInteractiveSession(int32_t count) {
+  beast::Program prg;
+  prg.declareVariable(kCountVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kCountVariable, count, true);
+  prg.declareVariable(kInputChangedVariable, beast::Program::VariableType::Int32);
+  prg.setVariable(kInputChangedVariable, 0, true);
+
+  const auto loop_start_address = static_cast<int32_t>(prg.getPointer());
+  prg.checkIfInputWasSet(kInputVariable, true, kInputChangedVariable, true);
+  prg.absoluteJumpToAddressIfVariableEqualsZero(kInputChangedVariable, true, loop_start_address);
+  prg.subtractConstantFromVariable(kCountVariable, 1, true);
+  prg.absoluteJumpToAddressIfVariableGreaterThanZero(kCountVariable, true, loop_start_address);
+  prg.terminate(0);
+
+  beast::VmSession session(std::move(prg), 10, 0, 0);
+  session.setVariableBehavior(kInputVariable, beast::VmSession::VariableIoBehavior::Input);
+  return session;
+}
+}  // namespace
+
+TEST_CASE("session_waits_for_input_after_unsuccessful_check", "session_scheduler") {
+  beast::VmSession session = makeInteractiveSession(1);
+  beast::CpuVirtualMachine virtual_machine;
+
+  while (!session.isWaitingForInput()) {
+    REQUIRE(virtual_machine.step(session, false) == true);
+  }
+
+  session.setVariableValue(kInputVariable, true, 1);
+  REQUIRE(session.isWaitingForInput() == false);
+}
+
+TEST_CASE("scheduler_rejects_zero_priority", "session_scheduler") {
+  beast::CpuVirtualMachine virtual_machine;
+  beast::SessionScheduler scheduler(virtual_machine, 0);
+
+  REQUIRE_THROWS_AS(scheduler.addSession(makeEndlessSession(), 0), std::invalid_argument);
+  const beast::SessionScheduler::SessionId session_id = scheduler.addSession(makeEndlessSession());
+  REQUIRE_THROWS_AS(scheduler.setPriority(session_id, 0), std::invalid_argument);
+  REQUIRE_THROWS_AS(scheduler.getState(session_id + 1), std::invalid_argument);
+}
+
+TEST_CASE("scheduler_shares_steps_according_to_priorities", "session_scheduler") {
+  beast::CpuVirtualMachine virtual_machine;
+  beast::SessionScheduler scheduler(virtual_machine, 0, 10);
+  const beast::SessionScheduler::SessionId low = scheduler.addSession(makeEndlessSession(), 1);
+  const beast::SessionScheduler::SessionId high = scheduler.addSession(makeEndlessSession(), 3);
+
+  for (uint32_t idx = 0; idx < 400; ++idx) {
+    REQUIRE(scheduler.runQuantum() == true);
+  }
+
+  const beast::VmSession low_session = scheduler.removeSession(low);
+  const beast::VmSession high_session = scheduler.removeSession(high);
+  const double low_steps = low_session.getRuntimeStatistics().steps_executed;
+  const double high_steps = high_session.getRuntimeStatistics().steps_executed;
+
+  REQUIRE(low_steps + high_steps == 4000);
+  REQUIRE(high_steps / low_steps == Approx(3.0).epsilon(0.05));
+}
+
+TEST_CASE("scheduler_parks_sessions_until_input_arrives", "session_scheduler") {
+  beast::CpuVirtualMachine virtual_machine;
+  beast::SessionScheduler scheduler(virtual_machine, 0);
+  const beast::SessionScheduler::SessionId session_id =
+      scheduler.addSession(makeInteractiveSession(3));
+
+  for (uint32_t input = 0; input < 3; ++input) {
+    while (scheduler.runQuantum()) {
+      // Run until the program parks.
+    }
+    REQUIRE(scheduler.getState(session_id) ==
+            beast::SessionScheduler::SessionState::WaitingForInput);
+
+    // A parked session does not busy-poll.
+    REQUIRE(scheduler.runQuantum() == false);
+
+    scheduler.setInput(session_id, kInputVariable, static_cast<int32_t>(input));
+    REQUIRE(scheduler.getState(session_id) == beast::SessionScheduler::SessionState::Runnable);
+  }
+
+  while (scheduler.runQuantum()) {
+    // Run until the program terminates.
+  }
+  REQUIRE(scheduler.getState(session_id) == beast::SessionScheduler::SessionState::Finished);
+
+  const beast::VmSession session = scheduler.removeSession(session_id);
+  REQUIRE(session.getRuntimeStatistics().terminated == true);
+  REQUIRE(session.getRuntimeStatistics().abnormal_exit == false);
+  REQUIRE(scheduler.getSessionCount() == 0);
+}
+
+TEST_CASE("scheduler_runs_many_sessions_on_worker_threads", "session_scheduler") {
+  const uint32_t session_count = 500;
+  const int32_t input_count = 4;
+
+  beast::CpuVirtualMachine virtual_machine;
+  virtual_machine.setSilent(true);
+  beast::SessionScheduler scheduler(virtual_machine, 4, 50);
+
+  std::vector<beast::SessionScheduler::SessionId> session_ids;
+  for (uint32_t idx = 0; idx < session_count; ++idx) {
+    session_ids.push_back(scheduler.addSession(makeInteractiveSession(input_count), 1 + idx % 3));
+  }
+
+  for (int32_t input = 0; input < input_count; ++input) {
+    scheduler.waitUntilIdle();
+    for (const beast::SessionScheduler::SessionId session_id : session_ids) {
+      REQUIRE(scheduler.getState(session_id) ==
+              beast::SessionScheduler::SessionState::WaitingForInput);
+      scheduler.setInput(session_id, kInputVariable, input);
+    }
+  }
+  scheduler.waitUntilIdle();
+
+  for (const beast::SessionScheduler::SessionId session_id : session_ids) {
+    REQUIRE(scheduler.getState(session_id) == beast::SessionScheduler::SessionState::Finished);
+    scheduler.accessSession(session_id, [](beast::VmSession& session) {
+      REQUIRE(session.getRuntimeStatistics().terminated == true);
+      REQUIRE(session.getVariableValue(kCountVariable, true) == 0);
+    });
+  }
+}
+
+TEST_CASE("scheduler_removes_sessions_while_they_are_accessed", "session_scheduler") {
+  beast::CpuVirtualMachine virtual_machine;
+  beast::SessionScheduler scheduler(virtual_machine, 2, 20);
+
+  // Removing a session waits for an accessor that got hold of it first.
+  const beast::SessionScheduler::SessionId accessed_id =
+      scheduler.addSession(makeInteractiveSession(1));
+  std::promise<void> accessor_entered;
+  std::atomic<bool> accessor_done{false};
+  std::thread accessor_thread([&]() {
+    scheduler.accessSession(accessed_id, [&](beast::VmSession& /*session*/) {
+      accessor_entered.set_value();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      accessor_done = true;
+    });
+  });
+  accessor_entered.get_future().wait();
+  const beast::VmSession removed = scheduler.removeSession(accessed_id);
+  REQUIRE(accessor_done == true);
+  accessor_thread.join();
+  REQUIRE_THROWS_AS(scheduler.setInput(accessed_id, kInputVariable, 1), std::invalid_argument);
+
+  // Inputs set while sessions are removed neither touch freed sessions nor requeue them.
+  std::vector<beast::SessionScheduler::SessionId> session_ids;
+  for (uint32_t idx = 0; idx < 200; ++idx) {
+    session_ids.push_back(scheduler.addSession(makeInteractiveSession(1000)));
+  }
+  std::atomic<uint32_t> rejected_count{0};
+  std::thread input_thread([&]() {
+    for (const beast::SessionScheduler::SessionId session_id : session_ids) {
+      try {
+        scheduler.setInput(session_id, kInputVariable, 1);
+      } catch (const std::invalid_argument& /*exception*/) {
+        rejected_count++;
+      }
+    }
+  });
+  for (const beast::SessionScheduler::SessionId session_id : session_ids) {
+    const beast::VmSession session = scheduler.removeSession(session_id);
+    REQUIRE(session.getRuntimeStatistics().abnormal_exit == false);
+  }
+  input_thread.join();
+
+  REQUIRE(rejected_count <= session_ids.size());
+  REQUIRE(scheduler.getSessionCount() == 0);
+  scheduler.waitUntilIdle();
+}
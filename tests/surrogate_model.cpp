@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <beast/beast.hpp>
+
+namespace {
+/**
+ * @brief Returns the index of an operator's share in the feature vector
+ */
+size_t getShareIndex(beast::OpCode opcode) {
+  return beast::SurrogateModel::getFeatureCount() - static_cast<size_t>(beast::OpCode::Size) +
+         static_cast<size_t>(opcode);
+}
+}  // namespace
+
+TEST_CASE("surrogate_model_extracts_static_program_features", "surrogate_model") {
+  beast::Program terminating;
+  terminating.noop();
+  terminating.terminate(0);
+  terminating.noop();
+  terminating.noop();
+  const std::vector<double> features =
+      beast::SurrogateModel::extractFeatures(terminating.getData());
+  REQUIRE(features.size() == beast::SurrogateModel::getFeatureCount());
+  REQUIRE(features[0] == 1.0);
+  REQUIRE(features[1] == Approx(std::log2(6.0) / 16.0));
+  // Only the first noop and the termination are reachable, which are 3 of 5 bytes.
+  REQUIRE(features[2] == Approx(0.6));
+  REQUIRE(features[getShareIndex(beast::OpCode::NoOp)] == Approx(0.75));
+  REQUIRE(features[getShareIndex(beast::OpCode::Terminate)] == Approx(0.25));
+
+  // A constant jump skips over the two noops to the termination.
+  beast::Program jumping;
+  jumping.unconditionalJumpToAbsoluteAddress(7);
+  jumping.noop();
+  jumping.noop();
+  jumping.terminate(0);
+  REQUIRE(beast::SurrogateModel::extractFeatures(jumping.getData())[2] == Approx(7.0 / 9.0));
+
+  // Targets of variable jumps are unknown, so all code may be reachable.
+  beast::Program variable_jumping;
+  variable_jumping.unconditionalJumpToAbsoluteVariableAddress(0, true);
+  variable_jumping.noop();
+  REQUIRE(beast::SurrogateModel::extractFeatures(variable_jumping.getData())[2] == 1.0);
+
+  const std::vector<double> empty_features = beast::SurrogateModel::extractFeatures({});
+  REQUIRE(empty_features[2] == 0.0);
+  REQUIRE(empty_features[getShareIndex(beast::OpCode::NoOp)] == 0.0);
+}
+
+TEST_CASE("surrogate_model_learns_scores_online", "surrogate_model") {
+  REQUIRE_THROWS_AS(beast::SurrogateModel(0.0), std::invalid_argument);
+  REQUIRE_THROWS_AS(beast::SurrogateModel(2.0), std::invalid_argument);
+
+  beast::SurrogateModel model;
+  REQUIRE(model.getSampleCount() == 0);
+  REQUIRE_THROWS_AS(model.predict({1.0}), std::invalid_argument);
+  REQUIRE_THROWS_AS(model.train({1.0}, 0.0), std::invalid_argument);
+
+  // The score is the share of noops, which the model can represent exactly.
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> count_distribution(0, 20);
+  const auto make_sample = [&]() {
+    beast::Program prg;
+    const uint32_t noop_count = count_distribution(rng);
+    const uint32_t other_count = count_distribution(rng) + 1;
+    for (uint32_t idx = 0; idx < noop_count; ++idx) {
+      prg.noop();
+    }
+    for (uint32_t idx = 0; idx < other_count; ++idx) {
+      prg.loadMemorySizeIntoVariable(0, true);
+    }
+    const double score =
+        static_cast<double>(noop_count) / static_cast<double>(noop_count + other_count);
+    return std::make_pair(beast::SurrogateModel::extractFeatures(prg.getData()), score);
+  };
+
+  const auto [initial_features, initial_score] = make_sample();
+  REQUIRE(model.predict(initial_features) == 0.0);
+  for (uint32_t sample_idx = 0; sample_idx < 3000; ++sample_idx) {
+    const auto [features, score] = make_sample();
+    model.train(features, score);
+  }
+  REQUIRE(model.getSampleCount() == 3000);
+  REQUIRE(model.getMeanAbsoluteError() < 0.05);
+  for (uint32_t sample_idx = 0; sample_idx < 20; ++sample_idx) {
+    const auto [features, score] = make_sample();
+    REQUIRE(model.predict(features) == Approx(score).margin(0.1));
+  }
+}